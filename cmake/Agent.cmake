@@ -73,6 +73,17 @@ target_link_libraries(utils
   Folly::folly
 )
 
+add_library(rx_packet_worker_pool
+  fboss/agent/RxPacketWorkerPool.cpp
+)
+
+target_link_libraries(rx_packet_worker_pool
+  utils
+  fboss_types
+  fb303::fb303
+  Folly::folly
+)
+
 add_library(stats
   fboss/agent/AggregatePortStats.cpp
   fboss/agent/PortStats.cpp
@@ -98,6 +109,7 @@ add_library(core
   fboss/agent/ApplyThriftConfig.cpp
   fboss/agent/ArpCache.cpp
   fboss/agent/ArpHandler.cpp
+  fboss/agent/ChangeFeed.cpp
   fboss/agent/DHCPv4Handler.cpp
   fboss/agent/DHCPv6Handler.cpp
   fboss/agent/HwSwitch.cpp
@@ -127,7 +139,9 @@ add_library(core
   fboss/agent/ResolvedNexthopProbe.cpp
   fboss/agent/ResolvedNexthopProbeScheduler.cpp
   fboss/agent/RestartTimeTracker.cpp
+  fboss/agent/RibUpdateQueue.cpp
   fboss/agent/RouteUpdateLogger.cpp
+  fboss/agent/RouteUpdateTracer.cpp
   fboss/agent/RouteUpdateLoggingPrefixTracker.cpp
   fboss/agent/StandaloneRibConversions.cpp
   fboss/agent/StaticL2ForNeighborObserver.cpp
@@ -145,6 +159,7 @@ add_library(core
 target_link_libraries(core
   agent_config_cpp2
   stats
+  rx_packet_worker_pool
   utils
   fb303::fb303
   capture
@@ -193,6 +208,7 @@ target_link_libraries(handler
   pkt
   fb303::fb303
   ctrl_cpp2
+  function_call_time_reporter
   log_thrift_call
   Folly::folly
 )
@@ -50,6 +50,14 @@ add_library(hw_resource_stats_publisher
   fboss/agent/hw/HwResourceStatsPublisher.cpp
 )
 
+add_library(ecmp_resource_manager
+  fboss/agent/hw/EcmpResourceManager.cpp
+)
+
+add_library(sflow_exporter
+  fboss/agent/hw/SflowExporter.cpp
+)
+
 target_link_libraries(hw_switch_warmboot_helper
   utils
   Folly::folly
@@ -89,3 +97,18 @@ target_link_libraries(hw_resource_stats_publisher
   fb303::fb303
   hardware_stats_cpp2
 )
+
+target_link_libraries(ecmp_resource_manager
+  error
+  state
+  Folly::folly
+)
+
+target_link_libraries(sflow_exporter
+  error
+  sflow_cpp2
+  sflow_structs
+  state
+  fb303::fb303
+  Folly::folly
+)
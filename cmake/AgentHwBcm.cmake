@@ -57,7 +57,6 @@ add_library(bcm
   fboss/agent/hw/bcm/BcmRoute.cpp
   fboss/agent/hw/bcm/BcmRtag7LoadBalancer.cpp
   fboss/agent/hw/bcm/BcmRtag7Module.cpp
-  fboss/agent/hw/bcm/BcmSflowExporter.cpp
   fboss/agent/hw/bcm/BcmRxPacket.cpp
   fboss/agent/hw/bcm/BcmStatUpdater.cpp
   fboss/agent/hw/bcm/BcmSwitch.cpp
@@ -97,6 +96,7 @@ add_library(bcm
 target_link_libraries(bcm
   config
   sflow_cpp2
+  sflow_exporter
   hw_switch_warmboot_helper
   hw_switch_stats
   hw_resource_stats_publisher
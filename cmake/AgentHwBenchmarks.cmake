@@ -177,6 +177,8 @@ target_link_libraries(hw_rx_slow_path_rate
   config_factory
   hw_packet_utils
   ecmp_helper
+  rx_packet_worker_pool
+  packet
   Folly::folly
 )
 
@@ -48,6 +48,7 @@ target_link_libraries(sai_switch
   hw_port_fb303_stats
   hw_resource_stats_publisher
   hw_switch_warmboot_helper
+  ecmp_resource_manager
   sai_api
   sai_store
   ref_map
@@ -15,6 +15,7 @@ add_library(packet
   fboss/agent/packet/MPLSHdr.cpp
   fboss/agent/packet/NDP.cpp
   fboss/agent/packet/NDPRouterAdvertisement.cpp
+  fboss/agent/packet/PktHeaders.cpp
   fboss/agent/packet/PktUtil.cpp
   fboss/agent/packet/TCPHeader.cpp
   fboss/agent/packet/UDPHeader.cpp
@@ -36,6 +37,7 @@ target_link_libraries(sflow_structs
 )
 
 add_library(pktutil
+  fboss/agent/packet/PktHeaders.cpp
   fboss/agent/packet/PktUtil.cpp
 )
 
@@ -13,9 +13,49 @@ target_link_libraries(product_info
   Folly::folly
 )
 
+add_executable(platform_mapping_compiler
+  fboss/agent/platforms/common/PlatformMappingCompiler.cpp
+)
+
+target_link_libraries(platform_mapping_compiler
+  platform_config_cpp2
+  Folly::folly
+)
+
+# Platform mappings whose embedded JSON gets precompiled into thrift compact
+# protocol at build time, see PrecompiledPlatformMapping.h
+set(PRECOMPILED_PLATFORM_MAPPING_SRCS
+  fboss/agent/platforms/common/galaxy/GalaxyFCPlatformMapping.cpp
+  fboss/agent/platforms/common/galaxy/GalaxyLCPlatformMapping.cpp
+  fboss/agent/platforms/common/wedge100/Wedge100PlatformMapping.cpp
+  fboss/agent/platforms/common/wedge40/Wedge40PlatformMapping.cpp
+  fboss/agent/platforms/common/wedge400c/Wedge400CPlatformMapping.cpp
+  fboss/agent/platforms/wedge/elbert/Elbert16QPimPlatformMapping.cpp
+  fboss/agent/platforms/wedge/fuji/Fuji16QPimPlatformMapping.cpp
+  fboss/agent/platforms/wedge/minipack/Minipack16QPimPlatformMapping.cpp
+  fboss/agent/platforms/wedge/wedge400/Wedge400PlatformMapping.cpp
+  fboss/agent/platforms/wedge/yamp/Yamp16QPimPlatformMapping.cpp
+)
+
+set(PRECOMPILED_PLATFORM_MAPPINGS_CPP
+  ${CMAKE_CURRENT_BINARY_DIR}/fboss/agent/platforms/common/PrecompiledPlatformMappings.cpp
+)
+
+add_custom_command(
+  OUTPUT ${PRECOMPILED_PLATFORM_MAPPINGS_CPP}
+  COMMAND platform_mapping_compiler
+    --output=${PRECOMPILED_PLATFORM_MAPPINGS_CPP}
+    ${PRECOMPILED_PLATFORM_MAPPING_SRCS}
+  DEPENDS platform_mapping_compiler ${PRECOMPILED_PLATFORM_MAPPING_SRCS}
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+  COMMENT "Precompiling platform mappings"
+)
+
 add_library(platform_mapping
   fboss/agent/platforms/common/MultiPimPlatformMapping.cpp
   fboss/agent/platforms/common/PlatformMapping.cpp
+  fboss/agent/platforms/common/PrecompiledPlatformMapping.cpp
+  ${PRECOMPILED_PLATFORM_MAPPINGS_CPP}
 )
 
 target_link_libraries(platform_mapping
@@ -25,6 +65,25 @@ target_link_libraries(platform_mapping
   ${RE2}
 )
 
+add_executable(platform_mapping_load_benchmark
+  fboss/agent/platforms/common/PlatformMappingLoadBenchmark.cpp
+)
+
+target_link_libraries(platform_mapping_load_benchmark
+  galaxy_platform_mapping
+  wedge100_platform_mapping
+  wedge40_platform_mapping
+  wedge400c_platform_mapping
+  elbert_platform_mapping
+  fuji_platform_mapping
+  minipack_platform_mapping
+  wedge400_platform_mapping
+  yamp_platform_mapping
+  hw_benchmark_main
+  Folly::folly
+  Folly::follybenchmark
+)
+
 add_library(wedge_led_utils
   fboss/agent/platforms/common/utils/GalaxyLedUtils.cpp
   fboss/agent/platforms/common/utils/Wedge100LedUtils.cpp
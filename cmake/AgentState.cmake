@@ -57,6 +57,7 @@ add_library(state
   fboss/agent/state/SwitchSettings.cpp
   fboss/agent/state/QcmConfig.cpp
   fboss/agent/state/SwitchState.cpp
+  fboss/agent/state/UcmpWeightNormalizer.cpp
   fboss/agent/state/Vlan.cpp
   fboss/agent/state/VlanMap.cpp
   fboss/agent/state/VlanMapDelta.cpp
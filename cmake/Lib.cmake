@@ -4,6 +4,7 @@
 # cmake/FooBar.cmake
 
 add_library(radix_tree
+  fboss/lib/CompactRadixTree.h
   fboss/lib/RadixTree.h
   fboss/lib/RadixTree-inl.h
 )
@@ -50,10 +51,12 @@ target_link_libraries(exponential_back_off
 )
 
 add_library(function_call_time_reporter
+  fboss/lib/CallProfiler.cpp
   fboss/lib/FunctionCallTimeReporter.cpp
 )
 
 target_link_libraries(function_call_time_reporter
+  fb303::fb303
   Folly::folly
 )
 
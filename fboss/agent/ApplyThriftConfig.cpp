@@ -11,6 +11,8 @@
 
 #include <folly/FileUtil.h>
 #include <folly/gen/Base.h>
+#include <folly/hash/Hash.h>
+#include <folly/hash/SpookyHashV2.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "fboss/agent/FbossError.h"
@@ -52,7 +54,10 @@
 #include <boost/container/flat_set.hpp>
 #include <folly/Range.h>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <map>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -93,10 +98,87 @@ void updateFibFromConfig(
   fibUpdater(*nextStatePtr);
 }
 
+/*
+ * Fingerprints of config (sub)sections, used by ThriftConfigApplyCache to
+ * tell which parts of the config are unchanged since the last apply.
+ */
+template <typename ThriftStruct>
+uint64_t fingerprint(const ThriftStruct& obj) {
+  auto serialized =
+      apache::thrift::CompactSerializer::serialize<std::string>(obj);
+  return folly::hash::SpookyHashV2::Hash64(
+      serialized.data(), serialized.size(), 0);
+}
+
+template <typename ThriftStruct>
+uint64_t fingerprint(const std::vector<ThriftStruct>& objs) {
+  uint64_t hash = objs.size();
+  for (const auto& obj : objs) {
+    hash = folly::hash::hash_combine(hash, fingerprint(obj));
+  }
+  return hash;
+}
+
+template <typename Value>
+uint64_t fingerprint(const std::map<std::string, Value>& objs) {
+  uint64_t hash = objs.size();
+  for (const auto& nameAndObj : objs) {
+    hash = folly::hash::hash_combine(
+        hash, nameAndObj.first, fingerprint(nameAndObj.second));
+  }
+  return hash;
+}
+
+template <typename OptionalRef>
+uint64_t fingerprintOptional(const OptionalRef& ref) {
+  return ref ? folly::hash::hash_combine(1, fingerprint(*ref)) : 0;
+}
+
 } // anonymous namespace
 
 namespace facebook::fboss {
 
+struct ThriftConfigApplyCache::Fingerprints {
+  /*
+   * Applier stages that get skipped as a whole when unchanged. Stages that
+   * derive data later stages consume (interfaces, vlans, ...) always run.
+   */
+  enum Section {
+    PORTS,
+    MIRRORS,
+    ACLS,
+    QOS_POLICIES,
+    SFLOW_COLLECTORS,
+    LOAD_BALANCERS,
+    NUM_SECTIONS,
+  };
+
+  struct Entry {
+    uint64_t fingerprint{0};
+    // The state node produced from the config with this fingerprint
+    std::shared_ptr<const void> node;
+
+    bool matches(uint64_t fp, const void* origNode) const {
+      return node && node.get() == origNode && fingerprint == fp;
+    }
+  };
+
+  std::array<Entry, NUM_SECTIONS> sections;
+  std::map<PortID, Entry> ports;
+  std::unordered_map<std::string, Entry> acls;
+};
+
+ThriftConfigApplyCache::ThriftConfigApplyCache()
+    : fingerprints_(std::make_unique<Fingerprints>()) {}
+
+ThriftConfigApplyCache::~ThriftConfigApplyCache() {}
+
+void ThriftConfigApplyCache::clear() {
+  fingerprints_ = std::make_unique<Fingerprints>();
+  numSkippedSections_ = 0;
+  numSkippedEntries_ = 0;
+}
+
 /*
  * A class for implementing applyThriftConfig().
  *
@@ -110,8 +192,13 @@ class ThriftConfigApplier {
       const std::shared_ptr<SwitchState>& orig,
       const cfg::SwitchConfig* config,
       const Platform* platform,
-      rib::RoutingInformationBase* rib)
-      : orig_(orig), cfg_(config), platform_(platform), rib_(rib) {}
+      rib::RoutingInformationBase* rib,
+      ThriftConfigApplyCache* cache)
+      : orig_(orig),
+        cfg_(config),
+        platform_(platform),
+        rib_(rib),
+        cache_(cache) {}
 
   std::shared_ptr<SwitchState> run();
 
@@ -288,11 +375,33 @@ class ThriftConfigApplier {
   std::shared_ptr<ForwardingInformationBaseMap>
   updateForwardingInformationBaseContainers();
 
+  using Section = ThriftConfigApplyCache::Fingerprints::Section;
+  void computeSectionFingerprints();
+  uint64_t computePortFingerprint(const cfg::Port& portCfg);
+  /*
+   * Whether a stage can be skipped: its config fingerprint is the same as
+   * last time and it would start from the very node it produced last time.
+   */
+  bool sectionUnchanged(Section section, const void* origNode);
+  bool portUnchanged(const std::shared_ptr<Port>& origPort);
+  bool aclUnchanged(
+      const std::shared_ptr<AclEntry>& origAcl,
+      int priority,
+      const MatchAction* action);
+  void recordFingerprints();
+
   std::shared_ptr<SwitchState> orig_;
   std::shared_ptr<SwitchState> new_;
   const cfg::SwitchConfig* cfg_{nullptr};
   const Platform* platform_{nullptr};
   rib::RoutingInformationBase* rib_{nullptr};
+  ThriftConfigApplyCache* cache_{nullptr};
+
+  // Fingerprints of cfg_, only computed when there is a cache_
+  std::array<uint64_t, Section::NUM_SECTIONS> sectionFingerprints_{};
+  uint64_t portDependenciesFingerprint_{0};
+  std::map<PortID, uint64_t> portFingerprints_;
+  std::unordered_map<std::string, std::optional<uint64_t>> aclFingerprints_;
 
   struct VlanIpInfo {
     VlanIpInfo(uint8_t mask, MacAddress mac, InterfaceID intf)
@@ -316,6 +425,7 @@ class ThriftConfigApplier {
 shared_ptr<SwitchState> ThriftConfigApplier::run() {
   new_ = orig_->clone();
   bool changed = false;
+  computeSectionFingerprints();
 
   {
     auto newSwitchSettings = updateSwitchSettings();
@@ -370,7 +480,10 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
   }
 
   // updateMirrors must be called after updatePorts, mirror needs ports!
-  {
+  // Mirrors only look at config driven port fields, so they are only
+  // re-evaluated if updatePorts() changed something.
+  if (new_->getPorts() != orig_->getPorts() ||
+      !sectionUnchanged(Section::MIRRORS, orig_->getMirrors().get())) {
     auto newMirrors = updateMirrors();
     if (newMirrors) {
       new_->resetMirrors(std::move(newMirrors));
@@ -379,7 +492,8 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
   }
 
   // updateAcls must be called after updateMirrors, acls may need mirror!
-  {
+  if (new_->getMirrors() != orig_->getMirrors() ||
+      !sectionUnchanged(Section::ACLS, orig_->getAcls().get())) {
     auto newAcls = updateAcls();
     if (newAcls) {
       new_->resetAcls(std::move(newAcls));
@@ -387,7 +501,8 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
     }
   }
 
-  {
+  if (!sectionUnchanged(
+          Section::QOS_POLICIES, orig_->getQosPolicies().get())) {
     auto newQosPolicies = updateQosPolicies();
     if (newQosPolicies) {
       new_->resetQosPolicies(std::move(newQosPolicies));
@@ -560,7 +675,8 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
   }
 
   // Add sFlow collectors
-  {
+  if (!sectionUnchanged(
+          Section::SFLOW_COLLECTORS, orig_->getSflowCollectors().get())) {
     auto newCollectors = updateSflowCollectors();
     if (newCollectors) {
       new_->resetSflowCollectors(std::move(newCollectors));
@@ -568,7 +684,8 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
     }
   }
 
-  {
+  if (!sectionUnchanged(
+          Section::LOAD_BALANCERS, orig_->getLoadBalancers().get())) {
     LoadBalancerConfigApplier loadBalancerConfigApplier(
         orig_->getLoadBalancers(), cfg_->get_loadBalancers(), platform_);
     auto newLoadBalancers = loadBalancerConfigApplier.updateLoadBalancers();
@@ -578,12 +695,167 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
     }
   }
 
+  recordFingerprints();
   if (!changed) {
     return nullptr;
   }
   return new_;
 }
 
+void ThriftConfigApplier::computeSectionFingerprints() {
+  if (!cache_) {
+    return;
+  }
+  cache_->numSkippedSections_ = 0;
+  cache_->numSkippedEntries_ = 0;
+
+  // Everything besides the port's own config that updatePort() reads
+  portDependenciesFingerprint_ = folly::hash::hash_combine(
+      fingerprint(*cfg_->portQueueConfigs_ref()),
+      fingerprintOptional(cfg_->dataPlaneTrafficPolicy_ref()),
+      fingerprint(*cfg_->qosPolicies_ref()),
+      fingerprintOptional(cfg_->portPgConfigs_ref()),
+      fingerprintOptional(cfg_->bufferPoolConfigs_ref()));
+
+  sectionFingerprints_[Section::MIRRORS] = fingerprint(*cfg_->mirrors_ref());
+
+  // ACL priorities follow config order, so the ACL list fingerprint does too
+  uint64_t aclsFingerprint = cfg_->acls_ref()->size();
+  for (const auto& acl : *cfg_->acls_ref()) {
+    auto aclFingerprint = fingerprint(acl);
+    auto ret = aclFingerprints_.emplace(*acl.name_ref(), aclFingerprint);
+    if (!ret.second) {
+      // Never skip ACLs whose name is not unique
+      ret.first->second = std::nullopt;
+    }
+    aclsFingerprint =
+        folly::hash::hash_combine(aclsFingerprint, aclFingerprint);
+  }
+  sectionFingerprints_[Section::ACLS] = folly::hash::hash_combine(
+      aclsFingerprint,
+      fingerprint(*cfg_->trafficCounters_ref()),
+      fingerprintOptional(cfg_->cpuTrafficPolicy_ref()),
+      fingerprintOptional(cfg_->dataPlaneTrafficPolicy_ref()));
+
+  sectionFingerprints_[Section::QOS_POLICIES] = folly::hash::hash_combine(
+      fingerprint(*cfg_->qosPolicies_ref()),
+      fingerprintOptional(cfg_->dataPlaneTrafficPolicy_ref()));
+  sectionFingerprints_[Section::SFLOW_COLLECTORS] =
+      fingerprint(*cfg_->sFlowCollectors_ref());
+  sectionFingerprints_[Section::LOAD_BALANCERS] =
+      fingerprint(*cfg_->loadBalancers_ref());
+}
+
+uint64_t ThriftConfigApplier::computePortFingerprint(
+    const cfg::Port& portCfg) {
+  auto hash = folly::hash::hash_combine(
+      fingerprint(portCfg), portDependenciesFingerprint_);
+  auto vlans = portVlans_.find(PortID(*portCfg.logicalID_ref()));
+  if (vlans != portVlans_.end()) {
+    for (const auto& vlanAndInfo : vlans->second) {
+      hash = folly::hash::hash_combine(
+          hash,
+          static_cast<uint16_t>(vlanAndInfo.first),
+          vlanAndInfo.second.tagged);
+    }
+  }
+  return hash;
+}
+
+bool ThriftConfigApplier::sectionUnchanged(
+    Section section,
+    const void* origNode) {
+  if (!cache_) {
+    return false;
+  }
+  const auto& cached = cache_->fingerprints_->sections[section];
+  if (!cached.matches(sectionFingerprints_[section], origNode)) {
+    return false;
+  }
+  ++cache_->numSkippedSections_;
+  return true;
+}
+
+bool ThriftConfigApplier::portUnchanged(const shared_ptr<Port>& origPort) {
+  if (!cache_) {
+    return false;
+  }
+  const auto& cached = cache_->fingerprints_->ports;
+  auto entry = cached.find(origPort->getID());
+  if (entry == cached.end() ||
+      !entry->second.matches(
+          portFingerprints_[origPort->getID()], origPort.get())) {
+    return false;
+  }
+  ++cache_->numSkippedEntries_;
+  return true;
+}
+
+bool ThriftConfigApplier::aclUnchanged(
+    const shared_ptr<AclEntry>& origAcl,
+    int priority,
+    const MatchAction* action) {
+  if (!cache_) {
+    return false;
+  }
+  auto aclFingerprint = aclFingerprints_.find(origAcl->getID());
+  if (aclFingerprint == aclFingerprints_.end() || !aclFingerprint->second) {
+    return false;
+  }
+  const auto& cached = cache_->fingerprints_->acls;
+  auto entry = cached.find(origAcl->getID());
+  if (entry == cached.end() ||
+      !entry->second.matches(*aclFingerprint->second, origAcl.get())) {
+    return false;
+  }
+  // Priority and action depend on where the ACL is referenced from
+  std::optional<MatchAction> newAction;
+  if (action) {
+    newAction = *action;
+  }
+  if (origAcl->getPriority() != priority ||
+      !(origAcl->getAclAction() == newAction)) {
+    return false;
+  }
+  ++cache_->numSkippedEntries_;
+  return true;
+}
+
+void ThriftConfigApplier::recordFingerprints() {
+  if (!cache_) {
+    return;
+  }
+  auto& fingerprints = *cache_->fingerprints_;
+  auto recordSection = [&](Section section, std::shared_ptr<const void> node) {
+    fingerprints.sections[section] = {
+        sectionFingerprints_[section], std::move(node)};
+  };
+  recordSection(Section::PORTS, new_->getPorts());
+  recordSection(Section::MIRRORS, new_->getMirrors());
+  recordSection(Section::ACLS, new_->getAcls());
+  recordSection(Section::QOS_POLICIES, new_->getQosPolicies());
+  recordSection(Section::SFLOW_COLLECTORS, new_->getSflowCollectors());
+  recordSection(Section::LOAD_BALANCERS, new_->getLoadBalancers());
+
+  fingerprints.ports.clear();
+  for (const auto& idAndFingerprint : portFingerprints_) {
+    if (auto port = new_->getPorts()->getPortIf(idAndFingerprint.first)) {
+      fingerprints.ports[idAndFingerprint.first] = {
+          idAndFingerprint.second, std::move(port)};
+    }
+  }
+  fingerprints.acls.clear();
+  for (const auto& nameAndFingerprint : aclFingerprints_) {
+    if (!nameAndFingerprint.second) {
+      continue;
+    }
+    if (auto acl = new_->getAcls()->getEntryIf(nameAndFingerprint.first)) {
+      fingerprints.acls[nameAndFingerprint.first] = {
+          *nameAndFingerprint.second, std::move(acl)};
+    }
+  }
+}
+
 void ThriftConfigApplier::processVlanPorts() {
   // Build the Port --> Vlan mappings
   //
@@ -685,6 +957,20 @@ shared_ptr<PortMap> ThriftConfigApplier::updatePorts() {
   PortMap::NodeContainer newPorts;
   bool changed = false;
 
+  if (cache_) {
+    uint64_t portsFingerprint = cfg_->ports_ref()->size();
+    for (const auto& portCfg : *cfg_->ports_ref()) {
+      auto portFingerprint = computePortFingerprint(portCfg);
+      portFingerprints_[PortID(*portCfg.logicalID_ref())] = portFingerprint;
+      portsFingerprint =
+          folly::hash::hash_combine(portsFingerprint, portFingerprint);
+    }
+    sectionFingerprints_[Section::PORTS] = portsFingerprint;
+    if (sectionUnchanged(Section::PORTS, origPorts.get())) {
+      return nullptr;
+    }
+  }
+
   // Process all supplied port configs
   for (const auto& portCfg : *cfg_->ports_ref()) {
     PortID id(*portCfg.logicalID_ref());
@@ -694,7 +980,7 @@ shared_ptr<PortMap> ThriftConfigApplier::updatePorts() {
       auto port = std::make_shared<Port>(
           PortID(*portCfg.logicalID_ref()), portCfg.name_ref().value_or({}));
       newPort = updatePort(port, &portCfg);
-    } else {
+    } else if (!portUnchanged(origPort)) {
       newPort = updatePort(origPort, &portCfg);
     }
     changed |= updateMap(&newPorts, origPort, newPort);
@@ -1772,6 +2058,10 @@ std::shared_ptr<AclEntry> ThriftConfigApplier::updateAcl(
     bool* changed,
     const MatchAction* action) {
   auto origAcl = orig_->getAcls()->getEntryIf(*acl.name_ref());
+  if (origAcl && aclUnchanged(origAcl, priority, action)) {
+    ++(*numExistingProcessed);
+    return origAcl;
+  }
   auto newAcl = createAcl(&acl, priority, action);
   if (origAcl) {
     ++(*numExistingProcessed);
@@ -2838,9 +3128,10 @@ shared_ptr<SwitchState> applyThriftConfig(
     const shared_ptr<SwitchState>& state,
     const cfg::SwitchConfig* config,
     const Platform* platform,
-    rib::RoutingInformationBase* rib) {
+    rib::RoutingInformationBase* rib,
+    ThriftConfigApplyCache* cache) {
   cfg::SwitchConfig emptyConfig;
-  return ThriftConfigApplier(state, config, platform, rib).run();
+  return ThriftConfigApplier(state, config, platform, rib, cache).run();
 }
 
 } // namespace facebook::fboss
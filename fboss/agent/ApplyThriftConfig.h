@@ -25,16 +25,69 @@ class SwitchConfig;
 class Platform;
 class SwitchState;
 
+/*
+ * Remembers fingerprints of the config sections, and of the individual ports
+ * and ACLs, that a previous applyThriftConfig() call applied, along with the
+ * state nodes it produced for them.
+ *
+ * When handed to the next applyThriftConfig() call, applier stages whose
+ * config inputs hash the same and whose state nodes are still the very
+ * nodes produced last time are skipped, as are unchanged ports and ACLs
+ * within a stage. Anything that modified those nodes in between (e.g. a
+ * thrift call changing a port's admin state) replaces them, so they are
+ * reconciled with config as usual.
+ *
+ * Since nodes are compared by identity, the state returned by
+ * applyThriftConfig() must be published before it is modified any further.
+ */
+class ThriftConfigApplyCache {
+ public:
+  ThriftConfigApplyCache();
+  ~ThriftConfigApplyCache();
+
+  /*
+   * Forget all fingerprints, the next apply runs every stage in full.
+   */
+  void clear();
+
+  /*
+   * Number of applier stages, and of individual ports and ACLs, skipped by
+   * the last applyThriftConfig() call.
+   */
+  size_t getNumSkippedSections() const {
+    return numSkippedSections_;
+  }
+  size_t getNumSkippedEntries() const {
+    return numSkippedEntries_;
+  }
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  ThriftConfigApplyCache(ThriftConfigApplyCache const&) = delete;
+  ThriftConfigApplyCache& operator=(ThriftConfigApplyCache const&) = delete;
+
+  friend class ThriftConfigApplier;
+  struct Fingerprints;
+
+  std::unique_ptr<Fingerprints> fingerprints_;
+  size_t numSkippedSections_{0};
+  size_t numSkippedEntries_{0};
+};
+
 /*
  * Apply a thrift config structure to a SwitchState object.
  *
  * Returns a new SwitchState object with the resulting state, or null if
  * the config file results in no changes.
+ *
+ * If a cache is given, it is used to skip work for the parts of the config
+ * that did not change since the apply that last used the same cache.
  */
 std::shared_ptr<SwitchState> applyThriftConfig(
     const std::shared_ptr<SwitchState>& state,
     const cfg::SwitchConfig* config,
     const Platform* platform,
-    rib::RoutingInformationBase* rib = nullptr);
+    rib::RoutingInformationBase* rib = nullptr,
+    ThriftConfigApplyCache* cache = nullptr);
 
 } // namespace facebook::fboss
@@ -88,7 +88,7 @@ void ArpHandler::handlePacket(
   }
 
   // Look up the Vlan state.
-  auto state = sw_->getState();
+  auto state = sw_->getStateView();
   auto vlan = state->getVlans()->getVlanIf(pkt->getSrcVlan());
   if (!vlan) {
     // Hmm, we don't actually have this VLAN configured.
@@ -136,7 +136,7 @@ void ArpHandler::handlePacket(
     stats->port(port)->arpReplyRx();
   }
 
-  if (op == ARP_OP_REQUEST && !AggregatePort::isIngressValid(state, pkt)) {
+  if (op == ARP_OP_REQUEST && !AggregatePort::isIngressValid(*state, pkt)) {
     XLOG(INFO) << "Dropping invalid ARP request ingressing on port "
                << pkt->getSrcPort() << " on vlan " << pkt->getSrcVlan()
                << " for " << targetIP;
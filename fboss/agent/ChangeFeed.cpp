@@ -0,0 +1,393 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ChangeFeed.h"
+
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/state/ArpEntry.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseDelta.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/MacEntry.h"
+#include "fboss/agent/state/MacTable.h"
+#include "fboss/agent/state/NdpEntry.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <folly/Random.h>
+#include <folly/logging/xlog.h>
+
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/experimental/coro/Invoke.h>
+#include <folly/experimental/coro/Sleep.h>
+#endif
+
+#include <algorithm>
+
+DEFINE_int32(
+    change_feed_capacity,
+    100000,
+    "Number of FIB, neighbor and MAC changes kept for change feed clients");
+DEFINE_int32(
+    change_feed_page_size,
+    1000,
+    "Maximum number of changes sent in a single change feed stream page");
+DEFINE_int32(
+    change_feed_poll_interval_ms,
+    100,
+    "How often change feed streams look for new changes once caught up");
+DEFINE_int32(
+    change_feed_scan_window,
+    10000,
+    "Maximum number of changes a change feed read looks at, matching or not, "
+    "unless asked for more");
+
+using facebook::network::toBinaryAddress;
+using facebook::network::toIPAddress;
+
+namespace facebook::fboss {
+
+namespace {
+
+int32_t toThriftPort(const PortDescriptor& port) {
+  return port.isPhysicalPort() ? static_cast<int32_t>(port.phyPortID())
+                               : static_cast<int32_t>(port.aggPortID());
+}
+
+template <typename AddrT>
+void setPrefix(ChangeFeedEntry& change, const AddrT& network, uint8_t mask) {
+  change.prefix_ref()->ip = toBinaryAddress(network);
+  change.prefix_ref()->prefixLength = mask;
+}
+
+int64_t newFeedId() {
+  int64_t id = 0;
+  while (id == 0) {
+    id = static_cast<int64_t>(folly::Random::secureRand64() >> 1);
+  }
+  return id;
+}
+
+} // namespace
+
+ChangeFeedMatcher::ChangeFeedMatcher(const ChangeFeedFilter& filter) {
+  if (filter.prefixes_ref().has_value()) {
+    prefixes_.emplace();
+    for (const auto& prefix : *filter.prefixes_ref()) {
+      auto ip = toIPAddress(prefix.ip);
+      prefixes_->insert(
+          ip.mask(prefix.prefixLength), prefix.prefixLength, true);
+    }
+  }
+  if (filter.vlans_ref().has_value()) {
+    vlans_.emplace(filter.vlans_ref()->begin(), filter.vlans_ref()->end());
+  }
+  if (filter.types_ref().has_value()) {
+    types_.emplace(filter.types_ref()->begin(), filter.types_ref()->end());
+  }
+}
+
+bool ChangeFeedMatcher::matches(const ChangeFeedEntry& entry) const {
+  auto type = *entry.type_ref();
+  if (types_ && !types_->count(type)) {
+    return false;
+  }
+  if (vlans_ && type != ChangeFeedEntryType::ROUTE &&
+      !vlans_->count(*entry.vlanID_ref())) {
+    return false;
+  }
+  if (prefixes_ && type != ChangeFeedEntryType::MAC) {
+    const auto& prefix = *entry.prefix_ref();
+    if (prefixes_->longestMatch(toIPAddress(prefix.ip), prefix.prefixLength) ==
+        prefixes_->end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ChangeFeed::ChangeFeed(SwSwitch* sw)
+    : ChangeFeed(sw, std::max(FLAGS_change_feed_capacity, 1)) {}
+
+ChangeFeed::ChangeFeed(SwSwitch* sw, size_t capacity)
+    : AutoRegisterStateObserver(sw, "ChangeFeed"),
+      feed_(std::make_shared<Feed>(capacity)) {}
+
+ChangeFeed::~ChangeFeed() {
+  feed_->stopped.store(true);
+}
+
+ChangeFeed::Feed::Feed(size_t capacity)
+    : id(newFeedId()), capacity(capacity) {
+  buffer.wlock()->entries.resize(capacity);
+}
+
+template <typename AddrT, typename RoutesDeltaT>
+void ChangeFeed::addRouteChanges(
+    RouterID vrf,
+    const RoutesDeltaT& routesDelta,
+    std::vector<ChangeFeedEntry>* changes) {
+  using RouteT = Route<AddrT>;
+  DeltaFunctions::forEachChanged(
+      routesDelta,
+      [&](const auto& oldRoute, const auto& newRoute) {
+        addRouteChange(vrf, oldRoute, newRoute, changes);
+      },
+      [&](const auto& newRoute) {
+        addRouteChange(vrf, std::shared_ptr<RouteT>(), newRoute, changes);
+      },
+      [&](const auto& oldRoute) {
+        addRouteChange(vrf, oldRoute, std::shared_ptr<RouteT>(), changes);
+      });
+}
+
+template <typename AddrT>
+void ChangeFeed::addRouteChange(
+    RouterID vrf,
+    const std::shared_ptr<Route<AddrT>>& oldRoute,
+    const std::shared_ptr<Route<AddrT>>& newRoute,
+    std::vector<ChangeFeedEntry>* changes) {
+  // Only resolved routes make it to the FIB
+  bool wasResolved = oldRoute && oldRoute->isResolved();
+  bool isResolved = newRoute && newRoute->isResolved();
+  if (!wasResolved && !isResolved) {
+    return;
+  }
+  const auto& route = isResolved ? newRoute : oldRoute;
+  ChangeFeedEntry change;
+  *change.type_ref() = ChangeFeedEntryType::ROUTE;
+  *change.removed_ref() = !isResolved;
+  setPrefix(change, route->prefix().network, route->prefix().mask);
+  *change.vrf_ref() = vrf;
+  if (isResolved) {
+    *change.nextHops_ref() =
+        util::fromRouteNextHopSet(route->getForwardInfo().getNextHopSet());
+  }
+  changes->push_back(std::move(change));
+}
+
+template <typename NeighborEntryT>
+void ChangeFeed::addNeighborChange(
+    ChangeFeedEntryType type,
+    VlanID vlan,
+    const std::shared_ptr<NeighborEntryT>& oldEntry,
+    const std::shared_ptr<NeighborEntryT>& newEntry,
+    std::vector<ChangeFeedEntry>* changes) {
+  // Pending entries are not programmed yet
+  bool wasResolved = oldEntry && !oldEntry->isPending();
+  bool isResolved = newEntry && !newEntry->isPending();
+  if (!wasResolved && !isResolved) {
+    return;
+  }
+  const auto& entry = isResolved ? newEntry : oldEntry;
+  ChangeFeedEntry change;
+  *change.type_ref() = type;
+  *change.removed_ref() = !isResolved;
+  setPrefix(change, entry->getIP(), entry->getIP().bitCount());
+  *change.mac_ref() = entry->getMac().toString();
+  *change.vlanID_ref() = vlan;
+  *change.port_ref() = toThriftPort(entry->getPort());
+  changes->push_back(std::move(change));
+}
+
+void ChangeFeed::stateUpdated(const StateDelta& delta) {
+  // Build the changes before taking the lock, so readers are only held up
+  // for as long as it takes to copy them in
+  std::vector<ChangeFeedEntry> changes;
+  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+    auto vrf = rtDelta.getNew() ? rtDelta.getNew()->getID()
+                                : rtDelta.getOld()->getID();
+    addRouteChanges<folly::IPAddressV4>(
+        vrf, rtDelta.getRoutesV4Delta(), &changes);
+    addRouteChanges<folly::IPAddressV6>(
+        vrf, rtDelta.getRoutesV6Delta(), &changes);
+  }
+  // With the standalone RIB, routes get to the switch state as FIBs instead
+  for (const auto& fibDelta : delta.getFibsDelta()) {
+    auto vrf = fibDelta.getNew() ? fibDelta.getNew()->getID()
+                                 : fibDelta.getOld()->getID();
+    addRouteChanges<folly::IPAddressV4>(
+        vrf, fibDelta.getV4FibDelta(), &changes);
+    addRouteChanges<folly::IPAddressV6>(
+        vrf, fibDelta.getV6FibDelta(), &changes);
+  }
+
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    auto vlan = vlanDelta.getNew() ? vlanDelta.getNew()->getID()
+                                   : vlanDelta.getOld()->getID();
+    auto arpType = ChangeFeedEntryType::ARP;
+    DeltaFunctions::forEachChanged(
+        vlanDelta.getArpDelta(),
+        [&](const auto& oldEntry, const auto& newEntry) {
+          addNeighborChange(arpType, vlan, oldEntry, newEntry, &changes);
+        },
+        [&](const auto& newEntry) {
+          addNeighborChange(
+              arpType, vlan, std::shared_ptr<ArpEntry>(), newEntry, &changes);
+        },
+        [&](const auto& oldEntry) {
+          addNeighborChange(
+              arpType, vlan, oldEntry, std::shared_ptr<ArpEntry>(), &changes);
+        });
+    auto ndpType = ChangeFeedEntryType::NDP;
+    DeltaFunctions::forEachChanged(
+        vlanDelta.getNdpDelta(),
+        [&](const auto& oldEntry, const auto& newEntry) {
+          addNeighborChange(ndpType, vlan, oldEntry, newEntry, &changes);
+        },
+        [&](const auto& newEntry) {
+          addNeighborChange(
+              ndpType, vlan, std::shared_ptr<NdpEntry>(), newEntry, &changes);
+        },
+        [&](const auto& oldEntry) {
+          addNeighborChange(
+              ndpType, vlan, oldEntry, std::shared_ptr<NdpEntry>(), &changes);
+        });
+
+    auto addMacChange = [&](const std::shared_ptr<MacEntry>& entry,
+                            bool removed) {
+      ChangeFeedEntry change;
+      *change.type_ref() = ChangeFeedEntryType::MAC;
+      *change.removed_ref() = removed;
+      *change.mac_ref() = entry->getMac().toString();
+      *change.vlanID_ref() = vlan;
+      *change.port_ref() = toThriftPort(entry->getPort());
+      changes.push_back(std::move(change));
+    };
+    DeltaFunctions::forEachChanged(
+        vlanDelta.getMacDelta(),
+        [&](const auto& /*oldEntry*/, const auto& newEntry) {
+          addMacChange(newEntry, false);
+        },
+        [&](const auto& newEntry) { addMacChange(newEntry, false); },
+        [&](const auto& oldEntry) { addMacChange(oldEntry, true); });
+  }
+
+  if (changes.empty()) {
+    return;
+  }
+  auto buffer = feed_->buffer.wlock();
+  for (auto& change : changes) {
+    auto sequence = ++buffer->lastSequence;
+    *change.sequence_ref() = sequence;
+    buffer->entries[(sequence - 1) % feed_->capacity] = std::move(change);
+  }
+  XLOG(DBG4) << "Change feed at sequence " << buffer->lastSequence << " after "
+             << changes.size() << " changes";
+}
+
+ChangeFeedPage ChangeFeed::read(
+    int64_t afterSequence,
+    int64_t feedId,
+    const ChangeFeedMatcher& matcher,
+    size_t maxEntries) const {
+  return feed_->read(afterSequence, feedId, matcher, maxEntries);
+}
+
+int64_t ChangeFeed::getLastSequence() const {
+  return feed_->getLastSequence();
+}
+
+int64_t ChangeFeed::getFeedId() const {
+  return feed_->id;
+}
+
+ChangeFeedPage ChangeFeed::Feed::read(
+    int64_t afterSequence,
+    int64_t feedId,
+    const ChangeFeedMatcher& matcher,
+    size_t maxEntries) const {
+  ChangeFeedPage page;
+  *page.feedId_ref() = id;
+  // Copy the changes out first, so that state updates are only held up for
+  // as long as that takes and not for matching them too
+  std::vector<ChangeFeedEntry> window;
+  {
+    auto buffer = this->buffer.rlock();
+    if (afterSequence < 0) {
+      afterSequence = buffer->lastSequence;
+      feedId = id;
+    }
+    int64_t oldestSequence = std::max<int64_t>(
+        buffer->lastSequence - static_cast<int64_t>(capacity) + 1, 1);
+    // Either the changes asked for were overwritten already, or the client
+    // was following the feed of a previous agent run
+    if ((feedId != 0 && feedId != id) || afterSequence + 1 < oldestSequence ||
+        afterSequence > buffer->lastSequence) {
+      *page.resyncRequired_ref() = true;
+      *page.lastSequence_ref() = buffer->lastSequence;
+      return page;
+    }
+    auto scanWindow = std::max<int64_t>(
+        maxEntries, std::max(FLAGS_change_feed_scan_window, 1));
+    auto windowEnd =
+        std::min(buffer->lastSequence, afterSequence + scanWindow);
+    window.reserve(windowEnd - afterSequence);
+    for (auto sequence = afterSequence; sequence < windowEnd; ++sequence) {
+      window.push_back(buffer->entries[sequence % capacity]);
+    }
+  }
+  auto sequence = afterSequence;
+  for (auto& entry : window) {
+    if (page.entries_ref()->size() >= maxEntries) {
+      break;
+    }
+    ++sequence;
+    if (matcher.matches(entry)) {
+      page.entries_ref()->push_back(std::move(entry));
+    }
+  }
+  *page.lastSequence_ref() = sequence;
+  return page;
+}
+
+int64_t ChangeFeed::Feed::getLastSequence() const {
+  return buffer.rlock()->lastSequence;
+}
+
+#if FOLLY_HAS_COROUTINES
+apache::thrift::ServerStream<ChangeFeedPage> ChangeFeed::subscribe(
+    int64_t afterSequence,
+    int64_t feedId,
+    std::unique_ptr<ChangeFeedMatcher> matcher) {
+  if (afterSequence < 0) {
+    afterSequence = getLastSequence();
+    feedId = getFeedId();
+  }
+  // Hold on to the feed rather than to this, which may go away first
+  return folly::coro::co_invoke(
+      [feed = feed_, afterSequence, feedId, matcher = std::move(matcher)]()
+          mutable -> folly::coro::AsyncGenerator<ChangeFeedPage&&> {
+        while (!feed->stopped.load()) {
+          auto page = feed->read(
+              afterSequence, feedId, *matcher, FLAGS_change_feed_page_size);
+          bool caughtUp = *page.lastSequence_ref() == feed->getLastSequence();
+          afterSequence = *page.lastSequence_ref();
+          feedId = feed->id;
+          if (*page.resyncRequired_ref() || !page.entries_ref()->empty()) {
+            co_yield std::move(page);
+          } else if (caughtUp) {
+            co_await folly::coro::sleep(
+                std::chrono::milliseconds(FLAGS_change_feed_poll_interval_ms));
+          }
+        }
+      });
+}
+#endif
+
+} // namespace facebook::fboss
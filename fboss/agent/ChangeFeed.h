@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+#include "fboss/agent/types.h"
+#include "fboss/lib/RadixTree.h"
+
+#include <folly/IPAddress.h>
+#include <folly/Synchronized.h>
+#include <thrift/lib/cpp2/async/ServerStream.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace facebook::fboss {
+
+class SwSwitch;
+class StateDelta;
+template <typename AddrT>
+class Route;
+
+/*
+ * Compiled form of a ChangeFeedFilter. Prefixes are kept in a radix tree,
+ * so matching a change takes a single longest match however many prefixes
+ * a client follows.
+ */
+class ChangeFeedMatcher {
+ public:
+  explicit ChangeFeedMatcher(const ChangeFeedFilter& filter);
+
+  bool matches(const ChangeFeedEntry& entry) const;
+
+ private:
+  std::optional<network::RadixTree<folly::IPAddress, bool>> prefixes_;
+  std::optional<std::unordered_set<int32_t>> vlans_;
+  std::optional<std::unordered_set<ChangeFeedEntryType>> types_;
+};
+
+/*
+ * Keeps the latest FIB, ARP/NDP and MAC table changes, numbered in the order
+ * they were applied to the switch state, so that clients can follow them
+ * instead of polling the full tables.
+ *
+ * Changes are kept in a ring buffer of fixed capacity, which is all the
+ * memory the feed ever uses however slow its clients are. A client that
+ * falls further behind than the buffer holds is asked to resync: dump the
+ * tables it follows and resume from the latest sequence number. So is a
+ * client whose feed ID is not the feed's own, as sequence numbers start over
+ * with every ChangeFeed, which is with every run of the agent.
+ *
+ * Reads copy at most --change_feed_scan_window changes out of the buffer
+ * before matching them, so that clients with narrow filters don't hold up
+ * state updates while the whole buffer is scanned.
+ *
+ * Open streams share the ring buffer with the feed, so they may outlive it.
+ * They end within a poll interval of the feed being destroyed.
+ */
+class ChangeFeed : public AutoRegisterStateObserver {
+ public:
+  explicit ChangeFeed(SwSwitch* sw);
+  ChangeFeed(SwSwitch* sw, size_t capacity);
+  ~ChangeFeed() override;
+
+  void stateUpdated(const StateDelta& delta) override;
+
+  /*
+   * Returns at most maxEntries of the changes made after afterSequence that
+   * match. A negative afterSequence stands for the latest sequence number,
+   * and a feedId of 0 for a client that has none yet.
+   */
+  ChangeFeedPage read(
+      int64_t afterSequence,
+      int64_t feedId,
+      const ChangeFeedMatcher& matcher,
+      size_t maxEntries) const;
+
+  int64_t getLastSequence() const;
+  int64_t getFeedId() const;
+
+#if FOLLY_HAS_COROUTINES
+  /*
+   * Stream the matching changes made after afterSequence, and then new ones
+   * as they are made. Changes are read from the ring buffer as the client
+   * asks for them, so nothing is queued for slow clients.
+   */
+  apache::thrift::ServerStream<ChangeFeedPage> subscribe(
+      int64_t afterSequence,
+      int64_t feedId,
+      std::unique_ptr<ChangeFeedMatcher> matcher);
+#endif
+
+ private:
+  template <typename AddrT, typename RoutesDeltaT>
+  static void addRouteChanges(
+      RouterID vrf,
+      const RoutesDeltaT& routesDelta,
+      std::vector<ChangeFeedEntry>* changes);
+  template <typename AddrT>
+  static void addRouteChange(
+      RouterID vrf,
+      const std::shared_ptr<Route<AddrT>>& oldRoute,
+      const std::shared_ptr<Route<AddrT>>& newRoute,
+      std::vector<ChangeFeedEntry>* changes);
+  template <typename NeighborEntryT>
+  static void addNeighborChange(
+      ChangeFeedEntryType type,
+      VlanID vlan,
+      const std::shared_ptr<NeighborEntryT>& oldEntry,
+      const std::shared_ptr<NeighborEntryT>& newEntry,
+      std::vector<ChangeFeedEntry>* changes);
+
+  struct RingBuffer {
+    // Change with sequence number s is at entries[(s - 1) % capacity]
+    std::vector<ChangeFeedEntry> entries;
+    int64_t lastSequence{0};
+  };
+
+  /*
+   * Everything open streams read, kept apart from the feed so that they
+   * can hold on to it
+   */
+  struct Feed {
+    explicit Feed(size_t capacity);
+
+    ChangeFeedPage read(
+        int64_t afterSequence,
+        int64_t feedId,
+        const ChangeFeedMatcher& matcher,
+        size_t maxEntries) const;
+    int64_t getLastSequence() const;
+
+    // Random, and never 0
+    const int64_t id;
+    const size_t capacity;
+    folly::Synchronized<RingBuffer> buffer;
+    // Set once the ChangeFeed is destroyed, to end open streams
+    std::atomic<bool> stopped{false};
+  };
+
+  std::shared_ptr<Feed> feed_;
+};
+
+} // namespace facebook::fboss
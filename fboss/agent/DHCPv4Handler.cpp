@@ -205,7 +205,7 @@ void DHCPv4Handler::processRequest(
     const IPv4Hdr& origIPHdr,
     const DHCPv4Packet& dhcpPacket) {
   auto dhcpPacketOut(dhcpPacket);
-  auto state = sw->getState();
+  auto state = sw->getStateView();
   auto vlan = state->getVlans()->getVlanIf(pkt->getSrcVlan());
   if (!vlan) {
     sw->stats()->dhcpV4DropPkt();
@@ -294,7 +294,7 @@ void DHCPv4Handler::processReply(
     const IPv4Hdr& origIPHdr,
     const DHCPv4Packet& dhcpPacket) {
   auto dhcpPacketOut(dhcpPacket);
-  auto state = sw->getState();
+  auto state = sw->getStateView();
   if (!stripAgentOptions(sw, pkt->getSrcPort(), dhcpPacket, dhcpPacketOut)) {
     sw->portStats(pkt->getSrcPort())->dhcpV4BadPkt();
     XLOG(DBG4) << "Bad DHCP packet, error stripping agent options."
@@ -280,7 +280,7 @@ void DHCPv6Handler::processDHCPv6RelayReply(
     MacAddress /*dstMac*/,
     const IPv6Hdr& ipHdr,
     DHCPv6Packet& dhcpPacket) {
-  auto state = sw->getState();
+  auto state = sw->getStateView();
 
   auto switchIp = state->getDhcpV6ReplySrc();
   if (switchIp.isZero()) {
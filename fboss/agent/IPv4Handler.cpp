@@ -141,7 +141,7 @@ void IPv4Handler::handlePacket(
   cursor.reset(payload.get());
 
   // retrieve the current switch state
-  auto state = sw_->getState();
+  auto state = sw_->getStateView();
   // Need to check if the packet is for self or not. We store our IP
   // in the ARP response table. Use that for now.
   auto vlan = state->getVlans()->getVlanIf(pkt->getSrcVlan());
@@ -230,7 +230,8 @@ void IPv4Handler::handlePacket(
   // We will need to manage the rate somehow. Either from HW
   // or a SW control here
   stats->port(port)->ipv4Nexthop();
-  if (!resolveMac(state, port, v4Hdr.dstAddr, pkt->getSrcVlan())) {
+  // Route lookups need the state itself rather than a view of it
+  if (!resolveMac(sw_->getState(), port, v4Hdr.dstAddr, pkt->getSrcVlan())) {
     stats->port(port)->ipv4NoArp();
     XLOG(DBG4) << "Cannot find the interface to send out ARP request for "
                << v4Hdr.dstAddr.str();
@@ -152,7 +152,11 @@ void LinkAggregationManager::stateUpdated(const StateDelta& delta) {
   folly::SharedMutexWritePriority::ReadHolder readGuard(std::move(writeGuard));
 
   DeltaFunctions::forEachChanged(
-      delta.getPortsDelta(), &LinkAggregationManager::portChanged, this);
+      delta.getPortsDelta(),
+      &LinkAggregationManager::portChanged,
+      &LinkAggregationManager::portAdded,
+      &LinkAggregationManager::portRemoved,
+      this);
 }
 
 void LinkAggregationManager::aggregatePortAdded(
@@ -252,11 +256,30 @@ void LinkAggregationManager::updateAggregatePortStats(
   aggregatePortStats->aggregatePortNameChanged(newAggPort->getName());
 }
 
+void LinkAggregationManager::portAdded(
+    const std::shared_ptr<Port>& /*addedPort*/) {}
+
+void LinkAggregationManager::portRemoved(
+    const std::shared_ptr<Port>& removedPort) {
+  pduHeaders_.wlock()->erase(removedPort->getID());
+}
+
 void LinkAggregationManager::portChanged(
     const std::shared_ptr<Port>& oldPort,
     const std::shared_ptr<Port>& newPort) {
   auto portId = newPort->getID();
 
+  if (oldPort->getIngressVlan() != newPort->getIngressVlan()) {
+    // The vlan is the only part of the LACPDU header that depends on the
+    // port, so it is patched into the cached header in place
+    auto headers = pduHeaders_.wlock();
+    auto it = headers->find(portId);
+    if (it != headers->end()) {
+      TxPacket::setEthHeaderVlan(it->second.data(), newPort->getIngressVlan());
+      sw_->stats()->LacpPduTemplatePatch();
+    }
+  }
+
   if (oldPort->getOperState() == Port::OperState::DOWN &&
       newPort->getOperState() == Port::OperState::UP) {
     auto it = portToController_.find(portId);
@@ -331,19 +354,37 @@ bool LinkAggregationManager::transmit(LACPDU lacpdu, PortID portID) {
 
   folly::io::RWPrivateCursor writer(pkt->buf());
 
-  folly::MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
-
-  auto port = sw_->getState()->getPorts()->getPortIf(portID);
-  CHECK(port);
-
-  TxPacket::writeEthHeader(
-      &writer,
-      LACPDU::kSlowProtocolsDstMac(),
-      cpuMac,
-      port->getIngressVlan(),
-      LACPDU::EtherType::SLOW_PROTOCOLS);
-
-  writer.writeBE<uint8_t>(LACPDU::EtherSubtype::LACP);
+  {
+    // Everything up to the LACPDU itself only depends on the port's ingress
+    // vlan, so it is only built once per port and patched by stateUpdated()
+    // when the vlan changes. The state is looked up with the lock held, so
+    // stateUpdated() can't patch the header before a stale one gets
+    // inserted.
+    auto headers = pduHeaders_.wlock();
+    auto& header = (*headers)[portID];
+    if (header.empty()) {
+      folly::MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
+
+      auto port = sw_->getState()->getPorts()->getPortIf(portID);
+      CHECK(port);
+
+      TxPacket::writeEthHeader(
+          &writer,
+          LACPDU::kSlowProtocolsDstMac(),
+          cpuMac,
+          port->getIngressVlan(),
+          LACPDU::EtherType::SLOW_PROTOCOLS);
+
+      writer.writeBE<uint8_t>(LACPDU::EtherSubtype::LACP);
+
+      const auto* data = pkt->buf()->data();
+      header.assign(data, data + writer.getCurrentPosition());
+      sw_->stats()->LacpPduTemplateRebuild();
+    } else {
+      writer.push(header.data(), header.size());
+      sw_->stats()->LacpPduTemplateHit();
+    }
+  }
 
   lacpdu.to(&writer);
 
@@ -17,9 +17,11 @@
 #include <boost/container/flat_map.hpp>
 
 #include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
 #include <folly/io/Cursor.h>
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace facebook::fboss {
@@ -108,6 +110,8 @@ class LinkAggregationManager : public AutoRegisterStateObserver,
   void portChanged(
       const std::shared_ptr<Port>& oldPort,
       const std::shared_ptr<Port>& newPort);
+  void portAdded(const std::shared_ptr<Port>& addedPort);
+  void portRemoved(const std::shared_ptr<Port>& removedPort);
 
   void updateAggregatePortStats(
       const std::shared_ptr<AggregatePort>& oldAggPort,
@@ -125,6 +129,10 @@ class LinkAggregationManager : public AutoRegisterStateObserver,
 
   PortIDToController portToController_;
   mutable folly::SharedMutexWritePriority controllersLock_;
+  // Ethernet header and LACP subtype of the LACPDUs sent on each port.
+  // Written on the LACP thread, patched from the update thread.
+  folly::Synchronized<std::unordered_map<PortID, std::vector<uint8_t>>>
+      pduHeaders_;
   SwSwitch* sw_{nullptr};
   bool initialStateSynced_{false};
 };
@@ -11,18 +11,23 @@
 #include "fboss/agent/LldpManager.h"
 
 #include <folly/MacAddress.h>
+#include <folly/Random.h>
 #include <folly/Range.h>
 #include <folly/futures/Future.h>
+#include <folly/hash/Hash.h>
 #include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include <unistd.h>
+#include <algorithm>
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 #include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/PortDescriptor.h"
+#include "fboss/agent/state/StateDelta.h"
 
 using folly::ByteRange;
 using folly::MacAddress;
@@ -66,10 +71,26 @@ namespace facebook::fboss {
 
 const MacAddress LldpManager::LLDP_DEST_MAC("01:80:c2:00:00:0e");
 
+namespace {
+std::string getHostname() {
+  const size_t kMaxLen = 64;
+  std::array<char, kMaxLen> hostname;
+  if (0 == gethostname(hostname.data(), kMaxLen)) {
+    // make sure it is null terminated
+    hostname[kMaxLen - 1] = '\0';
+  } else {
+    hostname[0] = '\0';
+  }
+  return std::string(hostname.data());
+}
+} // namespace
+
 LldpManager::LldpManager(SwSwitch* sw)
-    : folly::AsyncTimeout(sw->getBackgroundEvb()),
+    : AutoRegisterStateObserver(sw, "LldpManager"),
+      folly::AsyncTimeout(sw->getBackgroundEvb()),
       sw_(sw),
-      intervalMsecs_(LLDP_INTERVAL) {}
+      intervalMsecs_(LLDP_INTERVAL),
+      txSlotSeed_(folly::Random::rand32()) {}
 
 LldpManager::~LldpManager() {}
 
@@ -79,8 +100,27 @@ void LldpManager::start() {
 }
 
 void LldpManager::stop() {
-  sw_->getBackgroundEvb()->runInEventBaseThreadAndWait(
-      [this] { this->cancelTimeout(); });
+  sw_->getBackgroundEvb()->runInEventBaseThreadAndWait([this] {
+    this->cancelTimeout();
+    nextTxSlot_.reset();
+  });
+}
+
+void LldpManager::stateUpdated(const StateDelta& delta) {
+  // Templates of changed ports get patched when next sent, only those of
+  // removed ports have to go.
+  std::vector<PortID> removedPorts;
+  DeltaFunctions::forEachRemoved(
+      delta.getPortsDelta(), [&](const shared_ptr<Port>& removedPort) {
+        removedPorts.push_back(removedPort->getID());
+      });
+  if (removedPorts.empty()) {
+    return;
+  }
+  auto templates = templates_.wlock();
+  for (auto port : removedPorts) {
+    templates->erase(port);
+  }
 }
 
 void LldpManager::handlePacket(
@@ -108,7 +148,7 @@ void LldpManager::handlePacket(
              << " name=" << neighbor.getSystemName();
 
   auto plport = sw_->getPlatform()->getPlatformPort(pkt->getSrcPort());
-  auto port = sw_->getState()->getPorts()->getPortIf(pkt->getSrcPort());
+  auto port = sw_->getStateView()->getPorts()->getPortIf(pkt->getSrcPort());
   PortID pid = pkt->getSrcPort();
 
   XLOG(DBG4) << "Port " << pid << ", local name: " << port->getName()
@@ -140,20 +180,38 @@ void LldpManager::handlePacket(
 
 void LldpManager::timeoutExpired() noexcept {
   try {
-    sendLldpOnAllPorts();
+    sendLldpOnPorts(nextTxSlot_);
   } catch (const std::exception& ex) {
     XLOG(ERR) << "Failed to send LLDP on all ports. Error:"
               << folly::exceptionStr(ex);
   }
-  scheduleTimeout(intervalMsecs_);
+  // Announce ourselves on all ports right after start(), then every tick
+  // only covers the ports hashed to it.
+  nextTxSlot_ = nextTxSlot_ ? (*nextTxSlot_ + 1) % LLDP_TX_SLOTS : 0;
+  scheduleTimeout(intervalMsecs_ / LLDP_TX_SLOTS);
+}
+
+uint32_t LldpManager::getTxSlot(PortID port) const {
+  return folly::hash::twang_32from64(
+             (uint64_t(txSlotSeed_) << 32) | static_cast<uint16_t>(port)) %
+      LLDP_TX_SLOTS;
 }
 
 void LldpManager::sendLldpOnAllPorts() {
+  sendLldpOnPorts(std::nullopt);
+}
+
+void LldpManager::sendLldpOnPorts(std::optional<uint32_t> txSlot) {
   // send lldp frames through all the ports here.
   std::shared_ptr<SwitchState> state = sw_->getState();
+  // Only look the hostname up once per round rather than once per port
+  auto hostname = getHostname();
   for (const auto& port : *state->getPorts()) {
+    if (txSlot && getTxSlot(port->getID()) != *txSlot) {
+      continue;
+    }
     if (port->isPortUp()) {
-      sendLldpInfo(port);
+      sendLldpInfo(port, hostname);
     } else {
       XLOG(DBG5) << "Skipping LLDP send as this port is disabled "
                  << port->getID();
@@ -217,6 +275,47 @@ void writeTlv(
   cursor->push(value.data(), value.size());
 }
 
+namespace {
+// Where things are in the frames built by createLldpPkt()
+constexpr size_t kSrcMacOffset = MacAddress::SIZE;
+constexpr size_t kFirstTlvOffset = 2 * MacAddress::SIZE + 6;
+constexpr size_t kChassisMacOffset = kFirstTlvOffset + 3;
+
+/*
+ * Replace the value of the first TLV of the given type in frame, past
+ * subtypeLength bytes of subtype, moving the TLVs after it as needed.
+ */
+bool patchTlv(
+    std::vector<uint8_t>& frame,
+    LldpTlvType type,
+    size_t subtypeLength,
+    StringPiece value) {
+  size_t offset = kFirstTlvOffset;
+  while (offset + 2 <= frame.size()) {
+    uint16_t typeLength = (frame[offset] << 8) | frame[offset + 1];
+    auto tlvType = static_cast<LldpTlvType>(
+        typeLength >> LldpManager::TLV_TYPE_LEFT_SHIFT_OFFSET);
+    size_t length = typeLength & 0x01ff;
+    if (tlvType == type) {
+      auto valueStart = frame.begin() + offset + 2 + subtypeLength;
+      valueStart =
+          frame.erase(valueStart, valueStart + (length - subtypeLength));
+      frame.insert(valueStart, value.begin(), value.end());
+      typeLength = tlvHeader(
+          static_cast<uint16_t>(type), subtypeLength + value.size());
+      frame[offset] = typeLength >> 8;
+      frame[offset + 1] = typeLength & 0xff;
+      return true;
+    }
+    if (tlvType == LldpTlvType::PDU_END) {
+      break;
+    }
+    offset += 2 + length;
+  }
+  return false;
+}
+} // namespace
+
 uint32_t LldpManager::LldpPktSize(
     const std::string& hostname,
     const std::string& portname,
@@ -313,29 +412,99 @@ std::unique_ptr<TxPacket> LldpManager::createLldpPkt(
   return pkt;
 }
 
-void LldpManager::sendLldpInfo(const std::shared_ptr<Port>& port) {
+bool LldpManager::PduTemplate::matches(
+    MacAddress mac,
+    const Port& port,
+    const std::string& host) const {
+  return !frame.empty() && cpuMac == mac && vlan == port.getIngressVlan() &&
+      hostname == host && portName == port.getName() &&
+      portDesc == port.getDescription();
+}
+
+bool LldpManager::PduTemplate::patch(
+    MacAddress mac,
+    const Port& port,
+    const std::string& host) {
+  // The system name TLV is left out without a hostname, so one can't be
+  // patched in or out
+  if (frame.empty() || hostname.empty() != host.empty()) {
+    return false;
+  }
+  if (cpuMac != mac) {
+    std::copy(
+        mac.bytes(), mac.bytes() + MacAddress::SIZE, &frame[kSrcMacOffset]);
+    std::copy(
+        mac.bytes(),
+        mac.bytes() + MacAddress::SIZE,
+        &frame[kChassisMacOffset]);
+    cpuMac = mac;
+  }
+  if (vlan != port.getIngressVlan()) {
+    TxPacket::setEthHeaderVlan(frame.data(), port.getIngressVlan());
+    vlan = port.getIngressVlan();
+  }
+  if (portName != port.getName()) {
+    if (!patchTlv(frame, LldpTlvType::PORT, 1, port.getName())) {
+      return false;
+    }
+    portName = port.getName();
+  }
+  if (portDesc != port.getDescription()) {
+    if (!patchTlv(frame, LldpTlvType::PORT_DESC, 0, port.getDescription())) {
+      return false;
+    }
+    portDesc = port.getDescription();
+  }
+  if (hostname != host) {
+    if (!patchTlv(frame, LldpTlvType::SYSTEM_NAME, 0, host)) {
+      return false;
+    }
+    hostname = host;
+  }
+  return true;
+}
+
+void LldpManager::sendLldpInfo(
+    const std::shared_ptr<Port>& port,
+    const std::string& hostname) {
   MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
   PortID thisPortID = port->getID();
 
-  const size_t kMaxLen = 64;
-  std::array<char, kMaxLen> hostname;
-  if (0 == gethostname(hostname.data(), kMaxLen)) {
-    // make sure it is null terminated
-    hostname[kMaxLen - 1] = '\0';
-  } else {
-    hostname[0] = '\0';
+  std::unique_ptr<TxPacket> pkt;
+  {
+    auto templates = templates_.wlock();
+    auto& pduTemplate = (*templates)[thisPortID];
+    if (pduTemplate.matches(cpuMac, *port, hostname)) {
+      sw_->stats()->LldpPduTemplateHit();
+    } else if (pduTemplate.patch(cpuMac, *port, hostname)) {
+      sw_->stats()->LldpPduTemplatePatch();
+    } else {
+      pkt = LldpManager::createLldpPkt(
+          sw_,
+          cpuMac,
+          port->getIngressVlan(),
+          hostname,
+          port->getName(),
+          port->getDescription(),
+          TTL_TLV_VALUE,
+          SYSTEM_CAPABILITY_ROUTER);
+      pduTemplate.cpuMac = cpuMac;
+      pduTemplate.vlan = port->getIngressVlan();
+      pduTemplate.hostname = hostname;
+      pduTemplate.portName = port->getName();
+      pduTemplate.portDesc = port->getDescription();
+      pduTemplate.frame.resize(pkt->buf()->computeChainDataLength());
+      folly::io::Cursor(pkt->buf())
+          .pull(pduTemplate.frame.data(), pduTemplate.frame.size());
+      sw_->stats()->LldpPduTemplateRebuild();
+    }
+    if (!pkt) {
+      pkt = sw_->allocatePacket(pduTemplate.frame.size());
+      RWPrivateCursor cursor(pkt->buf());
+      cursor.push(pduTemplate.frame.data(), pduTemplate.frame.size());
+    }
   }
 
-  auto pkt = LldpManager::createLldpPkt(
-      sw_,
-      cpuMac,
-      port->getIngressVlan(),
-      std::string(hostname.data()),
-      port->getName(),
-      port->getDescription(),
-      TTL_TLV_VALUE,
-      SYSTEM_CAPABILITY_ROUTER);
-
   // this LLDP packet HAS to exit out of the port specified here.
   sw_->sendNetworkControlPacketAsync(
       std::move(pkt), PortDescriptor(thisPortID));
@@ -9,10 +9,15 @@
  */
 // Copyright 2014-present Facebook. All Rights Reserved.
 #pragma once
+#include <folly/MacAddress.h>
+#include <folly/Synchronized.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <memory>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/StateObserver.h"
 #include "fboss/agent/lldp/LinkNeighborDB.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/PortMap.h"
@@ -29,7 +34,8 @@ namespace facebook::fboss {
 class RxPacket;
 class TxPacket;
 
-class LldpManager : private folly::AsyncTimeout {
+class LldpManager : public AutoRegisterStateObserver,
+                    private folly::AsyncTimeout {
   /*
    * LldpManager is the class that manages Lldp support.
    * Responsible for processing received LLDP frames and maintaining the
@@ -38,6 +44,13 @@ class LldpManager : private folly::AsyncTimeout {
    * to inform of this switch's presence to its neighbors. Hence inheriting
    * the AsyncTimeout class for that purpose.
    *
+   * The frame sent on a port only changes when the port's name, description
+   * or ingress vlan, or the hostname, do, so it is built once and then
+   * copied for every send, only the fields that changed being patched into
+   * it in place. Sends are spread over the interval in
+   * LLDP_TX_SLOTS ticks, each port being hashed to one of them, so that
+   * large port counts don't burst all their frames at once.
+   *
    * http://www.ieee802.org/1/files/public/docs2002/lldp-protocol-00.pdf
    */
  public:
@@ -54,7 +67,8 @@ class LldpManager : private folly::AsyncTimeout {
     SYSTEM_CAPABILITY_ROUTER = 1 << 4, // 5th bit for router
     TTL_TLV_LENGTH = 0x2,
     TTL_TLV_VALUE = 120,
-    PDU_END_TLV_LENGTH = 0
+    PDU_END_TLV_LENGTH = 0,
+    LLDP_TX_SLOTS = 10
   };
   explicit LldpManager(SwSwitch* sw);
   ~LldpManager() override;
@@ -75,6 +89,8 @@ class LldpManager : private folly::AsyncTimeout {
    */
   void stop();
 
+  void stateUpdated(const StateDelta& delta) override;
+
   void handlePacket(
       std::unique_ptr<RxPacket> pkt,
       folly::MacAddress dst,
@@ -95,6 +111,10 @@ class LldpManager : private folly::AsyncTimeout {
   // This function is internal.  It is only public for use in unit tests.
   void sendLldpOnAllPorts();
 
+  // The tick of the interval LLDP frames on this port are sent in.
+  // Only public for use in unit tests.
+  uint32_t getTxSlot(PortID port) const;
+
   LinkNeighborDB* getDB() {
     return &db_;
   }
@@ -112,12 +132,44 @@ class LldpManager : private folly::AsyncTimeout {
       const std::string& sysDesc);
 
  private:
+  /*
+   * A prebuilt LLDP frame, along with everything it was built from.
+   */
+  struct PduTemplate {
+    folly::MacAddress cpuMac;
+    VlanID vlan{0};
+    std::string hostname;
+    std::string portName;
+    std::string portDesc;
+    std::vector<uint8_t> frame;
+
+    bool matches(
+        folly::MacAddress mac,
+        const Port& port,
+        const std::string& host) const;
+    // Patch the fields that differ into frame, in place. Returns false if
+    // the frame has to be rebuilt instead.
+    bool
+    patch(folly::MacAddress mac, const Port& port, const std::string& host);
+  };
+
   void timeoutExpired() noexcept override;
-  void sendLldpInfo(const std::shared_ptr<Port>& port);
+  // Send on all up ports, or only on those hashed to the given tx slot
+  void sendLldpOnPorts(std::optional<uint32_t> txSlot);
+  void sendLldpInfo(
+      const std::shared_ptr<Port>& port,
+      const std::string& hostname);
 
   SwSwitch* sw_{nullptr};
   std::chrono::milliseconds intervalMsecs_;
   LinkNeighborDB db_;
+  // Random per switch, so ports don't line up across a fleet
+  uint32_t txSlotSeed_{0};
+  // Only accessed from the background thread. Unset until the first round
+  // after start(), which goes out on all ports.
+  std::optional<uint32_t> nextTxSlot_;
+  // Written on the background thread, invalidated from the update thread
+  folly::Synchronized<std::unordered_map<PortID, PduTemplate>> templates_;
 };
 
 } // namespace facebook::fboss
@@ -14,7 +14,11 @@
 #include <folly/futures/Future.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <chrono>
 #include <list>
+#include <vector>
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/NeighborCacheImpl.h"
@@ -25,6 +29,8 @@
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/types.h"
 
+DECLARE_uint32(neighbor_update_batch_size);
+
 namespace facebook::fboss {
 
 namespace ncachehelpers {
@@ -58,90 +64,179 @@ bool checkVlanAndIntf(
   return true;
 }
 
-} // namespace ncachehelpers
-
+/*
+ * Helpers applying a change to the neighbor table of a VLAN to a SwitchState.
+ * They return whether the state was changed.
+ */
 template <typename NTable>
-void NeighborCacheImpl<NTable>::programEntry(Entry* entry) {
-  CHECK(!entry->isPending());
+bool programEntry(
+    std::shared_ptr<SwitchState>* state,
+    const typename NeighborCacheEntry<NTable>::EntryFields& fields,
+    VlanID vlanID) {
+  if (!checkVlanAndIntf<NTable>(*state, fields, vlanID)) {
+    // Either the vlan or intf is no longer valid.
+    return false;
+  }
 
-  auto fields = entry->getFields();
-  auto vlanID = vlanID_;
-  auto updateFn = [fields, vlanID](const std::shared_ptr<SwitchState>& state)
-      -> std::shared_ptr<SwitchState> {
-    if (!ncachehelpers::checkVlanAndIntf<NTable>(state, fields, vlanID)) {
-      // Either the vlan or intf is no longer valid.
-      return nullptr;
+  auto* vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  auto node = table->getNodeIf(fields.ip);
+
+  if (!node) {
+    table = table->modify(&vlan, state);
+    table->addEntry(fields);
+    XLOG(DBG2) << "Adding entry for " << fields.ip << " --> " << fields.mac
+               << " on interface " << fields.interfaceID << " for vlan "
+               << vlanID;
+  } else {
+    if (node->getMac() == fields.mac && node->getPort() == fields.port &&
+        node->getIntfID() == fields.interfaceID &&
+        node->getState() == fields.state && !node->isPending()) {
+      // This entry was already updated while we were waiting on the lock.
+      return false;
     }
+    table = table->modify(&vlan, state);
+    table->updateEntry(fields);
+    XLOG(DBG2) << "Converting pending entry for " << fields.ip << " --> "
+               << fields.mac << " on interface " << fields.interfaceID
+               << " for vlan " << vlanID;
+  }
+  return true;
+}
 
-    auto vlan = state->getVlans()->getVlanIf(vlanID).get();
-    std::shared_ptr<SwitchState> newState{state};
-    auto* table = vlan->template getNeighborTable<NTable>().get();
-    auto node = table->getNodeIf(fields.ip);
-
-    if (!node) {
-      table = table->modify(&vlan, &newState);
-      table->addEntry(fields);
-      XLOG(DBG2) << "Adding entry for " << fields.ip << " --> " << fields.mac
-                 << " on interface " << fields.interfaceID << " for vlan "
-                 << vlanID;
-    } else {
-      if (node->getMac() == fields.mac && node->getPort() == fields.port &&
-          node->getIntfID() == fields.interfaceID &&
-          node->getState() == fields.state && !node->isPending()) {
-        // This entry was already updated while we were waiting on the lock.
-        return nullptr;
-      }
-      table = table->modify(&vlan, &newState);
-      table->updateEntry(fields);
-      XLOG(DBG2) << "Converting pending entry for " << fields.ip << " --> "
-                 << fields.mac << " on interface " << fields.interfaceID
-                 << " for vlan " << vlanID;
-    }
-    return newState;
-  };
+template <typename NTable>
+bool programPendingEntry(
+    std::shared_ptr<SwitchState>* state,
+    const typename NeighborCacheEntry<NTable>::EntryFields& fields,
+    VlanID vlanID,
+    bool force) {
+  if (!checkVlanAndIntf<NTable>(*state, fields, vlanID)) {
+    // Either the vlan or intf is no longer valid.
+    return false;
+  }
+
+  auto* vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  auto node = table->getNodeIf(fields.ip);
+
+  if (node && !force) {
+    // don't replace an existing entry with a pending one unless
+    // explicitly allowed
+    return false;
+  }
+  table = table->modify(&vlan, state);
+  if (node) {
+    table->removeEntry(fields.ip);
+  }
+  table->addPendingEntry(fields.ip, fields.interfaceID);
+
+  XLOG(DBG4) << "Adding pending entry for " << fields.ip << " on interface "
+             << fields.interfaceID << " for vlan " << vlanID;
+  return true;
+}
+
+template <typename NTable>
+bool removeEntry(
+    std::shared_ptr<SwitchState>* state,
+    typename NTable::Entry::AddressType ip,
+    VlanID vlanID) {
+  auto* vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  if (!vlan) {
+    return false;
+  }
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  if (!table->getNodeIf(ip)) {
+    return false;
+  }
+
+  table = table->modify(&vlan, state);
+  table->removeNode(ip);
+  return true;
+}
+
+} // namespace ncachehelpers
 
-  sw_->updateState(
-      folly::to<std::string>("add neighbor ", fields.ip), std::move(updateFn));
+template <typename NTable>
+void NeighborCacheImpl<NTable>::programEntry(Entry* entry) {
+  CHECK(!entry->isPending());
+  queueUpdate(
+      PendingUpdate(PendingUpdate::Type::PROGRAM, entry->getFields()));
 }
 
 template <typename NTable>
 void NeighborCacheImpl<NTable>::programPendingEntry(Entry* entry, bool force) {
   CHECK(entry->isPending());
+  queueUpdate(PendingUpdate(
+      PendingUpdate::Type::PROGRAM_PENDING, entry->getFields(), force));
+}
 
-  auto fields = entry->getFields();
+template <typename NTable>
+void NeighborCacheImpl<NTable>::queueUpdate(PendingUpdate update) {
+  if (pendingUpdates_.empty()) {
+    firstPendingUpdate_ = std::chrono::steady_clock::now();
+    evb_->runInLoop(&sendCallback_);
+  }
+  pendingUpdates_.push_back(std::move(update));
+  if (pendingUpdates_.size() >= FLAGS_neighbor_update_batch_size) {
+    sendPendingUpdates();
+  }
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::sendPendingUpdates() {
+  if (pendingUpdates_.empty()) {
+    return;
+  }
+  sendCallback_.cancelLoopCallback();
+
+  std::vector<PendingUpdate> updates;
+  updates.swap(pendingUpdates_);
+  // Pending entries were never coalesced with other state updates, see
+  // SwSwitch::updateStateNoCoalescing()
+  bool hasPendingEntries = std::any_of(
+      updates.begin(), updates.end(), [](const PendingUpdate& update) {
+        return update.type == PendingUpdate::Type::PROGRAM_PENDING;
+      });
+  auto name = folly::to<std::string>(
+      "update ", updates.size(), " neighbor entries for vlan ", vlanID_);
+
+  auto sw = sw_;
   auto vlanID = vlanID_;
+  auto firstPendingUpdate = firstPendingUpdate_;
   auto updateFn =
-      [fields, vlanID, force](const std::shared_ptr<SwitchState>& state)
+      [sw, vlanID, firstPendingUpdate, updates = std::move(updates)](
+          const std::shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState> {
-    if (!ncachehelpers::checkVlanAndIntf<NTable>(state, fields, vlanID)) {
-      // Either the vlan or intf is no longer valid.
-      return nullptr;
-    }
-
-    auto vlan = state->getVlans()->getVlanIf(vlanID).get();
     std::shared_ptr<SwitchState> newState{state};
-    auto* table = vlan->template getNeighborTable<NTable>().get();
-    auto node = table->getNodeIf(fields.ip);
-    table = table->modify(&vlan, &newState);
-
-    if (node) {
-      if (!force) {
-        // don't replace an existing entry with a pending one unless
-        // explicitly allowed
-        return nullptr;
+    bool changed = false;
+    for (const auto& update : updates) {
+      switch (update.type) {
+        case PendingUpdate::Type::PROGRAM:
+          changed |= ncachehelpers::programEntry<NTable>(
+              &newState, update.fields, vlanID);
+          break;
+        case PendingUpdate::Type::PROGRAM_PENDING:
+          changed |= ncachehelpers::programPendingEntry<NTable>(
+              &newState, update.fields, vlanID, update.force);
+          break;
+        case PendingUpdate::Type::REMOVE:
+          changed |= ncachehelpers::removeEntry<NTable>(
+              &newState, update.fields.ip, vlanID);
+          break;
       }
-      table->removeEntry(fields.ip);
     }
-    table->addPendingEntry(fields.ip, fields.interfaceID);
-
-    XLOG(DBG4) << "Adding pending entry for " << fields.ip << " on interface "
-               << fields.interfaceID << " for vlan " << vlanID;
-    return newState;
+    sw->stats()->neighborUpdateBatch(
+        updates.size(),
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - firstPendingUpdate));
+    return changed ? newState : nullptr;
   };
 
-  sw_->updateStateNoCoalescing(
-      folly::to<std::string>("add pending entry ", fields.ip),
-      std::move(updateFn));
+  if (hasPendingEntries) {
+    sw_->updateStateNoCoalescing(name, std::move(updateFn));
+  } else {
+    sw_->updateState(name, std::move(updateFn));
+  }
 }
 
 template <typename NTable>
@@ -201,6 +296,8 @@ void NeighborCacheImpl<NTable>::updateEntryClassID(
 
   if (entry) {
     entry->updateClassID(classID);
+    // Not to be overtaken by the changes queued before
+    sendPendingUpdates();
 
     auto updateClassIDFn =
         [this, ip, classID](const std::shared_ptr<SwitchState>& state) {
@@ -315,16 +412,7 @@ template <typename NTable>
 bool NeighborCacheImpl<NTable>::flushEntryFromSwitchState(
     std::shared_ptr<SwitchState>* state,
     AddressType ip) {
-  auto* vlan = (*state)->getVlans()->getVlan(vlanID_).get();
-  auto* table = vlan->template getNeighborTable<NTable>().get();
-  const auto& entry = table->getNodeIf(ip);
-  if (!entry) {
-    return false;
-  }
-
-  table = table->modify(&vlan, state);
-  table->removeNode(ip);
-  return true;
+  return ncachehelpers::removeEntry<NTable>(state, ip, vlanID_);
 }
 
 template <typename NTable>
@@ -344,26 +432,26 @@ void NeighborCacheImpl<NTable>::flushEntry(AddressType ip, bool* flushed) {
     return;
   }
 
-  // flush from SwitchState
+  if (!flushed) {
+    queueUpdate(PendingUpdate(
+        PendingUpdate::Type::REMOVE,
+        EntryFields(ip, intfID_, NeighborState::PENDING)));
+    return;
+  }
+
+  // need a blocking state update if the caller wants to know if an entry
+  // was actually flushed, after the changes queued before
+  sendPendingUpdates();
   auto updateFn = [this, ip, flushed](const std::shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState> {
     std::shared_ptr<SwitchState> newState{state};
     if (flushEntryFromSwitchState(&newState, ip)) {
-      if (flushed) {
-        *flushed = true;
-      }
+      *flushed = true;
       return newState;
     }
     return nullptr;
   };
-
-  if (flushed) {
-    // need a blocking state update if the caller wants to know if an entry
-    // was actually flushed
-    sw_->updateStateBlocking("flush neighbor entry", std::move(updateFn));
-  } else {
-    sw_->updateState("remove neighbor entry: " + ip.str(), std::move(updateFn));
-  }
+  sw_->updateStateBlocking("flush neighbor entry", std::move(updateFn));
 }
 
 template <typename NTable>
@@ -18,9 +18,12 @@
 
 #include <folly/IPAddress.h>
 #include <folly/Random.h>
+#include <folly/io/async/EventBase.h>
+#include <chrono>
 #include <list>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -38,6 +41,13 @@ class NeighborCache;
  * All calls into this should have acquired a cache level lock through
  * NeighborCache so only one thread should ever be operating on the
  * cache at a given time.
+ *
+ * Changes to the neighbor table are not sent to the SwSwitch one entry at a
+ * time: they are queued and sent as a single state update at the end of the
+ * current loop of the neighbor cache thread, or as soon as
+ * --neighbor_update_batch_size of them are queued. A burst of ARP replies or
+ * NDP advertisements then costs one copy of the table instead of one per
+ * neighbor.
  */
 template <typename NTable>
 class NeighborCacheImpl {
@@ -64,7 +74,8 @@ class NeighborCacheImpl {
         vlanID_(vlanID),
         vlanName_(vlanName),
         intfID_(intfID),
-        evb_(sw->getNeighborCacheEvb()) {}
+        evb_(sw->getNeighborCacheEvb()),
+        sendCallback_(cache) {}
 
   // Methods useful for subclasses
   void setPendingEntry(AddressType ip, bool force = false);
@@ -91,6 +102,9 @@ class NeighborCacheImpl {
 
   void portDown(PortDescriptor port);
 
+  // Send the queued changes to the neighbor table to the SwSwitch
+  void sendPendingUpdates();
+
   SwSwitch* getSw() const {
     return sw_;
   }
@@ -125,9 +139,39 @@ class NeighborCacheImpl {
   std::optional<NeighborEntryThrift> getCacheData(AddressType ip) const;
 
  private:
+  // A change to the neighbor table waiting to be sent to the SwSwitch
+  struct PendingUpdate {
+    enum class Type {
+      PROGRAM,
+      PROGRAM_PENDING,
+      REMOVE,
+    };
+
+    PendingUpdate(Type type, EntryFields fields, bool force = false)
+        : type(type), fields(std::move(fields)), force(force) {}
+
+    Type type;
+    EntryFields fields;
+    // For PROGRAM_PENDING, whether to replace an existing entry
+    bool force;
+  };
+
+  class SendCallback : public folly::EventBase::LoopCallback {
+   public:
+    explicit SendCallback(NeighborCache<NTable>* cache) : cache_(cache) {}
+
+    void runLoopCallback() noexcept override {
+      cache_->sendPendingUpdates();
+    }
+
+   private:
+    NeighborCache<NTable>* cache_;
+  };
+
   // These are used to program entries into the SwitchState
   void programEntry(Entry* entry);
   void programPendingEntry(Entry* entry, bool force = false);
+  void queueUpdate(PendingUpdate update);
 
   void processEntry(AddressType ip);
 
@@ -161,6 +205,11 @@ class NeighborCacheImpl {
 
   // Map of all entries
   std::unordered_map<AddressType, std::shared_ptr<Entry>> entries_;
+
+  // Changes to the neighbor table not sent to the SwSwitch yet, in order
+  std::vector<PendingUpdate> pendingUpdates_;
+  std::chrono::steady_clock::time_point firstPendingUpdate_;
+  SendCallback sendCallback_;
 };
 
 } // namespace facebook::fboss
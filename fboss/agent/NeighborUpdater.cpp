@@ -38,6 +38,13 @@ using folly::IPAddressV6;
 using folly::MacAddress;
 using std::shared_ptr;
 
+DEFINE_uint32(
+    neighbor_update_batch_size,
+    1024,
+    "Number of changes to the neighbor table of a VLAN after which they are "
+    "sent to the SwSwitch, even if more may come in the same loop of the "
+    "neighbor cache thread");
+
 namespace facebook::fboss {
 
 using facebook::fboss::DeltaFunctions::forEachChanged;
@@ -56,7 +63,9 @@ NeighborUpdater::~NeighborUpdater() {
 }
 
 void NeighborUpdater::waitForPendingUpdates() {
-  folly::via(sw_->getNeighborCacheEvb(), [impl = this->impl_]() {}).get();
+  // Along with whatever is queued on the neighbor cache thread, the changes
+  // the neighbor caches would otherwise send at the end of its loop
+  sendPendingUpdates().get();
 }
 
 auto NeighborUpdater::createCaches(const SwitchState* state, const Vlan* vlan)
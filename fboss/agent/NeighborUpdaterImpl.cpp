@@ -149,6 +149,13 @@ void NeighborUpdaterImpl::portDown(PortDescriptor port) {
   }
 }
 
+void NeighborUpdaterImpl::sendPendingUpdates() {
+  for (auto vlanCaches : caches_) {
+    vlanCaches.second->arpCache->sendPendingUpdates();
+    vlanCaches.second->ndpCache->sendPendingUpdates();
+  }
+}
+
 bool NeighborUpdaterImpl::flushEntryImpl(VlanID vlan, IPAddress ip) {
   if (ip.isV4()) {
     auto cache = getArpCacheInternal(vlan);
@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RibUpdateQueue.h"
+
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/RouteUpdateTracer.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
+
+#include <folly/ScopeGuard.h>
+#include <folly/logging/xlog.h>
+
+DEFINE_int32(
+    rib_update_window_ms,
+    0,
+    "How long to wait for more route updates to a VRF before applying them. "
+    "Updates queued while the previous ones are applied are merged anyway.");
+
+using facebook::network::toBinaryAddress;
+using facebook::network::toIPAddress;
+
+namespace facebook::fboss {
+
+namespace {
+using ClientRouteUpdate = rib::RoutingInformationBase::ClientRouteUpdate;
+
+std::chrono::microseconds since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+}
+} // namespace
+
+RibUpdateQueue::RibUpdateQueue(
+    SwSwitch* sw,
+    rib::RoutingInformationBase::FibUpdateFunction fibUpdateCallback)
+    : sw_(sw),
+      fibUpdateCallback_(std::move(fibUpdateCallback)),
+      thread_("fbossRibUpdateThread") {}
+
+RibUpdateQueue::~RibUpdateQueue() {
+  // Callers are waiting for whatever is still queued
+  thread_.getEventBase()->runInEventBaseThreadAndWait([this] { apply(); });
+}
+
+folly::Future<RibUpdateQueue::UpdateStatistics> RibUpdateQueue::enqueue(
+    RouterID vrf,
+    ClientID clientID,
+    AdminDistance adminDistanceFromClientID,
+    const std::vector<UnicastRoute>& toAdd,
+    const std::vector<IpPrefix>& toDelete,
+    bool resetClientsRoutes) {
+  Caller caller;
+  caller.clientID = clientID;
+  caller.enqueued = std::chrono::steady_clock::now();
+  caller.routeUpdateID = RouteUpdateTracer::getCurrentID();
+  auto future = caller.promise.getFuture();
+
+  // Converted before taking the lock, so that a bad prefix fails this
+  // update alone and leaves nothing half queued
+  std::map<folly::CIDRNetwork, std::optional<UnicastRoute>> routes;
+  try {
+    for (const auto& route : toAdd) {
+      auto network = toIPAddress(route.dest.ip);
+      auto mask = static_cast<uint8_t>(route.dest.prefixLength);
+      if (network.isV4()) {
+        ++caller.stats.v4RoutesAdded;
+      } else {
+        ++caller.stats.v6RoutesAdded;
+      }
+      routes[{network.mask(mask), mask}] = route;
+    }
+    for (const auto& prefix : toDelete) {
+      auto network = toIPAddress(prefix.ip);
+      auto mask = static_cast<uint8_t>(prefix.prefixLength);
+      if (network.isV4()) {
+        ++caller.stats.v4RoutesDeleted;
+      } else {
+        ++caller.stats.v6RoutesDeleted;
+      }
+      routes[{network.mask(mask), mask}] = std::nullopt;
+    }
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Invalid route update from client " << clientID
+              << " to VRF " << vrf << ": " << ex.what();
+    caller.promise.setException(
+        folly::exception_wrapper(std::current_exception(), ex));
+    return future;
+  }
+
+  bool scheduleApply = false;
+  {
+    auto pending = pending_.wlock();
+    scheduleApply = pending->empty();
+    auto& vrfUpdate = (*pending)[vrf];
+    auto& clientUpdate = vrfUpdate.clients[clientID];
+    clientUpdate.adminDistanceFromClientID = adminDistanceFromClientID;
+    if (resetClientsRoutes) {
+      // Whatever the client queued before is replaced
+      clientUpdate.resetClientsRoutes = true;
+      clientUpdate.routes.clear();
+    }
+    for (auto& [network, route] : routes) {
+      clientUpdate.routes[network] = std::move(route);
+    }
+    vrfUpdate.numRoutes += toAdd.size() + toDelete.size();
+    vrfUpdate.callers.push_back(std::move(caller));
+  }
+
+  if (scheduleApply) {
+    auto evb = thread_.getEventBase();
+    evb->runInEventBaseThread([this, evb]() {
+      if (FLAGS_rib_update_window_ms > 0) {
+        evb->runAfterDelay([this]() { apply(); }, FLAGS_rib_update_window_ms);
+      } else {
+        apply();
+      }
+    });
+  }
+  return future;
+}
+
+void RibUpdateQueue::apply() {
+  std::map<RouterID, VrfUpdate> vrfUpdates;
+  vrfUpdates.swap(*pending_.wlock());
+  if (vrfUpdates.empty()) {
+    return;
+  }
+
+  std::map<RouterID, std::vector<ClientRouteUpdate>> ribUpdates;
+  size_t numCallers = 0;
+  size_t numRoutes = 0;
+  size_t numQueuedRoutes = 0;
+  for (auto& [vrf, vrfUpdate] : vrfUpdates) {
+    auto& clientUpdates = ribUpdates[vrf];
+    for (auto& [clientID, clientUpdate] : vrfUpdate.clients) {
+      ClientRouteUpdate ribUpdate;
+      ribUpdate.clientID = clientID;
+      ribUpdate.adminDistanceFromClientID =
+          clientUpdate.adminDistanceFromClientID;
+      ribUpdate.resetClientsRoutes = clientUpdate.resetClientsRoutes;
+      for (auto& [network, route] : clientUpdate.routes) {
+        if (route) {
+          ribUpdate.toAdd.push_back(std::move(*route));
+        } else {
+          IpPrefix prefix;
+          prefix.ip = toBinaryAddress(network.first);
+          prefix.prefixLength = network.second;
+          ribUpdate.toDelete.push_back(std::move(prefix));
+        }
+      }
+      numRoutes += ribUpdate.toAdd.size() + ribUpdate.toDelete.size();
+      clientUpdates.push_back(std::move(ribUpdate));
+    }
+    numCallers += vrfUpdate.callers.size();
+    numQueuedRoutes += vrfUpdate.numRoutes;
+  }
+  sw_->stats()->ribUpdateBatch(
+      numCallers, numRoutes, numQueuedRoutes - numRoutes);
+
+  // The update thread can only be told about one of the route updates in
+  // the batch, see RouteUpdateTracer
+  uint64_t routeUpdateID = 0;
+  for (const auto& vrfUpdate : vrfUpdates) {
+    for (const auto& caller : vrfUpdate.second.callers) {
+      if (caller.routeUpdateID) {
+        routeUpdateID = caller.routeUpdateID;
+      }
+    }
+  }
+  // Which may be done on any of the RIB's resolution threads
+  auto fibUpdate = [this, routeUpdateID](
+                       RouterID vrf,
+                       const rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
+                       const rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+                       void* cookie) {
+    RouteUpdateTracer::setCurrentID(routeUpdateID);
+    SCOPE_EXIT {
+      RouteUpdateTracer::setCurrentID(0);
+    };
+    fibUpdateCallback_(vrf, v4NetworkToRoute, v6NetworkToRoute, cookie);
+  };
+
+  // VRFs are updated in parallel, each failing on its own, and so are the
+  // clients of a VRF
+  auto start = std::chrono::steady_clock::now();
+  std::map<RouterID, std::vector<folly::exception_wrapper>> clientErrors;
+  auto results = sw_->getRib()->update(
+      ribUpdates, "coalesced route update", fibUpdate, sw_, &clientErrors);
+
+  for (auto& [vrf, vrfUpdate] : vrfUpdates) {
+    const auto& result = results.at(vrf);
+    if (result.hasException()) {
+      XLOG(ERR) << "Failed to apply " << vrfUpdate.callers.size()
+                << " route updates to VRF " << vrf << ": "
+                << result.exception().what();
+      for (auto& caller : vrfUpdate.callers) {
+        caller.promise.setException(result.exception());
+      }
+      continue;
+    }
+    // In the order the client updates were passed to the RIB
+    const auto& errors = clientErrors[vrf];
+    size_t clientIdx = 0;
+    for (auto& [clientID, clientUpdate] : vrfUpdate.clients) {
+      if (clientIdx < errors.size() && errors[clientIdx]) {
+        XLOG(ERR) << "Failed to apply route updates of client " << clientID
+                  << " to VRF " << vrf << ": " << errors[clientIdx].what();
+        clientUpdate.error = errors[clientIdx];
+      }
+      ++clientIdx;
+    }
+    for (auto& caller : vrfUpdate.callers) {
+      const auto& error = vrfUpdate.clients.at(caller.clientID).error;
+      if (error) {
+        caller.promise.setException(error);
+        continue;
+      }
+      caller.stats.duration = since(caller.enqueued);
+      caller.stats.queueDuration =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              start - caller.enqueued);
+      caller.stats.routeUpdateDuration = result->routeUpdateDuration;
+      caller.stats.resolutionDuration = result->resolutionDuration;
+      caller.promise.setValue(caller.stats);
+    }
+  }
+  XLOG(DBG2) << "Applied " << numCallers << " route updates (" << numRoutes
+             << " routes) to " << vrfUpdates.size() << " VRFs in "
+             << since(start).count() << "us";
+}
+
+} // namespace facebook::fboss
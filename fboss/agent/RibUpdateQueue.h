@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/rib/RoutingInformationBase.h"
+#include "fboss/agent/types.h"
+
+#include <folly/ExceptionWrapper.h>
+#include <folly/IPAddress.h>
+#include <folly/Synchronized.h>
+#include <folly/futures/Future.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace facebook::fboss {
+
+class SwSwitch;
+
+/*
+ * Applies the route updates of the standalone RIB in batches.
+ *
+ * The updates queued while the previous batch is being applied, or within
+ * --rib_update_window_ms of the first of them, are merged and applied as a
+ * single RIB and FIB update per VRF, so that concurrent route clients share
+ * the cost of resolving the RIB and of programming the FIB instead of
+ * queueing behind each other for it. The VRFs of a batch are resolved in
+ * parallel.
+ *
+ * Merging keeps the last add or delete of each prefix by each client: a
+ * route added and then deleted before it is applied is never programmed.
+ */
+class RibUpdateQueue {
+ public:
+  using UpdateStatistics = rib::RoutingInformationBase::UpdateStatistics;
+
+  RibUpdateQueue(
+      SwSwitch* sw,
+      rib::RoutingInformationBase::FibUpdateFunction fibUpdateCallback);
+  ~RibUpdateQueue();
+
+  /*
+   * Queue a client's update to a VRF, with the same arguments as
+   * RoutingInformationBase::update(). The future completes once the update
+   * is in the FIB, with the statistics of this update alone. It fails with
+   * the error of the client's routes if they can't be applied, in which
+   * case none of the client's routes queued with it are applied but those
+   * of other clients are, or with the error of the VRF update.
+   */
+  folly::Future<UpdateStatistics> enqueue(
+      RouterID vrf,
+      ClientID clientID,
+      AdminDistance adminDistanceFromClientID,
+      const std::vector<UnicastRoute>& toAdd,
+      const std::vector<IpPrefix>& toDelete,
+      bool resetClientsRoutes);
+
+ private:
+  RibUpdateQueue(const RibUpdateQueue&) = delete;
+  RibUpdateQueue& operator=(const RibUpdateQueue&) = delete;
+
+  struct ClientUpdate {
+    AdminDistance adminDistanceFromClientID;
+    bool resetClientsRoutes{false};
+    // Route to add, or none to delete, for each (masked) prefix
+    std::map<folly::CIDRNetwork, std::optional<UnicastRoute>> routes;
+    // Set if the client's routes could not be applied
+    folly::exception_wrapper error;
+  };
+  struct Caller {
+    ClientID clientID;
+    folly::Promise<UpdateStatistics> promise;
+    UpdateStatistics stats;
+    std::chrono::steady_clock::time_point enqueued;
+    uint64_t routeUpdateID;
+  };
+  struct VrfUpdate {
+    std::map<ClientID, ClientUpdate> clients;
+    std::vector<Caller> callers;
+    size_t numRoutes{0};
+  };
+
+  void apply();
+
+  SwSwitch* sw_;
+  rib::RoutingInformationBase::FibUpdateFunction fibUpdateCallback_;
+  // Updates not applied yet, with an apply() scheduled if not empty
+  folly::Synchronized<std::map<RouterID, VrfUpdate>> pending_;
+  folly::ScopedEventBaseThread thread_;
+};
+
+} // namespace facebook::fboss
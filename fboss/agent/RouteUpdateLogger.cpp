@@ -70,21 +70,25 @@ RouteUpdateLogger::RouteUpdateLogger(
       mplsRouteLogger_(std::move(mplsRouteLogger)) {}
 
 void RouteUpdateLogger::stateUpdated(const StateDelta& delta) {
-  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
-    DeltaFunctions::forEachChanged(
-        rtDelta.getRoutesV4Delta(),
-        &handleChangedRoute<folly::IPAddressV4>,
-        &handleAddedRoute<folly::IPAddressV4>,
-        &handleRemovedRoute<folly::IPAddressV4>,
-        prefixTracker_,
-        routeLoggerV4_);
-    DeltaFunctions::forEachChanged(
-        rtDelta.getRoutesV6Delta(),
-        &handleChangedRoute<folly::IPAddressV6>,
-        &handleAddedRoute<folly::IPAddressV6>,
-        &handleRemovedRoute<folly::IPAddressV6>,
-        prefixTracker_,
-        routeLoggerV6_);
+  // Nothing to look up route changes against: skip walking the route delta,
+  // which is costly on large FIB churns
+  if (!prefixTracker_.empty()) {
+    for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+      DeltaFunctions::forEachChanged(
+          rtDelta.getRoutesV4Delta(),
+          &handleChangedRoute<folly::IPAddressV4>,
+          &handleAddedRoute<folly::IPAddressV4>,
+          &handleRemovedRoute<folly::IPAddressV4>,
+          prefixTracker_,
+          routeLoggerV4_);
+      DeltaFunctions::forEachChanged(
+          rtDelta.getRoutesV6Delta(),
+          &handleChangedRoute<folly::IPAddressV6>,
+          &handleAddedRoute<folly::IPAddressV6>,
+          &handleRemovedRoute<folly::IPAddressV6>,
+          prefixTracker_,
+          routeLoggerV6_);
+    }
   }
 
   auto* mplsRouteLogger = mplsRouteLogger_.get();
@@ -95,4 +95,15 @@ RouteUpdateLoggingPrefixTracker::getTrackedPrefixes() const {
   return allPrefixes;
 }
 
+bool RouteUpdateLoggingPrefixTracker::empty() const {
+  SYNCHRONIZED_CONST(trackedPrefixes_) {
+    for (const auto& prefixes : trackedPrefixes_) {
+      if (prefixes.second.size()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 } // namespace facebook::fboss
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RouteUpdateTracer.h"
+
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
+
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+
+DEFINE_int32(
+    route_update_trace_count,
+    128,
+    "Number of route update traces kept for getRouteUpdateTraces");
+
+namespace facebook::fboss {
+
+namespace {
+thread_local uint64_t currentRouteUpdateID = 0;
+}
+
+folly::StringPiece routeUpdateStageName(RouteUpdateStage stage) {
+  switch (stage) {
+    case RouteUpdateStage::RIB_QUEUE:
+      return "rib_queue";
+    case RouteUpdateStage::RIB_UPDATE:
+      return "rib_update";
+    case RouteUpdateStage::RESOLUTION:
+      return "resolution";
+    case RouteUpdateStage::QUEUE:
+      return "queue";
+    case RouteUpdateStage::STATE_UPDATE:
+      return "state_update";
+    case RouteUpdateStage::PUBLISH:
+      return "publish";
+    case RouteUpdateStage::HW_PROGRAMMING:
+      return "hw_programming";
+    case RouteUpdateStage::OBSERVERS:
+      return "observers";
+    case RouteUpdateStage::TOTAL:
+      return "total";
+  }
+  return "unknown";
+}
+
+RouteUpdateTracer::RouteUpdateTracer(SwSwitch* sw) : sw_(sw) {}
+
+RouteUpdateTracer::Scope::Scope(
+    RouteUpdateTracer* tracer,
+    folly::StringPiece name,
+    size_t numRoutes)
+    : tracer_(tracer),
+      id_(tracer->start(name, numRoutes)),
+      previousID_(getCurrentID()),
+      start_(Clock::now()) {
+  setCurrentID(id_);
+}
+
+RouteUpdateTracer::Scope::~Scope() {
+  setCurrentID(previousID_);
+  auto total = std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now() - start_);
+  tracer_->record(id_, RouteUpdateStage::TOTAL, total);
+  XLOG(DBG2) << "Route update " << id_ << " took " << total.count() << "us";
+}
+
+uint64_t RouteUpdateTracer::start(folly::StringPiece name, size_t numRoutes) {
+  auto id = nextID_++;
+  sw_->stats()->routesPerUpdate(numRoutes);
+
+  RouteUpdateTrace trace;
+  *trace.updateId_ref() = id;
+  *trace.name_ref() = name.str();
+  *trace.numRoutes_ref() = numRoutes;
+  *trace.startTimeMs_ref() =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  size_t maxTraces = std::max(FLAGS_route_update_trace_count, 1);
+  auto traces = traces_.wlock();
+  traces->push_back(std::move(trace));
+  while (traces->size() > maxTraces) {
+    traces->pop_front();
+  }
+  return id;
+}
+
+void RouteUpdateTracer::record(
+    uint64_t id,
+    RouteUpdateStage stage,
+    std::chrono::microseconds duration) {
+  sw_->stats()->routeUpdateStage(stage, duration);
+  addToTrace(*traces_.wlock(), id, stage, duration);
+}
+
+void RouteUpdateTracer::record(
+    const std::vector<uint64_t>& ids,
+    RouteUpdateStage stage,
+    std::chrono::microseconds duration) {
+  if (ids.empty()) {
+    return;
+  }
+  sw_->stats()->routeUpdateStage(stage, duration);
+  auto traces = traces_.wlock();
+  for (auto id : ids) {
+    addToTrace(*traces, id, stage, duration);
+  }
+}
+
+void RouteUpdateTracer::addToTrace(
+    std::deque<RouteUpdateTrace>& traces,
+    uint64_t id,
+    RouteUpdateStage stage,
+    std::chrono::microseconds duration) {
+  // The update is most likely one of the last ones started
+  for (auto trace = traces.rbegin(); trace != traces.rend(); ++trace) {
+    if (*trace->updateId_ref() == static_cast<int64_t>(id)) {
+      if (stage == RouteUpdateStage::TOTAL) {
+        *trace->totalDurationUs_ref() = duration.count();
+      } else {
+        // Add up, in case a stage is gone through more than once
+        (*trace->stageDurationsUs_ref())[routeUpdateStageName(stage).str()] +=
+            duration.count();
+      }
+      break;
+    }
+  }
+}
+
+RouteUpdateTracer::Clock::time_point RouteUpdateTracer::recordSince(
+    uint64_t id,
+    RouteUpdateStage stage,
+    Clock::time_point start) {
+  auto now = Clock::now();
+  record(
+      id,
+      stage,
+      std::chrono::duration_cast<std::chrono::microseconds>(now - start));
+  return now;
+}
+
+std::vector<RouteUpdateTrace> RouteUpdateTracer::getTraces(
+    size_t count) const {
+  std::vector<RouteUpdateTrace> result;
+  auto traces = traces_.rlock();
+  for (auto trace = traces->rbegin();
+       trace != traces->rend() && result.size() < count;
+       ++trace) {
+    result.push_back(*trace);
+  }
+  return result;
+}
+
+uint64_t RouteUpdateTracer::getCurrentID() {
+  return currentRouteUpdateID;
+}
+
+void RouteUpdateTracer::setCurrentID(uint64_t id) {
+  currentRouteUpdateID = id;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <folly/Range.h>
+#include <folly/Synchronized.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace facebook::fboss {
+
+class SwSwitch;
+
+/*
+ * Stages a route update goes through on its way to the hardware
+ */
+enum class RouteUpdateStage {
+  // Waiting in the RibUpdateQueue to be applied with other updates
+  RIB_QUEUE,
+  // Adding and deleting routes in the standalone RIB
+  RIB_UPDATE,
+  // Resolving the standalone RIB
+  RESOLUTION,
+  // Waiting for the update thread to pick up the state update
+  QUEUE,
+  // Running the state update function, i.e. deriving the FIB from the RIB,
+  // or updating and resolving the routes without the standalone RIB
+  STATE_UPDATE,
+  PUBLISH,
+  // The HwSwitch walking the StateDelta and programming it
+  HW_PROGRAMMING,
+  OBSERVERS,
+  // All of the above, and whatever happened in between
+  TOTAL,
+};
+
+folly::StringPiece routeUpdateStageName(RouteUpdateStage stage);
+
+/*
+ * Follows route updates from the thrift handler down to the hardware and
+ * the state observers, to tell where the time of slow updates went.
+ *
+ * Each route update gets an ID, which the state updates it schedules carry
+ * to the update thread. While a route update is worked on, its ID is the
+ * current one of the thread doing it, so that the code on the way (the
+ * HwSwitch, state observers) can tell which update it is working for.
+ *
+ * The time spent in each stage goes to the SwitchStats histograms, and the
+ * traces of the last --route_update_trace_count updates are kept for
+ * dumping on demand.
+ */
+class RouteUpdateTracer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RouteUpdateTracer(SwSwitch* sw);
+
+  /*
+   * Traces a route update for as long as it is in scope. The update is the
+   * current one of the calling thread meanwhile.
+   */
+  class Scope {
+   public:
+    Scope(RouteUpdateTracer* tracer, folly::StringPiece name, size_t numRoutes);
+    ~Scope();
+
+    uint64_t getID() const {
+      return id_;
+    }
+    void record(RouteUpdateStage stage, std::chrono::microseconds duration) {
+      tracer_->record(id_, stage, duration);
+    }
+
+   private:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    RouteUpdateTracer* tracer_;
+    uint64_t id_;
+    uint64_t previousID_;
+    Clock::time_point start_;
+  };
+
+  void record(
+      uint64_t id,
+      RouteUpdateStage stage,
+      std::chrono::microseconds duration);
+  /*
+   * Record a stage that several updates went through together. It counts
+   * once in the histograms, and towards the trace of each of them.
+   */
+  void record(
+      const std::vector<uint64_t>& ids,
+      RouteUpdateStage stage,
+      std::chrono::microseconds duration);
+
+  /*
+   * Record the time since start for a stage of an update, and return the
+   * current time, where the next stage starts.
+   */
+  Clock::time_point
+  recordSince(uint64_t id, RouteUpdateStage stage, Clock::time_point start);
+
+  // Traces of the last count updates, most recent first
+  std::vector<RouteUpdateTrace> getTraces(size_t count) const;
+
+  /*
+   * ID of the route update the calling thread works on, or 0 if none
+   */
+  static uint64_t getCurrentID();
+  static void setCurrentID(uint64_t id);
+
+ private:
+  uint64_t start(folly::StringPiece name, size_t numRoutes);
+  static void addToTrace(
+      std::deque<RouteUpdateTrace>& traces,
+      uint64_t id,
+      RouteUpdateStage stage,
+      std::chrono::microseconds duration);
+
+  SwSwitch* sw_;
+  std::atomic<uint64_t> nextID_{1};
+  folly::Synchronized<std::deque<RouteUpdateTrace>> traces_;
+};
+
+} // namespace facebook::fboss
@@ -94,6 +94,18 @@ class RxPacket : public Packet {
     return {};
   }
 
+  /*
+   * Copy the packet data into a buffer of the packet's own.
+   *
+   * HwSwitch implementations may hand packets over in SDK buffers that are
+   * only valid until their rx callback returns (e.g. SAI, and BCM with
+   * PKTIO), so this must be called before holding on to a packet past that,
+   * e.g. to handle it on another thread.
+   */
+  void copyBuf() {
+    buf_ = folly::IOBuf::copyBuffer(buf_->coalesce());
+  }
+
  protected:
   PortID srcPort_{0};
   bool isFromAggregatePort_{false};
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/RxPacketWorkerPool.h"
+
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/packet/Ethertype.h"
+
+#include <fb303/ServiceData.h>
+#include <folly/Conv.h>
+#include <folly/hash/Hash.h>
+#include <folly/io/Cursor.h>
+
+namespace facebook::fboss {
+
+RxPacketWorkerPool::RxPacketWorkerPool(
+    folly::StringPiece name,
+    size_t numWorkers,
+    size_t maxQueueDepth)
+    : name_(name.str()), maxQueueDepth_(maxQueueDepth) {
+  for (size_t i = 0; i < numWorkers; ++i) {
+    auto worker = std::make_unique<Worker>();
+    auto eventBase = &worker->eventBase;
+    auto threadName = folly::to<std::string>(name_, i);
+    worker->thread = std::make_unique<std::thread>([eventBase, threadName] {
+      initThread(threadName);
+      eventBase->loopForever();
+    });
+    workers_.push_back(std::move(worker));
+  }
+}
+
+RxPacketWorkerPool::~RxPacketWorkerPool() {
+  stop();
+}
+
+uint64_t RxPacketWorkerPool::flowKey(const RxPacket* pkt) {
+  // Members of a LAG are one flow, so that the handling of packets from a
+  // neighbor stays in order whichever member they come in on
+  uint64_t port = pkt->isFromAggregatePort()
+      ? (1ULL << 32) | static_cast<uint32_t>(pkt->getSrcAggregatePort())
+      : static_cast<uint32_t>(pkt->getSrcPort());
+  // The ethertype past any VLAN tags, 0 for runt packets which get dropped
+  // anyway
+  folly::io::Cursor cursor(pkt->buf());
+  uint16_t ethertype = 0;
+  if (cursor.canAdvance(12)) {
+    cursor.skip(12);
+    while (cursor.tryReadBE(ethertype) && cursor.canAdvance(2) &&
+           (ethertype == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN) ||
+            ethertype == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_QINQ))) {
+      cursor.skip(2);
+    }
+  }
+  return folly::hash::hash_128_to_64(port, ethertype);
+}
+
+size_t RxPacketWorkerPool::workerIndex(uint64_t flowKey) const {
+  return flowKey % workers_.size();
+}
+
+bool RxPacketWorkerPool::dispatch(
+    uint64_t flowKey,
+    folly::Function<void()> work) {
+  auto worker = workers_[workerIndex(flowKey)].get();
+  if (stopped_.load(std::memory_order_acquire)) {
+    // The worker would never run it
+    worker->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  auto queueDepth =
+      worker->queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (queueDepth > maxQueueDepth_) {
+    worker->queueDepth.fetch_sub(1, std::memory_order_relaxed);
+    worker->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (queueDepth > worker->maxQueueDepth.load(std::memory_order_relaxed)) {
+    worker->maxQueueDepth.store(queueDepth, std::memory_order_relaxed);
+  }
+  worker->eventBase.runInEventBaseThread(
+      [worker, work = std::move(work)]() mutable {
+        work();
+        worker->queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        worker->processed.fetch_add(1, std::memory_order_relaxed);
+      });
+  return true;
+}
+
+std::vector<RxPacketWorkerPool::WorkerStats>
+RxPacketWorkerPool::getWorkerStats() {
+  std::vector<WorkerStats> workerStats;
+  for (const auto& worker : workers_) {
+    WorkerStats stats;
+    stats.processed = worker->processed.load(std::memory_order_relaxed);
+    stats.dropped = worker->dropped.load(std::memory_order_relaxed);
+    stats.queueDepth = worker->queueDepth.load(std::memory_order_relaxed);
+    stats.maxQueueDepth = worker->maxQueueDepth.exchange(stats.queueDepth);
+    workerStats.push_back(stats);
+  }
+  return workerStats;
+}
+
+void RxPacketWorkerPool::publishStats() {
+  auto workerStats = getWorkerStats();
+  for (size_t i = 0; i < workerStats.size(); ++i) {
+    auto prefix = folly::to<std::string>(name_, ".", i, ".");
+    const auto& stats = workerStats[i];
+    fb303::fbData->setCounter(prefix + "processed", stats.processed);
+    fb303::fbData->setCounter(prefix + "dropped", stats.dropped);
+    fb303::fbData->setCounter(prefix + "queue_depth", stats.queueDepth);
+    fb303::fbData->setCounter(
+        prefix + "max_queue_depth", stats.maxQueueDepth);
+  }
+}
+
+void RxPacketWorkerPool::stop() {
+  stopped_.store(true, std::memory_order_release);
+  // Terminate from within the loop, so that work queued already runs first
+  for (auto& worker : workers_) {
+    if (worker->thread) {
+      auto eventBase = &worker->eventBase;
+      eventBase->runInEventBaseThread(
+          [eventBase] { eventBase->terminateLoopSoon(); });
+    }
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread) {
+      worker->thread->join();
+      worker->thread.reset();
+    }
+  }
+}
+
+} // namespace facebook::fboss
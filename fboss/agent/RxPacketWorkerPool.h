@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/Range.h>
+#include <folly/io/async/EventBase.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace facebook::fboss {
+
+class RxPacket;
+
+/*
+ * Spreads the handling of packets trapped to the CPU over a fixed set of
+ * worker threads, rather than handling them on the SDK thread delivering
+ * them. Packets are dispatched by flow, the ingress port (or aggregate port)
+ * and ethertype, so packets of a flow are always handled by the same worker
+ * and in the order they were received, e.g. ARP/NDP from a neighbor or LACP
+ * on a LAG member. Each worker queues up to a given number of packets, past
+ * which packets are dropped, so that a burst of trapped packets does not hold
+ * on to all of the SDK's rx buffers.
+ */
+class RxPacketWorkerPool {
+ public:
+  struct WorkerStats {
+    uint64_t processed{0};
+    uint64_t dropped{0};
+    uint64_t queueDepth{0};
+    // Deepest the queue got since the last call to getWorkerStats()
+    uint64_t maxQueueDepth{0};
+  };
+
+  RxPacketWorkerPool(
+      folly::StringPiece name,
+      size_t numWorkers,
+      size_t maxQueueDepth);
+  ~RxPacketWorkerPool();
+
+  RxPacketWorkerPool(const RxPacketWorkerPool&) = delete;
+  RxPacketWorkerPool& operator=(const RxPacketWorkerPool&) = delete;
+
+  /*
+   * Flow a packet belongs to, to dispatch it by
+   */
+  static uint64_t flowKey(const RxPacket* pkt);
+
+  size_t numWorkers() const {
+    return workers_.size();
+  }
+  size_t workerIndex(uint64_t flowKey) const;
+
+  /*
+   * Run the work on the worker of the flow, after the work dispatched to it
+   * earlier. Returns false, dropping the work, if the worker queue is full or
+   * the pool was stopped. Must not race with stop()
+   */
+  bool dispatch(uint64_t flowKey, folly::Function<void()> work);
+
+  std::vector<WorkerStats> getWorkerStats();
+  /*
+   * Export worker stats to fb303, as <name>.<worker>.{processed, dropped,
+   * queue_depth, max_queue_depth}
+   */
+  void publishStats();
+
+  /*
+   * Stop the workers once they are done with the work queued so far. Work
+   * dispatched after is dropped
+   */
+  void stop();
+
+ private:
+  struct Worker {
+    folly::EventBase eventBase;
+    std::unique_ptr<std::thread> thread;
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> queueDepth{0};
+    std::atomic<uint64_t> maxQueueDepth{0};
+  };
+
+  std::string name_;
+  size_t maxQueueDepth_;
+  std::atomic<bool> stopped_{false};
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+} // namespace facebook::fboss
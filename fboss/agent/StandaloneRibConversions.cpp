@@ -51,17 +51,23 @@ static void dynamicFibUpdate(
 void syncFibWithStandaloneRib(
     rib::RoutingInformationBase& standaloneRib,
     SwSwitch* swSwitch) {
+  using ClientRouteUpdate = rib::RoutingInformationBase::ClientRouteUpdate;
+
+  // An empty update to each VRF, resolving them in parallel
+  std::map<RouterID, std::vector<ClientRouteUpdate>> vrfUpdates;
   for (auto routerID : standaloneRib.getVrfList()) {
-    standaloneRib.update(
-        routerID,
-        ClientID(-1),
-        AdminDistance(-1),
-        {},
-        {},
-        false,
-        "post-warmboot FIB sync",
-        &dynamicFibUpdate,
-        static_cast<void*>(swSwitch));
+    ClientRouteUpdate emptyUpdate;
+    emptyUpdate.clientID = ClientID(-1);
+    emptyUpdate.adminDistanceFromClientID = AdminDistance(-1);
+    vrfUpdates[routerID].push_back(std::move(emptyUpdate));
+  }
+  auto results = standaloneRib.update(
+      vrfUpdates,
+      "post-warmboot FIB sync",
+      &dynamicFibUpdate,
+      static_cast<void*>(swSwitch));
+  for (auto& result : results) {
+    result.second.throwIfFailed();
   }
 }
 
@@ -13,6 +13,7 @@
 #include "fboss/agent/AlpmUtils.h"
 #include "fboss/agent/ApplyThriftConfig.h"
 #include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/ChangeFeed.h"
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/FbossHwUpdateError.h"
@@ -38,7 +39,9 @@
 #include "fboss/agent/ResolvedNexthopProbeScheduler.h"
 #include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/RouteUpdateLogger.h"
+#include "fboss/agent/RouteUpdateTracer.h"
 #include "fboss/agent/RxPacket.h"
+#include "fboss/agent/RxPacketWorkerPool.h"
 #include "fboss/agent/StaticL2ForNeighborObserver.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/ThriftHandler.h"
@@ -51,6 +54,7 @@
 #include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/packet/IPv4Hdr.h"
 #include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/PktHeaders.h"
 #include "fboss/agent/packet/PktUtil.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/state/DeltaFunctions.h"
@@ -107,6 +111,24 @@ DEFINE_int32(
     1000,
     "Timeout for sending to distribution_service (ms)");
 
+DEFINE_uint32(
+    rx_packet_workers,
+    0,
+    "Threads handling packets trapped to the CPU, each handling the packets "
+    "of a subset of ingress ports. 0 to handle them on the thread the "
+    "hardware delivers them on");
+DEFINE_uint32(
+    rx_packet_worker_queue_size,
+    4096,
+    "Packets each rx packet worker queues, past which packets are dropped");
+
+DEFINE_uint32(
+    link_state_coalesce_window_ms,
+    0,
+    "Time link state changes are held back for, to apply those of all ports "
+    "changing within it in a single state update, e.g. when a linecard or "
+    "optics group flaps. 0 applies each change on its own");
+
 DEFINE_bool(
     log_all_fib_updates,
     false,
@@ -167,6 +189,8 @@ SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
       pcapMgr_(new PktCaptureManager(this)),
       mirrorManager_(new MirrorManager(this)),
       routeUpdateLogger_(new RouteUpdateLogger(this)),
+      changeFeed_(new ChangeFeed(this)),
+      routeUpdateTracer_(new RouteUpdateTracer(this)),
       resolvedNexthopMonitor_(new ResolvedNexthopMonitor(this)),
       resolvedNexthopProbeScheduler_(new ResolvedNexthopProbeScheduler(this)),
       rib_(new rib::RoutingInformationBase()),
@@ -196,6 +220,12 @@ void SwSwitch::stop() {
   // while we are destroying ourselves
   hw_->unregisterCallbacks();
 
+  // Workers run the packets already queued before stopping, which
+  // handlePacket() then drops as we are exiting
+  if (rxPacketWorkers_) {
+    rxPacketWorkers_->stop();
+  }
+
   // Stop tunMgr so we don't get any packets to process
   // in software that were sent to the switch ip or were
   // routed from kernel to the front panel tunnel interface.
@@ -353,6 +383,9 @@ void SwSwitch::updateStats() {
   updateRouteStats();
   updatePortInfo();
   updateLldpStats();
+  if (rxPacketWorkers_) {
+    rxPacketWorkers_->publishStats();
+  }
   try {
     getHw()->updateStats(stats());
   } catch (const std::exception& ex) {
@@ -419,6 +452,13 @@ void SwSwitch::publishTxPacket(TxPacket* pkt, uint16_t ethertype) {
 void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
   auto begin = steady_clock::now();
   flags_ = flags;
+  // Packets may come in as soon as the hardware is initialized
+  if (FLAGS_rx_packet_workers) {
+    rxPacketWorkers_ = std::make_unique<RxPacketWorkerPool>(
+        "rx_worker",
+        FLAGS_rx_packet_workers,
+        FLAGS_rx_packet_worker_queue_size);
+  }
   auto hwInitRet = hw_->init(this, false /*failHwCallsOnWarmboot*/);
   auto initialState = hwInitRet.switchState;
   bootType_ = hwInitRet.bootType;
@@ -657,6 +697,10 @@ void SwSwitch::notifyStateObservers(const StateDelta& delta) {
 }
 
 void SwSwitch::updateState(unique_ptr<StateUpdate> update) {
+  update->routeUpdateID_ = RouteUpdateTracer::getCurrentID();
+  if (update->routeUpdateID_) {
+    update->scheduledTime_ = std::chrono::steady_clock::now();
+  }
   {
     folly::SpinLockGuard guard(pendingUpdatesLock_);
     pendingUpdates_.push_back(*update.release());
@@ -771,11 +815,22 @@ void SwSwitch::handlePendingUpdates() {
   auto oldAppliedState = getState();
   // We start with the old state, and apply state updates one at a time.
   auto newDesiredState = oldAppliedState;
+  // Route updates among these, which we trace the stages of
+  std::vector<uint64_t> routeUpdateIDs;
   auto iter = updates.begin();
   while (iter != updates.end()) {
     StateUpdate* update = &(*iter);
     ++iter;
 
+    auto routeUpdateID = update->routeUpdateID_;
+    RouteUpdateTracer::Clock::time_point stageStart;
+    if (routeUpdateID) {
+      routeUpdateIDs.push_back(routeUpdateID);
+      stageStart = routeUpdateTracer_->recordSince(
+          routeUpdateID, RouteUpdateStage::QUEUE, update->scheduledTime_);
+    }
+    RouteUpdateTracer::setCurrentID(routeUpdateID);
+
     shared_ptr<SwitchState> intermediateState;
     XLOG(INFO) << "preparing state update " << update->getName();
     try {
@@ -790,15 +845,24 @@ void SwSwitch::handlePendingUpdates() {
     // We have applied the update to software switch state, so call success
     // on the update.
     if (intermediateState) {
+      if (routeUpdateID) {
+        stageStart = routeUpdateTracer_->recordSince(
+            routeUpdateID, RouteUpdateStage::STATE_UPDATE, stageStart);
+      }
       // Call publish after applying each StateUpdate.  This guarantees that
       // the next StateUpdate function will have clone the SwitchState before
       // making any changes.  This ensures that if a StateUpdate function
       // ever fails partway through it can't have partially modified our
       // existing state, leaving it in an invalid state.
       intermediateState->publish();
+      if (routeUpdateID) {
+        routeUpdateTracer_->recordSince(
+            routeUpdateID, RouteUpdateStage::PUBLISH, stageStart);
+      }
       newDesiredState = intermediateState;
     }
   }
+  RouteUpdateTracer::setCurrentID(0);
   // Start newAppliedState as equal to newDesiredState unless
   // we learn otherwise
   auto newAppliedState = newDesiredState;
@@ -807,8 +871,8 @@ void SwSwitch::handlePendingUpdates() {
     auto isTransaction = updates.begin()->hwFailureProtected() &&
         getHw()->transactionsSupported();
     // There was some change during these state updates
-    newAppliedState =
-        applyUpdate(oldAppliedState, newDesiredState, isTransaction);
+    newAppliedState = applyUpdate(
+        oldAppliedState, newDesiredState, isTransaction, routeUpdateIDs);
     if (newDesiredState != newAppliedState) {
       CHECK(updates.size() == 1 && updates.begin()->hwFailureProtected())
           << " Failed to apply update to HW and the update is not marked for "
@@ -842,14 +906,24 @@ void SwSwitch::setStateInternal(std::shared_ptr<SwitchState> newAppliedState) {
   // stateDontUseDirectly_.  (getState() being the other one.)
   CHECK(bool(newAppliedState));
   CHECK(newAppliedState->isPublished());
-  folly::SpinLockGuard guard(stateLock_);
-  appliedStateDontUseDirectly_.swap(newAppliedState);
+  {
+    folly::SpinLockGuard guard(stateLock_);
+    appliedStateDontUseDirectly_.swap(newAppliedState);
+    appliedStateView_.store(
+        appliedStateDontUseDirectly_.get(), std::memory_order_release);
+  }
+  // Views taken before the swap may still be reading the old state
+  if (newAppliedState) {
+    folly::rcu_default_domain()->call(
+        [oldAppliedState = std::move(newAppliedState)]() {});
+  }
 }
 
 std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
     const shared_ptr<SwitchState>& oldState,
     const shared_ptr<SwitchState>& newState,
-    bool isTransaction) {
+    bool isTransaction,
+    const std::vector<uint64_t>& routeUpdateIDs) {
   // Check that we are starting from what has been already applied
   DCHECK_EQ(oldState, getAppliedState());
 
@@ -866,6 +940,11 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
   }
 
   std::shared_ptr<SwitchState> newAppliedState;
+  // Route updates coalesced into this one all wait for it. The HwSwitch and
+  // observers see the ID of the last of them.
+  RouteUpdateTracer::setCurrentID(
+      routeUpdateIDs.empty() ? 0 : routeUpdateIDs.back());
+  auto hwStart = std::chrono::steady_clock::now();
 
   // Inform the HwSwitch of the change.
   //
@@ -895,12 +974,23 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
                 << folly::exceptionStr(ex);
   }
 
+  auto hwEnd = std::chrono::steady_clock::now();
   setStateInternal(newAppliedState);
 
   // Notifies all observers of the current state update.
   notifyStateObservers(StateDelta(oldState, newAppliedState));
 
   auto end = std::chrono::steady_clock::now();
+  // Once for the whole batch, however many route updates it holds
+  routeUpdateTracer_->record(
+      routeUpdateIDs,
+      RouteUpdateStage::HW_PROGRAMMING,
+      std::chrono::duration_cast<std::chrono::microseconds>(hwEnd - hwStart));
+  routeUpdateTracer_->record(
+      routeUpdateIDs,
+      RouteUpdateStage::OBSERVERS,
+      std::chrono::duration_cast<std::chrono::microseconds>(end - hwEnd));
+  RouteUpdateTracer::setCurrentID(0);
   auto duration =
       std::chrono::duration_cast<std::chrono::microseconds>(end - start);
   stats()->stateUpdate(duration);
@@ -980,6 +1070,24 @@ void SwSwitch::setPortStatusCounter(PortID port, bool up) {
 }
 
 void SwSwitch::packetReceived(std::unique_ptr<RxPacket> pkt) noexcept {
+  if (!rxPacketWorkers_) {
+    handlePacketNoThrow(std::move(pkt));
+    return;
+  }
+  PortID port = pkt->getSrcPort();
+  auto flowKey = RxPacketWorkerPool::flowKey(pkt.get());
+  // The HwSwitch buffer is only valid until we return
+  pkt->copyBuf();
+  auto dispatched = rxPacketWorkers_->dispatch(
+      flowKey, [this, pkt = std::move(pkt)]() mutable {
+        handlePacketNoThrow(std::move(pkt));
+      });
+  if (!dispatched) {
+    portStats(port)->pktDropped();
+  }
+}
+
+void SwSwitch::handlePacketNoThrow(std::unique_ptr<RxPacket> pkt) noexcept {
   PortID port = pkt->getSrcPort();
   try {
     handlePacket(std::move(pkt));
@@ -1017,16 +1125,21 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
     return;
   }
 
-  // Parse the source and destination MAC, as well as the ethertype.
-  Cursor c(pkt->buf());
-  auto dstMac = PktUtil::readMac(&c);
-  auto srcMac = PktUtil::readMac(&c);
-  auto ethertype = c.readBE<uint16_t>();
-  if (ethertype == 0x8100) {
-    // 802.1Q
-    c += 2; // Advance over the VLAN tag.  We ignore it for now
-    ethertype = c.readBE<uint16_t>();
+  // Parse the source and destination MAC, as well as the ethertype, in one
+  // go over the packet data. The VLAN tag is ignored for now. The handlers
+  // parse the rest of the headers themselves.
+  PktHeaders headers;
+  if (headers.parse(pkt->buf(), PktHeaders::Layer::L2) ==
+      PktHeaders::Layer::NONE) {
+    // Shorter than an Ethernet header, whatever length the HwSwitch claimed
+    portStats(port)->pktError();
+    return;
   }
+  const auto& dstMac = headers.dstMac;
+  const auto& srcMac = headers.srcMac;
+  auto ethertype = headers.ethertype;
+  Cursor c(pkt->buf());
+  c += headers.l3Offset;
 
   XLOG(DBG5) << "trapped packet: src_port=" << pkt->getSrcPort()
              << " srcAggPort="
@@ -1095,29 +1208,109 @@ void SwSwitch::linkStateChanged(PortID portId, bool up) {
     return;
   }
 
-  // Schedule an update for port's operational status
-  auto updateOperStateFn = [=](const std::shared_ptr<SwitchState>& state) {
-    std::shared_ptr<SwitchState> newState(state);
-    auto* port = newState->getPorts()->getPortIf(portId).get();
-
-    if (port) {
-      if (port->isUp() != up) {
-        XLOG(INFO) << "SW Link state changed: " << port->getName() << " ["
-                   << (port->isUp() ? "UP" : "DOWN") << "->"
-                   << (up ? "UP" : "DOWN") << "]";
-        port = port->modify(&newState);
-        port->setOperState(up);
-        // Log event and update counters if there is a change
-        logLinkStateEvent(portId, up);
-        setPortStatusCounter(portId, up);
-        portStats(portId)->linkStateChange(up);
+  // Hardware has already shrunk ECMP groups over a port going down by now,
+  // only the SwitchState waits for the window
+  bool firstEvent = false;
+  {
+    auto pending = pendingLinkStateChanges_.wlock();
+    if (pending->changes.empty()) {
+      firstEvent = true;
+      pending->firstEvent = steady_clock::now();
+    }
+    ++pending->events;
+    auto change = pending->changes.find(portId);
+    if (change != pending->changes.end() && !change->second) {
+      if (up) {
+        pending->deferredUp.insert(portId);
+      } else {
+        pending->deferredUp.erase(portId);
       }
+    } else {
+      pending->changes[portId] = up;
+    }
+  }
+  if (firstEvent) {
+    scheduleLinkStateChanges();
+  }
+}
+
+void SwSwitch::scheduleLinkStateChanges() {
+  if (!FLAGS_link_state_coalesce_window_ms) {
+    applyLinkStateChanges();
+    return;
+  }
+  updateEventBase_.runInEventBaseThread([this] {
+    updateEventBase_.runAfterDelay(
+        [this] { applyLinkStateChanges(); },
+        FLAGS_link_state_coalesce_window_ms);
+  });
+}
+
+void SwSwitch::applyLinkStateChanges() {
+  PendingLinkStateChanges changes;
+  {
+    auto pending = pendingLinkStateChanges_.wlock();
+    changes = std::move(*pending);
+    *pending = PendingLinkStateChanges();
+    for (auto portId : changes.deferredUp) {
+      pending->changes[portId] = true;
+    }
+    if (!pending->changes.empty()) {
+      pending->events = pending->changes.size();
+      pending->firstEvent = changes.firstEvent;
     }
+  }
+  if (changes.changes.empty()) {
+    return;
+  }
 
+  // Schedule an update for the operational status of all ports at once
+  auto numPorts = changes.changes.size();
+  auto events = changes.events;
+  auto firstEvent = changes.firstEvent;
+  auto updateOperStateFn = [this,
+                            portChanges = std::move(changes.changes),
+                            numPorts,
+                            events,
+                            firstEvent](
+                               const std::shared_ptr<SwitchState>& state) {
+    std::shared_ptr<SwitchState> newState(state);
+    for (const auto& [portId, up] : portChanges) {
+      auto* port = newState->getPorts()->getPortIf(portId).get();
+
+      if (port) {
+        if (port->isUp() != up) {
+          XLOG(INFO) << "SW Link state changed: " << port->getName() << " ["
+                     << (port->isUp() ? "UP" : "DOWN") << "->"
+                     << (up ? "UP" : "DOWN") << "]";
+          port = port->modify(&newState);
+          port->setOperState(up);
+          // Log event and update counters if there is a change
+          logLinkStateEvent(portId, up);
+          setPortStatusCounter(portId, up);
+          portStats(portId)->linkStateChange(up);
+        }
+      }
+    }
+    // Once done with this update, hardware programming included
+    updateEventBase_.runInLoop([this, numPorts, events, firstEvent] {
+      auto convergeTime = duration_cast<microseconds>(
+          steady_clock::now() - firstEvent);
+      stats()->linkStateChangeBatch(numPorts, events, convergeTime);
+      if (numPorts > 1) {
+        XLOG(INFO) << "Applied link state changes of " << numPorts
+                   << " ports, from " << events << " events, in "
+                   << convergeTime.count() << "us";
+      }
+    });
     return newState;
   };
   updateStateNoCoalescing(
       "Port OperState Update", std::move(updateOperStateFn));
+
+  if (!changes.deferredUp.empty()) {
+    scheduleLinkStateChanges();
+  }
 }
 
 void SwSwitch::startThreads() {
@@ -1495,7 +1688,8 @@ void SwSwitch::applyConfig(const std::string& reason, bool reload) {
             &newConfig,
             getPlatform(),
             (getFlags() & SwitchFlags::ENABLE_STANDALONE_RIB) ? getRib()
-                                                              : nullptr);
+                                                              : nullptr,
+            &configApplyCache_);
 
         if (newState && !isValidStateUpdate(StateDelta(state, newState))) {
           throw FbossError("Invalid config passed in, skipping");
@@ -1513,6 +1707,14 @@ void SwSwitch::applyConfig(const std::string& reason, bool reload) {
           XLOG(WARNING) << "Applying config did not cause state change";
           return nullptr;
         }
+        XLOG(DBG2) << "Config apply skipped "
+                   << configApplyCache_.getNumSkippedSections()
+                   << " unchanged sections and "
+                   << configApplyCache_.getNumSkippedEntries()
+                   << " unchanged ports/acls";
+        // The apply cache recognizes unchanged nodes by identity, so they
+        // must not be modified in place by updates batched after this one.
+        newState->publish();
         return newState;
       });
 }
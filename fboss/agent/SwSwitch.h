@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include "fboss/agent/ApplyThriftConfig.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/ThreadHeartbeat.h"
 #include "fboss/agent/Utils.h"
@@ -21,19 +22,25 @@
 #include <folly/IntrusiveList.h>
 #include <folly/Range.h>
 #include <folly/SpinLock.h>
+#include <folly/Synchronized.h>
 #include <folly/ThreadLocal.h>
 #include <folly/io/async/EventBase.h>
+#include <folly/synchronization/Rcu.h>
 #include <optional>
 
 #include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <thread>
 #include <type_traits>
 
 namespace facebook::fboss {
 
 class ArpHandler;
+class ChangeFeed;
 class IPv4Handler;
 class IPv6Handler;
 class LinkAggregationManager;
@@ -45,11 +52,13 @@ class PortDescriptor;
 class PortStats;
 class PortUpdateHandler;
 class RxPacket;
+class RxPacketWorkerPool;
 class SwitchState;
 class SwitchStats;
 class StateDelta;
 class NeighborUpdater;
 class RouteUpdateLogger;
+class RouteUpdateTracer;
 class StateObserver;
 class TunManager;
 class MirrorManager;
@@ -195,6 +204,42 @@ class SwSwitch : public HwSwitch::Callback {
   std::shared_ptr<SwitchState> getState() const {
     return getAppliedState();
   }
+
+  /*
+   * A view of the current (applied) switch state, for readers that are done
+   * with it before returning, such as the packet handlers.
+   *
+   * Unlike getState(), getting a view neither takes stateLock_ nor touches
+   * the reference count of the state, which all of the RX and thrift
+   * threads would otherwise contend on. The state stays alive as long as the
+   * view does, but states replaced meanwhile can only be freed once every
+   * view older than them is gone, so views must not be kept around or
+   * passed to other threads. Use getState() for that.
+   */
+  class StateView {
+   public:
+    const SwitchState* operator->() const {
+      return state_;
+    }
+    const SwitchState& operator*() const {
+      return *state_;
+    }
+    const SwitchState* get() const {
+      return state_;
+    }
+
+   private:
+    friend class SwSwitch;
+    explicit StateView(const std::atomic<SwitchState*>& state)
+        : state_(state.load(std::memory_order_acquire)) {}
+
+    // Taken before loading the state, so that it is not freed under us
+    folly::rcu_reader reader_;
+    const SwitchState* state_{nullptr};
+  };
+  StateView getStateView() const {
+    return StateView(appliedStateView_);
+  }
   /**
    * Schedule an update to the switch state.
    *
@@ -567,6 +612,17 @@ class SwSwitch : public HwSwitch::Callback {
     return routeUpdateLogger_.get();
   }
 
+  /*
+   * Get the feed of FIB, neighbor and MAC table changes
+   */
+  ChangeFeed* getChangeFeed() {
+    return changeFeed_.get();
+  }
+
+  RouteUpdateTracer* getRouteUpdateTracer() {
+    return routeUpdateTracer_.get();
+  }
+
   LinkAggregationManager* getLagManager() {
     return lagManager_.get();
   }
@@ -704,13 +760,20 @@ class SwSwitch : public HwSwitch::Callback {
   void setSwitchRunState(SwitchRunState desiredState);
   SwitchStats* createSwitchStats();
   void handlePacket(std::unique_ptr<RxPacket> pkt);
+  void handlePacketNoThrow(std::unique_ptr<RxPacket> pkt) noexcept;
 
   static void handlePendingUpdatesHelper(SwSwitch* sw);
   void handlePendingUpdates();
+  /*
+   * routeUpdateIDs are the traced route updates among the state updates
+   * being applied, for the time spent programming and notifying observers
+   * to be recorded against.
+   */
   std::shared_ptr<SwitchState> applyUpdate(
       const std::shared_ptr<SwitchState>& oldState,
       const std::shared_ptr<SwitchState>& newState,
-      bool isTransaction);
+      bool isTransaction,
+      const std::vector<uint64_t>& routeUpdateIDs = {});
 
   void startThreads();
   void stopThreads();
@@ -741,6 +804,9 @@ class SwSwitch : public HwSwitch::Callback {
 
   void logLinkStateEvent(PortID port, bool up);
 
+  void scheduleLinkStateChanges();
+  void applyLinkStateChanges();
+
   void logSwitchRunStateChange(
       SwitchRunState oldState,
       SwitchRunState newState);
@@ -752,6 +818,8 @@ class SwSwitch : public HwSwitch::Callback {
 
   std::string curConfigStr_;
   cfg::SwitchConfig curConfig_;
+  // Only accessed from the update thread, via applyConfig()
+  ThriftConfigApplyCache configApplyCache_;
 
   // The HwSwitch object.  This object is owned by the Platform.
   HwSwitch* hw_;
@@ -787,6 +855,11 @@ class SwSwitch : public HwSwitch::Callback {
    */
   std::shared_ptr<SwitchState> appliedStateDontUseDirectly_;
   mutable folly::SpinLock stateLock_;
+  /*
+   * The same state, for getStateView(). Replaced states are only released
+   * after an RCU grace period, once no view can still point to them.
+   */
+  std::atomic<SwitchState*> appliedStateView_{nullptr};
 
   /*
    * A thread for performing various background tasks.
@@ -831,6 +904,27 @@ class SwSwitch : public HwSwitch::Callback {
   folly::EventBase neighborCacheEventBase_;
   std::unique_ptr<ThreadHeartbeat> neighborCacheThreadHeartbeat_;
 
+  /*
+   * Workers handling the packets trapped to the CPU, if any. Otherwise
+   * packets are handled on the thread the HwSwitch delivers them on.
+   */
+  std::unique_ptr<RxPacketWorkerPool> rxPacketWorkers_;
+
+  /*
+   * Link state changes waiting to be applied together, see
+   * --link_state_coalesce_window_ms
+   */
+  struct PendingLinkStateChanges {
+    // The state each port is to be changed to
+    std::map<PortID, bool> changes;
+    // Ports which came back up after going down within the window. They are
+    // brought up by the next batch, so that going down is never missed.
+    std::set<PortID> deferredUp;
+    uint64_t events{0};
+    std::chrono::steady_clock::time_point firstEvent;
+  };
+  folly::Synchronized<PendingLinkStateChanges> pendingLinkStateChanges_;
+
   /*
    * A callback for listening to neighbors coming and going.
    */
@@ -854,6 +948,8 @@ class SwSwitch : public HwSwitch::Callback {
   std::unique_ptr<PktCaptureManager> pcapMgr_;
   std::unique_ptr<MirrorManager> mirrorManager_;
   std::unique_ptr<RouteUpdateLogger> routeUpdateLogger_;
+  std::unique_ptr<ChangeFeed> changeFeed_;
+  std::unique_ptr<RouteUpdateTracer> routeUpdateTracer_;
   std::unique_ptr<LinkAggregationManager> lagManager_;
   std::unique_ptr<ResolvedNexthopMonitor> resolvedNexthopMonitor_;
   std::unique_ptr<ResolvedNexthopProbeScheduler> resolvedNexthopProbeScheduler_;
@@ -9,8 +9,10 @@
  */
 #include "fboss/agent/SwitchStats.h"
 
+#include <folly/Conv.h>
 #include <folly/Memory.h>
 #include "fboss/agent/PortStats.h"
+#include "fboss/agent/RouteUpdateTracer.h"
 
 using facebook::fb303::AVG;
 using facebook::fb303::RATE;
@@ -80,6 +82,59 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           RATE),
       updateState_(map, kCounterPrefix + "state_update.us", 50000, 0, 1000000),
       routeUpdate_(map, kCounterPrefix + "route_update.us", 50, 0, 500),
+      routesPerUpdate_(
+          map,
+          kCounterPrefix + "route_update.routes",
+          100,
+          0,
+          10000),
+      ribUpdateBatchUpdates_(
+          map,
+          kCounterPrefix + "rib_update.batch_updates",
+          1,
+          0,
+          100),
+      ribUpdateBatchRoutes_(
+          map,
+          kCounterPrefix + "rib_update.batch_routes",
+          100,
+          0,
+          10000),
+      ribUpdateMergedRoutes_(
+          map,
+          kCounterPrefix + "rib_update.merged_routes",
+          SUM,
+          RATE),
+      neighborUpdateBatchEntries_(
+          map,
+          kCounterPrefix + "neighbor_update.batch_entries",
+          10,
+          0,
+          1000),
+      neighborUpdateProgramTime_(
+          map,
+          kCounterPrefix + "neighbor_update.program_time.us",
+          1000,
+          0,
+          100000),
+      linkStateChangeBatchPorts_(
+          map,
+          kCounterPrefix + "link_state_change.batch_ports",
+          4,
+          0,
+          256),
+      linkStateChangeBatchEvents_(
+          map,
+          kCounterPrefix + "link_state_change.batch_events",
+          4,
+          0,
+          1024),
+      linkStateChangeConvergeTime_(
+          map,
+          kCounterPrefix + "link_state_change.converge_time.us",
+          10000,
+          0,
+          1000000),
       bgHeartbeatDelay_(
           map,
           kCounterPrefix + "bg_heartbeat_delay.ms",
@@ -185,11 +240,23 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           SUM,
           RATE),
       LldpNeighborsSize_(map, kCounterPrefix + "lldp.neighbors_size", SUM),
+      LldpPduTemplateHit_(map, kCounterPrefix + "lldp.template_hit", SUM),
+      LldpPduTemplateRebuild_(
+          map,
+          kCounterPrefix + "lldp.template_rebuild",
+          SUM),
+      LldpPduTemplatePatch_(map, kCounterPrefix + "lldp.template_patch", SUM),
       LacpRxTimeouts_(map, kCounterPrefix + "lacp.rx_timeout", SUM),
       LacpMismatchPduTeardown_(
           map,
           kCounterPrefix + "lacp.mismatched_pdu_teardown",
           SUM),
+      LacpPduTemplateHit_(map, kCounterPrefix + "lacp.template_hit", SUM),
+      LacpPduTemplateRebuild_(
+          map,
+          kCounterPrefix + "lacp.template_rebuild",
+          SUM),
+      LacpPduTemplatePatch_(map, kCounterPrefix + "lacp.template_patch", SUM),
       MkPduRecvdPkts_(map, kCounterPrefix + "mkpdu.recvd", SUM, RATE),
       MkPduSendPkts_(map, kCounterPrefix + "mkpdu.send", SUM, RATE),
       MkPduSendFailure_(
@@ -216,7 +283,18 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           map,
           kCounterPrefix + "mka_service.recvd",
           SUM,
-          RATE) {}
+          RATE) {
+  for (int stage = 0; stage <= static_cast<int>(RouteUpdateStage::TOTAL);
+       ++stage) {
+    auto name = folly::to<std::string>(
+        kCounterPrefix,
+        "route_update.",
+        routeUpdateStageName(RouteUpdateStage(stage)),
+        ".us");
+    routeUpdateStages_.push_back(
+        std::make_unique<TLHistogram>(map, name, 5000, 0, 1000000));
+  }
+}
 
 PortStats* FOLLY_NULLABLE SwitchStats::port(PortID portID) {
   auto it = ports_.find(portID);
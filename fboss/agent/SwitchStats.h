@@ -13,6 +13,8 @@
 #include <boost/noncopyable.hpp>
 #include <fb303/ThreadCachedServiceData.h>
 #include <chrono>
+#include <memory>
+#include <vector>
 #include "fboss/agent/AggregatePortStats.h"
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/types.h"
@@ -20,6 +22,7 @@
 namespace facebook::fboss {
 
 class PortStats;
+enum class RouteUpdateStage;
 
 typedef boost::container::flat_map<PortID, std::unique_ptr<PortStats>>
     PortStatsMap;
@@ -234,6 +237,34 @@ class SwitchStats : public boost::noncopyable {
     routeUpdate_.addRepeatedValue(us.count() / routes, routes);
   }
 
+  void routeUpdateStage(RouteUpdateStage stage, std::chrono::microseconds us) {
+    routeUpdateStages_[static_cast<int>(stage)]->addValue(us.count());
+  }
+
+  void routesPerUpdate(uint64_t routes) {
+    routesPerUpdate_.addValue(routes);
+  }
+
+  void ribUpdateBatch(uint64_t updates, uint64_t routes, uint64_t merged) {
+    ribUpdateBatchUpdates_.addValue(updates);
+    ribUpdateBatchRoutes_.addValue(routes);
+    ribUpdateMergedRoutes_.addValue(merged);
+  }
+
+  void neighborUpdateBatch(uint64_t entries, std::chrono::microseconds us) {
+    neighborUpdateBatchEntries_.addValue(entries);
+    neighborUpdateProgramTime_.addValue(us.count());
+  }
+
+  void linkStateChangeBatch(
+      uint64_t ports,
+      uint64_t events,
+      std::chrono::microseconds us) {
+    linkStateChangeBatchPorts_.addValue(ports);
+    linkStateChangeBatchEvents_.addValue(events);
+    linkStateChangeConvergeTime_.addValue(us.count());
+  }
+
   void bgHeartbeatDelay(int delay) {
     bgHeartbeatDelay_.addValue(delay);
   }
@@ -302,6 +333,24 @@ class SwitchStats : public boost::noncopyable {
   void LldpNeighborsSize(int value) {
     LldpNeighborsSize_.addValue(value);
   }
+  void LldpPduTemplateHit() {
+    LldpPduTemplateHit_.addValue(1);
+  }
+  void LldpPduTemplateRebuild() {
+    LldpPduTemplateRebuild_.addValue(1);
+  }
+  void LldpPduTemplatePatch() {
+    LldpPduTemplatePatch_.addValue(1);
+  }
+  void LacpPduTemplateHit() {
+    LacpPduTemplateHit_.addValue(1);
+  }
+  void LacpPduTemplateRebuild() {
+    LacpPduTemplateRebuild_.addValue(1);
+  }
+  void LacpPduTemplatePatch() {
+    LacpPduTemplatePatch_.addValue(1);
+  }
   void LacpRxTimeouts() {
     LacpRxTimeouts_.addValue(1);
   }
@@ -447,6 +496,43 @@ class SwitchStats : public boost::noncopyable {
    */
   TLHistogram routeUpdate_;
 
+  /**
+   * Histograms for the time route updates spend in each stage, indexed by
+   * RouteUpdateStage (in microsecond)
+   */
+  std::vector<std::unique_ptr<TLHistogram>> routeUpdateStages_;
+
+  /**
+   * Histogram for the number of routes per route update
+   */
+  TLHistogram routesPerUpdate_;
+
+  /**
+   * Histograms for the number of route updates and routes applied together
+   * by the RibUpdateQueue, and the number of routes it saved programming by
+   * merging updates to the same prefix
+   */
+  TLHistogram ribUpdateBatchUpdates_;
+  TLHistogram ribUpdateBatchRoutes_;
+  TLTimeseries ribUpdateMergedRoutes_;
+
+  /**
+   * Histogram for the number of neighbor entry changes sent to the SwSwitch
+   * together, and for the time from the first of them being made in the
+   * neighbor cache to them being applied to the SwitchState (in microsecond)
+   */
+  TLHistogram neighborUpdateBatchEntries_;
+  TLHistogram neighborUpdateProgramTime_;
+
+  /**
+   * Histograms for the number of ports, and link state events, whose link
+   * state changes were applied together, and for the time from the first of
+   * the events to the changes being programmed (in microseconds)
+   */
+  TLHistogram linkStateChangeBatchPorts_;
+  TLHistogram linkStateChangeBatchEvents_;
+  TLHistogram linkStateChangeConvergeTime_;
+
   /**
    * Background thread heartbeat delay (ms)
    */
@@ -516,11 +602,21 @@ class SwitchStats : public boost::noncopyable {
   TLTimeseries LldpValidateMisMatch_;
   // Number of LLDP Neighbors.
   TLTimeseries LldpNeighborsSize_;
+  // Number of LLDP frames sent from, or that had to rebuild, a cached frame,
+  // and of cached frames patched for a change of the port or hostname
+  TLTimeseries LldpPduTemplateHit_;
+  TLTimeseries LldpPduTemplateRebuild_;
+  TLTimeseries LldpPduTemplatePatch_;
 
   // Number of LACP Rx timeouts
   TLTimeseries LacpRxTimeouts_;
   // Number of LACP session teardown due to mismatching PDUs
   TLTimeseries LacpMismatchPduTeardown_;
+  // Number of LACPDUs sent with a cached, or rebuilt, ethernet header, and
+  // of cached headers patched for a change of ingress vlan
+  TLTimeseries LacpPduTemplateHit_;
+  TLTimeseries LacpPduTemplateRebuild_;
+  TLTimeseries LacpPduTemplatePatch_;
   // Number of MkPdu Received.
   TLTimeseries MkPduRecvdPkts_;
   // Number of MkPdu Send.
@@ -12,15 +12,19 @@
 #include "common/logging/logging.h"
 #include "fboss/agent/AddressUtil.h"
 #include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/ChangeFeed.h"
 #include "fboss/agent/FbossHwUpdateError.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/LinkAggregationManager.h"
 #include "fboss/agent/LldpManager.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/RibUpdateQueue.h"
 #include "fboss/agent/RouteUpdateLogger.h"
+#include "fboss/agent/RouteUpdateTracer.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/ThriftPagedStream.h"
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/capture/PktCapture.h"
@@ -39,18 +43,23 @@
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/LabelForwardingEntry.h"
+#include "fboss/agent/state/MacEntry.h"
+#include "fboss/agent/state/MacTable.h"
 #include "fboss/agent/state/NdpEntry.h"
 #include "fboss/agent/state/NdpTable.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/PortQueue.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
 #include "fboss/agent/state/RouteTableRib.h"
 #include "fboss/agent/state/RouteUpdater.h"
 #include "fboss/agent/state/StateUtils.h"
+#include "fboss/agent/state/SwitchSettings.h"
 #include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/state/VlanMap.h"
+#include "fboss/lib/CallProfiler.h"
 #include "fboss/lib/LogThriftCall.h"
 
 #include <fb303/ServiceData.h>
@@ -68,6 +77,7 @@
 #include <thrift/lib/cpp2/async/DuplexChannel.h>
 
 #include <limits>
+#include <optional>
 
 using apache::thrift::ClientReceiveState;
 using apache::thrift::server::TConnectionContext;
@@ -100,6 +110,10 @@ DEFINE_bool(
     enable_running_config_mutations,
     false,
     "Allow external mutations of running config");
+DEFINE_bool(
+    coalesce_rib_updates,
+    false,
+    "Queue standalone RIB route updates and apply concurrent ones together");
 
 namespace facebook::fboss {
 
@@ -521,17 +535,290 @@ void translateToFibError(const FbossHwUpdateError& updError) {
       });
   throw fibError;
 }
+
 } // namespace
 
 namespace facebook::fboss {
 
+namespace {
+
+size_t checkPageSize(int32_t pageSize) {
+  if (pageSize <= 0) {
+    throw FbossError("Invalid page size ", pageSize);
+  }
+  return pageSize;
+}
+
+/*
+ * Walks the resolved routes of every VRF in a SwitchState snapshot, a page
+ * at a time. The snapshot is pinned for as long as the filler lives, so
+ * routes are converted to thrift only as pages are asked for.
+ */
+class RouteTablePageFiller {
+ public:
+  RouteTablePageFiller(
+      std::shared_ptr<SwitchState> state,
+      const TableDumpFilter& filter)
+      : state_(std::move(state)), table_(state_->getRouteTables()->begin()) {
+    if (filter.vrf_ref().has_value()) {
+      vrf_ = RouterID(*filter.vrf_ref());
+    }
+    if (filter.prefix_ref().has_value()) {
+      const auto& prefix = *filter.prefix_ref();
+      prefix_ = folly::CIDRNetwork(
+          toIPAddress(prefix.ip).mask(prefix.prefixLength),
+          prefix.prefixLength);
+    }
+    startTable();
+  }
+
+  bool operator()(std::vector<UnicastRoute>& page, size_t maxEntries) {
+    auto tablesEnd = state_->getRouteTables()->end();
+    size_t added = 0;
+    while (added < maxEntries && table_ != tablesEnd) {
+      if (v4_ != v4End_) {
+        added += addRoute(page, **v4_++);
+      } else if (v6_ != v6End_) {
+        added += addRoute(page, **v6_++);
+      } else {
+        ++table_;
+        startTable();
+      }
+    }
+    return table_ != tablesEnd;
+  }
+
+ private:
+  using V4Routes = RouteTableRib<IPAddressV4>::RoutesNodeMap;
+  using V6Routes = RouteTableRib<IPAddressV6>::RoutesNodeMap;
+
+  void startTable() {
+    auto tablesEnd = state_->getRouteTables()->end();
+    while (table_ != tablesEnd && vrf_ && (*table_)->getID() != *vrf_) {
+      ++table_;
+    }
+    if (table_ == tablesEnd) {
+      return;
+    }
+    const auto& v4Routes = (*table_)->getRibV4()->routes();
+    const auto& v6Routes = (*table_)->getRibV6()->routes();
+    v4_ = v4Routes->begin();
+    v4End_ = v4Routes->end();
+    v6_ = v6Routes->begin();
+    v6End_ = v6Routes->end();
+    // A prefix only ever matches routes of its own address family
+    if (prefix_ && prefix_->first.isV6()) {
+      v4_ = v4End_;
+    } else if (prefix_) {
+      v6_ = v6End_;
+    }
+  }
+
+  template <typename AddrT>
+  bool addRoute(std::vector<UnicastRoute>& page, const Route<AddrT>& route) {
+    if (!route.isResolved()) {
+      XLOG(DBG3) << "Skipping unresolved route: " << route.str();
+      return false;
+    }
+    const auto& routePrefix = route.prefix();
+    if (prefix_ &&
+        (routePrefix.mask < prefix_->second ||
+         !IPAddress(routePrefix.network)
+              .inSubnet(prefix_->first, prefix_->second))) {
+      return false;
+    }
+    auto fwdInfo = route.getForwardInfo();
+    UnicastRoute tempRoute;
+    tempRoute.dest.ip = toBinaryAddress(routePrefix.network);
+    tempRoute.dest.prefixLength = routePrefix.mask;
+    *tempRoute.nextHopAddrs_ref() =
+        util::fromFwdNextHops(fwdInfo.getNextHopSet());
+    *tempRoute.nextHops_ref() =
+        util::fromRouteNextHopSet(fwdInfo.getNextHopSet());
+    page.emplace_back(std::move(tempRoute));
+    return true;
+  }
+
+  std::shared_ptr<SwitchState> state_;
+  std::optional<RouterID> vrf_;
+  std::optional<folly::CIDRNetwork> prefix_;
+  RouteTableMap::Iterator table_;
+  V4Routes::Iterator v4_;
+  V4Routes::Iterator v4End_;
+  V6Routes::Iterator v6_;
+  V6Routes::Iterator v6End_;
+};
+
+template <typename Entry>
+bool matchesVlanAndPort(const Entry& entry, const TableDumpFilter& filter) {
+  return (!filter.vlanID_ref().has_value() ||
+          *filter.vlanID_ref() == *entry.vlanID_ref()) &&
+      (!filter.port_ref().has_value() ||
+       *filter.port_ref() == *entry.port_ref());
+}
+
+/*
+ * Pages through entries that are only available gathered in a vector, like
+ * the L2 table read from hardware, keeping those that match the filter.
+ */
+template <typename Entry>
+PageFiller<Entry> vectorPageFiller(
+    std::vector<Entry> entries,
+    const TableDumpFilter& filter) {
+  auto remaining = std::make_shared<std::vector<Entry>>(std::move(entries));
+  return [remaining, filter, next = size_t(0)](
+             std::vector<Entry>& page, size_t maxEntries) mutable {
+    size_t added = 0;
+    while (added < maxEntries && next < remaining->size()) {
+      auto& entry = (*remaining)[next++];
+      if (matchesVlanAndPort(entry, filter)) {
+        page.push_back(std::move(entry));
+        ++added;
+      }
+    }
+    return next < remaining->size();
+  };
+}
+
+/*
+ * Walks one table of every VLAN in a SwitchState snapshot, like the ARP, NDP
+ * or MAC tables, a page at a time. The snapshot is pinned for as long as the
+ * filler lives, so entries are converted to thrift only as pages are asked
+ * for, and VLANs other than the filter's are skipped without a look.
+ */
+template <typename Entry, typename Table>
+class VlanTablePageFiller {
+ public:
+  using TableNode = typename Table::Node;
+  using GetTable = std::function<std::shared_ptr<Table>(const Vlan&)>;
+  using ToThrift =
+      std::function<void(const Vlan&, const TableNode&, Entry& entry)>;
+
+  VlanTablePageFiller(
+      std::shared_ptr<SwitchState> state,
+      const TableDumpFilter& filter,
+      GetTable getTable,
+      ToThrift toThrift)
+      : state_(std::move(state)),
+        filter_(filter),
+        getTable_(std::move(getTable)),
+        toThrift_(std::move(toThrift)),
+        vlan_(state_->getVlans()->begin()) {
+    startVlan();
+  }
+
+  bool operator()(std::vector<Entry>& page, size_t maxEntries) {
+    auto vlansEnd = state_->getVlans()->end();
+    size_t added = 0;
+    while (added < maxEntries && vlan_ != vlansEnd) {
+      if (entry_ == entriesEnd_) {
+        ++vlan_;
+        startVlan();
+        continue;
+      }
+      Entry entry;
+      toThrift_(**vlan_, **entry_++, entry);
+      if (matchesVlanAndPort(entry, filter_)) {
+        page.push_back(std::move(entry));
+        ++added;
+      }
+    }
+    return vlan_ != vlansEnd;
+  }
+
+ private:
+  void startVlan() {
+    auto vlansEnd = state_->getVlans()->end();
+    while (vlan_ != vlansEnd && filter_.vlanID_ref().has_value() &&
+           (*vlan_)->getID() != VlanID(*filter_.vlanID_ref())) {
+      ++vlan_;
+    }
+    if (vlan_ == vlansEnd) {
+      return;
+    }
+    table_ = getTable_(**vlan_);
+    entry_ = table_->begin();
+    entriesEnd_ = table_->end();
+  }
+
+  std::shared_ptr<SwitchState> state_;
+  TableDumpFilter filter_;
+  GetTable getTable_;
+  ToThrift toThrift_;
+  VlanMap::Iterator vlan_;
+  std::shared_ptr<Table> table_;
+  typename Table::Iterator entry_;
+  typename Table::Iterator entriesEnd_;
+};
+
+/*
+ * Neighbor entries as the switch state has them. TTLs and the finer grained
+ * states of the neighbor caches are left out, as reading them means a trip
+ * to the neighbor cache thread for every entry: getArpTable() and
+ * getNdpTable() still have them.
+ */
+template <typename Entry, typename Table>
+PageFiller<Entry> neighborTablePageFiller(
+    std::shared_ptr<SwitchState> state,
+    const TableDumpFilter& filter) {
+  using AddrT = typename Table::AddressType;
+  return VlanTablePageFiller<Entry, Table>(
+      std::move(state),
+      filter,
+      [](const Vlan& vlan) {
+        return vlan.getNeighborEntryTable<AddrT>();
+      },
+      [](const Vlan& vlan,
+         const typename Table::Entry& neighbor,
+         Entry& entry) {
+        *entry.ip_ref() = network::toBinaryAddress(neighbor.getIP());
+        *entry.mac_ref() = neighbor.getMac().toString();
+        *entry.port_ref() = neighbor.getPort().asThriftPort();
+        *entry.vlanName_ref() = vlan.getName();
+        *entry.vlanID_ref() = vlan.getID();
+        *entry.state_ref() = neighbor.isPending() ? "PENDING" : "REACHABLE";
+        *entry.classID_ref() = neighbor.getClassID().has_value()
+            ? static_cast<int>(neighbor.getClassID().value())
+            : 0;
+      });
+}
+
+/*
+ * MAC entries as the switch state has them, which only holds the L2 table
+ * with software learning. Entries only get into the state once validated.
+ */
+PageFiller<L2EntryThrift> macTablePageFiller(
+    std::shared_ptr<SwitchState> state,
+    const TableDumpFilter& filter) {
+  return VlanTablePageFiller<L2EntryThrift, MacTable>(
+      std::move(state),
+      filter,
+      [](const Vlan& vlan) { return vlan.getMacTable(); },
+      [](const Vlan& vlan, const MacEntry& mac, L2EntryThrift& entry) {
+        *entry.mac_ref() = mac.getMac().toString();
+        *entry.vlanID_ref() = vlan.getID();
+        *entry.port_ref() = 0;
+        if (mac.getPort().isAggregatePort()) {
+          entry.trunk_ref() = mac.getPort().aggPortID();
+        } else {
+          *entry.port_ref() = mac.getPort().phyPortID();
+        }
+        *entry.l2EntryType_ref() = L2EntryType::L2_ENTRY_TYPE_VALIDATED;
+        if (mac.getClassID().has_value()) {
+          entry.classID_ref() = static_cast<int>(mac.getClassID().value());
+        }
+      });
+}
+} // namespace
+
 class RouteUpdateStats {
  public:
   RouteUpdateStats(SwSwitch* sw, const std::string& func, uint32_t routes)
       : sw_(sw),
         func_(func),
         routes_(routes),
-        start_(std::chrono::steady_clock::now()) {}
+        start_(std::chrono::steady_clock::now()),
+        trace_(sw->getRouteUpdateTracer(), func, routes) {}
   ~RouteUpdateStats() {
     auto end = std::chrono::steady_clock::now();
     auto duration =
@@ -546,6 +833,7 @@ class RouteUpdateStats {
   const std::string func_;
   uint32_t routes_;
   std::chrono::time_point<std::chrono::steady_clock> start_;
+  RouteUpdateTracer::Scope trace_;
 };
 
 ThriftHandler::ThriftHandler(SwSwitch* sw) : FacebookBase2("FBOSS"), sw_(sw) {
@@ -561,9 +849,15 @@ ThriftHandler::ThriftHandler(SwSwitch* sw) : FacebookBase2("FBOSS"), sw_(sw) {
         });
       }
     });
+    if (FLAGS_coalesce_rib_updates && sw->isStandaloneRibEnabled()) {
+      ribUpdateQueue_ =
+          std::make_unique<RibUpdateQueue>(sw, &dynamicFibUpdate);
+    }
   }
 }
 
+ThriftHandler::~ThriftHandler() {}
+
 fb_status ThriftHandler::getStatus() {
   if (sw_->isExiting()) {
     return fb_status::STOPPING;
@@ -670,16 +964,34 @@ void ThriftHandler::deleteUnicastRoutesInVrf(
     auto clientID = ClientID(client);
     auto defaultAdminDistance = sw_->clientIdToAdminDistance(client);
 
-    auto stats = sw_->getRib()->update(
-        routerID,
-        clientID,
-        defaultAdminDistance,
-        {} /* routes to add */,
-        *prefixes /* prefixes to delete */,
-        false /* reset routes for client */,
-        "delete unicast route",
-        &dynamicFibUpdate,
-        static_cast<void*>(sw_));
+    RouteUpdateTracer::Scope trace(
+        sw_->getRouteUpdateTracer(), "delete unicast route", prefixes->size());
+    rib::RoutingInformationBase::UpdateStatistics stats;
+    if (ribUpdateQueue_) {
+      stats = ribUpdateQueue_
+                  ->enqueue(
+                      routerID,
+                      clientID,
+                      defaultAdminDistance,
+                      {} /* routes to add */,
+                      *prefixes /* prefixes to delete */,
+                      false /* reset routes for client */)
+                  .get();
+      trace.record(RouteUpdateStage::RIB_QUEUE, stats.queueDuration);
+    } else {
+      stats = sw_->getRib()->update(
+          routerID,
+          clientID,
+          defaultAdminDistance,
+          {} /* routes to add */,
+          *prefixes /* prefixes to delete */,
+          false /* reset routes for client */,
+          "delete unicast route",
+          &dynamicFibUpdate,
+          static_cast<void*>(sw_));
+    }
+    trace.record(RouteUpdateStage::RIB_UPDATE, stats.routeUpdateDuration);
+    trace.record(RouteUpdateStage::RESOLUTION, stats.resolutionDuration);
 
     sw_->stats()->delRoutesV4(stats.v4RoutesDeleted);
     sw_->stats()->delRoutesV6(stats.v6RoutesDeleted);
@@ -762,16 +1074,34 @@ void ThriftHandler::updateUnicastRoutesImpl(
     auto clientID = ClientID(client);
     auto defaultAdminDistance = sw_->clientIdToAdminDistance(client);
 
-    auto stats = sw_->getRib()->update(
-        routerID,
-        clientID,
-        defaultAdminDistance,
-        *routes /* routes to add */,
-        {} /* prefixes to delete */,
-        sync,
-        updType,
-        &dynamicFibUpdate,
-        static_cast<void*>(sw_));
+    RouteUpdateTracer::Scope trace(
+        sw_->getRouteUpdateTracer(), updType, routes->size());
+    rib::RoutingInformationBase::UpdateStatistics stats;
+    if (ribUpdateQueue_) {
+      stats = ribUpdateQueue_
+                  ->enqueue(
+                      routerID,
+                      clientID,
+                      defaultAdminDistance,
+                      *routes /* routes to add */,
+                      {} /* prefixes to delete */,
+                      sync)
+                  .get();
+      trace.record(RouteUpdateStage::RIB_QUEUE, stats.queueDuration);
+    } else {
+      stats = sw_->getRib()->update(
+          routerID,
+          clientID,
+          defaultAdminDistance,
+          *routes /* routes to add */,
+          {} /* prefixes to delete */,
+          sync,
+          updType,
+          &dynamicFibUpdate,
+          static_cast<void*>(sw_));
+    }
+    trace.record(RouteUpdateStage::RIB_UPDATE, stats.routeUpdateDuration);
+    trace.record(RouteUpdateStage::RESOLUTION, stats.resolutionDuration);
 
     sw_->stats()->addRoutesV4(stats.v4RoutesAdded);
     sw_->stats()->addRoutesV6(stats.v6RoutesAdded);
@@ -893,7 +1223,7 @@ void ThriftHandler::getInterfaceDetail(
     int32_t interfaceId) {
   auto log = LOG_THRIFT_CALL(DBG1);
   ensureConfigured(__func__);
-  const auto& intf = sw_->getState()->getInterfaces()->getInterfaceIf(
+  const auto& intf = sw_->getStateView()->getInterfaces()->getInterfaceIf(
       InterfaceID(interfaceId));
 
   if (!intf) {
@@ -931,6 +1261,55 @@ void ThriftHandler::getL2Table(std::vector<L2EntryThrift>& l2Table) {
   XLOG(DBG6) << "L2 Table size:" << l2Table.size();
 }
 
+apache::thrift::ServerStream<std::vector<NdpEntryThrift>>
+ThriftHandler::getNdpTableStream(
+    int32_t pageSize,
+    std::unique_ptr<TableDumpFilter> filter) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+  return makePagedStream<NdpEntryThrift>(
+      checkPageSize(pageSize),
+      neighborTablePageFiller<NdpEntryThrift, NdpTable>(
+          sw_->getState(), *filter),
+      sw_->getBackgroundEvb());
+}
+
+apache::thrift::ServerStream<std::vector<ArpEntryThrift>>
+ThriftHandler::getArpTableStream(
+    int32_t pageSize,
+    std::unique_ptr<TableDumpFilter> filter) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+  return makePagedStream<ArpEntryThrift>(
+      checkPageSize(pageSize),
+      neighborTablePageFiller<ArpEntryThrift, ArpTable>(
+          sw_->getState(), *filter),
+      sw_->getBackgroundEvb());
+}
+
+apache::thrift::ServerStream<std::vector<L2EntryThrift>>
+ThriftHandler::getL2TableStream(
+    int32_t pageSize,
+    std::unique_ptr<TableDumpFilter> filter) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+  auto state = sw_->getState();
+  if (state->getSwitchSettings()->getL2LearningMode() ==
+      cfg::L2LearningMode::SOFTWARE) {
+    return makePagedStream<L2EntryThrift>(
+        checkPageSize(pageSize),
+        macTablePageFiller(std::move(state), *filter),
+        sw_->getBackgroundEvb());
+  }
+  // With hardware learning, only the hardware has the L2 table
+  std::vector<L2EntryThrift> l2Table;
+  sw_->getHw()->fetchL2Table(&l2Table);
+  return makePagedStream<L2EntryThrift>(
+      checkPageSize(pageSize),
+      vectorPageFiller(std::move(l2Table), *filter),
+      sw_->getBackgroundEvb());
+}
+
 void ThriftHandler::getAclTable(std::vector<AclEntryThrift>& aclTable) {
   auto log = LOG_THRIFT_CALL(DBG1);
   ensureConfigured(__func__);
@@ -954,7 +1333,8 @@ void ThriftHandler::getAggregatePort(
   auto aggregatePortID = static_cast<AggregatePortID>(aggregatePortIDThrift);
 
   auto aggregatePort =
-      sw_->getState()->getAggregatePorts()->getAggregatePortIf(aggregatePortID);
+      sw_->getStateView()->getAggregatePorts()->getAggregatePortIf(
+          aggregatePortID);
 
   if (!aggregatePort) {
     throw FbossError(
@@ -986,7 +1366,7 @@ void ThriftHandler::getPortInfo(PortInfoThrift& portInfo, int32_t portId) {
   auto log = LOG_THRIFT_CALL(DBG1);
   ensureConfigured(__func__);
 
-  const auto port = sw_->getState()->getPorts()->getPortIf(PortID(portId));
+  const auto port = sw_->getStateView()->getPorts()->getPortIf(PortID(portId));
   if (!port) {
     throw FbossError("no such port ", portId);
   }
@@ -1008,6 +1388,70 @@ void ThriftHandler::getAllPortInfo(map<int32_t, PortInfoThrift>& portInfoMap) {
   }
 }
 
+apache::thrift::ServerStream<std::vector<PortInfoThrift>>
+ThriftHandler::getAllPortInfoStream(
+    int32_t pageSize,
+    std::unique_ptr<TableDumpFilter> filter) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+
+  // Port info is only filled in as pages are asked for, from the ports of
+  // the state at the time of the call
+  auto ports = sw_->getState()->getPorts();
+  auto port = ports->begin();
+  std::optional<PortID> portFilter;
+  if (filter->port_ref().has_value()) {
+    portFilter = PortID(*filter->port_ref());
+  }
+  return makePagedStream<PortInfoThrift>(
+      checkPageSize(pageSize),
+      [sw = sw_, ports, port, portFilter](
+          std::vector<PortInfoThrift>& page, size_t maxEntries) mutable {
+        size_t added = 0;
+        for (; added < maxEntries && port != ports->end(); ++port) {
+          if (portFilter && (*port)->getID() != *portFilter) {
+            continue;
+          }
+          page.emplace_back();
+          getPortInfoHelper(*sw, page.back(), *port);
+          ++added;
+        }
+        return port != ports->end();
+      },
+      sw_->getBackgroundEvb());
+}
+
+void ThriftHandler::getChangeFeed(
+    ChangeFeedPage& page,
+    int64_t afterSequence,
+    std::unique_ptr<ChangeFeedFilter> filter,
+    int32_t maxEntries,
+    int64_t feedId) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+  page = sw_->getChangeFeed()->read(
+      afterSequence,
+      feedId,
+      ChangeFeedMatcher(*filter),
+      checkPageSize(maxEntries));
+}
+
+apache::thrift::ServerStream<ChangeFeedPage>
+ThriftHandler::subscribeToChangeFeed(
+    int64_t afterSequence,
+    std::unique_ptr<ChangeFeedFilter> filter,
+    int64_t feedId) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+#if FOLLY_HAS_COROUTINES
+  return sw_->getChangeFeed()->subscribe(
+      afterSequence, feedId, std::make_unique<ChangeFeedMatcher>(*filter));
+#else
+  throw FbossError(
+      "Change feed streams are not supported in this build, use getChangeFeed");
+#endif
+}
+
 void ThriftHandler::clearPortStats(unique_ptr<vector<int32_t>> ports) {
   auto log = LOG_THRIFT_CALL(DBG1, *ports);
   ensureConfigured(__func__);
@@ -1049,7 +1493,8 @@ void ThriftHandler::clearPortStats(unique_ptr<vector<int32_t>> ports) {
 
   auto statsMap = facebook::fb303::fbData->getStatMap();
   for (const auto& portId : *ports) {
-    const auto port = sw_->getState()->getPorts()->getPortIf(PortID(portId));
+    const auto port =
+        sw_->getStateView()->getPorts()->getPortIf(PortID(portId));
     std::vector<std::string> portKeys;
     getPortCounterKeys(portKeys, "out_", port);
     getPortCounterKeys(portKeys, "in_", port);
@@ -1202,7 +1647,7 @@ void ThriftHandler::setPortPrbs(
   auto log = LOG_THRIFT_CALL(DBG1, portNum, enable);
   ensureConfigured(__func__);
   PortID portId = PortID(portNum);
-  const auto port = sw_->getState()->getPorts()->getPortIf(portId);
+  const auto port = sw_->getStateView()->getPorts()->getPortIf(portId);
   if (!port) {
     throw FbossError("no such port ", portNum);
   }
@@ -1245,7 +1690,7 @@ void ThriftHandler::setPortState(int32_t portNum, bool enable) {
   auto log = LOG_THRIFT_CALL(DBG1, portNum, enable);
   ensureConfigured(__func__);
   PortID portId = PortID(portNum);
-  const auto port = sw_->getState()->getPorts()->getPortIf(portId);
+  const auto port = sw_->getStateView()->getPorts()->getPortIf(portId);
   if (!port) {
     throw FbossError("no such port ", portNum);
   }
@@ -1271,39 +1716,20 @@ void ThriftHandler::setPortState(int32_t portNum, bool enable) {
 void ThriftHandler::getRouteTable(std::vector<UnicastRoute>& routes) {
   auto log = LOG_THRIFT_CALL(DBG1);
   ensureConfigured(__func__);
-  auto appliedState = sw_->getState();
-  for (const auto& routeTable : (*appliedState->getRouteTables())) {
-    for (const auto& ipv4 : *(routeTable->getRibV4()->routes())) {
-      UnicastRoute tempRoute;
-      if (!ipv4->isResolved()) {
-        XLOG(INFO) << "Skipping unresolved route: " << ipv4->toFollyDynamic();
-        continue;
-      }
-      auto fwdInfo = ipv4->getForwardInfo();
-      tempRoute.dest.ip = toBinaryAddress(ipv4->prefix().network);
-      tempRoute.dest.prefixLength = ipv4->prefix().mask;
-      *tempRoute.nextHopAddrs_ref() =
-          util::fromFwdNextHops(fwdInfo.getNextHopSet());
-      *tempRoute.nextHops_ref() =
-          util::fromRouteNextHopSet(fwdInfo.getNextHopSet());
-      routes.emplace_back(std::move(tempRoute));
-    }
-    for (const auto& ipv6 : *(routeTable->getRibV6()->routes())) {
-      UnicastRoute tempRoute;
-      if (!ipv6->isResolved()) {
-        XLOG(INFO) << "Skipping unresolved route: " << ipv6->toFollyDynamic();
-        continue;
-      }
-      auto fwdInfo = ipv6->getForwardInfo();
-      tempRoute.dest.ip = toBinaryAddress(ipv6->prefix().network);
-      tempRoute.dest.prefixLength = ipv6->prefix().mask;
-      *tempRoute.nextHopAddrs_ref() =
-          util::fromFwdNextHops(fwdInfo.getNextHopSet());
-      *tempRoute.nextHops_ref() =
-          util::fromRouteNextHopSet(fwdInfo.getNextHopSet());
-      routes.emplace_back(std::move(tempRoute));
-    }
-  }
+  RouteTablePageFiller fillRoutes(sw_->getState(), TableDumpFilter());
+  fillRoutes(routes, std::numeric_limits<size_t>::max());
+}
+
+apache::thrift::ServerStream<std::vector<UnicastRoute>>
+ThriftHandler::getRouteTableStream(
+    int32_t pageSize,
+    std::unique_ptr<TableDumpFilter> filter) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  ensureConfigured(__func__);
+  return makePagedStream<UnicastRoute>(
+      checkPageSize(pageSize),
+      RouteTablePageFiller(sw_->getState(), *filter),
+      sw_->getBackgroundEvb());
 }
 
 void ThriftHandler::getRouteTableByClient(
@@ -1583,6 +2009,16 @@ void ThriftHandler::getRouteUpdateLoggingTrackedPrefixes(
   }
 }
 
+void ThriftHandler::getRouteUpdateTraces(
+    std::vector<RouteUpdateTrace>& traces,
+    int32_t count) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  if (count < 0) {
+    throw FbossError("Invalid trace count ", count);
+  }
+  traces = sw_->getRouteUpdateTracer()->getTraces(count);
+}
+
 void ThriftHandler::getMplsRouteUpdateLoggingTrackedLabels(
     std::vector<MplsRouteUpdateLoggingInfo>& infos) {
   auto log = LOG_THRIFT_CALL(DBG1);
@@ -2066,4 +2502,9 @@ void ThriftHandler::listHwObjects(
   ensureConfigured(__func__);
   out = sw_->getHw()->listObjects(*hwObjects, cached);
 }
+
+void ThriftHandler::getSdkCallProfile(std::string& out) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  out = CallProfiler::getInstance()->dump();
+}
 } // namespace facebook::fboss
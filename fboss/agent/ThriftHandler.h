@@ -35,6 +35,7 @@ class SwSwitch;
 class Vlan;
 class SwitchState;
 class AclEntry;
+class RibUpdateQueue;
 struct LinkNeighbor;
 
 class ThriftHandler : virtual public FbossCtrlSvIf,
@@ -52,6 +53,7 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   typedef std::vector<BinaryAddress> BinaryAddresses;
 
   explicit ThriftHandler(SwSwitch* sw);
+  ~ThriftHandler() override;
 
   fb303::cpp2::fb_status getStatus() override;
 
@@ -198,6 +200,33 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void getAggregatePortTable(
       std::vector<AggregatePortThrift>& aggregatePortsThrift) override;
   void getNdpTable(std::vector<NdpEntryThrift>& arpTable) override;
+
+  apache::thrift::ServerStream<std::vector<UnicastRoute>> getRouteTableStream(
+      int32_t pageSize,
+      std::unique_ptr<TableDumpFilter> filter) override;
+  apache::thrift::ServerStream<std::vector<ArpEntryThrift>> getArpTableStream(
+      int32_t pageSize,
+      std::unique_ptr<TableDumpFilter> filter) override;
+  apache::thrift::ServerStream<std::vector<NdpEntryThrift>> getNdpTableStream(
+      int32_t pageSize,
+      std::unique_ptr<TableDumpFilter> filter) override;
+  apache::thrift::ServerStream<std::vector<L2EntryThrift>> getL2TableStream(
+      int32_t pageSize,
+      std::unique_ptr<TableDumpFilter> filter) override;
+  apache::thrift::ServerStream<std::vector<PortInfoThrift>>
+  getAllPortInfoStream(
+      int32_t pageSize,
+      std::unique_ptr<TableDumpFilter> filter) override;
+  void getChangeFeed(
+      ChangeFeedPage& page,
+      int64_t afterSequence,
+      std::unique_ptr<ChangeFeedFilter> filter,
+      int32_t maxEntries,
+      int64_t feedId) override;
+  apache::thrift::ServerStream<ChangeFeedPage> subscribeToChangeFeed(
+      int64_t afterSequence,
+      std::unique_ptr<ChangeFeedFilter> filter,
+      int64_t feedId) override;
   void getLacpPartnerPair(LacpPartnerPair& lacpPartnerPair, int32_t portID)
       override;
   void getAllLacpPartnerPairs(
@@ -223,6 +252,9 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
       std::unique_ptr<std::string> identifier) override;
   void getRouteUpdateLoggingTrackedPrefixes(
       std::vector<RouteUpdateLoggingInfo>& infos) override;
+  void getRouteUpdateTraces(
+      std::vector<RouteUpdateTrace>& traces,
+      int32_t count) override;
 
   void startLoggingMplsRouteUpdates(
       std::unique_ptr<MplsRouteUpdateLoggingInfo> info) override;
@@ -314,6 +346,7 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
       std::string& out,
       std::unique_ptr<std::vector<HwObjectType>> hwObjects,
       bool cached) override;
+  void getSdkCallProfile(std::string& out) override;
 
   void getPlatformMapping(cfg::PlatformMapping& ret) override;
 
@@ -395,6 +428,9 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
    */
   SwSwitch* sw_;
 
+  // Merges concurrent standalone RIB updates, with --coalesce_rib_updates
+  std::unique_ptr<RibUpdateQueue> ribUpdateQueue_;
+
   int thriftIdleTimeout_;
   std::vector<const TConnectionContext*> brokenClients_;
 
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <folly/io/async/EventBase.h>
+#include <thrift/lib/cpp2/async/ServerStream.h>
+
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/experimental/coro/Invoke.h>
+#endif
+
+namespace facebook::fboss {
+
+/*
+ * Appends at most maxEntries entries of a table to page, resuming where the
+ * previous call stopped, and returns whether there may be entries left.
+ */
+template <typename Entry>
+using PageFiller =
+    std::function<bool(std::vector<Entry>& page, size_t maxEntries)>;
+
+#if !FOLLY_HAS_COROUTINES
+namespace detail {
+/*
+ * Publishes a page at a time on an EventBase, scheduling the next page
+ * behind whatever else the EventBase has queued, until the table is done
+ * or the client goes away.
+ */
+template <typename Entry>
+class PagePublisher
+    : public std::enable_shared_from_this<PagePublisher<Entry>> {
+ public:
+  PagePublisher(
+      size_t pageSize,
+      PageFiller<Entry> fillPage,
+      apache::thrift::ServerStreamPublisher<std::vector<Entry>> publisher,
+      std::shared_ptr<std::atomic<bool>> cancelled,
+      folly::EventBase* evb)
+      : pageSize_(pageSize),
+        fillPage_(std::move(fillPage)),
+        publisher_(std::move(publisher)),
+        cancelled_(std::move(cancelled)),
+        evb_(evb) {}
+
+  void publishNextPage() {
+    bool more = !cancelled_->load();
+    if (more) {
+      std::vector<Entry> page;
+      page.reserve(pageSize_);
+      more = fillPage_(page, pageSize_);
+      if (!page.empty()) {
+        publisher_.next(std::move(page));
+      }
+    }
+    if (more) {
+      evb_->runInEventBaseThread(
+          [self = this->shared_from_this()]() { self->publishNextPage(); });
+    } else {
+      std::move(publisher_).complete();
+    }
+  }
+
+ private:
+  const size_t pageSize_;
+  PageFiller<Entry> fillPage_;
+  apache::thrift::ServerStreamPublisher<std::vector<Entry>> publisher_;
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+  folly::EventBase* evb_;
+};
+} // namespace detail
+#endif
+
+/*
+ * Stream a table to a Thrift client in pages of at most pageSize entries.
+ *
+ * With coroutines, a page is only built once the client asks for it, so
+ * neither the table nor its serialization is ever held in memory as a
+ * whole. Without, the client cannot pace the stream: pages are built one at
+ * a time on evb instead, each queued behind the other work of evb, and
+ * stop being built once the client goes away.
+ */
+template <typename Entry>
+apache::thrift::ServerStream<std::vector<Entry>> makePagedStream(
+    size_t pageSize,
+    PageFiller<Entry> fillPage,
+    folly::EventBase* evb) {
+#if FOLLY_HAS_COROUTINES
+  (void)evb;
+  return folly::coro::co_invoke(
+      [pageSize, fillPage = std::move(fillPage)]()
+          -> folly::coro::AsyncGenerator<std::vector<Entry>&&> {
+        bool more = true;
+        while (more) {
+          std::vector<Entry> page;
+          page.reserve(pageSize);
+          more = fillPage(page, pageSize);
+          if (!page.empty()) {
+            co_yield std::move(page);
+          }
+        }
+      });
+#else
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<std::vector<Entry>>::createPublisher(
+          [cancelled]() { cancelled->store(true); });
+  auto publisher = std::make_shared<detail::PagePublisher<Entry>>(
+      pageSize,
+      std::move(fillPage),
+      std::move(streamAndPublisher.second),
+      std::move(cancelled),
+      evb);
+  evb->runInEventBaseThread([publisher]() { publisher->publishNextPage(); });
+  return std::move(streamAndPublisher.first);
+#endif
+}
+
+} // namespace facebook::fboss
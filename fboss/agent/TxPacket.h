@@ -54,6 +54,12 @@ class TxPacket : public Packet {
       folly::MacAddress src,
       uint16_t protocol);
 
+  /**
+   * Rewrite the VLAN of a header written by the tagged writeEthHeader()
+   * above, in place. header must point to the start of the header.
+   */
+  static void setEthHeaderVlan(uint8_t* header, VlanID vlan);
+
  protected:
   TxPacket() {}
 
@@ -88,4 +94,11 @@ void TxPacket::writeEthHeader(
   cursor->template writeBE<uint16_t>(protocol);
 }
 
+inline void TxPacket::setEthHeaderVlan(uint8_t* header, VlanID vlan) {
+  // The VLAN follows the macs and the 802.1Q TPID
+  uint8_t* tci = header + 2 * folly::MacAddress::SIZE + 2;
+  tci[0] = static_cast<uint16_t>(vlan) >> 8;
+  tci[1] = static_cast<uint16_t>(vlan) & 0xff;
+}
+
 } // namespace facebook::fboss
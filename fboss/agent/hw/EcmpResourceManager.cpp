@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/EcmpResourceManager.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+#include <limits>
+
+DEFINE_uint64(
+    ecmp_max_groups,
+    0,
+    "ECMP groups the hardware holds, 0 to take it from the hardware");
+DEFINE_uint64(
+    ecmp_max_members,
+    0,
+    "ECMP group members the hardware holds, 0 to take it from the hardware");
+DEFINE_uint32(
+    ecmp_resource_percentage,
+    90,
+    "Percentage of the ECMP groups and members past which next hop sets "
+    "share existing groups rather than getting groups of their own");
+DEFINE_string(
+    ecmp_group_sharing_policy,
+    "subset",
+    "Groups next hop sets share once ECMP resources run low: none, subset, "
+    "superset or closest");
+
+namespace facebook::fboss {
+
+EcmpResourceManager::GroupUsage::~GroupUsage() {
+  auto& stats = manager_->stats_;
+  if (shared_) {
+    --stats.groupsShared;
+    stats.membersSaved -= members_;
+  } else {
+    --stats.groupsUsed;
+    stats.membersUsed -= members_;
+  }
+}
+
+EcmpResourceManager::EcmpResourceManager(
+    uint64_t maxGroups,
+    uint64_t maxMembers,
+    uint32_t percentage,
+    SharingPolicy policy)
+    : maxGroups_(maxGroups),
+      maxMembers_(maxMembers),
+      percentage_(percentage),
+      policy_(policy) {}
+
+EcmpResourceManager::SharingPolicy
+EcmpResourceManager::sharingPolicyFromString(const std::string& policy) {
+  if (policy == "none") {
+    return SharingPolicy::NONE;
+  } else if (policy == "subset") {
+    return SharingPolicy::SUBSET;
+  } else if (policy == "superset") {
+    return SharingPolicy::SUPERSET;
+  } else if (policy == "closest") {
+    return SharingPolicy::CLOSEST;
+  }
+  throw FbossError("Unknown ECMP group sharing policy: ", policy);
+}
+
+void EcmpResourceManager::setLimits(uint64_t maxGroups, uint64_t maxMembers) {
+  maxGroups_ = maxGroups;
+  maxMembers_ = maxMembers;
+}
+
+uint64_t EcmpResourceManager::members(const NextHopSet& nextHops) {
+  uint64_t members = 0;
+  for (const auto& nextHop : nextHops) {
+    members += (nextHop.weight() == ECMP_WEIGHT ? 1 : nextHop.weight());
+  }
+  return members;
+}
+
+bool EcmpResourceManager::fits(const NextHopSet& nextHops) const {
+  if (maxGroups_ &&
+      (stats_.groupsUsed + 1) * 100 > maxGroups_ * percentage_) {
+    return false;
+  }
+  if (maxMembers_ &&
+      (stats_.membersUsed + members(nextHops)) * 100 >
+          maxMembers_ * percentage_) {
+    return false;
+  }
+  return true;
+}
+
+std::optional<size_t> EcmpResourceManager::closestGroup(
+    const NextHopSet& nextHops,
+    const std::vector<const NextHopSet*>& groups) const {
+  if (policy_ == SharingPolicy::NONE) {
+    return std::nullopt;
+  }
+  std::optional<size_t> closest;
+  size_t closestDistance = std::numeric_limits<size_t>::max();
+  bool closestIsSubset = false;
+  for (size_t i = 0; i < groups.size(); ++i) {
+    const auto& group = *groups[i];
+    size_t distance;
+    bool isSubset;
+    if (policy_ != SharingPolicy::SUPERSET &&
+        group.size() < nextHops.size() &&
+        std::includes(
+            nextHops.begin(), nextHops.end(), group.begin(), group.end())) {
+      distance = nextHops.size() - group.size();
+      isSubset = true;
+    } else if (
+        policy_ != SharingPolicy::SUBSET && group.size() > nextHops.size() &&
+        std::includes(
+            group.begin(), group.end(), nextHops.begin(), nextHops.end())) {
+      distance = group.size() - nextHops.size();
+      isSubset = false;
+    } else {
+      continue;
+    }
+    if (distance < closestDistance ||
+        (distance == closestDistance && isSubset && !closestIsSubset)) {
+      closest = i;
+      closestDistance = distance;
+      closestIsSubset = isSubset;
+    }
+  }
+  return closest;
+}
+
+std::unique_ptr<EcmpResourceManager::GroupUsage> EcmpResourceManager::addGroup(
+    const NextHopSet& nextHops) {
+  auto groupMembers = members(nextHops);
+  ++stats_.groupsUsed;
+  stats_.membersUsed += groupMembers;
+  return std::unique_ptr<GroupUsage>(
+      new GroupUsage(this, groupMembers, false /* shared */));
+}
+
+std::unique_ptr<EcmpResourceManager::GroupUsage>
+EcmpResourceManager::addSharedGroup(
+    const NextHopSet& nextHops,
+    const NextHopSet& sharedNextHops) {
+  auto membersSaved = members(nextHops);
+  ++stats_.groupsShared;
+  stats_.membersSaved += membersSaved;
+  XLOG(DBG2) << "Next hops " << nextHops << " share the ECMP group of "
+             << sharedNextHops << " for lack of ECMP resources";
+  return std::unique_ptr<GroupUsage>(
+      new GroupUsage(this, membersSaved, true /* shared */));
+}
+
+} // namespace facebook::fboss
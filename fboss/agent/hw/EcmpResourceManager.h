@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#pragma once
+
+#include "fboss/agent/state/RouteNextHopEntry.h"
+
+#include <gflags/gflags.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+DECLARE_uint64(ecmp_max_groups);
+DECLARE_uint64(ecmp_max_members);
+DECLARE_uint32(ecmp_resource_percentage);
+DECLARE_string(ecmp_group_sharing_policy);
+
+namespace facebook::fboss {
+
+/*
+ * Keeps the ECMP groups and group members a switch programs within what its
+ * tables hold. Each distinct next hop set normally gets a group of its own.
+ * Once programming another one would take the groups or members in use past
+ * --ecmp_resource_percentage of the table sizes, the next hop set shares the
+ * closest group already programmed instead, as --ecmp_group_sharing_policy
+ * says:
+ *  - subset: a group over some of the next hops of the set only. Traffic
+ *    only goes to the next hops the route asked for, just over fewer paths
+ *  - superset: a group over all of the next hops of the set and more
+ *  - closest: either, whichever differs from the set by the fewest next hops,
+ *    subsets winning ties
+ *  - none: never share, programming fails once the tables are full
+ * The hw switch gives next hop sets their exact group back once there is
+ * room for it again.
+ */
+class EcmpResourceManager {
+ public:
+  using NextHopSet = RouteNextHopEntry::NextHopSet;
+
+  enum class SharingPolicy {
+    NONE,
+    SUBSET,
+    SUPERSET,
+    CLOSEST,
+  };
+
+  /*
+   * Resources taken by a group, or by a next hop set sharing another's
+   * group, handed back when destroyed
+   */
+  class GroupUsage {
+   public:
+    ~GroupUsage();
+    GroupUsage(const GroupUsage&) = delete;
+    GroupUsage& operator=(const GroupUsage&) = delete;
+
+   private:
+    friend class EcmpResourceManager;
+    GroupUsage(EcmpResourceManager* manager, uint64_t members, bool shared)
+        : manager_(manager), members_(members), shared_(shared) {}
+
+    EcmpResourceManager* manager_;
+    // Members taken, or saved by sharing
+    uint64_t members_;
+    bool shared_;
+  };
+
+  struct Stats {
+    uint64_t groupsUsed{0};
+    uint64_t membersUsed{0};
+    // Next hop sets sharing the group of other next hops
+    uint64_t groupsShared{0};
+    // Members sharing saved, compared to every set having its own group
+    uint64_t membersSaved{0};
+  };
+
+  /*
+   * Limits of 0 are unknown, and never reached
+   */
+  EcmpResourceManager(
+      uint64_t maxGroups,
+      uint64_t maxMembers,
+      uint32_t percentage,
+      SharingPolicy policy);
+
+  static SharingPolicy sharingPolicyFromString(const std::string& policy);
+
+  void setLimits(uint64_t maxGroups, uint64_t maxMembers);
+  uint64_t getMaxGroups() const {
+    return maxGroups_;
+  }
+  uint64_t getMaxMembers() const {
+    return maxMembers_;
+  }
+  SharingPolicy getSharingPolicy() const {
+    return policy_;
+  }
+
+  /*
+   * Whether a group of its own for the next hops stays within the limits
+   */
+  bool fits(const NextHopSet& nextHops) const;
+
+  /*
+   * The group, among those given, the next hops should share as per the
+   * policy, if any
+   */
+  std::optional<size_t> closestGroup(
+      const NextHopSet& nextHops,
+      const std::vector<const NextHopSet*>& groups) const;
+
+  std::unique_ptr<GroupUsage> addGroup(const NextHopSet& nextHops);
+  std::unique_ptr<GroupUsage> addSharedGroup(
+      const NextHopSet& nextHops,
+      const NextHopSet& sharedNextHops);
+
+  Stats getStats() const {
+    return stats_;
+  }
+
+  /*
+   * Members a next hop set takes, one per unit of weight
+   */
+  static uint64_t members(const NextHopSet& nextHops);
+
+ private:
+  uint64_t maxGroups_;
+  uint64_t maxMembers_;
+  uint32_t percentage_;
+  SharingPolicy policy_;
+  Stats stats_;
+};
+
+} // namespace facebook::fboss
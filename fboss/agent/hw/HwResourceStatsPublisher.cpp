@@ -43,6 +43,9 @@ void HwResourceStatsPublisher::publish(const HwResourceStats& stats) const {
   publish(kL3EcmpGroupsUsed, *stats.l3_ecmp_groups_used_ref());
   publish(kL3EcmpGroupsFree, *stats.l3_ecmp_groups_free_ref());
   publish(kL3EcmpGroupMembersFree, *stats.l3_ecmp_group_members_free_ref());
+  publish(kL3EcmpGroupMembersUsed, *stats.l3_ecmp_group_members_used_ref());
+  publish(kL3EcmpGroupsShared, *stats.l3_ecmp_groups_shared_ref());
+  publish(kL3EcmpGroupMembersSaved, *stats.l3_ecmp_group_members_saved_ref());
 
   // LPM
   publish(kLpmIpv4Max, *stats.lpm_ipv4_max_ref());
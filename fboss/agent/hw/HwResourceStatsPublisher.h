@@ -33,6 +33,11 @@ constexpr folly::StringPiece kL3EcmpGroupsUsed{"l3_ecmp_groups_used"};
 constexpr folly::StringPiece kL3EcmpGroupsFree{"l3_ecmp_groups_free"};
 constexpr folly::StringPiece kL3EcmpGroupMembersFree{
     "l3_ecmp_group_memers_free"};
+constexpr folly::StringPiece kL3EcmpGroupMembersUsed{
+    "l3_ecmp_group_members_used"};
+constexpr folly::StringPiece kL3EcmpGroupsShared{"l3_ecmp_groups_shared"};
+constexpr folly::StringPiece kL3EcmpGroupMembersSaved{
+    "l3_ecmp_group_members_saved"};
 constexpr folly::StringPiece kLpmIpv4Max{"lpm_ipv4_max"};
 constexpr folly::StringPiece kLpmIpv4Used{"lpm_ipv4_used"};
 constexpr folly::StringPiece kLpmIpv4Free{"lpm_ipv4_free"};
@@ -0,0 +1,510 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/SflowExporter.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <sys/socket.h>
+
+#include <fb303/ServiceData.h>
+#include <folly/Range.h>
+#include <folly/ScopeGuard.h>
+#include <folly/io/Cursor.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <optional>
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/packet/SflowStructs.h"
+
+DEFINE_uint32(
+    sflow_datagram_size,
+    1400,
+    "Largest sFlow datagram to send, in bytes, without the IP and UDP headers");
+DEFINE_uint32(
+    sflow_batch_size,
+    256,
+    "Number of queued sFlow samples at which they are exported right away");
+DEFINE_uint32(
+    sflow_flush_interval_ms,
+    50,
+    "Longest time a sFlow sample waits for others to share its datagram");
+DEFINE_uint32(
+    sflow_max_backlog,
+    16384,
+    "Number of queued sFlow samples beyond which new ones are dropped");
+
+using namespace std;
+using folly::IOBuf;
+
+namespace {
+std::optional<folly::IPAddress> getLocalIPv6FromWhoAmI() {
+  const std::string whoAmIFn = "/etc/fbwhoami";
+  const std::string key = "DEVICE_PRIMARY_IPV6";
+
+  std::ifstream infile(whoAmIFn);
+  std::string line;
+
+  while (std::getline(infile, line)) {
+    std::vector<std::string> kv;
+    folly::split("=", line, kv);
+    if (kv.size() != 2) {
+      continue;
+    }
+    if (kv[0] == key) {
+      try {
+        return folly::IPAddress(kv[1]);
+      } catch (std::exception const& e) {
+        XLOG(DBG2) << folly::exceptionStr(e);
+        return std::nullopt;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+folly::IPAddress getLocalIPv6() {
+  // We first try to get the local IPv6 in fbwhoami
+  auto ret = getLocalIPv6FromWhoAmI();
+  if (ret.has_value()) {
+    XLOG(DBG2) << "Got local IPv6 address from fbwhoami";
+    return ret.value();
+  }
+
+  struct ifaddrs* ifaddr{nullptr};
+  std::vector<char> host;
+  host.reserve(NI_MAXHOST);
+
+  if (getifaddrs(&ifaddr) == -1) {
+    XLOG(DBG2) << "getifaddrs failed. Returned default address ::";
+    return folly::IPAddress("::");
+  }
+  SCOPE_EXIT {
+    freeifaddrs(ifaddr);
+  };
+
+  for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == nullptr) {
+      continue;
+    }
+    std::string ifname{ifa->ifa_name};
+    if (ifname != "eth0" or ifa->ifa_addr->sa_family != AF_INET6) {
+      continue;
+    }
+    int retno = getnameinfo(
+        ifa->ifa_addr,
+        sizeof(struct sockaddr_in6),
+        host.data(),
+        NI_MAXHOST,
+        nullptr,
+        0,
+        NI_NUMERICHOST);
+    if (retno != 0) {
+      XLOG(DBG2) << "getnameinfo() failed: " << gai_strerror(retno);
+      continue;
+    }
+    try {
+      return folly::IPAddress(host.data());
+    } catch (std::exception const& e) {
+      XLOG(DBG2) << folly::exceptionStr(e);
+      continue;
+    }
+  }
+  XLOG(DBG2) << "Failed to get loopback ipv6 address, returned default one ::";
+  return folly::IPAddress("::");
+}
+} // namespace
+
+namespace facebook::fboss {
+
+namespace {
+
+// sFlow v5 formats, with enterprise 0
+constexpr uint32_t kFlowSampleFormat = 1;
+constexpr uint32_t kSampledHeaderFormat = 1;
+
+// Version, agent address type, sub agent ID, sequence number, uptime and
+// number of samples
+constexpr uint32_t kDatagramHeaderSize = 6 * 4;
+// Data format and length of the sample_record
+constexpr uint32_t kSampleRecordHeaderSize = 2 * 4;
+
+uint32_t xdrPadded(uint32_t length) {
+  return (length + sflow::XDR_BASIC_BLOCK_SIZE - 1) /
+      sflow::XDR_BASIC_BLOCK_SIZE * sflow::XDR_BASIC_BLOCK_SIZE;
+}
+
+template <typename T>
+void serializeTo(const T& t, std::vector<uint8_t>* out) {
+  auto buf = IOBuf::wrapBuffer(out->data(), out->size());
+  folly::io::RWPrivateCursor cursor(buf.get());
+  t.serialize(&cursor);
+  DCHECK(cursor.isAtEnd());
+}
+
+/*
+ * Encode the flow_sample of a sampled packet, with its raw header as the
+ * only flow record.
+ */
+std::vector<uint8_t> encodeFlowSample(
+    const SflowPacketInfo& info,
+    uint32_t sequenceNumber,
+    uint32_t samplingRate,
+    uint32_t drops) {
+  const auto& packet = *info.packetData_ref();
+  sflow::SampledHeader header;
+  header.protocol = sflow::HeaderProtocol::ETHERNET_ISO88023;
+  header.frameLength = packet.size();
+  if (*info.frameLength_ref() > 0) {
+    header.frameLength = *info.frameLength_ref();
+  }
+  header.stripped = 0;
+  header.headerLength = packet.size();
+  header.header = reinterpret_cast<const sflow::byte*>(packet.data());
+  std::vector<uint8_t> flowData(xdrPadded(header.size()));
+  serializeTo(header, &flowData);
+
+  sflow::FlowRecord record;
+  record.flowFormat = kSampledHeaderFormat;
+  record.flowDataLen = flowData.size();
+  record.flowData = flowData.data();
+
+  auto srcPort = static_cast<uint16_t>(*info.srcPort_ref());
+  auto dstPort = static_cast<uint16_t>(*info.dstPort_ref());
+  sflow::FlowSample sample;
+  sample.sequenceNumber = sequenceNumber;
+  // Type 0, for ifIndex, in the top byte
+  sample.sourceID = *info.ingressSampled_ref() ? srcPort : dstPort;
+  sample.samplingRate = samplingRate;
+  sample.samplePool = 0;
+  sample.drops = drops;
+  sample.input = srcPort;
+  sample.output = dstPort;
+  sample.flowRecordsCnt = 1;
+  sample.flowRecords = &record;
+  std::vector<uint8_t> sampleData(sample.size(record.size()));
+  serializeTo(sample, &sampleData);
+  return sampleData;
+}
+
+int openSocket(sa_family_t family) {
+  int sock = ::socket(family, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock == -1) {
+    throw FbossError("Error creating UDP socket: ", folly::errnoStr(errno));
+  }
+  SCOPE_FAIL {
+    close(sock);
+  };
+
+  // put the socket in non-blocking mode
+  if (fcntl(sock, F_SETFL, O_NONBLOCK) != 0) {
+    throw FbossError(
+        "Failed to put socket in non-blocking mode: ", folly::errnoStr(errno));
+  }
+
+  // bind the socket.
+  folly::SocketAddress localAddr;
+  switch (family) {
+    case AF_INET6:
+      localAddr = folly::SocketAddress("::", 0);
+      break;
+    case AF_INET:
+      localAddr = folly::SocketAddress("0.0.0.0", 0);
+      break;
+    default:
+      throw FbossError("Unsupported address family for exporter target");
+  }
+
+  sockaddr_storage addrStorage;
+  localAddr.getAddress(&addrStorage);
+  sockaddr* saddr = reinterpret_cast<sockaddr*>(&addrStorage);
+  if (bind(sock, saddr, localAddr.getActualSize()) != 0) {
+    throw FbossError(
+        "Failed to bind the sFlow socket for ",
+        localAddr.describe(),
+        ": ",
+        folly::errnoStr(errno));
+  }
+  return sock;
+}
+
+/*
+ * Send the messages, skipping over those that fail. Returns the number of
+ * messages sent.
+ */
+size_t sendMessages(int sock, std::vector<mmsghdr>* msgs) {
+  size_t sent = 0;
+  size_t next = 0;
+  while (next < msgs->size()) {
+    auto ret = ::sendmmsg(sock, msgs->data() + next, msgs->size() - next, 0);
+    if (ret >= 0) {
+      sent += ret;
+      next += ret;
+      continue;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    XLOG(DBG1) << "Failed sending sFlow datagram reason: "
+               << folly::errnoStr(errno);
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      // The socket buffer is full, the others would fail the same way
+      break;
+    }
+    ++next;
+  }
+  return sent;
+}
+
+} // namespace
+
+SflowExporter::SflowExporter() : thread_("fbossSflowExporter") {
+  config_.wlock()->agentAddress = folly::IPAddress("::");
+}
+
+SflowExporter::~SflowExporter() {
+  flush();
+  auto collectors = collectors_.wlock();
+  for (auto sock : {collectors->v4Socket, collectors->v6Socket}) {
+    if (sock != -1) {
+      close(sock);
+    }
+  }
+}
+
+bool SflowExporter::contains(const shared_ptr<SflowCollector>& c) const {
+  return collectors_.rlock()->addresses.count(c->getID()) > 0;
+}
+
+size_t SflowExporter::size() const {
+  return collectors_.rlock()->addresses.size();
+}
+
+void SflowExporter::addCollector(const shared_ptr<SflowCollector>& c) {
+  const auto& address = c->getAddress();
+  try {
+    auto collectors = collectors_.wlock();
+    auto& sock = address.getFamily() == AF_INET6 ? collectors->v6Socket
+                                                 : collectors->v4Socket;
+    if (sock == -1) {
+      sock = openSocket(address.getFamily());
+    }
+    collectors->addresses.emplace(c->getID(), address);
+  } catch (const fboss::thrift::FbossBaseError& ex) {
+    XLOG(ERR) << "Could not add exporter: " << address.getFullyQualified()
+              << " reason: " << folly::exceptionStr(ex);
+    return;
+  }
+
+  XLOG(INFO) << "Successfully added exporter for "
+             << address.getFullyQualified();
+}
+
+void SflowExporter::removeCollector(const std::string& id) {
+  XLOG(INFO) << "Removed sFlow exporter " << id;
+  collectors_.wlock()->addresses.erase(id);
+}
+
+void SflowExporter::updateSamplingRates(
+    PortID id,
+    int64_t inRate,
+    int64_t outRate) {
+  // We piggyback the update of local IPv6
+  auto localIP = getLocalIPv6();
+
+  auto config = config_.wlock();
+  config->port2samplingRates[id] = std::make_pair(inRate, outRate);
+  config->agentAddress = localIP;
+}
+
+void SflowExporter::addSample(SflowPacketInfo info) {
+  bool scheduleSend = false;
+  bool sendNow = false;
+  {
+    auto pending = pending_.wlock();
+    if (pending->size() >= FLAGS_sflow_max_backlog) {
+      ++samplesDropped_;
+      return;
+    }
+    scheduleSend = pending->empty();
+    pending->push_back(std::move(info));
+    sendNow = pending->size() == FLAGS_sflow_batch_size;
+  }
+
+  auto evb = thread_.getEventBase();
+  if (sendNow) {
+    evb->runInEventBaseThread([this]() { sendPending(); });
+  } else if (scheduleSend) {
+    evb->runInEventBaseThread([this, evb]() {
+      evb->runAfterDelay(
+          [this]() { sendPending(); }, FLAGS_sflow_flush_interval_ms);
+    });
+  }
+}
+
+void SflowExporter::flush() {
+  thread_.getEventBase()->runInEventBaseThreadAndWait(
+      [this]() { sendPending(); });
+}
+
+SflowExporter::Stats SflowExporter::getStats() const {
+  Stats stats;
+  stats.samplesExported = samplesExported_.load();
+  stats.samplesDropped = samplesDropped_.load();
+  stats.datagramsSent = datagramsSent_.load();
+  stats.sendErrors = sendErrors_.load();
+  return stats;
+}
+
+void SflowExporter::sendPending() {
+  std::vector<SflowPacketInfo> samples;
+  samples.swap(*pending_.wlock());
+  if (samples.empty()) {
+    return;
+  }
+  SCOPE_EXIT {
+    publishStats(samples.size());
+  };
+
+  if (collectors_.rlock()->addresses.empty()) {
+    XLOG(DBG1)
+        << "zero sFlow collectors with sflow enabled, skipping sample export";
+    return;
+  }
+  sendToAll(makeDatagrams(samples));
+  samplesExported_ += samples.size();
+}
+
+std::vector<std::unique_ptr<IOBuf>> SflowExporter::makeDatagrams(
+    const std::vector<SflowPacketInfo>& samples) {
+  std::vector<std::vector<uint8_t>> flowSamples;
+  flowSamples.reserve(samples.size());
+  folly::IPAddress agentAddress;
+  uint32_t drops = samplesDropped_.load();
+  {
+    auto config = config_.rlock();
+    agentAddress = config->agentAddress;
+    for (const auto& info : samples) {
+      int64_t samplingRate = 0;
+      bool ingress = *info.ingressSampled_ref();
+      auto port = PortID(static_cast<uint16_t>(
+          ingress ? *info.srcPort_ref() : *info.dstPort_ref()));
+      auto rates = config->port2samplingRates.find(port);
+      if (rates != config->port2samplingRates.end()) {
+        samplingRate = ingress ? rates->second.first : rates->second.second;
+      }
+      flowSamples.push_back(encodeFlowSample(
+          info, ++sampleSequenceNumber_, samplingRate, drops));
+    }
+  }
+
+  auto uptime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start_)
+                    .count();
+  auto headerSize = kDatagramHeaderSize + agentAddress.byteCount();
+  std::vector<std::unique_ptr<IOBuf>> datagrams;
+  std::vector<sflow::SampleRecord> records;
+  size_t datagramSize = headerSize;
+  auto finishDatagram = [&]() {
+    sflow::SampleDatagram datagram;
+    datagram.datagramV5.agentAddress = agentAddress;
+    datagram.datagramV5.subAgentID = 0;
+    datagram.datagramV5.sequenceNumber = ++datagramSequenceNumber_;
+    datagram.datagramV5.uptime = uptime;
+    datagram.datagramV5.samplesCnt = records.size();
+    datagram.datagramV5.samples = records.data();
+
+    auto buf = IOBuf::create(datagramSize);
+    buf->append(datagramSize);
+    folly::io::RWPrivateCursor cursor(buf.get());
+    datagram.serialize(&cursor);
+    DCHECK(cursor.isAtEnd());
+    datagrams.push_back(std::move(buf));
+
+    records.clear();
+    datagramSize = headerSize;
+  };
+
+  // As many samples per datagram as fit, but at least one
+  for (auto& flowSample : flowSamples) {
+    auto recordSize = kSampleRecordHeaderSize + flowSample.size();
+    if (!records.empty() &&
+        datagramSize + recordSize > FLAGS_sflow_datagram_size) {
+      finishDatagram();
+    }
+    sflow::SampleRecord record;
+    record.sampleType = kFlowSampleFormat;
+    record.sampleDataLen = flowSample.size();
+    record.sampleData = flowSample.data();
+    records.push_back(record);
+    datagramSize += recordSize;
+  }
+  if (!records.empty()) {
+    finishDatagram();
+  }
+  return datagrams;
+}
+
+void SflowExporter::sendToAll(
+    const std::vector<std::unique_ptr<IOBuf>>& datagrams) {
+  std::vector<iovec> vecs(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); ++i) {
+    vecs[i].iov_base = datagrams[i]->writableData();
+    vecs[i].iov_len = datagrams[i]->length();
+  }
+
+  auto collectors = collectors_.rlock();
+  for (auto family : {AF_INET, AF_INET6}) {
+    auto sock =
+        family == AF_INET6 ? collectors->v6Socket : collectors->v4Socket;
+    std::vector<sockaddr_storage> addresses;
+    addresses.reserve(collectors->addresses.size());
+    std::vector<mmsghdr> msgs;
+    for (const auto& idAndAddress : collectors->addresses) {
+      const auto& address = idAndAddress.second;
+      if (address.getFamily() != family) {
+        continue;
+      }
+      addresses.emplace_back();
+      auto addressLen = address.getAddress(&addresses.back());
+      XLOG(DBG4) << "Sending " << datagrams.size() << " sFlow datagrams to "
+                 << address.describe();
+      for (auto& vec : vecs) {
+        mmsghdr msg = {};
+        msg.msg_hdr.msg_name = &addresses.back();
+        msg.msg_hdr.msg_namelen = addressLen;
+        msg.msg_hdr.msg_iov = &vec;
+        msg.msg_hdr.msg_iovlen = 1;
+        msgs.push_back(msg);
+      }
+    }
+    if (msgs.empty()) {
+      continue;
+    }
+    auto sent = sendMessages(sock, &msgs);
+    datagramsSent_ += sent;
+    sendErrors_ += msgs.size() - sent;
+  }
+}
+
+void SflowExporter::publishStats(size_t backlog) const {
+  fb303::fbData->setCounter(kSflowSamplesExported, samplesExported_.load());
+  fb303::fbData->setCounter(kSflowSamplesDropped, samplesDropped_.load());
+  fb303::fbData->setCounter(kSflowDatagramsSent, datagramsSent_.load());
+  fb303::fbData->setCounter(kSflowSendErrors, sendErrors_.load());
+  fb303::fbData->setCounter(kSflowBacklog, backlog);
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/IPAddress.h>
+#include <folly/Range.h>
+#include <folly/SocketAddress.h>
+#include <folly/Synchronized.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include "fboss/agent/if/gen-cpp2/sflow_types.h"
+#include "fboss/agent/state/SflowCollector.h"
+#include "fboss/agent/types.h"
+
+namespace facebook::fboss {
+
+constexpr folly::StringPiece kSflowSamplesExported{"sflow_samples_exported"};
+constexpr folly::StringPiece kSflowSamplesDropped{"sflow_samples_dropped"};
+constexpr folly::StringPiece kSflowDatagramsSent{"sflow_datagrams_sent"};
+constexpr folly::StringPiece kSflowSendErrors{"sflow_send_errors"};
+constexpr folly::StringPiece kSflowBacklog{"sflow_backlog"};
+
+/*
+ * Exports the packets sampled by the ASIC to the sFlow collectors, as sFlow
+ * v5 datagrams, whatever the HwSwitch the samples come from.
+ *
+ * The RX threads only queue the samples. The exporter thread packs as many
+ * of them as fit in a datagram of up to FLAGS_sflow_datagram_size bytes, and
+ * sends all of the datagrams to all of the collectors with one sendmmsg()
+ * per address family. It does so once FLAGS_sflow_batch_size samples are
+ * queued, or FLAGS_sflow_flush_interval_ms after the first of them was.
+ * Samples beyond FLAGS_sflow_max_backlog are dropped.
+ */
+class SflowExporter {
+ public:
+  struct Stats {
+    uint64_t samplesExported{0};
+    uint64_t samplesDropped{0};
+    uint64_t datagramsSent{0};
+    uint64_t sendErrors{0};
+  };
+
+  SflowExporter();
+  ~SflowExporter();
+
+  bool contains(const std::shared_ptr<SflowCollector>& collector) const;
+  size_t size() const;
+  void addCollector(const std::shared_ptr<SflowCollector>& collector);
+  void removeCollector(const std::string& id);
+
+  void updateSamplingRates(PortID id, int64_t inRate, int64_t outRate);
+
+  /*
+   * Queue a sampled packet for export. Thread safe, and cheap enough for the
+   * RX threads.
+   */
+  void addSample(SflowPacketInfo info);
+
+  /*
+   * Send whatever samples are queued right away, and wait for it.
+   */
+  void flush();
+
+  Stats getStats() const;
+
+ private:
+  // no copy or assignment
+  SflowExporter(SflowExporter const&) = delete;
+  SflowExporter& operator=(SflowExporter const&) = delete;
+
+  struct Collectors {
+    std::unordered_map<std::string, folly::SocketAddress> addresses;
+    // One unconnected socket per address family, shared by the collectors
+    int v4Socket{-1};
+    int v6Socket{-1};
+  };
+  struct Config {
+    std::unordered_map<
+        PortID,
+        std::pair<int64_t /* ingress rate */, int64_t /* egress rate */>>
+        port2samplingRates;
+    folly::IPAddress agentAddress;
+  };
+
+  // Run in the exporter thread
+  void sendPending();
+  std::vector<std::unique_ptr<folly::IOBuf>> makeDatagrams(
+      const std::vector<SflowPacketInfo>& samples);
+  void sendToAll(const std::vector<std::unique_ptr<folly::IOBuf>>& datagrams);
+  void publishStats(size_t backlog) const;
+
+  folly::Synchronized<std::vector<SflowPacketInfo>> pending_;
+  folly::Synchronized<Collectors> collectors_;
+  folly::Synchronized<Config> config_;
+
+  // Only used from the exporter thread
+  uint32_t datagramSequenceNumber_{0};
+  uint32_t sampleSequenceNumber_{0};
+  const std::chrono::steady_clock::time_point start_{
+      std::chrono::steady_clock::now()};
+
+  std::atomic<uint64_t> samplesExported_{0};
+  std::atomic<uint64_t> samplesDropped_{0};
+  std::atomic<uint64_t> datagramsSent_{0};
+  std::atomic<uint64_t> sendErrors_{0};
+
+  folly::ScopedEventBaseThread thread_;
+};
+
+} // namespace facebook::fboss
@@ -31,6 +31,7 @@
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 #include "fboss/agent/hw/BufferStatsLogger.h"
 #include "fboss/agent/hw/HwSwitchStats.h"
+#include "fboss/agent/hw/SflowExporter.h"
 #include "fboss/agent/hw/bcm/BcmAPI.h"
 #include "fboss/agent/hw/bcm/BcmAclEntry.h"
 #include "fboss/agent/hw/bcm/BcmAclTable.h"
@@ -62,7 +63,6 @@
 #include "fboss/agent/hw/bcm/BcmRoute.h"
 #include "fboss/agent/hw/bcm/BcmRtag7LoadBalancer.h"
 #include "fboss/agent/hw/bcm/BcmRxPacket.h"
-#include "fboss/agent/hw/bcm/BcmSflowExporter.h"
 #include "fboss/agent/hw/bcm/BcmStatUpdater.h"
 #include "fboss/agent/hw/bcm/BcmSwitchEventCallback.h"
 #include "fboss/agent/hw/bcm/BcmSwitchEventUtils.h"
@@ -372,7 +372,7 @@ BcmSwitch::BcmSwitch(BcmPlatform* platform, uint32_t featuresDesired)
       qosPolicyTable_(new BcmQosPolicyTable(this)),
       aclTable_(new BcmAclTable(this)),
       trunkTable_(new BcmTrunkTable(this)),
-      sFlowExporterTable_(new BcmSflowExporterTable()),
+      sFlowExporter_(new SflowExporter()),
       rtag7LoadBalancer_(new BcmRtag7LoadBalancer(this)),
       mirrorTable_(new BcmMirrorTable(this)),
       bstStatsMgr_(new BcmBstStatsMgr(this)),
@@ -1915,21 +1915,21 @@ void BcmSwitch::processChangedSflowCollector(
 
 void BcmSwitch::processRemovedSflowCollector(
     const std::shared_ptr<SflowCollector>& collector) {
-  if (!sFlowExporterTable_->contains(collector)) {
+  if (!sFlowExporter_->contains(collector)) {
     throw FbossError("Tried to remove non-existent sFlow exporter");
   }
 
-  sFlowExporterTable_->removeExporter(collector->getID());
+  sFlowExporter_->removeCollector(collector->getID());
 }
 
 void BcmSwitch::processAddedSflowCollector(
     const shared_ptr<SflowCollector>& collector) {
-  if (sFlowExporterTable_->contains(collector)) {
+  if (sFlowExporter_->contains(collector)) {
     // Something is wrong.
     throw FbossError("Tried to add an existing sFlow exporter");
   }
 
-  sFlowExporterTable_->addExporter(collector);
+  sFlowExporter_->addCollector(collector);
 }
 
 void BcmSwitch::processSflowSamplingRateChanges(const StateDelta& delta) {
@@ -1944,7 +1944,7 @@ void BcmSwitch::processSflowSamplingRateChanges(const StateDelta& delta) {
             (oldEgressRate != newEgressRate);
         if (sFlowChanged) {
           auto id = newPort->getID();
-          sFlowExporterTable_->updateSamplingRates(
+          sFlowExporter_->updateSamplingRates(
               id, newIngressRate, newEgressRate);
         }
       });
@@ -3047,6 +3047,7 @@ bool BcmSwitch::handleSflowPacket(BcmPacketT& bcmPacket) noexcept {
   info.srcPort_ref() = src_port;
   info.dstPort_ref() = dest_port;
   info.vlan_ref() = vlan;
+  info.frameLength_ref() = pkt_len;
 
   auto snapLen = std::min(kMaxSflowSnapLen, (unsigned int)(pkt_len));
 
@@ -3067,7 +3068,7 @@ bool BcmSwitch::handleSflowPacket(BcmPacketT& bcmPacket) noexcept {
              << *info.vlan_ref() << ',' << info.packetData_ref()->length()
              << ")\n";
 
-  sFlowExporterTable_->sendToAll(info);
+  sFlowExporter_->addSample(std::move(info));
 
   // If it is only here because of sFlow, we're done
   if (sampleOnly) {
@@ -69,11 +69,11 @@ class BcmUnit;
 class BcmWarmBootCache;
 class BcmWarmBootHelper;
 class BcmRtag7LoadBalancer;
-class BcmSflowExporterTable;
 class LabelForwardingEntry;
 class LoadBalancer;
 class PacketTraceInfo;
 class SflowCollector;
+class SflowExporter;
 class MockRxPacket;
 class Interface;
 class Port;
@@ -952,7 +952,7 @@ class BcmSwitch : public BcmSwitchIf {
   std::unique_ptr<BcmStatUpdater> bcmStatUpdater_;
   std::unique_ptr<BcmCosManager> cosManager_;
   std::unique_ptr<BcmTrunkTable> trunkTable_;
-  std::unique_ptr<BcmSflowExporterTable> sFlowExporterTable_;
+  std::unique_ptr<SflowExporter> sFlowExporter_;
   std::unique_ptr<BcmControlPlane> controlPlane_;
   std::unique_ptr<BcmRtag7LoadBalancer> rtag7LoadBalancer_;
   std::unique_ptr<BcmMirrorTable> mirrorTable_;
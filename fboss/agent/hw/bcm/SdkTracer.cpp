@@ -15,7 +15,7 @@
 
 #include "fboss/agent/hw/bcm/BcmCinter.h"
 #include "fboss/agent/hw/bcm/SdkWrapSettings.h"
-#include "fboss/lib/FunctionCallTimeReporter.h"
+#include "fboss/lib/CallProfiler.h"
 
 extern "C" {
 
@@ -1489,6 +1489,11 @@ int __real_sh_process_command(int unit, char* cmd);
 
 using namespace facebook::fboss;
 
+namespace {
+// SDK calls are profiled as a single api, they are not typed like SAI calls
+constexpr uint32_t kBcmSdkApi = 0;
+} // namespace
+
 extern "C" {
 
 #define CALL_WRAPPERS_RV(func_call)                                         \
@@ -1496,7 +1501,7 @@ extern "C" {
     return 0;                                                               \
   }                                                                         \
   {                                                                         \
-    TIME_CALL;                                                              \
+    PROFILE_CALL(kBcmSdkApi, CallProfiler::Operation::OTHER);               \
     auto rv = __real_##func_call;                                           \
     if (FLAGS_enable_bcm_cinter) {                                          \
       facebook::fboss::BcmCinter::getInstance()->func_call;                 \
@@ -1518,7 +1523,7 @@ extern "C" {
     return;                                                                 \
   }                                                                         \
   {                                                                         \
-    TIME_CALL;                                                              \
+    PROFILE_CALL(kBcmSdkApi, CallProfiler::Operation::OTHER);               \
     __real_##func_call;                                                     \
   }                                                                         \
   if (FLAGS_enable_bcm_cinter) {                                            \
@@ -2539,7 +2544,7 @@ int __wrap_bcm_tx(int unit, bcm_pkt_t* tx_pkt, void* cookie) {
   // the SDK call is executed, so we call into BcmCinter->bcm_tx here first
   // since BcmCinter requires access to packet data in order to log it.
   {
-    TIME_CALL;
+    PROFILE_CALL(kBcmSdkApi, CallProfiler::Operation::OTHER);
     CALL_WRAPPERS_RV_CINTER_FIRST(bcm_tx(unit, tx_pkt, cookie));
   }
 }
@@ -12,20 +12,62 @@
 #include "fboss/agent/hw/test/ConfigFactory.h"
 #include "fboss/agent/hw/test/HwSwitchEnsemble.h"
 #include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/SwitchState.h"
 
 #include <folly/Benchmark.h>
 #include "fboss/lib/FunctionCallTimeReporter.h"
 
 namespace facebook::fboss {
 
+/*
+ * The state the standalone RIB would have produced for the given one: the
+ * resolved routes of its route tables moved to the FIBs of the same VRFs.
+ */
+template <typename AddrT>
+std::shared_ptr<ForwardingInformationBase<AddrT>> routeTableRibToFib(
+    const std::shared_ptr<RouteTable>& routeTable) {
+  auto fib = std::make_shared<ForwardingInformationBase<AddrT>>();
+  for (const auto& route : *routeTable->template getRib<AddrT>()->routes()) {
+    if (route->isResolved()) {
+      fib->addNode(route);
+    }
+  }
+  return fib;
+}
+
+inline std::shared_ptr<SwitchState> toStandaloneRibState(
+    const std::shared_ptr<SwitchState>& state) {
+  auto newState = state->clone();
+  auto fibs = std::make_shared<ForwardingInformationBaseMap>();
+  for (const auto& routeTable : *state->getRouteTables()) {
+    auto fibContainer = std::make_shared<ForwardingInformationBaseContainer>(
+        routeTable->getID());
+    fibContainer->writableFields()->fibV4 =
+        routeTableRibToFib<folly::IPAddressV4>(routeTable);
+    fibContainer->writableFields()->fibV6 =
+        routeTableRibToFib<folly::IPAddressV6>(routeTable);
+    fibs->addNode(fibContainer);
+  }
+  newState->resetForwardingInformationBases(fibs);
+  newState->resetRouteTables(std::make_shared<RouteTableMap>());
+  return newState;
+}
+
 /*
  * Helper function to benchmark speed of route insertion, deletion
  * in HW. This function inits the ASIC, generate switch states for
  * a given route distribution and then measures the time it takes
- * to add (or delete post addition) these routes
+ * to add (or delete post addition) these routes.
+ * With standaloneRib, the routes are programmed from the FIBs, as with
+ * SwitchFlags::ENABLE_STANDALONE_RIB, instead of from the route tables.
  */
 template <typename RouteScaleGeneratorT>
-void routeAddDelBenchmarker(bool measureAdd) {
+void routeAddDelBenchmarker(bool measureAdd, bool standaloneRib = false) {
   folly::BenchmarkSuspender suspender;
   auto ensemble = createHwEnsemble(HwSwitchEnsemble::getAllFeatures());
   auto config = utility::onePortPerVlanConfig(
@@ -36,7 +78,19 @@ void routeAddDelBenchmarker(bool measureAdd) {
     // skip if this is not supported for a platform
     return;
   }
-  static const auto states = routeGenerator.getSwitchStates();
+  auto states = routeGenerator.getSwitchStates();
+  if (standaloneRib) {
+    // A HwSwitch takes routes from either the route tables or the FIBs in
+    // a given delta, so the interface routes are moved over in two steps
+    auto programmed = ensemble->getProgrammedState();
+    auto withoutRoutes = programmed->clone();
+    withoutRoutes->resetRouteTables(std::make_shared<RouteTableMap>());
+    ensemble->applyNewState(withoutRoutes);
+    ensemble->applyNewState(toStandaloneRibState(programmed));
+    for (auto& state : states) {
+      state = toStandaloneRibState(state);
+    }
+  }
 
   if (measureAdd) {
     ScopedCallTimer timeIt;
@@ -61,14 +115,20 @@ void routeAddDelBenchmarker(bool measureAdd) {
   }
 }
 
-#define ROUTE_ADD_BENCHMARK(name, RouteScaleGeneratorT) \
-  BENCHMARK(name) {                                     \
-    routeAddDelBenchmarker<RouteScaleGeneratorT>(true); \
+#define ROUTE_ADD_BENCHMARK(name, RouteScaleGeneratorT)       \
+  BENCHMARK(name) {                                           \
+    routeAddDelBenchmarker<RouteScaleGeneratorT>(true);       \
+  }                                                           \
+  BENCHMARK_RELATIVE(name##StandaloneRib) {                   \
+    routeAddDelBenchmarker<RouteScaleGeneratorT>(true, true); \
   }
 
-#define ROUTE_DEL_BENCHMARK(name, RouteScaleGeneratorT)  \
-  BENCHMARK(name) {                                      \
-    routeAddDelBenchmarker<RouteScaleGeneratorT>(false); \
+#define ROUTE_DEL_BENCHMARK(name, RouteScaleGeneratorT)        \
+  BENCHMARK(name) {                                            \
+    routeAddDelBenchmarker<RouteScaleGeneratorT>(false);       \
+  }                                                            \
+  BENCHMARK_RELATIVE(name##StandaloneRib) {                    \
+    routeAddDelBenchmarker<RouteScaleGeneratorT>(false, true); \
   }
 
 } // namespace facebook::fboss
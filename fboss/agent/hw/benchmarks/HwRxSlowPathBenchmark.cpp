@@ -9,6 +9,8 @@
  */
 
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/RxPacketWorkerPool.h"
 #include "fboss/agent/hw/test/ConfigFactory.h"
 #include "fboss/agent/hw/test/HwSwitchEnsemble.h"
 #include "fboss/agent/hw/test/HwSwitchEnsembleFactory.h"
@@ -19,12 +21,16 @@
 
 #include "fboss/agent/hw/switch_asics/HwAsic.h"
 #include "fboss/agent/hw/test/HwTestPacketTrapEntry.h"
+#include "fboss/agent/packet/PktHeaders.h"
 
+#include <folly/Conv.h>
 #include <folly/IPAddressV6.h>
+#include <folly/String.h>
 #include <folly/dynamic.h>
 #include <folly/init/Init.h>
 #include <folly/json.h>
 
+#include <atomic>
 #include <iostream>
 #include <thread>
 
@@ -33,16 +39,124 @@ DEFINE_bool(
     setup_for_warmboot,
     false,
     "Set to true will prepare the device for warmboot");
+DEFINE_int32(
+    rx_slow_path_ports,
+    1,
+    "Ports to loop packets trapped to the CPU over. Packets are dispatched "
+    "to rx packet workers by ingress port, so more than one is needed for "
+    "handling to scale with workers");
+DEFINE_string(
+    rx_packet_worker_counts,
+    "0,1,2,4,8",
+    "Comma separated rx packet worker counts to measure the rate trapped "
+    "packets are handled at with, 0 handling them on the rx thread");
+DEFINE_int32(
+    rx_packet_handler_usecs,
+    10,
+    "CPU time the synthetic handler spends on each trapped packet, on top of "
+    "parsing it");
 
 namespace facebook::fboss {
 
+namespace {
+/*
+ * Stands in for the handling of trapped packets by SwSwitch: parses the
+ * headers of each packet and keeps the CPU busy for a while after. There is
+ * no SwSwitch over the HwSwitch here, so this is a synthetic load: it shows
+ * how handling scales with rx packet workers, not how fast
+ * SwSwitch::handlePacket() is.
+ */
+class RxPacketHandler : public HwSwitchEnsemble::HwSwitchEventObserverIf {
+ public:
+  explicit RxPacketHandler(RxPacketWorkerPool* workers) : workers_(workers) {}
+
+  void packetReceived(RxPacket* pkt) noexcept override {
+    if (!workers_) {
+      handlePacket(pkt->buf());
+      return;
+    }
+    // Copied, as the HwSwitch buffer is only valid until we return
+    auto buf =
+        folly::IOBuf::copyBuffer(pkt->buf()->data(), pkt->buf()->length());
+    workers_->dispatch(
+        RxPacketWorkerPool::flowKey(pkt),
+        [this, buf = std::move(buf)]() { handlePacket(buf.get()); });
+  }
+  void linkStateChanged(PortID /*port*/, bool /*up*/) override {}
+  void l2LearningUpdateReceived(
+      L2Entry /*l2Entry*/,
+      L2EntryUpdateType /*l2EntryUpdateType*/) override {}
+
+  uint64_t handled() const {
+    return handled_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void handlePacket(const folly::IOBuf* buf) {
+    PktHeaders headers;
+    headers.parse(buf);
+    auto end = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(FLAGS_rx_packet_handler_usecs);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+    handled_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  RxPacketWorkerPool* workers_;
+  std::atomic<uint64_t> handled_{0};
+};
+
+/*
+ * Rate trapped packets are handled at, with the given number of workers
+ */
+folly::dynamic measureRxPacketHandling(
+    HwSwitchEnsemble* ensemble,
+    int numWorkers,
+    std::chrono::seconds interval) {
+  std::unique_ptr<RxPacketWorkerPool> workers;
+  if (numWorkers) {
+    workers = std::make_unique<RxPacketWorkerPool>(
+        "rx_worker", numWorkers, 4096 /* maxQueueDepth */);
+  }
+  RxPacketHandler handler(workers.get());
+  ensemble->addHwEventObserver(&handler);
+  auto handledBefore = handler.handled();
+  auto timeBefore = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(interval);
+  auto handledAfter = handler.handled();
+  auto timeAfter = std::chrono::steady_clock::now();
+  ensemble->removeHwEventObserver(&handler);
+
+  std::chrono::duration<double> duration = timeAfter - timeBefore;
+  folly::dynamic result = folly::dynamic::object;
+  result["workers"] = numWorkers;
+  result["handled_pps"] = static_cast<uint64_t>(
+      (handledAfter - handledBefore) / duration.count());
+  if (workers) {
+    workers->stop();
+    folly::dynamic workerLoad = folly::dynamic::array;
+    uint64_t dropped = 0;
+    for (const auto& stats : workers->getWorkerStats()) {
+      workerLoad.push_back(stats.processed);
+      dropped += stats.dropped;
+    }
+    result["worker_handled"] = std::move(workerLoad);
+    result["dropped"] = dropped;
+  }
+  return result;
+}
+} // namespace
+
 void runRxSlowPathBenchmark() {
-  constexpr int kEcmpWidth = 1;
+  const int kEcmpWidth = FLAGS_rx_slow_path_ports;
   auto ensemble = createHwEnsemble(HwSwitchEnsemble::getAllFeatures());
   auto hwSwitch = ensemble->getHwSwitch();
   auto dstIp = folly::IPAddress("2620:0:1cfe:face:b00c::4");
-  auto portUsed = ensemble->masterLogicalPortIds()[0];
-  auto config = utility::oneL3IntfConfig(hwSwitch, portUsed);
+  auto masterLogicalPorts = ensemble->masterLogicalPortIds();
+  CHECK_LE(kEcmpWidth, static_cast<int>(masterLogicalPorts.size()));
+  std::vector<PortID> portsUsed(
+      masterLogicalPorts.begin(), masterLogicalPorts.begin() + kEcmpWidth);
+  auto config = utility::oneL3IntfNPortConfig(hwSwitch, portsUsed);
   ensemble->applyInitialConfig(config);
   // capture packet exiting port 0 (entering due to loopback)
   auto packetCapture = HwTestPacketTrapEntry(hwSwitch, dstIp);
@@ -55,21 +169,26 @@ void runRxSlowPathBenchmark() {
       kEcmpWidth);
   ensemble->applyNewState(ecmpRouteState);
   // Disable TTL decrements
-  utility::disableTTLDecrements(
-      hwSwitch, ecmpHelper.getRouterId(), ecmpHelper.getNextHops()[0]);
+  for (int i = 0; i < kEcmpWidth; ++i) {
+    utility::disableTTLDecrements(
+        hwSwitch, ecmpHelper.getRouterId(), ecmpHelper.getNextHops()[i]);
+  }
 
   const auto kSrcMac = folly::MacAddress{"fa:ce:b0:00:00:0c"};
-  // Send packet
-  auto txPacket = utility::makeUDPTxPacket(
-      hwSwitch,
-      VlanID(*config.vlanPorts_ref()[0].vlanID_ref()),
-      kSrcMac,
-      dstMac,
-      folly::IPAddressV6("2620:0:1cfe:face:b00c::3"),
-      dstIp,
-      8000,
-      8001);
-  hwSwitch->sendPacketSwitchedSync(std::move(txPacket));
+  // Send packets, a few per port for ECMP to spread them over all ports
+  const int kNumPackets = kEcmpWidth == 1 ? 1 : kEcmpWidth * 4;
+  for (int i = 0; i < kNumPackets; ++i) {
+    auto txPacket = utility::makeUDPTxPacket(
+        hwSwitch,
+        VlanID(*config.vlanPorts_ref()[0].vlanID_ref()),
+        kSrcMac,
+        dstMac,
+        folly::IPAddressV6("2620:0:1cfe:face:b00c::3"),
+        dstIp,
+        8000 + i,
+        8001);
+    hwSwitch->sendPacketSwitchedSync(std::move(txPacket));
+  }
 
   constexpr auto kBurnIntevalInSeconds = 5;
   // Let the packet flood warm up
@@ -92,15 +211,40 @@ void runRxSlowPathBenchmark() {
                           durationMillseconds.count()) *
       1000;
 
+  // Then how fast the trapped packets get handled, with each worker count
+  std::vector<int> workerCounts;
+  folly::splitTo<int>(
+      ',',
+      FLAGS_rx_packet_worker_counts,
+      std::back_inserter(workerCounts),
+      true /* ignoreEmpty */);
+  folly::dynamic handlingJson = folly::dynamic::array;
+  for (auto numWorkers : workerCounts) {
+    handlingJson.push_back(measureRxPacketHandling(
+        ensemble.get(),
+        numWorkers,
+        std::chrono::seconds(kBurnIntevalInSeconds)));
+  }
+
+  auto handlingLoad = folly::to<std::string>(
+      "synthetic: header parse and ",
+      FLAGS_rx_packet_handler_usecs,
+      "us busy wait per packet, not SwSwitch::handlePacket");
   if (FLAGS_json) {
     folly::dynamic cpuRxRateJson = folly::dynamic::object;
     cpuRxRateJson["cpu_rx_pps"] = pps;
     cpuRxRateJson["cpu_rx_bytes_per_sec"] = bytesPerSec;
+    cpuRxRateJson["rx_packet_handling"] = std::move(handlingJson);
+    cpuRxRateJson["rx_packet_handling_load"] = handlingLoad;
     std::cout << toPrettyJson(cpuRxRateJson) << std::endl;
   } else {
     XLOG(INFO) << " Pkts before: " << pktsBefore << " Pkts after: " << pktsAfter
                << " interval ms: " << durationMillseconds.count()
                << " pps: " << pps << " bytes per sec: " << bytesPerSec;
+    XLOG(INFO) << " Rx packet handling load: " << handlingLoad;
+    for (const auto& handling : handlingJson) {
+      XLOG(INFO) << " Rx packet handling: " << folly::toJson(handling);
+    }
   }
 }
 } // namespace facebook::fboss
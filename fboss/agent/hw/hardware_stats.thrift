@@ -134,4 +134,11 @@ struct HwResourceStats {
   43: i32 mirrors_span = STAT_UNINITIALIZED
   44: i32 mirrors_erspan = STAT_UNINITIALIZED
   45: i32 mirrors_sflow = STAT_UNINITIALIZED
+
+  // ECMP members taken by the next hop groups programmed
+  46: i32 l3_ecmp_group_members_used = STAT_UNINITIALIZED
+  // Next hop sets sharing the ECMP group of other next hops, for lack of
+  // ECMP resources, and the members they would have taken otherwise
+  47: i32 l3_ecmp_groups_shared = STAT_UNINITIALIZED
+  48: i32 l3_ecmp_group_members_saved = STAT_UNINITIALIZED
 }
@@ -15,7 +15,7 @@
 #include "fboss/agent/hw/sai/api/SaiAttribute.h"
 #include "fboss/agent/hw/sai/api/SaiAttributeDataTypes.h"
 #include "fboss/agent/hw/sai/api/Traits.h"
-#include "fboss/lib/FunctionCallTimeReporter.h"
+#include "fboss/lib/CallProfiler.h"
 #include "fboss/lib/TupleUtils.h"
 
 #include <folly/Format.h>
@@ -42,7 +42,10 @@ template <typename ApiT>
 class SaiApi {
  public:
   virtual ~SaiApi() = default;
-  SaiApi() = default;
+  SaiApi() {
+    CallProfiler::getInstance()->setApiName(
+        apiType(), saiApiTypeToString(apiType()).str());
+  }
   SaiApi(const SaiApi& other) = delete;
   SaiApi& operator=(const SaiApi& other) = delete;
 
@@ -89,7 +92,7 @@ class SaiApi {
     std::lock_guard<std::mutex> g{SaiApiLock::getInstance()->lock};
     sai_status_t status;
     {
-      TIME_CALL;
+      PROFILE_CALL(apiType(), CallProfiler::Operation::CREATE);
       status = impl()._create(
           &key, switch_id, saiAttributeTs.size(), saiAttributeTs.data());
     }
@@ -124,7 +127,7 @@ class SaiApi {
     std::lock_guard<std::mutex> g{SaiApiLock::getInstance()->lock};
     sai_status_t status;
     {
-      TIME_CALL;
+      PROFILE_CALL(apiType(), CallProfiler::Operation::CREATE);
       status =
           impl()._create(entry, saiAttributeTs.size(), saiAttributeTs.data());
     }
@@ -150,7 +153,7 @@ class SaiApi {
     std::lock_guard<std::mutex> g{SaiApiLock::getInstance()->lock};
     sai_status_t status;
     {
-      TIME_CALL;
+      PROFILE_CALL(apiType(), CallProfiler::Operation::REMOVE);
       status = impl()._remove(key);
     }
     saiApiCheckError(
@@ -184,7 +187,7 @@ class SaiApi {
     std::lock_guard<std::mutex> g{SaiApiLock::getInstance()->lock};
     sai_status_t status;
     {
-      TIME_CALL;
+      PROFILE_CALL(apiType(), CallProfiler::Operation::GET);
       status = impl()._getAttribute(key, attr.saiAttr());
     }
     /*
@@ -197,7 +200,7 @@ class SaiApi {
     if (status == SAI_STATUS_BUFFER_OVERFLOW) {
       attr.realloc();
       {
-        TIME_CALL;
+        PROFILE_CALL(apiType(), CallProfiler::Operation::GET);
         status = impl()._getAttribute(key, attr.saiAttr());
       }
     }
@@ -310,7 +313,7 @@ class SaiApi {
     }
     sai_status_t status;
     {
-      TIME_CALL;
+      PROFILE_CALL(apiType(), CallProfiler::Operation::SET);
       status = impl()._setAttribute(key, saiAttr(attr));
     }
     saiApiCheckError(
@@ -406,7 +409,7 @@ class SaiApi {
       counters.resize(numCounters);
       sai_status_t status;
       {
-        TIME_CALL
+        PROFILE_CALL(apiType(), CallProfiler::Operation::STATS);
         status = impl()._getStats(
             key, counters.size(), counterIds, mode, counters.data());
       }
@@ -433,7 +436,7 @@ class SaiApi {
       }
       sai_status_t status;
       {
-        TIME_CALL
+        PROFILE_CALL(apiType(), CallProfiler::Operation::STATS);
         status = impl()._clearStats(key, numCounters, counterIds);
       }
       saiApiCheckError(status, apiType(), "Failed to clear stats");
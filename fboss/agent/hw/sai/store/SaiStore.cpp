@@ -11,6 +11,23 @@
 #include "fboss/agent/hw/sai/store/SaiStore.h"
 
 #include <folly/Singleton.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
+
+#include <vector>
+
+DEFINE_uint32(
+    sai_store_reload_threads,
+    8,
+    "Threads reloading the object types of the SAI store in parallel on "
+    "warm boot, 0 or 1 to reload them one after the other");
+
+DEFINE_bool(
+    sai_store_lazy_reload,
+    true,
+    "Only fetch the attributes of reloaded route and label entries once "
+    "they are first looked up, rather than on reload");
 
 namespace {
 struct singleton_tag_type {};
@@ -39,18 +56,37 @@ void SaiStore::setSwitchId(sai_object_id_t switchId) {
 void SaiStore::reload(
     const folly::dynamic* adapterKeysJson,
     const folly::dynamic* adapterKeys2AdapterHostKeyJson) {
+  auto reloadStore = [adapterKeysJson,
+                      adapterKeys2AdapterHostKeyJson](auto& store) {
+    const folly::dynamic* adapterKeys = adapterKeysJson
+        ? adapterKeysJson->get_ptr(store.objectTypeName())
+        : nullptr;
+    const folly::dynamic* adapterHostKeys = adapterKeys2AdapterHostKeyJson
+        ? adapterKeys2AdapterHostKeyJson->get_ptr(store.objectTypeName())
+        : nullptr;
+
+    store.reload(adapterKeys, adapterHostKeys);
+  };
+  if (FLAGS_sai_store_reload_threads <= 1) {
+    tupleForEach(reloadStore, stores_);
+    return;
+  }
+  // Each object type has a store of its own, and loading an object only
+  // reads its own attributes from the adapter, so the types are reloaded
+  // independently of each other
+  folly::CPUThreadPoolExecutor executor(
+      FLAGS_sai_store_reload_threads,
+      std::make_shared<folly::NamedThreadFactory>("SaiStoreReload"));
+  std::vector<folly::Future<folly::Unit>> reloads;
   tupleForEach(
-      [adapterKeysJson, adapterKeys2AdapterHostKeyJson](auto& store) {
-        const folly::dynamic* adapterKeys = adapterKeysJson
-            ? adapterKeysJson->get_ptr(store.objectTypeName())
-            : nullptr;
-        const folly::dynamic* adapterHostKeys = adapterKeys2AdapterHostKeyJson
-            ? adapterKeys2AdapterHostKeyJson->get_ptr(store.objectTypeName())
-            : nullptr;
-
-        store.reload(adapterKeys, adapterHostKeys);
+      [&executor, &reloadStore, &reloads](auto& store) {
+        reloads.push_back(folly::via(
+            &executor, [&reloadStore, &store]() { reloadStore(store); }));
       },
       stores_);
+  for (auto& result : folly::collectAll(reloads).get()) {
+    result.throwIfFailed();
+  }
 }
 
 void SaiStore::release() {
@@ -21,16 +21,20 @@
 #include "fboss/lib/RefMap.h"
 
 #include <folly/dynamic.h>
+#include <gflags/gflags.h>
 
 #include <memory>
 #include <optional>
 #include <sstream>
 #include <type_traits>
+#include <unordered_set>
 
 extern "C" {
 #include <sai.h>
 }
 
+DECLARE_bool(sai_store_lazy_reload);
+
 namespace facebook::fboss {
 
 inline constexpr auto kAdapterKey2AdapterHostKey = "adapterKey2AdapterHostKey";
@@ -39,6 +43,12 @@ template <>
 struct AdapterHostKeyWarmbootRecoverable<SaiNextHopGroupTraits>
     : std::false_type {};
 
+template <>
+struct IsSaiObjectReloadedLazily<SaiRouteTraits> : std::true_type {};
+
+template <>
+struct IsSaiObjectReloadedLazily<SaiInSegTraits> : std::true_type {};
+
 /*
  * SaiObjectStore is the critical component of SaiStore,
  * it provides the needed operations on a single type of SaiObject
@@ -132,17 +142,24 @@ class SaiObjectStore {
               }),
           keys.end());
     }
-    for (const auto k : keys) {
-      ObjectType obj = getObject(k, adapterKeys2AdapterHostKey);
-      auto adapterHostKey = obj.adapterHostKey();
-      XLOGF(DBG5, "SaiStore reloaded {}", obj);
-      auto ins = objects_.refOrInsert(adapterHostKey, std::move(obj));
-      if (!ins.second) {
-        XLOG(FATAL) << "[" << saiObjectTypeToString(SaiObjectTraits::ObjectType)
-                    << "]"
-                    << " Unexpected duplicate adapterHostKey";
+    if constexpr (IsSaiObjectReloadedLazily<SaiObjectTraits>::value) {
+      static_assert(
+          std::is_same_v<
+              typename SaiObjectTraits::AdapterHostKey,
+              typename SaiObjectTraits::AdapterKey>,
+          "lazily reloaded objects must have AdapterKey == AdapterHostKey");
+      if (FLAGS_sai_store_lazy_reload) {
+        unloadedKeys_.insert(keys.begin(), keys.end());
+        XLOGF(
+            DBG2,
+            "SaiStore deferred reload of {} {}",
+            keys.size(),
+            objectTypeName());
+        return;
       }
-      warmBootHandles_.emplace(adapterHostKey, ins.first);
+    }
+    for (const auto k : keys) {
+      loadWarmBootHandle(k, adapterKeys2AdapterHostKey);
     }
   }
 
@@ -197,6 +214,7 @@ class SaiObjectStore {
   std::shared_ptr<ObjectType> get(
       const typename SaiObjectTraits::AdapterHostKey& adapterHostKey) {
     XLOGF(DBG5, "SaiStore get object {}", adapterHostKey);
+    loadIfUnloaded(adapterHostKey);
     auto itr = warmBootHandles_.find(adapterHostKey);
     if (itr != warmBootHandles_.end()) {
       return itr->second;
@@ -206,6 +224,7 @@ class SaiObjectStore {
 
   void release() {
     objects_.clear();
+    unloadedKeys_.clear();
   }
 
   folly::dynamic adapterKeysFollyDynamic() const {
@@ -214,6 +233,9 @@ class SaiObjectStore {
       adapterKeys.push_back(toFollyDynamic<SaiObjectTraits>(
           hostKeyAndObj.second.lock()->adapterKey()));
     }
+    for (const auto& key : unloadedKeys_) {
+      adapterKeys.push_back(toFollyDynamic<SaiObjectTraits>(key));
+    }
     return adapterKeys;
   }
   static std::vector<typename SaiObjectTraits::AdapterKey>
@@ -231,6 +253,7 @@ class SaiObjectStore {
       }
     }
     objects_.clear();
+    unloadedKeys_.clear();
   }
 
   const UnorderedRefMap<typename SaiObjectTraits::AdapterHostKey, ObjectType>&
@@ -256,7 +279,7 @@ class SaiObjectStore {
   }
 
   size_t warmBootHandlesCount() const {
-    return warmBootHandles_.size();
+    return warmBootHandles_.size() + unloadedKeys_.size();
   }
 
   bool hasUnexpectedUnclaimedWarmbootHandles() const {
@@ -271,17 +294,51 @@ class SaiObjectStore {
     for (auto iter : warmBootHandles_) {
       XLOGF(DBG1, "{}", *iter.second);
     }
+    for (const auto& key : unloadedKeys_) {
+      XLOGF(DBG1, "{} (not loaded)", key);
+    }
   }
 
   void removeUnexpectedUnclaimedWarmbootHandles() {
     if (!hasUnexpectedUnclaimedWarmbootHandles()) {
       return;
     }
-    // remove unclaimed objects
+    // remove unclaimed objects, which needs those never looked up loaded
+    while (!unloadedKeys_.empty()) {
+      loadIfUnloaded(*unloadedKeys_.begin());
+    }
     warmBootHandles_.clear();
   }
 
  private:
+  void loadWarmBootHandle(
+      const typename SaiObjectTraits::AdapterKey& key,
+      const folly::dynamic* adapterKeys2AdapterHostKey) {
+    ObjectType obj = getObject(key, adapterKeys2AdapterHostKey);
+    auto adapterHostKey = obj.adapterHostKey();
+    XLOGF(DBG5, "SaiStore reloaded {}", obj);
+    auto ins = objects_.refOrInsert(adapterHostKey, std::move(obj));
+    if (!ins.second) {
+      XLOG(FATAL) << "[" << saiObjectTypeToString(SaiObjectTraits::ObjectType)
+                  << "]"
+                  << " Unexpected duplicate adapterHostKey";
+    }
+    warmBootHandles_.emplace(adapterHostKey, ins.first);
+  }
+
+  void loadIfUnloaded(
+      const typename SaiObjectTraits::AdapterHostKey& adapterHostKey) {
+    if constexpr (IsSaiObjectReloadedLazily<SaiObjectTraits>::value) {
+      auto itr = unloadedKeys_.find(adapterHostKey);
+      if (itr == unloadedKeys_.end()) {
+        return;
+      }
+      auto key = *itr;
+      unloadedKeys_.erase(itr);
+      loadWarmBootHandle(key, nullptr);
+    }
+  }
+
   ObjectType getObject(
       typename SaiObjectTraits::AdapterKey key,
       const folly::dynamic* adapterKey2AdapterHostKey) {
@@ -298,6 +355,7 @@ class SaiObjectStore {
   std::pair<std::shared_ptr<ObjectType>, bool> program(
       const typename SaiObjectTraits::AdapterHostKey& adapterHostKey,
       const typename SaiObjectTraits::CreateAttributes& attributes) {
+    loadIfUnloaded(adapterHostKey);
     auto existingObj = objects_.ref(adapterHostKey);
     auto ins = existingObj
         ? std::make_pair(existingObj, false)
@@ -343,6 +401,8 @@ class SaiObjectStore {
       typename SaiObjectTraits::AdapterHostKey,
       std::shared_ptr<ObjectType>>
       warmBootHandles_;
+  // Keys of the objects reloaded lazily which were not looked up yet
+  std::unordered_set<typename SaiObjectTraits::AdapterHostKey> unloadedKeys_;
 };
 
 /*
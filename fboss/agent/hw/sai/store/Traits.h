@@ -68,4 +68,12 @@ struct PublisherKey<
 template <typename ObjectTraits>
 struct AdapterHostKeyWarmbootRecoverable : std::true_type {};
 
+/*
+ * Entries which no other object depends on, and whose adapter host key is
+ * their adapter key, need not be loaded on reload. Their attributes are only
+ * fetched from the adapter when they are first looked up.
+ */
+template <typename ObjectTraits>
+struct IsSaiObjectReloadedLazily : std::false_type {};
+
 } // namespace facebook::fboss
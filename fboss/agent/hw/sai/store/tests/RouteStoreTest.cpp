@@ -172,3 +172,76 @@ TEST_F(SaiStoreTest, toStrV6Route) {
 
   verifyToStr<SaiRouteTraits>();
 }
+
+TEST_F(SaiStoreTest, lazyReloadRoute) {
+  auto& routeApi = saiApiTable->routeApi();
+  folly::CIDRNetwork dest(folly::IPAddress("10.10.10.1"), 24);
+  SaiRouteTraits::RouteEntry r(0, 0, dest);
+  SaiRouteTraits::Attributes::PacketAction packetActionAttribute{
+      SAI_PACKET_ACTION_FORWARD};
+  routeApi.create<SaiRouteTraits>(r, {packetActionAttribute, 5, 42});
+
+  SaiStore s(0);
+  s.reload();
+  auto& store = s.get<SaiRouteTraits>();
+  // Not loaded until looked up, but still a warm boot handle
+  EXPECT_EQ(store.size(), 0);
+  EXPECT_EQ(store.warmBootHandlesCount(), 1);
+  EXPECT_EQ(
+      keysForSaiObjStoreFromStoreJson<SaiRouteTraits>(
+          s.adapterKeysFollyDynamic()),
+      std::vector<SaiRouteTraits::RouteEntry>{r});
+
+  auto got = store.get(r);
+  EXPECT_EQ(GET_OPT_ATTR(Route, NextHopId, got->attributes()), 5);
+  EXPECT_EQ(store.size(), 1);
+  EXPECT_EQ(store.warmBootHandlesCount(), 1);
+  store.setObject(r, {packetActionAttribute, 4, 41});
+  EXPECT_EQ(GET_OPT_ATTR(Route, NextHopId, got->attributes()), 4);
+  EXPECT_EQ(store.warmBootHandlesCount(), 0);
+}
+
+TEST_F(SaiStoreTest, releaseForgetsUnloadedRoutes) {
+  auto& routeApi = saiApiTable->routeApi();
+  folly::CIDRNetwork dest(folly::IPAddress("10.10.10.1"), 24);
+  SaiRouteTraits::RouteEntry r(0, 0, dest);
+  routeApi.create<SaiRouteTraits>(r, {SAI_PACKET_ACTION_FORWARD, 5, 42});
+
+  SaiStore s(0);
+  s.reload();
+  s.release();
+  auto& store = s.get<SaiRouteTraits>();
+  EXPECT_EQ(store.warmBootHandlesCount(), 0);
+  EXPECT_EQ(store.get(r), nullptr);
+  EXPECT_EQ(store.size(), 0);
+}
+
+TEST_F(SaiStoreTest, eagerReloadRoute) {
+  auto& routeApi = saiApiTable->routeApi();
+  folly::CIDRNetwork dest(folly::IPAddress("10.10.10.1"), 24);
+  SaiRouteTraits::RouteEntry r(0, 0, dest);
+  routeApi.create<SaiRouteTraits>(r, {SAI_PACKET_ACTION_FORWARD, 5, 42});
+
+  FLAGS_sai_store_lazy_reload = false;
+  SaiStore s(0);
+  s.reload();
+  FLAGS_sai_store_lazy_reload = true;
+  auto& store = s.get<SaiRouteTraits>();
+  EXPECT_EQ(store.size(), 1);
+  EXPECT_EQ(store.warmBootHandlesCount(), 1);
+}
+
+TEST_F(SaiStoreTest, removeUnclaimedLazilyReloadedRoute) {
+  auto& routeApi = saiApiTable->routeApi();
+  folly::CIDRNetwork dest(folly::IPAddress("10.10.10.1"), 24);
+  SaiRouteTraits::RouteEntry r(0, 0, dest);
+  routeApi.create<SaiRouteTraits>(r, {SAI_PACKET_ACTION_FORWARD, 5, 42});
+
+  SaiStore s(0);
+  s.reload();
+  auto& store = s.get<SaiRouteTraits>();
+  EXPECT_TRUE(store.hasUnexpectedUnclaimedWarmbootHandles());
+  s.removeUnexpectedUnclaimedWarmbootHandles();
+  EXPECT_EQ(store.warmBootHandlesCount(), 0);
+  EXPECT_EQ(getObjectCount<SaiRouteTraits>(0), 0);
+}
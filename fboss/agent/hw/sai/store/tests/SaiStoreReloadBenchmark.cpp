@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/init/Init.h"
+#include "fboss/agent/hw/sai/api/SaiApiTable.h"
+#include "fboss/agent/hw/sai/fake/FakeSai.h"
+#include "fboss/agent/hw/sai/store/SaiStore.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV6.h>
+#include <folly/MacAddress.h>
+#include <gflags/gflags.h>
+
+DECLARE_uint32(sai_store_reload_threads);
+
+using namespace facebook::fboss;
+
+namespace {
+
+constexpr uint32_t kNumNextHops = 4096;
+constexpr uint32_t kNumRoutes = 100000;
+
+folly::IPAddressV6 makeAddress(uint32_t base, uint32_t index) {
+  auto bytes = folly::IPAddressV6("2401:db00::").toByteArray();
+  bytes[4] = base;
+  bytes[12] = index >> 24;
+  bytes[13] = index >> 16;
+  bytes[14] = index >> 8;
+  bytes[15] = index;
+  return folly::IPAddressV6(bytes);
+}
+
+/*
+ * The adapter keys an agent with a full routing table saves on warm boot
+ */
+folly::dynamic makeWarmBootState() {
+  FakeSai::getInstance();
+  sai_api_initialize(0, nullptr);
+  auto saiApiTable = SaiApiTable::getInstance();
+  saiApiTable->queryApis();
+  for (uint32_t i = 0; i < kNumNextHops; ++i) {
+    folly::IPAddress ip(makeAddress(0, i));
+    saiApiTable->nextHopApi().create<SaiIpNextHopTraits>(
+        {SAI_NEXT_HOP_TYPE_IP, 42, ip, std::nullopt}, 0);
+    saiApiTable->neighborApi().create<SaiNeighborTraits>(
+        SaiNeighborTraits::NeighborEntry(0, 42, ip),
+        {folly::MacAddress("42:42:42:42:42:42"), std::nullopt});
+  }
+  for (uint32_t i = 0; i < kNumRoutes; ++i) {
+    folly::CIDRNetwork prefix(makeAddress(1, i), 128);
+    saiApiTable->routeApi().create<SaiRouteTraits>(
+        SaiRouteTraits::RouteEntry(0, 0, prefix),
+        {SAI_PACKET_ACTION_FORWARD, i % kNumNextHops + 1, std::nullopt});
+  }
+  SaiStore store(0);
+  store.reload();
+  auto adapterKeys = store.adapterKeysFollyDynamic();
+  store.exitForWarmBoot();
+  return adapterKeys;
+}
+
+void reloadBenchmark(size_t iters, uint32_t threads, bool lazy) {
+  folly::dynamic adapterKeys;
+  BENCHMARK_SUSPEND {
+    adapterKeys = makeWarmBootState();
+    FLAGS_sai_store_reload_threads = threads;
+    FLAGS_sai_store_lazy_reload = lazy;
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    SaiStore store(0);
+    store.reload(&adapterKeys);
+    BENCHMARK_SUSPEND {
+      store.exitForWarmBoot();
+    }
+  }
+  BENCHMARK_SUSPEND {
+    FakeSai::clear();
+  }
+}
+
+} // namespace
+
+BENCHMARK(SerialReload, iters) {
+  reloadBenchmark(iters, 1, false);
+}
+
+BENCHMARK_RELATIVE(ParallelReload, iters) {
+  reloadBenchmark(iters, 8, false);
+}
+
+BENCHMARK_RELATIVE(ParallelLazyReload, iters) {
+  reloadBenchmark(iters, 8, true);
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
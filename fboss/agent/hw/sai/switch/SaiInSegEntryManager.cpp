@@ -93,6 +93,21 @@ void SaiInSegEntryManager::processRemovedInSegEntry(
   saiInSegEntryTable_.erase(inSegEntry);
 }
 
+void SaiInSegEntryManager::refreshNextHopGroups() {
+  for (auto& [inSegEntry, handle] : saiInSegEntryTable_) {
+    auto attributes = handle.inSegEntry->attributes();
+    auto& nextHopId =
+        std::get<std::optional<SaiInSegTraits::Attributes::NextHopId>>(
+            attributes);
+    auto nextHopGroupId = handle.nextHopGroupHandle->adapterKey();
+    if (nextHopId && nextHopId->value() == nextHopGroupId) {
+      continue;
+    }
+    nextHopId = nextHopGroupId;
+    handle.inSegEntry->setAttributes(attributes);
+  }
+}
+
 const SaiInSegEntryHandle* SaiInSegEntryManager::getInSegEntryHandle(
     LabelForwardingEntry::Label label) const {
   auto inSegEntry = SaiInSegTraits::InSegEntry(
@@ -46,6 +46,12 @@ class SaiInSegEntryManager {
   void processRemovedInSegEntry(
       const std::shared_ptr<LabelForwardingEntry>& removedEntry);
 
+  /*
+   * Point the label entries to the groups their next hop group handles hold
+   * now (see SaiRouteManager::refreshNextHopGroups)
+   */
+  void refreshNextHopGroups();
+
  private:
   SaiManagerTable* managerTable_;
   const SaiPlatform* platform_;
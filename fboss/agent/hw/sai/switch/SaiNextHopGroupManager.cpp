@@ -11,12 +11,15 @@
 #include "fboss/agent/hw/sai/switch/SaiNextHopGroupManager.h"
 
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/hw/sai/api/SaiApiTable.h"
 #include "fboss/agent/hw/sai/store/SaiStore.h"
 #include "fboss/agent/hw/sai/switch/SaiManagerTable.h"
 #include "fboss/agent/hw/sai/switch/SaiNeighborManager.h"
 #include "fboss/agent/hw/sai/switch/SaiNextHopManager.h"
 #include "fboss/agent/hw/sai/switch/SaiRouterInterfaceManager.h"
 #include "fboss/agent/hw/sai/switch/SaiSwitchManager.h"
+#include "fboss/agent/hw/switch_asics/HwAsic.h"
+#include "fboss/agent/platforms/sai/SaiPlatform.h"
 
 #include <folly/logging/xlog.h>
 
@@ -27,7 +30,47 @@ namespace facebook::fboss {
 SaiNextHopGroupManager::SaiNextHopGroupManager(
     SaiManagerTable* managerTable,
     const SaiPlatform* platform)
-    : managerTable_(managerTable), platform_(platform) {}
+    : managerTable_(managerTable),
+      platform_(platform),
+      ecmpResourceManager_(
+          FLAGS_ecmp_max_groups,
+          FLAGS_ecmp_max_members,
+          FLAGS_ecmp_resource_percentage,
+          EcmpResourceManager::sharingPolicyFromString(
+              FLAGS_ecmp_group_sharing_policy)) {
+  if ((FLAGS_ecmp_max_groups && FLAGS_ecmp_max_members) ||
+      !platform_->getAsic()->isSupported(
+          HwAsic::Feature::RESOURCE_USAGE_STATS)) {
+    return;
+  }
+  auto& switchApi = SaiApiTable::getInstance()->switchApi();
+  auto switchId = managerTable_->switchManager().getSwitchSaiId();
+  auto saiStore = SaiStore::getInstance();
+  try {
+    // Groups and members reloaded on warm boot are taken already, though
+    // not claimed yet
+    uint64_t maxGroups = FLAGS_ecmp_max_groups;
+    if (!maxGroups) {
+      maxGroups =
+          switchApi.getAttribute(
+              switchId,
+              SaiSwitchTraits::Attributes::AvailableNextHopGroupEntry{}) +
+          saiStore->get<SaiNextHopGroupTraits>().warmBootHandlesCount();
+    }
+    uint64_t maxMembers = FLAGS_ecmp_max_members;
+    if (!maxMembers) {
+      maxMembers =
+          switchApi.getAttribute(
+              switchId,
+              SaiSwitchTraits::Attributes::AvailableNextHopGroupMemberEntry{}) +
+          saiStore->get<SaiNextHopGroupMemberTraits>().warmBootHandlesCount();
+    }
+    ecmpResourceManager_.setLimits(maxGroups, maxMembers);
+  } catch (const SaiApiError& e) {
+    XLOG(WARNING) << "Failed to get ECMP resources, next hop groups will not "
+                  << "be shared: " << *e.message_ref();
+  }
+}
 
 std::shared_ptr<SaiNextHopGroupHandle>
 SaiNextHopGroupManager::incRefOrAddNextHopGroup(
@@ -37,6 +80,17 @@ SaiNextHopGroupManager::incRefOrAddNextHopGroup(
   if (!ins.second) {
     return nextHopGroupHandle;
   }
+  if (!ecmpResourceManager_.fits(swNextHops) &&
+      shareNextHopGroup(nextHopGroupHandle.get(), swNextHops)) {
+    return nextHopGroupHandle;
+  }
+  programNextHopGroup(nextHopGroupHandle.get(), swNextHops);
+  return nextHopGroupHandle;
+}
+
+void SaiNextHopGroupManager::programNextHopGroup(
+    SaiNextHopGroupHandle* nextHopGroupHandle,
+    const RouteNextHopEntry::NextHopSet& swNextHops) {
   SaiNextHopGroupTraits::AdapterHostKey nextHopGroupAdapterHostKey;
   // Populate the set of rifId, IP pairs for the NextHopGroup's
   // AdapterHostKey, and a set of next hop ids to create members for
@@ -74,7 +128,59 @@ SaiNextHopGroupManager::incRefOrAddNextHopGroup(
         key, managerTable_, nextHopGroupId, resolvedNextHop);
     nextHopGroupHandle->members_.push_back(result.first);
   }
-  return nextHopGroupHandle;
+  nextHopGroupHandle->usage = ecmpResourceManager_.addGroup(swNextHops);
+}
+
+bool SaiNextHopGroupManager::shareNextHopGroup(
+    SaiNextHopGroupHandle* nextHopGroupHandle,
+    const RouteNextHopEntry::NextHopSet& swNextHops) {
+  // Only groups programmed for their own next hops are shared
+  std::vector<const RouteNextHopEntry::NextHopSet*> groups;
+  std::vector<std::shared_ptr<SaiNextHopGroupHandle>> groupHandles;
+  for (const auto& [groupNextHops, weakHandle] : handles_) {
+    auto handle = weakHandle.lock();
+    if (!handle || !handle->nextHopGroup || handle->sharedHandle) {
+      continue;
+    }
+    groups.push_back(&groupNextHops);
+    groupHandles.push_back(std::move(handle));
+  }
+  auto closest = ecmpResourceManager_.closestGroup(swNextHops, groups);
+  if (!closest) {
+    return false;
+  }
+  const auto& sharedHandle = groupHandles[*closest];
+  nextHopGroupHandle->nextHopGroup = sharedHandle->nextHopGroup;
+  nextHopGroupHandle->sharedHandle = sharedHandle;
+  nextHopGroupHandle->usage =
+      ecmpResourceManager_.addSharedGroup(swNextHops, *groups[*closest]);
+  return true;
+}
+
+std::vector<SaiNextHopGroupHandle>
+SaiNextHopGroupManager::restoreSharedNextHopGroups() {
+  std::vector<SaiNextHopGroupHandle> previousHandles;
+  if (!ecmpResourceManager_.getStats().groupsShared) {
+    return previousHandles;
+  }
+  for (const auto& [swNextHops, weakHandle] : handles_) {
+    auto handle = weakHandle.lock();
+    if (!handle || !handle->sharedHandle ||
+        !ecmpResourceManager_.fits(swNextHops)) {
+      continue;
+    }
+    SaiNextHopGroupHandle previousHandle;
+    previousHandle.nextHopGroup = std::move(handle->nextHopGroup);
+    previousHandle.sharedHandle = std::move(handle->sharedHandle);
+    previousHandle.usage = std::move(handle->usage);
+    previousHandles.push_back(std::move(previousHandle));
+    programNextHopGroup(handle.get(), swNextHops);
+  }
+  return previousHandles;
+}
+
+uint64_t SaiNextHopGroupManager::getEcmpMembersUsed() const {
+  return ecmpResourceManager_.getStats().membersUsed;
 }
 
 ManagedNextHopGroupMember::ManagedNextHopGroupMember(
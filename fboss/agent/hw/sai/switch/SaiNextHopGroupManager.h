@@ -12,6 +12,7 @@
 
 #include "fboss/agent/hw/sai/api/NextHopGroupApi.h"
 
+#include "fboss/agent/hw/EcmpResourceManager.h"
 #include "fboss/agent/hw/sai/api/NextHopApi.h"
 #include "fboss/agent/hw/sai/store/SaiObject.h"
 #include "fboss/agent/state/RouteNextHop.h"
@@ -118,6 +119,10 @@ class ManagedNextHopGroupMember {
 struct SaiNextHopGroupHandle {
   std::shared_ptr<SaiNextHopGroup> nextHopGroup;
   std::vector<std::shared_ptr<ManagedNextHopGroupMember>> members_;
+  // Set when the next hops share the group of other next hops, for lack of
+  // ECMP resources to program a group of their own
+  std::shared_ptr<SaiNextHopGroupHandle> sharedHandle;
+  std::unique_ptr<EcmpResourceManager::GroupUsage> usage;
   sai_object_id_t adapterKey() const {
     if (!nextHopGroup) {
       return SAI_NULL_OBJECT_ID;
@@ -135,9 +140,38 @@ class SaiNextHopGroupManager {
   std::shared_ptr<SaiNextHopGroupHandle> incRefOrAddNextHopGroup(
       const RouteNextHopEntry::NextHopSet& swNextHops);
 
+  /*
+   * The ECMP members taken by the next hop groups in use, each next hop
+   * taking as many as its weight.
+   */
+  uint64_t getEcmpMembersUsed() const;
+
+  /*
+   * Program groups of their own for the next hops sharing the group of
+   * others, as far as ECMP resources allow now. Routes and label entries
+   * still point to the shared groups, which are kept alive by the returned
+   * handles until they are pointed to the new groups.
+   */
+  std::vector<SaiNextHopGroupHandle> restoreSharedNextHopGroups();
+
+  EcmpResourceManager& ecmpResourceManager() {
+    return ecmpResourceManager_;
+  }
+  const EcmpResourceManager& ecmpResourceManager() const {
+    return ecmpResourceManager_;
+  }
+
  private:
+  void programNextHopGroup(
+      SaiNextHopGroupHandle* nextHopGroupHandle,
+      const RouteNextHopEntry::NextHopSet& swNextHops);
+  bool shareNextHopGroup(
+      SaiNextHopGroupHandle* nextHopGroupHandle,
+      const RouteNextHopEntry::NextHopSet& swNextHops);
+
   SaiManagerTable* managerTable_;
   const SaiPlatform* platform_;
+  EcmpResourceManager ecmpResourceManager_;
   // TODO(borisb): improve SaiObject/SaiStore to the point where they
   // support the next hop group use case correctly, rather than this
   // abomination of multiple levels of RefMaps :(
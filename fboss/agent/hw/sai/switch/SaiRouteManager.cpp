@@ -100,7 +100,8 @@ std::vector<std::shared_ptr<SaiRoute>> SaiRouteManager::makeInterfaceToMeRoutes(
 }
 
 template <typename AddrT>
-bool SaiRouteManager::validRoute(const std::shared_ptr<Route<AddrT>>& swRoute) {
+bool SaiRouteManager::validRoute(
+    const std::shared_ptr<Route<AddrT>>& swRoute) const {
   /*
    * For each subnet on an L3 Interface configured on the switch, FBOSS will
    * generate two routes: a subnet route to the prefix of the subnet,
@@ -131,20 +132,14 @@ bool SaiRouteManager::validRoute(const std::shared_ptr<Route<AddrT>>& swRoute) {
 template <typename AddrT>
 void SaiRouteManager::addOrUpdateRoute(
     SaiRouteHandle* routeHandle,
-    RouterID routerId,
-    const std::shared_ptr<Route<AddrT>>& oldRoute,
-    const std::shared_ptr<Route<AddrT>>& newRoute) {
-  SaiRouteTraits::RouteEntry entry = routeEntryFromSwRoute(routerId, newRoute);
-  auto fwd = newRoute->getForwardInfo();
+    const RouteUpdate<AddrT>& update) {
+  const auto& newRoute = update.newRoute;
+  const auto& entry = update.entry.value();
+  const auto& metadata = update.metadata;
+  const auto& fwd = newRoute->getForwardInfo();
   sai_int32_t packetAction;
   std::optional<SaiRouteTraits::CreateAttributes> attributes;
   SaiRouteHandle::NextHopHandle nextHopHandle;
-  std::optional<SaiRouteTraits::Attributes::Metadata> metadata;
-  if (newRoute->getClassID()) {
-    metadata = static_cast<sai_uint32_t>(newRoute->getClassID().value());
-  } else if (oldRoute && oldRoute->getClassID()) {
-    metadata = 0;
-  }
 
   if (fwd.getAction() == NEXTHOPS) {
     packetAction = SAI_PACKET_ACTION_FORWARD;
@@ -181,7 +176,7 @@ void SaiRouteManager::addOrUpdateRoute(
        */
       auto nextHopGroupHandle =
           managerTable_->nextHopGroupManager().incRefOrAddNextHopGroup(
-              fwd.normalizedNextHops());
+              update.ecmpNextHops.value());
       NextHopGroupSaiId nextHopGroupId{
           nextHopGroupHandle->nextHopGroup->adapterKey()};
       attributes = SaiRouteTraits::CreateAttributes{
@@ -253,54 +248,94 @@ void SaiRouteManager::addOrUpdateRoute(
 }
 
 template <typename AddrT>
-void SaiRouteManager::changeRoute(
-    const std::shared_ptr<Route<AddrT>>& oldSwRoute,
-    const std::shared_ptr<Route<AddrT>>& newSwRoute,
-    RouterID routerId) {
-  SaiRouteTraits::RouteEntry entry =
-      routeEntryFromSwRoute(routerId, newSwRoute);
-  auto itr = handles_.find(entry);
-  if (itr == handles_.end()) {
-    throw FbossError(
-        "Failure to update route. Route does not exist ",
-        newSwRoute->prefix().str());
-  }
-  if (!validRoute(newSwRoute)) {
+void SaiRouteManager::prepareRouteUpdate(
+    RouterID routerId,
+    RouteUpdate<AddrT>* update) const {
+  const auto& oldRoute = update->oldRoute;
+  const auto& newRoute = update->newRoute;
+  update->entry =
+      routeEntryFromSwRoute(routerId, newRoute ? newRoute : oldRoute);
+  if (!newRoute) {
     return;
   }
-  addOrUpdateRoute(itr->second.get(), routerId, oldSwRoute, newSwRoute);
+  update->valid = validRoute(newRoute);
+  if (newRoute->getClassID()) {
+    update->metadata =
+        static_cast<sai_uint32_t>(newRoute->getClassID().value());
+  } else if (oldRoute && oldRoute->getClassID()) {
+    update->metadata = 0;
+  }
+  const auto& fwd = newRoute->getForwardInfo();
+  if (fwd.getAction() == NEXTHOPS && !newRoute->isConnected() &&
+      fwd.getNextHopSet().size() > 1) {
+    update->ecmpNextHops = fwd.normalizedNextHops();
+  }
 }
 
 template <typename AddrT>
-void SaiRouteManager::addRoute(
-    const std::shared_ptr<Route<AddrT>>& swRoute,
-    RouterID routerId) {
-  SaiRouteTraits::RouteEntry entry = routeEntryFromSwRoute(routerId, swRoute);
+void SaiRouteManager::programRouteUpdate(const RouteUpdate<AddrT>& update) {
+  const auto& entry = update.entry.value();
+  if (!update.newRoute) {
+    size_t count = handles_.erase(entry);
+    if (!count) {
+      throw FbossError(
+          "Failed to remove non-existent route to ",
+          update.oldRoute->prefix().str());
+    }
+    return;
+  }
   auto itr = handles_.find(entry);
+  if (update.oldRoute) {
+    if (itr == handles_.end()) {
+      throw FbossError(
+          "Failure to update route. Route does not exist ",
+          update.newRoute->prefix().str());
+    }
+    if (!update.valid) {
+      return;
+    }
+    addOrUpdateRoute(itr->second.get(), update);
+    return;
+  }
   if (itr != handles_.end()) {
     throw FbossError(
         "Failure to add route. A route already exists to ",
-        swRoute->prefix().str());
+        update.newRoute->prefix().str());
   }
-  if (!validRoute(swRoute)) {
+  if (!update.valid) {
     return;
   }
   auto routeHandle = std::make_unique<SaiRouteHandle>();
-  addOrUpdateRoute(
-      routeHandle.get(), routerId, std::shared_ptr<Route<AddrT>>{}, swRoute);
+  addOrUpdateRoute(routeHandle.get(), update);
   handles_.emplace(entry, std::move(routeHandle));
 }
 
+template <typename AddrT>
+void SaiRouteManager::changeRoute(
+    const std::shared_ptr<Route<AddrT>>& oldSwRoute,
+    const std::shared_ptr<Route<AddrT>>& newSwRoute,
+    RouterID routerId) {
+  RouteUpdate<AddrT> update{oldSwRoute, newSwRoute};
+  prepareRouteUpdate(routerId, &update);
+  programRouteUpdate(update);
+}
+
+template <typename AddrT>
+void SaiRouteManager::addRoute(
+    const std::shared_ptr<Route<AddrT>>& swRoute,
+    RouterID routerId) {
+  RouteUpdate<AddrT> update{nullptr, swRoute};
+  prepareRouteUpdate(routerId, &update);
+  programRouteUpdate(update);
+}
+
 template <typename AddrT>
 void SaiRouteManager::removeRoute(
     const std::shared_ptr<Route<AddrT>>& swRoute,
     RouterID routerId) {
-  SaiRouteTraits::RouteEntry entry = routeEntryFromSwRoute(routerId, swRoute);
-  size_t count = handles_.erase(entry);
-  if (!count) {
-    throw FbossError(
-        "Failed to remove non-existent route to ", swRoute->prefix().str());
-  }
+  RouteUpdate<AddrT> update{swRoute, nullptr};
+  prepareRouteUpdate(routerId, &update);
+  programRouteUpdate(update);
 }
 
 SaiRouteHandle* SaiRouteManager::getRouteHandle(
@@ -325,6 +360,24 @@ SaiRouteHandle* SaiRouteManager::getRouteHandleImpl(
   return itr->second.get();
 }
 
+void SaiRouteManager::refreshNextHopGroups() {
+  for (auto& [entry, routeHandle] : handles_) {
+    auto nextHopGroupHandle = routeHandle->nextHopGroupHandle();
+    if (!nextHopGroupHandle) {
+      continue;
+    }
+    auto attributes = routeHandle->route->attributes();
+    auto& nextHopId =
+        std::get<std::optional<SaiRouteTraits::Attributes::NextHopId>>(
+            attributes);
+    if (nextHopId && nextHopId->value() == nextHopGroupHandle->adapterKey()) {
+      continue;
+    }
+    nextHopId = nextHopGroupHandle->adapterKey();
+    routeHandle->route->setAttributes(attributes);
+  }
+}
+
 void SaiRouteManager::clear() {
   handles_.clear();
 }
@@ -442,4 +495,16 @@ template void SaiRouteManager::removeRoute<folly::IPAddressV4>(
     const std::shared_ptr<Route<folly::IPAddressV4>>& swEntry,
     RouterID routerId);
 
+template void SaiRouteManager::prepareRouteUpdate<folly::IPAddressV6>(
+    RouterID routerId,
+    RouteUpdate<folly::IPAddressV6>* update) const;
+template void SaiRouteManager::prepareRouteUpdate<folly::IPAddressV4>(
+    RouterID routerId,
+    RouteUpdate<folly::IPAddressV4>* update) const;
+
+template void SaiRouteManager::programRouteUpdate<folly::IPAddressV6>(
+    const RouteUpdate<folly::IPAddressV6>& update);
+template void SaiRouteManager::programRouteUpdate<folly::IPAddressV4>(
+    const RouteUpdate<folly::IPAddressV4>& update);
+
 } // namespace facebook::fboss
@@ -13,6 +13,7 @@
 #include "fboss/agent/hw/sai/api/NextHopGroupApi.h"
 #include "fboss/agent/hw/sai/api/RouteApi.h"
 #include "fboss/agent/hw/sai/store/SaiObject.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/types.h"
 
@@ -22,6 +23,7 @@
 
 #include <memory>
 #include <mutex>
+#include <optional>
 
 namespace facebook::fboss {
 
@@ -73,6 +75,26 @@ struct SaiRouteHandle {
 
 class SaiRouteManager {
  public:
+  /*
+   * A route to add (no oldRoute), change or remove (no newRoute), along with
+   * what can be worked out before programming it. prepareRouteUpdate() only
+   * reads the manager table, so SaiSwitch prepares the updates of a large
+   * delta in parallel without holding its lock, and then programs them
+   * with programRouteUpdate() under it.
+   */
+  template <typename AddrT>
+  struct RouteUpdate {
+    std::shared_ptr<Route<AddrT>> oldRoute;
+    std::shared_ptr<Route<AddrT>> newRoute;
+
+    // Filled in by prepareRouteUpdate()
+    std::optional<SaiRouteTraits::RouteEntry> entry;
+    bool valid{true};
+    std::optional<SaiRouteTraits::Attributes::Metadata> metadata;
+    // The next hops of the ECMP group the route points to, if any
+    std::optional<RouteNextHopEntry::NextHopSet> ecmpNextHops;
+  };
+
   SaiRouteManager(SaiManagerTable* managerTable, const SaiPlatform* platform);
   // Helper function to create a SAI RouteEntry from an FBOSS SwitchState
   // Route (e.g., Route<IPAddressV6>)
@@ -100,10 +122,24 @@ class SaiRouteManager {
       const std::shared_ptr<Route<AddrT>>& swRoute,
       RouterID routerId);
 
+  template <typename AddrT>
+  void prepareRouteUpdate(RouterID routerId, RouteUpdate<AddrT>* update)
+      const;
+
+  template <typename AddrT>
+  void programRouteUpdate(const RouteUpdate<AddrT>& update);
+
   SaiRouteHandle* getRouteHandle(const SaiRouteTraits::RouteEntry& entry);
   const SaiRouteHandle* getRouteHandle(
       const SaiRouteTraits::RouteEntry& entry) const;
 
+  /*
+   * Point the routes using next hop groups to the groups their handles hold
+   * now, once SaiNextHopGroupManager gave next hops sharing the group of
+   * others a group of their own
+   */
+  void refreshNextHopGroups();
+
   void clear();
 
  private:
@@ -112,12 +148,10 @@ class SaiRouteManager {
   template <typename AddrT>
   void addOrUpdateRoute(
       SaiRouteHandle* routeHandle,
-      RouterID routerId,
-      const std::shared_ptr<Route<AddrT>>& oldRoute,
-      const std::shared_ptr<Route<AddrT>>& newRoute);
+      const RouteUpdate<AddrT>& update);
 
   template <typename AddrT>
-  bool validRoute(const std::shared_ptr<Route<AddrT>>& swRoute);
+  bool validRoute(const std::shared_ptr<Route<AddrT>>& swRoute) const;
 
   SaiManagerTable* managerTable_;
   const SaiPlatform* platform_;
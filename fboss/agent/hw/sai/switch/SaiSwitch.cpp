@@ -46,17 +46,27 @@
 #include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/packet/PktUtil.h"
 #include "fboss/agent/platforms/sai/SaiPlatform.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
 #include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
+#include "fboss/lib/CallProfiler.h"
 
 #include "fboss/agent/hw/HwSwitchWarmBootHelper.h"
 #include "fboss/agent/hw/switch_asics/HwAsic.h"
 
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
 #include <folly/logging/xlog.h>
 
+#include <algorithm>
 #include <chrono>
 #include <optional>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include <sai.h>
@@ -82,6 +92,24 @@ DEFINE_bool(
     false,
     "Fail if any warm boot handles are left unclaimed.");
 
+DEFINE_uint32(
+    sai_delta_chunk_size,
+    512,
+    "Number of changes of a state delta programmed per acquisition of the "
+    "SaiSwitch lock");
+
+DEFINE_uint32(
+    sai_delta_prepare_threads,
+    4,
+    "Number of threads preparing the routes of large state deltas, 0 to "
+    "prepare them on the update thread");
+
+DEFINE_uint32(
+    sai_delta_prepare_threshold,
+    4096,
+    "Number of routes from which those of a state delta are prepared in "
+    "parallel");
+
 namespace {
 /*
  * For the devices/SDK we use, the only events we should get (and process)
@@ -97,6 +125,15 @@ const std::map<sai_fdb_event_t, facebook::fboss::L2EntryUpdateType>
         {SAI_FDB_EVENT_AGED,
          facebook::fboss::L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE},
 };
+
+bool routeTableModified(const facebook::fboss::StateDelta& delta) {
+  return delta.getRouteTablesDelta().begin() !=
+      delta.getRouteTablesDelta().end();
+}
+
+bool fibModified(const facebook::fboss::StateDelta& delta) {
+  return delta.getFibsDelta().begin() != delta.getFibsDelta().end();
+}
 } // namespace
 
 namespace facebook::fboss {
@@ -156,6 +193,11 @@ SaiSwitch::SaiSwitch(SaiPlatform* platform, uint32_t featuresDesired)
     : HwSwitch(featuresDesired), platform_(platform) {
   utilCreateDir(platform_->getVolatileStateDir());
   utilCreateDir(platform_->getPersistentStateDir());
+  if (FLAGS_sai_delta_prepare_threads > 0) {
+    deltaPrepareExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        FLAGS_sai_delta_prepare_threads,
+        std::make_shared<folly::NamedThreadFactory>("SaiDeltaPrepare"));
+  }
 }
 
 SaiSwitch::~SaiSwitch() {}
@@ -481,26 +523,26 @@ std::shared_ptr<SwitchState> SaiSwitch::stateChangedImpl(
         &SaiFdbManager::removeMac);
   }
 
+  // Routes come from either the route tables or the FIBs, never both
+  CHECK(!(routeTableModified(delta) && fibModified(delta)));
+
   for (const auto& routeDelta : delta.getRouteTablesDelta()) {
     auto routerID = routeDelta.getOld() ? routeDelta.getOld()->getID()
                                         : routeDelta.getNew()->getID();
-    processDelta(
-        routeDelta.getRoutesV4Delta(),
-        managerTable_->routeManager(),
-        lockPolicy,
-        &SaiRouteManager::changeRoute<folly::IPAddressV4>,
-        &SaiRouteManager::addRoute<folly::IPAddressV4>,
-        &SaiRouteManager::removeRoute<folly::IPAddressV4>,
-        routerID);
+    processRouteDelta<folly::IPAddressV4>(
+        routeDelta.getRoutesV4Delta(), lockPolicy, routerID);
+    processRouteDelta<folly::IPAddressV6>(
+        routeDelta.getRoutesV6Delta(), lockPolicy, routerID);
+  }
 
-    processDelta(
-        routeDelta.getRoutesV6Delta(),
-        managerTable_->routeManager(),
-        lockPolicy,
-        &SaiRouteManager::changeRoute<folly::IPAddressV6>,
-        &SaiRouteManager::addRoute<folly::IPAddressV6>,
-        &SaiRouteManager::removeRoute<folly::IPAddressV6>,
-        routerID);
+  // With the standalone RIB, the resolved routes come in the FIBs instead
+  for (const auto& fibDelta : delta.getFibsDelta()) {
+    auto vrf = fibDelta.getOld() ? fibDelta.getOld()->getID()
+                                 : fibDelta.getNew()->getID();
+    processRouteDelta<folly::IPAddressV4>(
+        fibDelta.getV4FibDelta(), lockPolicy, vrf);
+    processRouteDelta<folly::IPAddressV6>(
+        fibDelta.getV6FibDelta(), lockPolicy, vrf);
   }
 
   {
@@ -518,6 +560,20 @@ std::shared_ptr<SwitchState> SaiSwitch::stateChangedImpl(
       &SaiInSegEntryManager::processChangedInSegEntry,
       &SaiInSegEntryManager::processAddedInSegEntry,
       &SaiInSegEntryManager::processRemovedInSegEntry);
+
+  {
+    [[maybe_unused]] const auto& lock = lockPolicy.lock();
+    // Next hops which had to share the group of other next hops, for lack
+    // of ECMP resources, get a group of their own once there is room again.
+    // The shared groups are only let go of once nothing points to them.
+    auto sharedNextHopGroups =
+        managerTable_->nextHopGroupManager().restoreSharedNextHopGroups();
+    if (!sharedNextHopGroups.empty()) {
+      managerTable_->routeManager().refreshNextHopGroups();
+      managerTable_->inSegEntryManager().refreshNextHopGroups();
+    }
+  }
+
   processDelta(
       delta.getLoadBalancersDelta(),
       managerTable_->switchManager(),
@@ -576,6 +632,18 @@ void SaiSwitch::updateResourceUsage(const LockPolicyT& lockPolicy) {
     hwResourceStats_.l3_ecmp_group_members_free_ref() = switchApi.getAttribute(
         switchId_,
         SaiSwitchTraits::Attributes::AvailableNextHopGroupMemberEntry{});
+    const auto& ecmpResourceManager =
+        managerTable_->nextHopGroupManager().ecmpResourceManager();
+    auto ecmpStats = ecmpResourceManager.getStats();
+    hwResourceStats_.l3_ecmp_groups_used_ref() = ecmpStats.groupsUsed;
+    hwResourceStats_.l3_ecmp_group_members_used_ref() = ecmpStats.membersUsed;
+    if (ecmpResourceManager.getMaxGroups()) {
+      hwResourceStats_.l3_ecmp_groups_max_ref() =
+          ecmpResourceManager.getMaxGroups();
+    }
+    hwResourceStats_.l3_ecmp_groups_shared_ref() = ecmpStats.groupsShared;
+    hwResourceStats_.l3_ecmp_group_members_saved_ref() =
+        ecmpStats.membersSaved;
     hwResourceStats_.l3_ipv4_host_free_ref() = switchApi.getAttribute(
         switchId_, SaiSwitchTraits::Attributes::AvailableIpv4NeighborEntry{});
     hwResourceStats_.l3_ipv6_host_free_ref() = switchApi.getAttribute(
@@ -660,6 +728,7 @@ void SaiSwitch::updateStatsImpl(SwitchStats* /* switchStats */) {
     std::lock_guard<std::mutex> locked(saiSwitchMutex_);
     HwResourceStatsPublisher().publish(hwResourceStats_);
   }
+  CallProfiler::getInstance()->publish();
 }
 
 uint64_t SaiSwitch::getDeviceWatermarkBytes() const {
@@ -1500,21 +1569,27 @@ void SaiSwitch::processDelta(
     AddedFunc addedFunc,
     RemovedFunc removedFunc,
     Args... args) {
+  using NodePtr = std::shared_ptr<typename Delta::Node>;
+  // The old and new node of each change, the old one null if it is an
+  // addition and the new one null if it is a removal
+  std::vector<std::pair<NodePtr, NodePtr>> changes;
   DeltaFunctions::forEachChanged(
       delta,
-      [&](const std::shared_ptr<typename Delta::Node>& removed,
-          const std::shared_ptr<typename Delta::Node>& added) {
-        [[maybe_unused]] const auto& lock = lockPolicy.lock();
-        (manager.*changedFunc)(removed, added, args...);
+      [&](const NodePtr& removed, const NodePtr& added) {
+        changes.emplace_back(removed, added);
       },
-      [&](const std::shared_ptr<typename Delta::Node>& added) {
-        [[maybe_unused]] const auto& lock = lockPolicy.lock();
-        (manager.*addedFunc)(added, args...);
-      },
-      [&](const std::shared_ptr<typename Delta::Node>& removed) {
-        [[maybe_unused]] const auto& lock = lockPolicy.lock();
-        (manager.*removedFunc)(removed, args...);
-      });
+      [&](const NodePtr& added) { changes.emplace_back(nullptr, added); },
+      [&](const NodePtr& removed) { changes.emplace_back(removed, nullptr); });
+  programInChunks(changes.size(), lockPolicy, [&](size_t i) {
+    const auto& [oldNode, newNode] = changes[i];
+    if (oldNode && newNode) {
+      (manager.*changedFunc)(oldNode, newNode, args...);
+    } else if (newNode) {
+      (manager.*addedFunc)(newNode, args...);
+    } else {
+      (manager.*removedFunc)(oldNode, args...);
+    }
+  });
 }
 
 template <
@@ -1529,13 +1604,15 @@ void SaiSwitch::processChangedDelta(
     const LockPolicyT& lockPolicy,
     ChangeFunc changedFunc,
     Args... args) {
+  using NodePtr = std::shared_ptr<typename Delta::Node>;
+  std::vector<std::pair<NodePtr, NodePtr>> changes;
   DeltaFunctions::forEachChanged(
-      delta,
-      [&](const std::shared_ptr<typename Delta::Node>& added,
-          const std::shared_ptr<typename Delta::Node>& removed) {
-        [[maybe_unused]] const auto& lock = lockPolicy.lock();
-        (manager.*changedFunc)(added, removed, args...);
+      delta, [&](const NodePtr& oldNode, const NodePtr& newNode) {
+        changes.emplace_back(oldNode, newNode);
       });
+  programInChunks(changes.size(), lockPolicy, [&](size_t i) {
+    (manager.*changedFunc)(changes[i].first, changes[i].second, args...);
+  });
 }
 
 template <
@@ -1550,11 +1627,13 @@ void SaiSwitch::processAddedDelta(
     const LockPolicyT& lockPolicy,
     AddedFunc addedFunc,
     Args... args) {
+  using NodePtr = std::shared_ptr<typename Delta::Node>;
+  std::vector<NodePtr> added;
   DeltaFunctions::forEachAdded(
-      delta, [&](const std::shared_ptr<typename Delta::Node>& added) {
-        [[maybe_unused]] const auto& lock = lockPolicy.lock();
-        (manager.*addedFunc)(added, args...);
-      });
+      delta, [&](const NodePtr& newNode) { added.push_back(newNode); });
+  programInChunks(added.size(), lockPolicy, [&](size_t i) {
+    (manager.*addedFunc)(added[i], args...);
+  });
 }
 
 template <
@@ -1569,11 +1648,86 @@ void SaiSwitch::processRemovedDelta(
     const LockPolicyT& lockPolicy,
     RemovedFunc removedFunc,
     Args... args) {
+  using NodePtr = std::shared_ptr<typename Delta::Node>;
+  std::vector<NodePtr> removed;
   DeltaFunctions::forEachRemoved(
-      delta, [&](const std::shared_ptr<typename Delta::Node>& removed) {
-        [[maybe_unused]] const auto& lock = lockPolicy.lock();
-        (manager.*removedFunc)(removed, args...);
+      delta, [&](const NodePtr& oldNode) { removed.push_back(oldNode); });
+  programInChunks(removed.size(), lockPolicy, [&](size_t i) {
+    (manager.*removedFunc)(removed[i], args...);
+  });
+}
+
+template <typename AddrT, typename Delta, typename LockPolicyT>
+void SaiSwitch::processRouteDelta(
+    Delta delta,
+    const LockPolicyT& lockPolicy,
+    RouterID routerID) {
+  using RouteT = Route<AddrT>;
+  auto& routeManager = managerTable_->routeManager();
+  std::vector<SaiRouteManager::RouteUpdate<AddrT>> updates;
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<RouteT>& oldRoute,
+          const std::shared_ptr<RouteT>& newRoute) {
+        updates.push_back({oldRoute, newRoute});
+      },
+      [&](const std::shared_ptr<RouteT>& newRoute) {
+        updates.push_back({nullptr, newRoute});
+      },
+      [&](const std::shared_ptr<RouteT>& oldRoute) {
+        updates.push_back({oldRoute, nullptr});
       });
+  // The objects routes depend on (virtual routers, router interfaces, next
+  // hops) were programmed earlier in the delta, and only the update thread
+  // changes them, so they are read without the lock
+  prepareInParallel(updates.size(), [&](size_t i) {
+    routeManager.prepareRouteUpdate(routerID, &updates[i]);
+  });
+  programInChunks(updates.size(), lockPolicy, [&](size_t i) {
+    routeManager.programRouteUpdate(updates[i]);
+  });
+}
+
+void SaiSwitch::prepareInParallel(
+    size_t count,
+    const std::function<void(size_t)>& prepareFn) {
+  if (!deltaPrepareExecutor_ || count < FLAGS_sai_delta_prepare_threshold) {
+    for (size_t i = 0; i < count; ++i) {
+      prepareFn(i);
+    }
+    return;
+  }
+  // One contiguous slice per thread
+  size_t numThreads = deltaPrepareExecutor_->numThreads();
+  size_t sliceSize = (count + numThreads - 1) / numThreads;
+  std::vector<folly::Future<folly::Unit>> futures;
+  for (size_t begin = 0; begin < count; begin += sliceSize) {
+    auto end = std::min(count, begin + sliceSize);
+    futures.push_back(
+        folly::via(deltaPrepareExecutor_.get(), [&prepareFn, begin, end] {
+          for (size_t i = begin; i < end; ++i) {
+            prepareFn(i);
+          }
+        }));
+  }
+  for (auto& result : folly::collectAll(futures.begin(), futures.end()).get()) {
+    result.throwIfFailed();
+  }
+}
+
+template <typename LockPolicyT, typename ProgramFn>
+void SaiSwitch::programInChunks(
+    size_t count,
+    const LockPolicyT& lockPolicy,
+    ProgramFn programFn) {
+  size_t chunkSize = std::max<size_t>(FLAGS_sai_delta_chunk_size, 1);
+  for (size_t begin = 0; begin < count; begin += chunkSize) {
+    auto end = std::min(count, begin + chunkSize);
+    [[maybe_unused]] const auto& lock = lockPolicy.lock();
+    for (size_t i = begin; i < end; ++i) {
+      programFn(i);
+    }
+  }
 }
 
 void SaiSwitch::dumpDebugState(const std::string& path) const {
@@ -18,8 +18,10 @@
 #include "fboss/agent/hw/sai/switch/SaiRxPacket.h"
 #include "fboss/agent/platforms/sai/SaiPlatform.h"
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/io/async/EventBase.h>
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -347,6 +349,33 @@ class SaiSwitch : public HwSwitch {
       RemovedFunc removedFunc,
       Args... args);
 
+  /*
+   * Routes are programmed in two phases. The SAI route entries and the
+   * attributes of the routes of the delta are first prepared without the
+   * SaiSwitch lock, in parallel on deltaPrepareExecutor_ for large deltas.
+   * They are then programmed in order, in chunks.
+   */
+  template <typename AddrT, typename Delta, typename LockPolicyT>
+  void processRouteDelta(
+      Delta delta,
+      const LockPolicyT& lockPolicy,
+      RouterID routerID);
+
+  void prepareInParallel(
+      size_t count,
+      const std::function<void(size_t)>& prepareFn);
+
+  /*
+   * Calls programFn(i) for i in [0, count) in order, taking the lock once
+   * per FLAGS_sai_delta_chunk_size calls rather than once per call, while
+   * still letting the other users of the lock in between chunks.
+   */
+  template <typename LockPolicyT, typename ProgramFn>
+  void programInChunks(
+      size_t count,
+      const LockPolicyT& lockPolicy,
+      ProgramFn programFn);
+
   template <typename LockPolicyT>
   void processSwitchSettingsChanged(
       const StateDelta& delta,
@@ -399,6 +428,9 @@ class SaiSwitch : public HwSwitch {
 
   HwResourceStats hwResourceStats_;
   std::atomic<SwitchRunState> runState_{SwitchRunState::UNINITIALIZED};
+
+  // Null if the routes of a delta are to be prepared one after the other
+  std::unique_ptr<folly::CPUThreadPoolExecutor> deltaPrepareExecutor_;
 };
 
 } // namespace facebook::fboss
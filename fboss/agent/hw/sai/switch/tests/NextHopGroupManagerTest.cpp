@@ -208,3 +208,71 @@ TEST_F(NextHopGroupManagerTest, testNextHopGroupMemberWeights) {
       SaiNextHopGroupMemberTraits::Attributes::Weight{});
   EXPECT_EQ(weight, 42);
 }
+
+TEST_F(NextHopGroupManagerTest, ecmpMembersUsed) {
+  auto& nextHopGroupManager = saiManagerTable->nextHopGroupManager();
+  EXPECT_EQ(nextHopGroupManager.getEcmpMembersUsed(), 0);
+  ResolvedNextHop nh1{h0.ip, InterfaceID(intf0.id), ECMP_WEIGHT};
+  ResolvedNextHop nh2{h1.ip, InterfaceID(intf1.id), ECMP_WEIGHT};
+  auto ecmpHandle = nextHopGroupManager.incRefOrAddNextHopGroup(
+      RouteNextHopEntry::NextHopSet{nh1, nh2});
+  EXPECT_EQ(nextHopGroupManager.getEcmpMembersUsed(), 2);
+  {
+    ResolvedNextHop ucmpNh1{h0.ip, InterfaceID(intf0.id), 3};
+    ResolvedNextHop ucmpNh2{h1.ip, InterfaceID(intf1.id), 5};
+    auto ucmpHandle = nextHopGroupManager.incRefOrAddNextHopGroup(
+        RouteNextHopEntry::NextHopSet{ucmpNh1, ucmpNh2});
+    EXPECT_EQ(nextHopGroupManager.getEcmpMembersUsed(), 10);
+  }
+  EXPECT_EQ(nextHopGroupManager.getEcmpMembersUsed(), 2);
+}
+
+TEST_F(NextHopGroupManagerTest, shareNextHopGroupWhenEcmpResourcesRunLow) {
+  auto& nextHopGroupManager = saiManagerTable->nextHopGroupManager();
+  auto intf2 = testInterfaces[2];
+  auto h2 = intf2.remoteHosts[0];
+  ResolvedNextHop nh1{h0.ip, InterfaceID(intf0.id), ECMP_WEIGHT};
+  ResolvedNextHop nh2{h1.ip, InterfaceID(intf1.id), ECMP_WEIGHT};
+  ResolvedNextHop nh3{h2.ip, InterfaceID(intf2.id), ECMP_WEIGHT};
+  // Room for a single group
+  nextHopGroupManager.ecmpResourceManager().setLimits(1, 0);
+  auto subsetHandle = nextHopGroupManager.incRefOrAddNextHopGroup(
+      RouteNextHopEntry::NextHopSet{nh1, nh2});
+  auto handle = nextHopGroupManager.incRefOrAddNextHopGroup(
+      RouteNextHopEntry::NextHopSet{nh1, nh2, nh3});
+  EXPECT_EQ(handle->nextHopGroup, subsetHandle->nextHopGroup);
+  EXPECT_EQ(handle->sharedHandle, subsetHandle);
+  auto stats = nextHopGroupManager.ecmpResourceManager().getStats();
+  EXPECT_EQ(stats.groupsUsed, 1);
+  EXPECT_EQ(stats.groupsShared, 1);
+  EXPECT_EQ(stats.membersSaved, 3);
+
+  // Nothing to restore until there is room
+  EXPECT_TRUE(nextHopGroupManager.restoreSharedNextHopGroups().empty());
+  nextHopGroupManager.ecmpResourceManager().setLimits(2, 0);
+  auto previousHandles = nextHopGroupManager.restoreSharedNextHopGroups();
+  ASSERT_EQ(previousHandles.size(), 1);
+  EXPECT_EQ(previousHandles[0].nextHopGroup, subsetHandle->nextHopGroup);
+  EXPECT_NE(handle->nextHopGroup, subsetHandle->nextHopGroup);
+  EXPECT_FALSE(handle->sharedHandle);
+  previousHandles.clear();
+  stats = nextHopGroupManager.ecmpResourceManager().getStats();
+  EXPECT_EQ(stats.groupsUsed, 2);
+  EXPECT_EQ(stats.groupsShared, 0);
+  EXPECT_EQ(stats.membersUsed, 5);
+}
+
+TEST_F(NextHopGroupManagerTest, noSharedNextHopGroupToFallBackOn) {
+  auto& nextHopGroupManager = saiManagerTable->nextHopGroupManager();
+  ResolvedNextHop nh1{h0.ip, InterfaceID(intf0.id), ECMP_WEIGHT};
+  ResolvedNextHop nh2{h1.ip, InterfaceID(intf1.id), ECMP_WEIGHT};
+  nextHopGroupManager.ecmpResourceManager().setLimits(1, 0);
+  auto handle1 = nextHopGroupManager.incRefOrAddNextHopGroup(
+      RouteNextHopEntry::NextHopSet{nh1});
+  // No group over some of the next hops, a group of their own is programmed
+  auto handle2 = nextHopGroupManager.incRefOrAddNextHopGroup(
+      RouteNextHopEntry::NextHopSet{nh2});
+  EXPECT_NE(handle1->nextHopGroup, handle2->nextHopGroup);
+  EXPECT_FALSE(handle2->sharedHandle);
+  EXPECT_EQ(nextHopGroupManager.ecmpResourceManager().getStats().groupsUsed, 2);
+}
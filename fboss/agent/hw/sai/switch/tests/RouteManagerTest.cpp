@@ -15,9 +15,18 @@
 #include "fboss/agent/hw/sai/switch/SaiRouteManager.h"
 #include "fboss/agent/hw/sai/switch/SaiSwitchManager.h"
 #include "fboss/agent/hw/sai/switch/tests/ManagerTestBase.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/types.h"
 
+#include <folly/Format.h>
+#include <gflags/gflags.h>
+
+DECLARE_uint32(sai_delta_chunk_size);
+DECLARE_uint32(sai_delta_prepare_threshold);
+
 using namespace facebook::fboss;
 class RouteManagerTest : public ManagerTestBase {
  public:
@@ -173,6 +182,73 @@ TEST_F(RouteManagerTest, removeNonexistentRoute) {
       saiManagerTable->routeManager().removeRoute(r2, RouterID(0)), FbossError);
 }
 
+TEST_F(RouteManagerTest, fibRoutes) {
+  // Routes programmed from the FIBs, as with the standalone RIB
+  auto r = makeRoute(tr1);
+  auto newState = programmedState->clone();
+  auto fibs = std::make_shared<ForwardingInformationBaseMap>();
+  auto fibContainer =
+      std::make_shared<ForwardingInformationBaseContainer>(RouterID(0));
+  auto fibV4 = std::make_shared<ForwardingInformationBaseV4>();
+  fibV4->addNode(r);
+  fibContainer->writableFields()->fibV4 = fibV4;
+  fibs->addNode(fibContainer);
+  newState->resetForwardingInformationBases(fibs);
+  applyNewState(newState);
+
+  auto entry =
+      saiManagerTable->routeManager().routeEntryFromSwRoute(RouterID(0), r);
+  EXPECT_TRUE(saiManagerTable->routeManager().getRouteHandle(entry));
+
+  newState = programmedState->clone();
+  newState->resetForwardingInformationBases(
+      std::make_shared<ForwardingInformationBaseMap>());
+  applyNewState(newState);
+  EXPECT_FALSE(saiManagerTable->routeManager().getRouteHandle(entry));
+}
+
+TEST_F(RouteManagerTest, prepareThenProgramRoute) {
+  auto r = makeRoute(tr1);
+  auto& routeManager = saiManagerTable->routeManager();
+  SaiRouteManager::RouteUpdate<folly::IPAddressV4> update{nullptr, r};
+  routeManager.prepareRouteUpdate(RouterID(0), &update);
+  ASSERT_TRUE(update.entry.has_value());
+  EXPECT_TRUE(update.valid);
+  EXPECT_EQ(update.ecmpNextHops, r->getForwardInfo().normalizedNextHops());
+  // Nothing programmed until then
+  EXPECT_FALSE(routeManager.getRouteHandle(update.entry.value()));
+  routeManager.programRouteUpdate(update);
+  EXPECT_TRUE(routeManager.getRouteHandle(update.entry.value()));
+}
+
+TEST_F(RouteManagerTest, fibRoutesPreparedInParallel) {
+  FLAGS_sai_delta_prepare_threshold = 1;
+  FLAGS_sai_delta_chunk_size = 3;
+  std::vector<std::shared_ptr<Route<folly::IPAddressV4>>> routes;
+  auto fibV4 = std::make_shared<ForwardingInformationBaseV4>();
+  for (int i = 0; i < 10; ++i) {
+    tr1.destination = {folly::IPAddress(folly::sformat("50.0.{}.0", i)), 24};
+    routes.push_back(makeRoute(tr1));
+    fibV4->addNode(routes.back());
+  }
+  auto newState = programmedState->clone();
+  auto fibs = std::make_shared<ForwardingInformationBaseMap>();
+  auto fibContainer =
+      std::make_shared<ForwardingInformationBaseContainer>(RouterID(0));
+  fibContainer->writableFields()->fibV4 = fibV4;
+  fibs->addNode(fibContainer);
+  newState->resetForwardingInformationBases(fibs);
+  applyNewState(newState);
+  FLAGS_sai_delta_prepare_threshold = 4096;
+  FLAGS_sai_delta_chunk_size = 512;
+
+  for (const auto& r : routes) {
+    auto entry =
+        saiManagerTable->routeManager().routeEntryFromSwRoute(RouterID(0), r);
+    EXPECT_TRUE(saiManagerTable->routeManager().getRouteHandle(entry));
+  }
+}
+
 TEST_F(RouteManagerTest, updateNonexistentRoute) {
   auto r1 = makeRoute(tr1);
   tr2.nextHopInterfaces = tr1.nextHopInterfaces;
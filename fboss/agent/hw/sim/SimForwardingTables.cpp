@@ -0,0 +1,454 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sim/SimForwardingTables.h"
+
+#include "fboss/agent/state/AggregatePort.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/MacTable.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+
+namespace facebook::fboss {
+
+using DeltaFunctions::forEachChanged;
+
+SimForwardingTables::EcmpGroup::EcmpGroup(const RouteNextHopSet& nhops) {
+  uint64_t totalWeight = 0;
+  for (const auto& nhop : nhops) {
+    // Weight 0 stands for plain ECMP, treat it as an equal share
+    auto weight = std::max<NextHopWeight>(nhop.weight(), 1);
+    totalWeight += weight;
+    members_.push_back({nhop.intf(), nhop.addr(), weight});
+    cumulativeWeights_.push_back(totalWeight);
+  }
+}
+
+const SimForwardingTables::EcmpMember& SimForwardingTables::EcmpGroup::select(
+    uint64_t hash) const {
+  CHECK(!members_.empty());
+  auto point = hash % cumulativeWeights_.back();
+  auto itr = std::upper_bound(
+      cumulativeWeights_.begin(), cumulativeWeights_.end(), point);
+  return members_[itr - cumulativeWeights_.begin()];
+}
+
+template <>
+SimForwardingTables::Lpm<folly::IPAddressV4>&
+SimForwardingTables::VrfTables::lpm<folly::IPAddressV4>() {
+  return v4;
+}
+
+template <>
+SimForwardingTables::Lpm<folly::IPAddressV6>&
+SimForwardingTables::VrfTables::lpm<folly::IPAddressV6>() {
+  return v6;
+}
+
+template <>
+const SimForwardingTables::Lpm<folly::IPAddressV4>&
+SimForwardingTables::VrfTables::lpm<folly::IPAddressV4>() const {
+  return v4;
+}
+
+template <>
+const SimForwardingTables::Lpm<folly::IPAddressV6>&
+SimForwardingTables::VrfTables::lpm<folly::IPAddressV6>() const {
+  return v6;
+}
+
+void SimForwardingTables::processDelta(const StateDelta& delta) {
+  processPortDelta(delta);
+  processVlanDelta(delta);
+  processIntfDelta(delta);
+  processAggregatePortDelta(delta);
+
+  processNeighborDelta<ArpTable>(delta);
+  processNeighborDelta<NdpTable>(delta);
+  processMacDelta(delta);
+
+  // Only one of the legacy route tables or the standalone RIB FIBs will
+  // carry changes, but processing both keeps SimSwitch agnostic of the mode.
+  processRouteDelta<folly::IPAddressV4>(delta);
+  processRouteDelta<folly::IPAddressV6>(delta);
+  processFibDelta<folly::IPAddressV4>(delta);
+  processFibDelta<folly::IPAddressV6>(delta);
+
+  pruneEcmpGroups();
+}
+
+template <typename AddrT>
+const SimForwardingTables::RouteEntry* SimForwardingTables::longestMatch(
+    RouterID vrf,
+    const AddrT& addr) const {
+  auto vrfItr = vrfs_.find(vrf);
+  if (vrfItr == vrfs_.end()) {
+    return nullptr;
+  }
+  const auto& lpm = vrfItr->second.template lpm<AddrT>();
+  auto itr = lpm.longestMatch(addr, addr.bitCount());
+  if (itr == lpm.end()) {
+    return nullptr;
+  }
+  return &itr->value();
+}
+
+template const SimForwardingTables::RouteEntry*
+SimForwardingTables::longestMatch<folly::IPAddressV4>(
+    RouterID vrf,
+    const folly::IPAddressV4& addr) const;
+template const SimForwardingTables::RouteEntry*
+SimForwardingTables::longestMatch<folly::IPAddressV6>(
+    RouterID vrf,
+    const folly::IPAddressV6& addr) const;
+
+const SimForwardingTables::HostEntry* SimForwardingTables::getHostIf(
+    InterfaceID intf,
+    const folly::IPAddress& ip) const {
+  auto itr = hosts_.find(std::make_pair(intf, ip));
+  return itr == hosts_.end() ? nullptr : &itr->second;
+}
+
+std::optional<PortDescriptor> SimForwardingTables::getL2EntryIf(
+    VlanID vlan,
+    folly::MacAddress mac) const {
+  auto itr = l2Table_.find(std::make_pair(vlan, mac));
+  if (itr == l2Table_.end()) {
+    return std::nullopt;
+  }
+  return itr->second.port;
+}
+
+const SimForwardingTables::InterfaceEntry* SimForwardingTables::getInterfaceIf(
+    InterfaceID intf) const {
+  auto itr = intfs_.find(intf);
+  return itr == intfs_.end() ? nullptr : &itr->second;
+}
+
+std::optional<InterfaceID> SimForwardingTables::getVlanInterfaceIf(
+    VlanID vlan) const {
+  auto itr = vlanToIntf_.find(vlan);
+  if (itr == vlanToIntf_.end()) {
+    return std::nullopt;
+  }
+  return itr->second;
+}
+
+const SimForwardingTables::VlanMembers* SimForwardingTables::getVlanMembersIf(
+    VlanID vlan) const {
+  auto itr = vlans_.find(vlan);
+  return itr == vlans_.end() ? nullptr : &itr->second;
+}
+
+const SimForwardingTables::PortEntry* SimForwardingTables::getPortIf(
+    PortID port) const {
+  auto itr = ports_.find(port);
+  return itr == ports_.end() ? nullptr : &itr->second;
+}
+
+const std::vector<PortID>* SimForwardingTables::getAggregatePortMembersIf(
+    AggregatePortID aggPort) const {
+  auto itr = aggPorts_.find(aggPort);
+  return itr == aggPorts_.end() ? nullptr : &itr->second;
+}
+
+bool SimForwardingTables::isLocalAddress(
+    RouterID vrf,
+    const folly::IPAddress& ip) const {
+  return localAddrs_.find(std::make_pair(vrf, ip)) != localAddrs_.end();
+}
+
+size_t SimForwardingTables::numRoutes() const {
+  size_t count = 0;
+  for (const auto& vrf : vrfs_) {
+    count += vrf.second.v4.size() + vrf.second.v6.size();
+  }
+  return count;
+}
+
+template <typename AddrT>
+void SimForwardingTables::processRouteDelta(const StateDelta& delta) {
+  using RouteT = Route<AddrT>;
+  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+    auto vrf = rtDelta.getOld() ? rtDelta.getOld()->getID()
+                                : rtDelta.getNew()->getID();
+    forEachChanged(
+        rtDelta.template getRoutesDelta<AddrT>(),
+        [&](const std::shared_ptr<RouteT>& /*oldRoute*/,
+            const std::shared_ptr<RouteT>& newRoute) {
+          programRoute(vrf, newRoute);
+        },
+        [&](const std::shared_ptr<RouteT>& addedRoute) {
+          programRoute(vrf, addedRoute);
+        },
+        [&](const std::shared_ptr<RouteT>& removedRoute) {
+          unprogramRoute(vrf, removedRoute);
+        });
+  }
+}
+
+template <typename AddrT>
+void SimForwardingTables::processFibDelta(const StateDelta& delta) {
+  using RouteT = Route<AddrT>;
+  for (const auto& fibDelta : delta.getFibsDelta()) {
+    auto vrf = fibDelta.getOld() ? fibDelta.getOld()->getID()
+                                 : fibDelta.getNew()->getID();
+    auto processFib = [&](const auto& routesDelta) {
+      forEachChanged(
+          routesDelta,
+          [&](const std::shared_ptr<RouteT>& /*oldRoute*/,
+              const std::shared_ptr<RouteT>& newRoute) {
+            programRoute(vrf, newRoute);
+          },
+          [&](const std::shared_ptr<RouteT>& addedRoute) {
+            programRoute(vrf, addedRoute);
+          },
+          [&](const std::shared_ptr<RouteT>& removedRoute) {
+            unprogramRoute(vrf, removedRoute);
+          });
+    };
+    if constexpr (std::is_same_v<AddrT, folly::IPAddressV4>) {
+      processFib(fibDelta.getV4FibDelta());
+    } else {
+      processFib(fibDelta.getV6FibDelta());
+    }
+  }
+}
+
+template <typename RouteT>
+void SimForwardingTables::programRoute(
+    RouterID vrf,
+    const std::shared_ptr<RouteT>& route) {
+  using AddrT = std::decay_t<decltype(route->prefix().network)>;
+  if (!route->isResolved()) {
+    // Like hardware, unresolved routes are not programmed
+    unprogramRoute(vrf, route);
+    return;
+  }
+  RouteEntry entry;
+  const auto& fwd = route->getForwardInfo();
+  entry.action = fwd.getAction();
+  if (entry.action == RouteForwardAction::NEXTHOPS) {
+    entry.ecmpGroup = getOrCreateEcmpGroup(fwd.getNextHopSet());
+  }
+  auto& lpm = vrfs_[vrf].template lpm<AddrT>();
+  const auto& prefix = route->prefix();
+  auto result = lpm.insert(prefix.network, prefix.mask, entry);
+  if (!result.second) {
+    result.first->value() = std::move(entry);
+  }
+}
+
+template <typename RouteT>
+void SimForwardingTables::unprogramRoute(
+    RouterID vrf,
+    const std::shared_ptr<RouteT>& route) {
+  using AddrT = std::decay_t<decltype(route->prefix().network)>;
+  auto vrfItr = vrfs_.find(vrf);
+  if (vrfItr == vrfs_.end()) {
+    return;
+  }
+  const auto& prefix = route->prefix();
+  vrfItr->second.template lpm<AddrT>().erase(prefix.network, prefix.mask);
+}
+
+template <typename NeighborTableT>
+void SimForwardingTables::processNeighborDelta(const StateDelta& delta) {
+  using NeighborEntryT = typename NeighborTableT::Entry;
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    auto vlan = vlanDelta.getOld() ? vlanDelta.getOld()->getID()
+                                   : vlanDelta.getNew()->getID();
+    forEachChanged(
+        vlanDelta.template getNeighborDelta<NeighborTableT>(),
+        [&](const std::shared_ptr<NeighborEntryT>& oldEntry,
+            const std::shared_ptr<NeighborEntryT>& newEntry) {
+          removeHost(vlan, oldEntry.get());
+          addHost(vlan, newEntry.get());
+        },
+        [&](const std::shared_ptr<NeighborEntryT>& addedEntry) {
+          addHost(vlan, addedEntry.get());
+        },
+        [&](const std::shared_ptr<NeighborEntryT>& removedEntry) {
+          removeHost(vlan, removedEntry.get());
+        });
+  }
+}
+
+template <typename NeighborEntryT>
+void SimForwardingTables::addHost(VlanID vlan, const NeighborEntryT* entry) {
+  if (entry->isPending()) {
+    // Pending entries punt to CPU, which is what a missing host entry does
+    return;
+  }
+  folly::IPAddress ip(entry->getIP());
+  hosts_[std::make_pair(entry->getIntfID(), ip)] =
+      HostEntry{entry->getMac(), entry->getPort()};
+  addL2Entry(vlan, entry->getMac(), entry->getPort());
+}
+
+template <typename NeighborEntryT>
+void SimForwardingTables::removeHost(VlanID vlan, const NeighborEntryT* entry) {
+  if (entry->isPending()) {
+    return;
+  }
+  folly::IPAddress ip(entry->getIP());
+  hosts_.erase(std::make_pair(entry->getIntfID(), ip));
+  removeL2Entry(vlan, entry->getMac());
+}
+
+void SimForwardingTables::processMacDelta(const StateDelta& delta) {
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    auto vlan = vlanDelta.getOld() ? vlanDelta.getOld()->getID()
+                                   : vlanDelta.getNew()->getID();
+    forEachChanged(
+        vlanDelta.getMacDelta(),
+        [&](const std::shared_ptr<MacEntry>& oldEntry,
+            const std::shared_ptr<MacEntry>& newEntry) {
+          removeL2Entry(vlan, oldEntry->getMac());
+          addL2Entry(vlan, newEntry->getMac(), newEntry->getPort());
+        },
+        [&](const std::shared_ptr<MacEntry>& addedEntry) {
+          addL2Entry(vlan, addedEntry->getMac(), addedEntry->getPort());
+        },
+        [&](const std::shared_ptr<MacEntry>& removedEntry) {
+          removeL2Entry(vlan, removedEntry->getMac());
+        });
+  }
+}
+
+void SimForwardingTables::addL2Entry(
+    VlanID vlan,
+    folly::MacAddress mac,
+    PortDescriptor port) {
+  auto& entry = l2Table_[std::make_pair(vlan, mac)];
+  // Last writer wins on the port, as with a station move
+  entry.port = port;
+  ++entry.refCount;
+}
+
+void SimForwardingTables::removeL2Entry(VlanID vlan, folly::MacAddress mac) {
+  auto itr = l2Table_.find(std::make_pair(vlan, mac));
+  if (itr == l2Table_.end()) {
+    return;
+  }
+  if (--itr->second.refCount == 0) {
+    l2Table_.erase(itr);
+  }
+}
+
+void SimForwardingTables::processPortDelta(const StateDelta& delta) {
+  forEachChanged(
+      delta.getPortsDelta(),
+      [&](const std::shared_ptr<Port>& /*oldPort*/,
+          const std::shared_ptr<Port>& newPort) {
+        ports_[newPort->getID()] =
+            PortEntry{newPort->isPortUp(), newPort->getIngressVlan()};
+      },
+      [&](const std::shared_ptr<Port>& addedPort) {
+        ports_[addedPort->getID()] =
+            PortEntry{addedPort->isPortUp(), addedPort->getIngressVlan()};
+      },
+      [&](const std::shared_ptr<Port>& removedPort) {
+        ports_.erase(removedPort->getID());
+      });
+}
+
+void SimForwardingTables::processVlanDelta(const StateDelta& delta) {
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    const auto& oldVlan = vlanDelta.getOld();
+    const auto& newVlan = vlanDelta.getNew();
+    if (!newVlan) {
+      vlans_.erase(oldVlan->getID());
+      continue;
+    }
+    if (oldVlan && oldVlan->getPorts() == newVlan->getPorts()) {
+      // Only neighbor or MAC tables changed
+      continue;
+    }
+    auto& members = vlans_[newVlan->getID()];
+    members.clear();
+    for (const auto& port : newVlan->getPorts()) {
+      members.emplace(port.first, port.second.tagged);
+    }
+  }
+}
+
+void SimForwardingTables::processIntfDelta(const StateDelta& delta) {
+  const auto& intfsDelta = delta.getIntfsDelta();
+  if (intfsDelta.begin() == intfsDelta.end()) {
+    return;
+  }
+  // Interface count is small, rebuild the derived tables from scratch
+  intfs_.clear();
+  vlanToIntf_.clear();
+  localAddrs_.clear();
+  for (const auto& intf : *delta.newState()->getInterfaces()) {
+    intfs_[intf->getID()] =
+        InterfaceEntry{intf->getRouterID(), intf->getVlanID(), intf->getMac()};
+    vlanToIntf_[intf->getVlanID()] = intf->getID();
+    for (const auto& addr : intf->getAddresses()) {
+      localAddrs_.emplace(intf->getRouterID(), addr.first);
+    }
+  }
+}
+
+void SimForwardingTables::processAggregatePortDelta(const StateDelta& delta) {
+  forEachChanged(
+      delta.getAggregatePortsDelta(),
+      [&](const std::shared_ptr<AggregatePort>& /*oldAggPort*/,
+          const std::shared_ptr<AggregatePort>& newAggPort) {
+        auto& members = aggPorts_[newAggPort->getID()];
+        members.clear();
+        for (const auto& subport : newAggPort->sortedSubports()) {
+          members.push_back(subport.portID);
+        }
+      },
+      [&](const std::shared_ptr<AggregatePort>& addedAggPort) {
+        auto& members = aggPorts_[addedAggPort->getID()];
+        for (const auto& subport : addedAggPort->sortedSubports()) {
+          members.push_back(subport.portID);
+        }
+      },
+      [&](const std::shared_ptr<AggregatePort>& removedAggPort) {
+        aggPorts_.erase(removedAggPort->getID());
+      });
+}
+
+std::shared_ptr<const SimForwardingTables::EcmpGroup>
+SimForwardingTables::getOrCreateEcmpGroup(const RouteNextHopSet& nhops) {
+  auto& weakGroup = ecmpGroups_[nhops];
+  if (auto group = weakGroup.lock()) {
+    return group;
+  }
+  auto group = std::make_shared<const EcmpGroup>(nhops);
+  weakGroup = group;
+  return group;
+}
+
+void SimForwardingTables::pruneEcmpGroups() {
+  for (auto itr = ecmpGroups_.begin(); itr != ecmpGroups_.end();) {
+    if (itr->second.expired()) {
+      itr = ecmpGroups_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+}
+
+} // namespace facebook::fboss
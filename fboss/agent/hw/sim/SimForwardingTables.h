@@ -0,0 +1,188 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/state/PortDescriptor.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
+#include "fboss/agent/state/RouteTypes.h"
+#include "fboss/agent/types.h"
+#include "fboss/lib/RadixTree.h"
+
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace facebook::fboss {
+
+class StateDelta;
+class SwitchState;
+
+/*
+ * SimForwardingTables is the software model of the tables an ASIC would
+ * program from a StateDelta: per-VRF LPM tables, ARP/NDP host entries, the
+ * L2 table and the ECMP groups routes point to.
+ *
+ * It is not thread safe. SimSwitch serializes writes (from stateChanged())
+ * against reads (from the packet path).
+ */
+class SimForwardingTables {
+ public:
+  struct EcmpMember {
+    InterfaceID intf;
+    folly::IPAddress ip;
+    NextHopWeight weight;
+  };
+
+  /*
+   * ECMP groups are interned per next hop set, so routes sharing a next hop
+   * set share a group, as they would in hardware.
+   */
+  class EcmpGroup {
+   public:
+    explicit EcmpGroup(const RouteNextHopSet& nhops);
+
+    const std::vector<EcmpMember>& members() const {
+      return members_;
+    }
+    /*
+     * Pick a member for a flow hash, honoring UCMP weights.
+     */
+    const EcmpMember& select(uint64_t hash) const;
+
+   private:
+    std::vector<EcmpMember> members_;
+    // Running sum of weights, used for weighted member selection
+    std::vector<uint64_t> cumulativeWeights_;
+  };
+
+  struct RouteEntry {
+    RouteForwardAction action{RouteForwardAction::DROP};
+    std::shared_ptr<const EcmpGroup> ecmpGroup;
+  };
+
+  struct HostEntry {
+    folly::MacAddress mac;
+    PortDescriptor port{PortID(0)};
+  };
+
+  struct InterfaceEntry {
+    RouterID vrf{0};
+    VlanID vlan{0};
+    folly::MacAddress mac;
+  };
+
+  struct PortEntry {
+    bool up{false};
+    VlanID ingressVlan{0};
+  };
+
+  // VLAN member ports, mapped to whether they emit tagged frames
+  using VlanMembers = std::map<PortID, bool>;
+
+  /*
+   * Apply all forwarding relevant changes in the delta.
+   */
+  void processDelta(const StateDelta& delta);
+
+  template <typename AddrT>
+  const RouteEntry* longestMatch(RouterID vrf, const AddrT& addr) const;
+
+  const HostEntry* getHostIf(InterfaceID intf, const folly::IPAddress& ip)
+      const;
+  std::optional<PortDescriptor> getL2EntryIf(
+      VlanID vlan,
+      folly::MacAddress mac) const;
+  const InterfaceEntry* getInterfaceIf(InterfaceID intf) const;
+  std::optional<InterfaceID> getVlanInterfaceIf(VlanID vlan) const;
+  const VlanMembers* getVlanMembersIf(VlanID vlan) const;
+  const PortEntry* getPortIf(PortID port) const;
+  const std::vector<PortID>* getAggregatePortMembersIf(
+      AggregatePortID aggPort) const;
+  bool isLocalAddress(RouterID vrf, const folly::IPAddress& ip) const;
+
+  size_t numRoutes() const;
+  size_t numHosts() const {
+    return hosts_.size();
+  }
+  size_t numL2Entries() const {
+    return l2Table_.size();
+  }
+  size_t numEcmpGroups() const {
+    return ecmpGroups_.size();
+  }
+
+ private:
+  template <typename AddrT>
+  using Lpm = facebook::network::RadixTree<AddrT, RouteEntry>;
+
+  struct VrfTables {
+    Lpm<folly::IPAddressV4> v4;
+    Lpm<folly::IPAddressV6> v6;
+
+    template <typename AddrT>
+    Lpm<AddrT>& lpm();
+    template <typename AddrT>
+    const Lpm<AddrT>& lpm() const;
+  };
+
+  struct L2Entry {
+    PortDescriptor port{PortID(0)};
+    // Entries are installed both from the MAC table and on behalf of
+    // resolved neighbors, track how many of those refer to this entry.
+    uint32_t refCount{0};
+  };
+
+  template <typename AddrT>
+  void processRouteDelta(const StateDelta& delta);
+  template <typename AddrT>
+  void processFibDelta(const StateDelta& delta);
+  template <typename RouteT>
+  void programRoute(RouterID vrf, const std::shared_ptr<RouteT>& route);
+  template <typename RouteT>
+  void unprogramRoute(RouterID vrf, const std::shared_ptr<RouteT>& route);
+
+  template <typename NeighborTableT>
+  void processNeighborDelta(const StateDelta& delta);
+  template <typename NeighborEntryT>
+  void addHost(VlanID vlan, const NeighborEntryT* entry);
+  template <typename NeighborEntryT>
+  void removeHost(VlanID vlan, const NeighborEntryT* entry);
+
+  void processMacDelta(const StateDelta& delta);
+  void addL2Entry(VlanID vlan, folly::MacAddress mac, PortDescriptor port);
+  void removeL2Entry(VlanID vlan, folly::MacAddress mac);
+
+  void processPortDelta(const StateDelta& delta);
+  void processVlanDelta(const StateDelta& delta);
+  void processIntfDelta(const StateDelta& delta);
+  void processAggregatePortDelta(const StateDelta& delta);
+
+  std::shared_ptr<const EcmpGroup> getOrCreateEcmpGroup(
+      const RouteNextHopSet& nhops);
+  void pruneEcmpGroups();
+
+  std::map<RouterID, VrfTables> vrfs_;
+  std::map<std::pair<InterfaceID, folly::IPAddress>, HostEntry> hosts_;
+  std::map<std::pair<VlanID, folly::MacAddress>, L2Entry> l2Table_;
+  std::map<RouteNextHopSet, std::weak_ptr<const EcmpGroup>> ecmpGroups_;
+  std::map<InterfaceID, InterfaceEntry> intfs_;
+  std::map<VlanID, InterfaceID> vlanToIntf_;
+  std::set<std::pair<RouterID, folly::IPAddress>> localAddrs_;
+  std::map<VlanID, VlanMembers> vlans_;
+  std::map<PortID, PortEntry> ports_;
+  std::map<AggregatePortID, std::vector<PortID>> aggPorts_;
+};
+
+} // namespace facebook::fboss
@@ -9,20 +9,133 @@
  */
 #include "fboss/agent/hw/sim/SimSwitch.h"
 
+#include "fboss/agent/TxPacket.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
 #include "fboss/agent/hw/mock/MockTxPacket.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/PktUtil.h"
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
 
 #include <folly/Conv.h>
 #include <folly/Memory.h>
 #include <folly/dynamic.h>
+#include <folly/hash/Hash.h>
+#include <folly/io/Cursor.h>
+#include <folly/logging/xlog.h>
 
+using folly::io::Cursor;
 using std::make_shared;
 using std::make_unique;
 using std::shared_ptr;
 using std::string;
 
+namespace {
+
+using namespace facebook::fboss;
+
+// Offsets into the IPv4/IPv6 headers for the fields we rewrite when routing
+constexpr size_t kIPv4TtlOffset = 8;
+constexpr size_t kIPv4ChecksumOffset = 10;
+constexpr size_t kIPv6HopLimitOffset = 7;
+
+/*
+ * Link local control protocols (LACP, LLDP, STP, ...) use
+ * 01:80:c2:00:00:0X and must never be flooded.
+ */
+bool isLinkLocalControlMac(folly::MacAddress mac) {
+  return (mac.u64HBO() & 0xfffffffffff0ULL) == 0x0180c2000000ULL;
+}
+
+/*
+ * Build the egress copy of a packet: a fresh L2 header followed by
+ * everything past the ingress L2 header. If decrementTtl is set, the
+ * IPv4 TTL (and header checksum) or IPv6 hop limit is decremented as a
+ * router would.
+ */
+std::unique_ptr<folly::IOBuf> makeEgressBuf(
+    const folly::IOBuf* ingress,
+    size_t l2HdrLen,
+    folly::MacAddress dstMac,
+    folly::MacAddress srcMac,
+    std::optional<VlanID> tag,
+    uint16_t etherType,
+    bool decrementTtl) {
+  auto payload = ingress->clone();
+  payload->coalesce();
+  payload->trimStart(l2HdrLen);
+  if (decrementTtl) {
+    payload->unshare();
+    auto data = payload->writableData();
+    if (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4)) {
+      size_t ihlLen = (data[0] & 0x0f) * 4;
+      data[kIPv4TtlOffset] -= 1;
+      data[kIPv4ChecksumOffset] = 0;
+      data[kIPv4ChecksumOffset + 1] = 0;
+      auto csum = PktUtil::internetChecksum(data, ihlLen);
+      data[kIPv4ChecksumOffset] = csum >> 8;
+      data[kIPv4ChecksumOffset + 1] = csum & 0xff;
+    } else {
+      data[kIPv6HopLimitOffset] -= 1;
+    }
+  }
+
+  auto hdrLen = tag ? EthHdr::SIZE : EthHdr::SIZE - 4;
+  auto egress = folly::IOBuf::create(hdrLen);
+  egress->append(hdrLen);
+  folly::io::RWPrivateCursor cursor(egress.get());
+  if (tag) {
+    TxPacket::writeEthHeader(&cursor, dstMac, srcMac, *tag, etherType);
+  } else {
+    TxPacket::writeEthHeader(&cursor, dstMac, srcMac, etherType);
+  }
+  egress->prependChain(std::move(payload));
+  return egress;
+}
+
+std::optional<VlanID> egressTag(
+    const SimForwardingTables& tables,
+    VlanID vlan,
+    PortID port) {
+  const auto* members = tables.getVlanMembersIf(vlan);
+  if (members) {
+    auto itr = members->find(port);
+    if (itr != members->end() && itr->second) {
+      return vlan;
+    }
+  }
+  return std::nullopt;
+}
+
+/*
+ * Resolve a (possibly aggregate) port to an operationally up physical port.
+ */
+std::optional<PortID> resolveEgressPort(
+    const SimForwardingTables& tables,
+    const PortDescriptor& port,
+    uint64_t hash) {
+  PortID physicalPort;
+  if (port.isAggregatePort()) {
+    const auto* members = tables.getAggregatePortMembersIf(port.aggPortID());
+    if (!members || members->empty()) {
+      return std::nullopt;
+    }
+    physicalPort = (*members)[hash % members->size()];
+  } else {
+    physicalPort = port.phyPortID();
+  }
+  const auto* portEntry = tables.getPortIf(physicalPort);
+  if (!portEntry || !portEntry->up) {
+    return std::nullopt;
+  }
+  return physicalPort;
+}
+
+} // namespace
+
 namespace facebook::fboss {
 
 SimSwitch::SimSwitch(SimPlatform* platform, uint32_t numPorts)
@@ -46,7 +159,19 @@ HwInitResult SimSwitch::init(
 }
 
 std::shared_ptr<SwitchState> SimSwitch::stateChanged(const StateDelta& delta) {
-  // TODO
+  auto start = std::chrono::steady_clock::now();
+  tables_.wlock()->processDelta(delta);
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  {
+    auto stats = programmingStats_.wlock();
+    ++stats->numUpdates;
+    stats->lastLatency = latency;
+    stats->maxLatency = std::max(stats->maxLatency, latency);
+    stats->totalLatency += latency;
+  }
+  XLOG(DBG3) << "Programmed state delta in " << latency.count() << "us";
   return delta.newState();
 }
 
@@ -55,38 +180,278 @@ std::unique_ptr<TxPacket> SimSwitch::allocatePacket(uint32_t size) const {
 }
 
 bool SimSwitch::sendPacketSwitchedAsync(
-    std::unique_ptr<TxPacket> /*pkt*/) noexcept {
-  // TODO
-  ++txCount_;
-  return true;
+    std::unique_ptr<TxPacket> pkt) noexcept {
+  return sendPacketSwitchedSync(std::move(pkt));
 }
 
 bool SimSwitch::sendPacketOutOfPortAsync(
-    std::unique_ptr<TxPacket> /*pkt*/,
-    PortID /*portID*/,
-    std::optional<uint8_t> /* queue */) noexcept {
-  // TODO
-  ++txCount_;
-  return true;
+    std::unique_ptr<TxPacket> pkt,
+    PortID portID,
+    std::optional<uint8_t> queue) noexcept {
+  return sendPacketOutOfPortSync(std::move(pkt), portID, queue);
 }
 
 bool SimSwitch::sendPacketSwitchedSync(
-    std::unique_ptr<TxPacket> /*pkt*/) noexcept {
-  // TODO
+    std::unique_ptr<TxPacket> pkt) noexcept {
   ++txCount_;
+  std::vector<EgressPacket> egress;
+  PipelineResult result;
+  try {
+    // Packets from the CPU carry their VLAN in the 802.1Q tag
+    result = runPipeline(
+        *tables_.rlock(), pkt->buf(), std::nullopt, VlanID(0), &egress);
+  } catch (const std::exception& ex) {
+    XLOG(DBG3) << "Dropping malformed packet from CPU: " << ex.what();
+    result = PipelineResult::DROP;
+  }
+  if (result != PipelineResult::FORWARD) {
+    // Nothing we'd trap can be sent back to the CPU
+    ++droppedPackets_;
+    return true;
+  }
+  transmit(std::move(egress));
   return true;
 }
 
 bool SimSwitch::sendPacketOutOfPortSync(
-    std::unique_ptr<TxPacket> /*pkt*/,
-    PortID /*portID*/,
+    std::unique_ptr<TxPacket> pkt,
+    PortID portID,
     std::optional<uint8_t> /* queue */) noexcept {
-  // TODO
   ++txCount_;
+  std::vector<EgressPacket> egress;
+  egress.push_back({portID, pkt->buf()->clone()});
+  transmit(std::move(egress));
   return true;
 }
+
 void SimSwitch::injectPacket(std::unique_ptr<RxPacket> pkt) {
-  callback_->packetReceived(std::move(pkt));
+  ++rxPackets_;
+  std::vector<EgressPacket> egress;
+  PipelineResult result;
+  try {
+    auto tables = tables_.rlock();
+    auto vlan = pkt->getSrcVlan();
+    if (vlan == VlanID(0)) {
+      const auto* port = tables->getPortIf(pkt->getSrcPort());
+      if (port) {
+        vlan = port->ingressVlan;
+      }
+    }
+    result =
+        runPipeline(*tables, pkt->buf(), pkt->getSrcPort(), vlan, &egress);
+  } catch (const std::exception& ex) {
+    XLOG(DBG3) << "Dropping malformed packet from port " << pkt->getSrcPort()
+               << ": " << ex.what();
+    result = PipelineResult::DROP;
+  }
+
+  // Flooded copies go out even when the packet is also trapped
+  transmit(std::move(egress));
+  switch (result) {
+    case PipelineResult::PUNT:
+      ++puntedPackets_;
+      callback_->packetReceived(std::move(pkt));
+      break;
+    case PipelineResult::DROP:
+      ++droppedPackets_;
+      break;
+    case PipelineResult::FORWARD:
+      break;
+  }
+}
+
+SimSwitch::PipelineResult SimSwitch::runPipeline(
+    const SimForwardingTables& tables,
+    const folly::IOBuf* buf,
+    std::optional<PortID> ingressPort,
+    VlanID ingressVlan,
+    std::vector<EgressPacket>* egress) {
+  Cursor cursor(buf);
+  EthHdr ethHdr(cursor);
+  const size_t l2HdrLen = cursor - Cursor(buf);
+  auto vlan = ethHdr.getVlanTags().empty()
+      ? ingressVlan
+      : VlanID(ethHdr.getVlanTags()[0].vid());
+  auto dstMac = ethHdr.getDstMac();
+
+  auto flood = [&]() {
+    const auto* members = tables.getVlanMembersIf(vlan);
+    if (!members) {
+      return;
+    }
+    for (const auto& member : *members) {
+      const auto* port = tables.getPortIf(member.first);
+      if ((ingressPort && member.first == *ingressPort) || !port ||
+          !port->up) {
+        continue;
+      }
+      egress->push_back(
+          {member.first,
+           makeEgressBuf(
+               buf,
+               l2HdrLen,
+               dstMac,
+               ethHdr.getSrcMac(),
+               member.second ? std::optional<VlanID>(vlan) : std::nullopt,
+               ethHdr.getEtherType(),
+               false)});
+    }
+    if (!egress->empty()) {
+      ++floodedPackets_;
+    }
+  };
+
+  const SimForwardingTables::InterfaceEntry* intf = nullptr;
+  if (auto intfID = tables.getVlanInterfaceIf(vlan)) {
+    intf = tables.getInterfaceIf(*intfID);
+  }
+
+  if (!intf || dstMac != intf->mac) {
+    // Bridged
+    if (!dstMac.isUnicast()) {
+      if (!isLinkLocalControlMac(dstMac)) {
+        flood();
+      }
+      // ARP, NDP, DHCP, LLDP, LACP etc. are all trapped by hardware
+      return ingressPort ? PipelineResult::PUNT : PipelineResult::FORWARD;
+    }
+    auto l2Entry = tables.getL2EntryIf(vlan, dstMac);
+    if (!l2Entry) {
+      flood();
+      return egress->empty() ? PipelineResult::DROP : PipelineResult::FORWARD;
+    }
+    auto port = resolveEgressPort(tables, *l2Entry, dstMac.u64HBO());
+    if (!port || (ingressPort && *port == *ingressPort)) {
+      return PipelineResult::DROP;
+    }
+    egress->push_back(
+        {*port,
+         makeEgressBuf(
+             buf,
+             l2HdrLen,
+             dstMac,
+             ethHdr.getSrcMac(),
+             egressTag(tables, vlan, *port),
+             ethHdr.getEtherType(),
+             false)});
+    ++switchedPackets_;
+    return PipelineResult::FORWARD;
+  }
+
+  // Routed
+  const SimForwardingTables::RouteEntry* route = nullptr;
+  folly::IPAddress dstIp;
+  uint64_t flowHash = 0;
+  auto etherType = ethHdr.getEtherType();
+  if (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4)) {
+    IPv4Hdr ipHdr(cursor);
+    dstIp = ipHdr.dstAddr;
+    if (ipHdr.dstAddr.isMulticast() || ipHdr.ttl <= 1 ||
+        tables.isLocalAddress(intf->vrf, dstIp)) {
+      return PipelineResult::PUNT;
+    }
+    flowHash =
+        folly::hash::hash_combine(ipHdr.srcAddr, ipHdr.dstAddr, ipHdr.protocol);
+    route = tables.longestMatch(intf->vrf, ipHdr.dstAddr);
+  } else if (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6)) {
+    IPv6Hdr ipHdr(cursor);
+    dstIp = ipHdr.dstAddr;
+    if (ipHdr.dstAddr.isMulticast() || ipHdr.dstAddr.isLinkLocal() ||
+        ipHdr.hopLimit <= 1 || tables.isLocalAddress(intf->vrf, dstIp)) {
+      return PipelineResult::PUNT;
+    }
+    flowHash = folly::hash::hash_combine(
+        ipHdr.srcAddr, ipHdr.dstAddr, ipHdr.nextHeader);
+    route = tables.longestMatch(intf->vrf, ipHdr.dstAddr);
+  } else {
+    // Non IP traffic to the router MAC, e.g. ARP replies
+    return PipelineResult::PUNT;
+  }
+
+  if (!route) {
+    return PipelineResult::DROP;
+  }
+  switch (route->action) {
+    case RouteForwardAction::DROP:
+      return PipelineResult::DROP;
+    case RouteForwardAction::TO_CPU:
+      return PipelineResult::PUNT;
+    case RouteForwardAction::NEXTHOPS:
+      break;
+  }
+
+  const auto& nhop = route->ecmpGroup->select(flowHash);
+  // Connected routes point at our own interface address, the packet's
+  // destination is the neighbor in that case.
+  auto neighborIp =
+      tables.isLocalAddress(intf->vrf, nhop.ip) ? dstIp : nhop.ip;
+  const auto* host = tables.getHostIf(nhop.intf, neighborIp);
+  const auto* egressIntf = tables.getInterfaceIf(nhop.intf);
+  if (!host || !egressIntf) {
+    // Glean: let the CPU resolve the neighbor
+    return PipelineResult::PUNT;
+  }
+  auto port = resolveEgressPort(tables, host->port, flowHash);
+  if (!port) {
+    return PipelineResult::DROP;
+  }
+  egress->push_back(
+      {*port,
+       makeEgressBuf(
+           buf,
+           l2HdrLen,
+           host->mac,
+           egressIntf->mac,
+           egressTag(tables, egressIntf->vlan, *port),
+           etherType,
+           true)});
+  ++routedPackets_;
+  return PipelineResult::FORWARD;
+}
+
+void SimSwitch::transmit(std::vector<EgressPacket> egress) {
+  if (egress.empty()) {
+    return;
+  }
+  {
+    auto counts = portTxCounts_.wlock();
+    for (const auto& pkt : egress) {
+      ++(*counts)[pkt.port];
+    }
+  }
+  // Copy the handler so it may inject packets back into the switch
+  auto handler = *portTxHandler_.rlock();
+  if (!handler) {
+    return;
+  }
+  for (auto& pkt : egress) {
+    handler(pkt.port, std::move(pkt.buf));
+  }
+}
+
+void SimSwitch::setPortTxHandler(PortTxHandler handler) {
+  *portTxHandler_.wlock() = std::move(handler);
+}
+
+SimSwitch::ForwardingStats SimSwitch::getForwardingStats() const {
+  ForwardingStats stats;
+  stats.rxPackets = rxPackets_.load();
+  stats.puntedPackets = puntedPackets_.load();
+  stats.routedPackets = routedPackets_.load();
+  stats.switchedPackets = switchedPackets_.load();
+  stats.floodedPackets = floodedPackets_.load();
+  stats.droppedPackets = droppedPackets_.load();
+  return stats;
+}
+
+SimSwitch::ProgrammingStats SimSwitch::getProgrammingStats() const {
+  return *programmingStats_.rlock();
+}
+
+uint64_t SimSwitch::getPortTxCount(PortID port) const {
+  auto counts = portTxCounts_.rlock();
+  auto itr = counts->find(port);
+  return itr == counts->end() ? 0 : itr->second;
 }
 
 folly::dynamic SimSwitch::toFollyDynamic() const {
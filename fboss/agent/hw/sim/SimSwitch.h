@@ -10,16 +10,51 @@
 #pragma once
 
 #include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/hw/sim/SimForwardingTables.h"
 #include "fboss/agent/hw/sim/SimPlatform.h"
 
+#include <folly/Synchronized.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <optional>
 
 namespace facebook::fboss {
 
 class SwitchState;
 
+/*
+ * SimSwitch is a software forwarding model of an ASIC. It programs its own
+ * LPM, host, L2 and ECMP tables from the StateDeltas it is handed, forwards
+ * injected packets between simulated ports and punts the packets hardware
+ * would trap to the CPU. This lets SwSwitch level pipelines (RIB -> FIB ->
+ * HwSwitch -> packet path) be exercised and benchmarked without an ASIC.
+ */
 class SimSwitch : public HwSwitch {
  public:
+  /*
+   * Called for every packet egressing a simulated front panel port.
+   */
+  using PortTxHandler =
+      std::function<void(PortID port, std::unique_ptr<folly::IOBuf> pkt)>;
+
+  struct ForwardingStats {
+    uint64_t rxPackets{0};
+    uint64_t puntedPackets{0};
+    uint64_t routedPackets{0};
+    uint64_t switchedPackets{0};
+    uint64_t floodedPackets{0};
+    uint64_t droppedPackets{0};
+  };
+
+  struct ProgrammingStats {
+    uint64_t numUpdates{0};
+    std::chrono::microseconds lastLatency{0};
+    std::chrono::microseconds maxLatency{0};
+    std::chrono::microseconds totalLatency{0};
+  };
+
   SimSwitch(SimPlatform* platform, uint32_t numPorts);
 
   HwInitResult init(Callback* callback, bool failHwCallsOnWarmboot) override;
@@ -43,8 +78,27 @@ class SimSwitch : public HwSwitch {
 
   folly::dynamic toFollyDynamic() const override;
 
+  /*
+   * Inject a packet as if it was received on pkt->getSrcPort(). The packet
+   * is run through the forwarding pipeline and is either punted to the
+   * HwSwitch callback, forwarded/flooded to other ports or dropped.
+   */
   void injectPacket(std::unique_ptr<RxPacket> pkt);
 
+  void setPortTxHandler(PortTxHandler handler);
+
+  ForwardingStats getForwardingStats() const;
+  ProgrammingStats getProgrammingStats() const;
+  uint64_t getPortTxCount(PortID port) const;
+
+  /*
+   * Run fn with a read-only view of the programmed tables
+   */
+  template <typename Fn>
+  void withForwardingTables(Fn fn) const {
+    fn(*tables_.rlock());
+  }
+
   folly::F14FastMap<std::string, HwPortStats> getPortStats() const override {
     return {};
   }
@@ -118,11 +172,44 @@ class SimSwitch : public HwSwitch {
   SimSwitch(SimSwitch const&) = delete;
   SimSwitch& operator=(SimSwitch const&) = delete;
 
+  struct EgressPacket {
+    PortID port;
+    std::unique_ptr<folly::IOBuf> buf;
+  };
+
+  enum class PipelineResult { PUNT, FORWARD, DROP };
+
+  /*
+   * Look up buf in the programmed tables and fill egress with the packets to
+   * transmit. Runs with the tables read locked, so must not call out of
+   * SimSwitch.
+   */
+  PipelineResult runPipeline(
+      const SimForwardingTables& tables,
+      const folly::IOBuf* buf,
+      std::optional<PortID> ingressPort,
+      VlanID ingressVlan,
+      std::vector<EgressPacket>* egress);
+  void transmit(std::vector<EgressPacket> egress);
+
   SimPlatform* platform_;
   HwSwitch::Callback* callback_{nullptr};
   uint32_t numPorts_{0};
   uint64_t txCount_{0};
   BootType bootType_{BootType::UNINITIALIZED};
+
+  folly::Synchronized<SimForwardingTables> tables_;
+  folly::Synchronized<PortTxHandler> portTxHandler_;
+  folly::Synchronized<std::map<PortID, uint64_t>> portTxCounts_;
+
+  std::atomic<uint64_t> rxPackets_{0};
+  std::atomic<uint64_t> puntedPackets_{0};
+  std::atomic<uint64_t> routedPackets_{0};
+  std::atomic<uint64_t> switchedPackets_{0};
+  std::atomic<uint64_t> floodedPackets_{0};
+  std::atomic<uint64_t> droppedPackets_{0};
+
+  folly::Synchronized<ProgrammingStats> programmingStats_;
 };
 
 } // namespace facebook::fboss
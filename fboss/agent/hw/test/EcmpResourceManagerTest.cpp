@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/EcmpResourceManager.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+using NextHopSet = EcmpResourceManager::NextHopSet;
+using SharingPolicy = EcmpResourceManager::SharingPolicy;
+
+NextHopSet makeNextHops(std::vector<int> hosts, NextHopWeight weight = 0) {
+  NextHopSet nextHops;
+  for (auto host : hosts) {
+    nextHops.emplace(
+        folly::IPAddress(folly::to<std::string>("10.0.0.", host)),
+        InterfaceID(host),
+        weight);
+  }
+  return nextHops;
+}
+} // namespace
+
+TEST(EcmpResourceManagerTest, sharingPolicyFromString) {
+  EXPECT_EQ(
+      SharingPolicy::NONE,
+      EcmpResourceManager::sharingPolicyFromString("none"));
+  EXPECT_EQ(
+      SharingPolicy::CLOSEST,
+      EcmpResourceManager::sharingPolicyFromString("closest"));
+  EXPECT_THROW(
+      EcmpResourceManager::sharingPolicyFromString("random"), FbossError);
+}
+
+TEST(EcmpResourceManagerTest, members) {
+  EXPECT_EQ(3, EcmpResourceManager::members(makeNextHops({1, 2, 3})));
+  EXPECT_EQ(10, EcmpResourceManager::members(makeNextHops({1, 2}, 5)));
+}
+
+TEST(EcmpResourceManagerTest, fits) {
+  EcmpResourceManager manager(4, 100, 50, SharingPolicy::SUBSET);
+  auto nextHops = makeNextHops({1, 2});
+  EXPECT_TRUE(manager.fits(nextHops));
+  auto first = manager.addGroup(nextHops);
+  EXPECT_TRUE(manager.fits(nextHops));
+  auto second = manager.addGroup(nextHops);
+  // A third group takes 3 of 4 groups, past 50%
+  EXPECT_FALSE(manager.fits(nextHops));
+  second.reset();
+  EXPECT_TRUE(manager.fits(nextHops));
+  // 2 members in use, 50 more would be past 50% of 100
+  EXPECT_FALSE(manager.fits(makeNextHops({1, 2}, 25)));
+}
+
+TEST(EcmpResourceManagerTest, unknownLimits) {
+  EcmpResourceManager manager(0, 0, 50, SharingPolicy::SUBSET);
+  std::vector<std::unique_ptr<EcmpResourceManager::GroupUsage>> usages;
+  for (int i = 0; i < 100; ++i) {
+    usages.push_back(manager.addGroup(makeNextHops({1, 2})));
+  }
+  EXPECT_TRUE(manager.fits(makeNextHops({1, 2})));
+}
+
+TEST(EcmpResourceManagerTest, closestGroup) {
+  auto nextHops = makeNextHops({1, 2, 3, 4});
+  auto subset = makeNextHops({1, 2});
+  auto closerSubset = makeNextHops({1, 2, 3});
+  auto superset = makeNextHops({1, 2, 3, 4, 5});
+  auto disjoint = makeNextHops({5, 6, 7, 8});
+  std::vector<const NextHopSet*> groups{
+      &disjoint, &subset, &superset, &closerSubset};
+
+  auto closestGroup = [&](SharingPolicy policy) {
+    return EcmpResourceManager(0, 0, 100, policy)
+        .closestGroup(nextHops, groups);
+  };
+  EXPECT_EQ(std::nullopt, closestGroup(SharingPolicy::NONE));
+  EXPECT_EQ(3, closestGroup(SharingPolicy::SUBSET));
+  EXPECT_EQ(2, closestGroup(SharingPolicy::SUPERSET));
+  // Subset and superset differ by one next hop each, subsets win ties
+  EXPECT_EQ(3, closestGroup(SharingPolicy::CLOSEST));
+
+  std::vector<const NextHopSet*> noMatch{&disjoint};
+  EXPECT_EQ(
+      std::nullopt,
+      EcmpResourceManager(0, 0, 100, SharingPolicy::CLOSEST)
+          .closestGroup(nextHops, noMatch));
+}
+
+TEST(EcmpResourceManagerTest, stats) {
+  EcmpResourceManager manager(0, 0, 100, SharingPolicy::SUBSET);
+  auto nextHops = makeNextHops({1, 2, 3});
+  auto subset = makeNextHops({1, 2});
+  auto group = manager.addGroup(subset);
+  {
+    auto shared = manager.addSharedGroup(nextHops, subset);
+    auto stats = manager.getStats();
+    EXPECT_EQ(1, stats.groupsUsed);
+    EXPECT_EQ(2, stats.membersUsed);
+    EXPECT_EQ(1, stats.groupsShared);
+    EXPECT_EQ(3, stats.membersSaved);
+  }
+  auto stats = manager.getStats();
+  EXPECT_EQ(1, stats.groupsUsed);
+  EXPECT_EQ(0, stats.groupsShared);
+  EXPECT_EQ(0, stats.membersSaved);
+  group.reset();
+  EXPECT_EQ(0, manager.getStats().groupsUsed);
+  EXPECT_EQ(0, manager.getStats().membersUsed);
+}
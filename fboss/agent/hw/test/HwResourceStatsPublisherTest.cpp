@@ -167,15 +167,24 @@ TEST(HwResourceStatsPublisher, EcmpGroupStats) {
   stats.l3_ecmp_groups_used_ref() = 1;
   stats.l3_ecmp_groups_free_ref() = 9;
   stats.l3_ecmp_group_members_free_ref() = 42;
+  stats.l3_ecmp_group_members_used_ref() = 22;
+  stats.l3_ecmp_groups_shared_ref() = 3;
+  stats.l3_ecmp_group_members_saved_ref() = 12;
   HwResourceStatsPublisher().publish(stats);
   EXPECT_EQ(fbData->getCounter(kL3EcmpGroupsMax), 10);
   EXPECT_EQ(fbData->getCounter(kL3EcmpGroupsUsed), 1);
   EXPECT_EQ(fbData->getCounter(kL3EcmpGroupsFree), 9);
   EXPECT_EQ(fbData->getCounter(kL3EcmpGroupMembersFree), 42);
+  EXPECT_EQ(fbData->getCounter(kL3EcmpGroupMembersUsed), 22);
+  EXPECT_EQ(fbData->getCounter(kL3EcmpGroupsShared), 3);
+  EXPECT_EQ(fbData->getCounter(kL3EcmpGroupMembersSaved), 12);
   checkMissing({kL3EcmpGroupsMax,
                 kL3EcmpGroupsUsed,
                 kL3EcmpGroupsFree,
-                kL3EcmpGroupMembersFree});
+                kL3EcmpGroupMembersFree,
+                kL3EcmpGroupMembersUsed,
+                kL3EcmpGroupsShared,
+                kL3EcmpGroupMembersSaved});
 }
 
 TEST(HwResourceStatsPublisher, HostStats) {
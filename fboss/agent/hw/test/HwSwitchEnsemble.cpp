@@ -20,6 +20,7 @@
 #include "fboss/agent/hw/switch_asics/HwAsic.h"
 #include "fboss/agent/hw/test/HwLinkStateToggler.h"
 #include "fboss/agent/hw/test/StaticL2ForNeighborHwSwitchUpdater.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/Port.h"
@@ -68,8 +69,15 @@ HwSwitchEnsemble::~HwSwitchEnsemble() {
     // done via interfaceToMe routes. So blow away routes and interface
     // addresses.
     auto noRoutesState{getProgrammedState()->clone()};
-    auto routeTables = noRoutesState->getRouteTables()->modify(&noRoutesState);
-    routeTables->removeRouteTable(routeTables->getRouteTable(RouterID(0)));
+    if (noRoutesState->getRouteTables()->getRouteTableIf(RouterID(0))) {
+      auto routeTables =
+          noRoutesState->getRouteTables()->modify(&noRoutesState);
+      routeTables->removeRouteTable(routeTables->getRouteTable(RouterID(0)));
+    } else {
+      // Routes were programmed from the FIBs, as with the standalone RIB
+      noRoutesState->resetForwardingInformationBases(
+          std::make_shared<ForwardingInformationBaseMap>());
+    }
 
     auto vlans = noRoutesState->getVlans()->modify(&noRoutesState);
     for (auto& vlan : *vlans) {
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/init/Init.h"
+#include "fboss/agent/hw/SflowExporter.h"
+
+#include <folly/Benchmark.h>
+#include <folly/SocketAddress.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <gflags/gflags.h>
+#include <sys/socket.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+DECLARE_uint32(sflow_max_backlog);
+
+using namespace facebook::fboss;
+
+namespace {
+
+// A second worth of samples, at the rate sFlow is expected to sustain
+constexpr size_t kSamplesPerSecond = 50000;
+constexpr size_t kNumCollectors = 2;
+
+/*
+ * Sockets on the loopback standing in for the collectors. They are never
+ * read from: the kernel drops what does not fit in their buffers.
+ */
+class Collectors {
+ public:
+  Collectors() {
+    for (size_t i = 0; i < kNumCollectors; ++i) {
+      int sock = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      CHECK_NE(sock, -1);
+      folly::SocketAddress address("127.0.0.1", 0);
+      sockaddr_storage addrStorage;
+      address.getAddress(&addrStorage);
+      CHECK_EQ(
+          0,
+          bind(
+              sock,
+              reinterpret_cast<sockaddr*>(&addrStorage),
+              address.getActualSize()));
+      address.setFromLocalAddress(sock);
+      sockets_.push_back(sock);
+      collectors_.push_back(std::make_shared<SflowCollector>(
+          address.getAddressStr(), address.getPort()));
+    }
+  }
+  ~Collectors() {
+    for (auto sock : sockets_) {
+      close(sock);
+    }
+  }
+
+  const std::vector<std::shared_ptr<SflowCollector>>& get() const {
+    return collectors_;
+  }
+
+ private:
+  std::vector<int> sockets_;
+  std::vector<std::shared_ptr<SflowCollector>> collectors_;
+};
+
+SflowPacketInfo makeSample(size_t index) {
+  SflowPacketInfo info;
+  *info.ingressSampled_ref() = true;
+  info.srcPort_ref() = index % 32 + 1;
+  info.dstPort_ref() = 0;
+  info.vlan_ref() = 1;
+  info.frameLength_ref() = 1500;
+  *info.packetData_ref() = std::string(128, 'x');
+  return info;
+}
+
+} // namespace
+
+/*
+ * What the BCM exporter did: one thrift serialized sample per datagram, and
+ * one sendmsg() per sample per collector.
+ */
+BENCHMARK(SendPerSample, iters) {
+  std::unique_ptr<Collectors> collectors;
+  int sock = -1;
+  std::vector<sockaddr_storage> addresses;
+  std::vector<socklen_t> addressLens;
+  BENCHMARK_SUSPEND {
+    collectors = std::make_unique<Collectors>();
+    sock = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    for (const auto& collector : collectors->get()) {
+      addresses.emplace_back();
+      addressLens.push_back(collector->getAddress().getAddress(
+          &addresses.back()));
+    }
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    for (size_t j = 0; j < kSamplesPerSecond; ++j) {
+      std::string output;
+      apache::thrift::BinarySerializer::serialize(makeSample(j), &output);
+      iovec vec;
+      vec.iov_base = output.data();
+      vec.iov_len = output.size();
+      for (size_t k = 0; k < addresses.size(); ++k) {
+        msghdr msg = {};
+        msg.msg_name = &addresses[k];
+        msg.msg_namelen = addressLens[k];
+        msg.msg_iov = &vec;
+        msg.msg_iovlen = 1;
+        ::sendmsg(sock, &msg, MSG_DONTWAIT);
+      }
+    }
+  }
+  BENCHMARK_SUSPEND {
+    close(sock);
+    collectors.reset();
+  }
+}
+
+BENCHMARK_RELATIVE(SflowExporter, iters) {
+  std::unique_ptr<Collectors> collectors;
+  std::unique_ptr<SflowExporter> exporter;
+  BENCHMARK_SUSPEND {
+    // Whatever the exporter thread has not caught up with yet
+    FLAGS_sflow_max_backlog = kSamplesPerSecond;
+    collectors = std::make_unique<Collectors>();
+    exporter = std::make_unique<SflowExporter>();
+    for (const auto& collector : collectors->get()) {
+      exporter->addCollector(collector);
+    }
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    for (size_t j = 0; j < kSamplesPerSecond; ++j) {
+      exporter->addSample(makeSample(j));
+    }
+    exporter->flush();
+  }
+  BENCHMARK_SUSPEND {
+    CHECK_EQ(0, exporter->getStats().samplesDropped);
+    exporter.reset();
+    collectors.reset();
+  }
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/hw/SflowExporter.h"
+
+#include <fb303/ServiceData.h>
+#include <folly/SocketAddress.h>
+#include <folly/io/Cursor.h>
+#include <gflags/gflags.h>
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+
+DECLARE_uint32(sflow_datagram_size);
+DECLARE_uint32(sflow_batch_size);
+DECLARE_uint32(sflow_flush_interval_ms);
+DECLARE_uint32(sflow_max_backlog);
+
+using namespace facebook::fboss;
+using namespace facebook::fb303;
+
+namespace {
+
+/*
+ * A UDP socket on the loopback, standing in for an sFlow collector
+ */
+class TestCollector {
+ public:
+  TestCollector() {
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    CHECK_NE(socket_, -1);
+    folly::SocketAddress address("127.0.0.1", 0);
+    sockaddr_storage addrStorage;
+    address.getAddress(&addrStorage);
+    CHECK_EQ(
+        0,
+        bind(
+            socket_,
+            reinterpret_cast<sockaddr*>(&addrStorage),
+            address.getActualSize()));
+    address.setFromLocalAddress(socket_);
+    collector_ = std::make_shared<SflowCollector>(
+        address.getAddressStr(), address.getPort());
+  }
+  ~TestCollector() {
+    close(socket_);
+  }
+
+  const std::shared_ptr<SflowCollector>& getCollector() const {
+    return collector_;
+  }
+
+  // The datagrams received so far
+  std::vector<std::vector<uint8_t>> receive() {
+    std::vector<std::vector<uint8_t>> datagrams;
+    std::vector<uint8_t> buf(65536);
+    while (true) {
+      auto len = ::recv(socket_, buf.data(), buf.size(), MSG_DONTWAIT);
+      if (len < 0) {
+        break;
+      }
+      datagrams.emplace_back(buf.begin(), buf.begin() + len);
+    }
+    return datagrams;
+  }
+
+ private:
+  int socket_{-1};
+  std::shared_ptr<SflowCollector> collector_;
+};
+
+SflowPacketInfo makeSample(int16_t srcPort, size_t length) {
+  SflowPacketInfo info;
+  *info.ingressSampled_ref() = true;
+  info.srcPort_ref() = srcPort;
+  info.dstPort_ref() = 0;
+  info.frameLength_ref() = 1500;
+  *info.packetData_ref() = std::string(length, 'x');
+  return info;
+}
+
+struct Datagram {
+  uint32_t version;
+  uint32_t sequenceNumber;
+  uint32_t numSamples;
+  // Sampling rate and input port of each sample
+  std::vector<std::pair<uint32_t, uint32_t>> samples;
+};
+
+Datagram parse(const std::vector<uint8_t>& data) {
+  Datagram datagram;
+  auto buf = folly::IOBuf::wrapBuffer(data.data(), data.size());
+  folly::io::Cursor cursor(buf.get());
+  datagram.version = cursor.readBE<uint32_t>();
+  auto addressType = cursor.readBE<uint32_t>();
+  EXPECT_EQ(2, addressType);
+  cursor.skip(16); // agent address
+  cursor.skip(4); // sub agent ID
+  datagram.sequenceNumber = cursor.readBE<uint32_t>();
+  cursor.skip(4); // uptime
+  datagram.numSamples = cursor.readBE<uint32_t>();
+  for (uint32_t i = 0; i < datagram.numSamples; ++i) {
+    EXPECT_EQ(1, cursor.readBE<uint32_t>()); // flow sample
+    auto sampleLength = cursor.readBE<uint32_t>();
+    auto sample = cursor;
+    sample.skip(8); // sequence number, source ID
+    auto samplingRate = sample.readBE<uint32_t>();
+    sample.skip(8); // sample pool, drops
+    auto input = sample.readBE<uint32_t>();
+    datagram.samples.emplace_back(samplingRate, input);
+    cursor.skip(sampleLength);
+  }
+  EXPECT_TRUE(cursor.isAtEnd());
+  return datagram;
+}
+
+} // namespace
+
+class SflowExporterTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    // Only send the samples when told to
+    FLAGS_sflow_batch_size = 1000000;
+    FLAGS_sflow_flush_interval_ms = 1000000;
+    exporter = std::make_unique<SflowExporter>();
+  }
+
+  void TearDown() override {
+    exporter.reset();
+    FLAGS_sflow_batch_size = 256;
+    FLAGS_sflow_flush_interval_ms = 50;
+    FLAGS_sflow_max_backlog = 16384;
+    FLAGS_sflow_datagram_size = 1400;
+  }
+
+  std::unique_ptr<SflowExporter> exporter;
+};
+
+TEST_F(SflowExporterTest, SamplesPackedInDatagrams) {
+  TestCollector collector1;
+  TestCollector collector2;
+  exporter->addCollector(collector1.getCollector());
+  exporter->addCollector(collector2.getCollector());
+  EXPECT_EQ(2, exporter->size());
+  exporter->updateSamplingRates(PortID(5), 1000, 0);
+
+  constexpr size_t kNumSamples = 50;
+  for (size_t i = 0; i < kNumSamples; ++i) {
+    exporter->addSample(makeSample(5, 128));
+  }
+  exporter->flush();
+
+  for (auto* collector : {&collector1, &collector2}) {
+    auto datagrams = collector->receive();
+    // Each sample takes 192 bytes, so 7 fit in 1400 bytes
+    EXPECT_EQ(8, datagrams.size());
+    size_t numSamples = 0;
+    uint32_t sequenceNumber = 0;
+    for (const auto& data : datagrams) {
+      EXPECT_LE(data.size(), FLAGS_sflow_datagram_size);
+      auto datagram = parse(data);
+      EXPECT_EQ(5, datagram.version);
+      EXPECT_EQ(++sequenceNumber, datagram.sequenceNumber);
+      for (const auto& sample : datagram.samples) {
+        EXPECT_EQ(1000, sample.first);
+        EXPECT_EQ(5, sample.second);
+      }
+      numSamples += datagram.numSamples;
+    }
+    EXPECT_EQ(kNumSamples, numSamples);
+  }
+
+  auto stats = exporter->getStats();
+  EXPECT_EQ(kNumSamples, stats.samplesExported);
+  EXPECT_EQ(16, stats.datagramsSent);
+  EXPECT_EQ(0, stats.samplesDropped);
+  EXPECT_EQ(0, stats.sendErrors);
+  EXPECT_EQ(kNumSamples, fbData->getCounter(kSflowSamplesExported));
+  EXPECT_EQ(kNumSamples, fbData->getCounter(kSflowBacklog));
+}
+
+TEST_F(SflowExporterTest, SentOnBatchSize) {
+  TestCollector collector;
+  exporter->addCollector(collector.getCollector());
+  FLAGS_sflow_batch_size = 4;
+
+  for (size_t i = 0; i < 4; ++i) {
+    exporter->addSample(makeSample(1, 64));
+  }
+  // Queued behind the send triggered by the fourth sample
+  exporter->flush();
+  EXPECT_EQ(4, exporter->getStats().samplesExported);
+  EXPECT_EQ(1, collector.receive().size());
+}
+
+TEST_F(SflowExporterTest, BacklogFull) {
+  TestCollector collector;
+  exporter->addCollector(collector.getCollector());
+  FLAGS_sflow_max_backlog = 10;
+
+  for (size_t i = 0; i < 15; ++i) {
+    exporter->addSample(makeSample(1, 64));
+  }
+  exporter->flush();
+
+  auto stats = exporter->getStats();
+  EXPECT_EQ(10, stats.samplesExported);
+  EXPECT_EQ(5, stats.samplesDropped);
+  EXPECT_EQ(5, fbData->getCounter(kSflowSamplesDropped));
+}
+
+TEST_F(SflowExporterTest, NoCollectors) {
+  exporter->addSample(makeSample(1, 64));
+  exporter->flush();
+  EXPECT_EQ(0, exporter->getStats().samplesExported);
+  EXPECT_EQ(0, exporter->getStats().datagramsSent);
+}
@@ -350,6 +350,94 @@ struct NdpEntryThrift {
   8: i32 classID,
 }
 
+/*
+ * Narrows down the entries returned by the streaming table dumps. Unset
+ * fields match everything, and fields that do not apply to a table are
+ * ignored.
+ */
+struct TableDumpFilter {
+  // Routes within this prefix
+  1: optional IpPrefix prefix,
+  // Routes of this VRF
+  2: optional i32 vrf,
+  // Neighbor and L2 entries on this VLAN
+  3: optional i32 vlanID,
+  // Neighbor, L2 and port entries of this port
+  4: optional i32 port,
+}
+
+enum ChangeFeedEntryType {
+  ROUTE = 0,
+  ARP = 1,
+  NDP = 2,
+  MAC = 3,
+}
+
+/*
+ * A single FIB, neighbor or MAC table change. Changes are numbered in the
+ * order they were applied to the switch state.
+ */
+struct ChangeFeedEntry {
+  1: i64 sequence,
+  2: ChangeFeedEntryType type,
+  // Whether the entry was removed (or became unresolved), as opposed to
+  // added or changed
+  3: bool removed,
+  // Route prefix, or neighbor address as a host prefix
+  4: IpPrefix prefix,
+  // VRF and resolved next hops of routes
+  5: i32 vrf,
+  6: list<NextHopThrift> nextHops,
+  // MAC address, VLAN and port of neighbor and MAC entries
+  7: string mac,
+  8: i32 vlanID,
+  9: i32 port,
+}
+
+/*
+ * Selects the changes a change feed client is interested in. Unset fields
+ * match everything, and fields that do not apply to a type of change are
+ * ignored for it.
+ */
+struct ChangeFeedFilter {
+  // Routes and neighbors within any of these prefixes
+  1: optional list<IpPrefix> prefixes,
+  // Neighbor and MAC entries on any of these VLANs
+  2: optional list<i32> vlans,
+  // Only changes of these types
+  3: optional list<ChangeFeedEntryType> types,
+}
+
+struct ChangeFeedPage {
+  1: list<ChangeFeedEntry> entries,
+  // Sequence number to ask for the changes following this page with
+  2: i64 lastSequence,
+  // The changes asked for are no longer buffered, or were made by another
+  // run of the agent. The client should dump the tables it follows and
+  // resume from lastSequence and feedId.
+  3: bool resyncRequired,
+  // Identifies the feed lastSequence belongs to, which changes whenever the
+  // agent restarts. Clients pass it back with lastSequence.
+  4: i64 feedId,
+}
+
+/*
+ * Where the time of a route update went, from the thrift call to the state
+ * observers being notified
+ */
+struct RouteUpdateTrace {
+  // Also set on the state updates the route update leads to
+  1: i64 updateId,
+  2: string name,
+  3: i64 numRoutes,
+  // Wall clock time the update started at
+  4: i64 startTimeMs,
+  // Time spent in each stage, by stage name
+  5: map<string, i64> stageDurationsUs,
+  // 0 for as long as the update is in progress
+  6: i64 totalDurationUs,
+}
+
 enum BootType {
   UNINITIALIZED = 0,
   COLD_BOOT = 1,
@@ -817,6 +905,56 @@ service FbossCtrl extends fb303.FacebookService {
   list<AclEntryThrift> getAclTable()
     throws (1: fboss.FbossBaseError error)
 
+  /*
+   * Streaming variants of the table dumps above, for tables too large to
+   * return in one response. Entries come in pages of at most pageSize
+   * entries, built from a snapshot of the switch state taken when the call
+   * started. Neighbor entries are as the switch state has them, PENDING or
+   * REACHABLE and without a TTL, and the L2 table is read from hardware
+   * unless L2 learning is done in software.
+   */
+  stream<list<UnicastRoute>> getRouteTableStream(
+    1: i32 pageSize,
+    2: TableDumpFilter filter,
+  ) throws (1: fboss.FbossBaseError error)
+  stream<list<ArpEntryThrift>> getArpTableStream(
+    1: i32 pageSize,
+    2: TableDumpFilter filter,
+  ) throws (1: fboss.FbossBaseError error)
+  stream<list<NdpEntryThrift>> getNdpTableStream(
+    1: i32 pageSize,
+    2: TableDumpFilter filter,
+  ) throws (1: fboss.FbossBaseError error)
+  stream<list<L2EntryThrift>> getL2TableStream(
+    1: i32 pageSize,
+    2: TableDumpFilter filter,
+  ) throws (1: fboss.FbossBaseError error)
+  stream<list<PortInfoThrift>> getAllPortInfoStream(
+    1: i32 pageSize,
+    2: TableDumpFilter filter,
+  ) throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Follow FIB, neighbor and MAC table changes, instead of polling the
+   * tables. Both return the changes made after afterSequence of the feed
+   * feedId. Clients start by calling getChangeFeed with a negative
+   * afterSequence to learn the current lastSequence and feedId, dump the
+   * tables they follow, and then follow the changes made after that. The
+   * stream keeps sending new changes as they happen, and a page with
+   * resyncRequired if the client falls behind or the agent restarted.
+   */
+  ChangeFeedPage getChangeFeed(
+    1: i64 afterSequence,
+    2: ChangeFeedFilter filter,
+    3: i32 maxEntries,
+    4: i64 feedId,
+  ) throws (1: fboss.FbossBaseError error)
+  stream<ChangeFeedPage> subscribeToChangeFeed(
+    1: i64 afterSequence,
+    2: ChangeFeedFilter filter,
+    3: i64 feedId,
+  ) throws (1: fboss.FbossBaseError error)
+
   AggregatePortThrift getAggregatePort(1: i32 aggregatePortID)
     throws (1: fboss.FbossBaseError error)
   list<AggregatePortThrift> getAggregatePortTable()
@@ -838,6 +976,11 @@ service FbossCtrl extends fb303.FacebookService {
   string listHwObjects(1: list<HwObjectType> objects, 2: bool cached)
     throws (1: fboss.FbossBaseError error)
 
+  /*
+   * Count and latency of the SDK calls made so far, per API and operation
+   */
+  string getSdkCallProfile()
+
   /*
    * Type of boot performed by the controller
    */
@@ -869,6 +1012,12 @@ service FbossCtrl extends fb303.FacebookService {
 
   list<RouteUpdateLoggingInfo> getRouteUpdateLoggingTrackedPrefixes()
 
+  /*
+   * Returns the traces of the last count route updates, most recent first
+   */
+  list<RouteUpdateTrace> getRouteUpdateTraces(1: i32 count)
+    throws (1: fboss.FbossBaseError error)
+
   /*
    * Log all updates to mpls routes for given label
    */
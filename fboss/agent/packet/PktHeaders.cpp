@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/PktHeaders.h"
+
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <folly/Bits.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+using folly::ByteRange;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+using folly::MacAddress;
+
+namespace facebook::fboss {
+
+namespace {
+constexpr size_t kEthHdrSize = 14;
+constexpr size_t kVlanTagSize = 4;
+constexpr size_t kIPv4MinHdrSize = 20;
+constexpr size_t kIPv6HdrSize = 40;
+constexpr size_t kUdpHdrSize = 8;
+constexpr size_t kTcpMinHdrSize = 20;
+constexpr size_t kIcmpHdrSize = 4;
+
+uint16_t readBE16(const uint8_t* data) {
+  return folly::Endian::big(folly::loadUnaligned<uint16_t>(data));
+}
+} // namespace
+
+PktHeaders::Layer PktHeaders::parse(ByteRange packet, Layer maxLayer) {
+  if (packet.size() < kEthHdrSize) {
+    return Layer::NONE;
+  }
+  const auto* data = packet.data();
+  auto type = readBE16(data + 2 * MacAddress::SIZE);
+  size_t offset = kEthHdrSize;
+  if (type == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN)) {
+    if (packet.size() < kEthHdrSize + kVlanTagSize) {
+      return Layer::NONE;
+    }
+    vlanID = readBE16(data + kEthHdrSize) & 0xfff;
+    type = readBE16(data + kEthHdrSize + 2);
+    offset += kVlanTagSize;
+  }
+  dstMac = MacAddress::fromBinary(ByteRange(data, MacAddress::SIZE));
+  srcMac = MacAddress::fromBinary(
+      ByteRange(data + MacAddress::SIZE, MacAddress::SIZE));
+  ethertype = type;
+  l3Offset = offset;
+  if (maxLayer == Layer::L2) {
+    return Layer::L2;
+  }
+  return parseL3(packet, maxLayer);
+}
+
+PktHeaders::Layer PktHeaders::parse(
+    const folly::IOBuf* buf,
+    Layer maxLayer) {
+  if (!buf->isChained() || buf->length() >= kMaxHeaderSize) {
+    return parse(ByteRange(buf->data(), buf->length()), maxLayer);
+  }
+  uint8_t headers[kMaxHeaderSize];
+  folly::io::Cursor cursor(buf);
+  auto length = cursor.pullAtMost(headers, kMaxHeaderSize);
+  return parse(ByteRange(headers, length), maxLayer);
+}
+
+PktHeaders::Layer PktHeaders::parseL3(ByteRange packet, Layer maxLayer) {
+  const auto* data = packet.data() + l3Offset;
+  size_t length = packet.size() - l3Offset;
+
+  switch (static_cast<ETHERTYPE>(ethertype)) {
+    case ETHERTYPE::ETHERTYPE_IPV4: {
+      if (length < kIPv4MinHdrSize || (data[0] >> 4) != 4) {
+        return Layer::L2;
+      }
+      size_t hdrSize = (data[0] & 0xf) * 4;
+      if (hdrSize < kIPv4MinHdrSize || length < hdrSize) {
+        return Layer::L2;
+      }
+      size_t totalLength = readBE16(data + 2);
+      ipVersion = 4;
+      hopLimit = data[8];
+      ipProto = data[9];
+      ipChecksumValid = PktUtil::internetChecksum(data, hdrSize) == 0;
+      srcIP = IPAddressV4::fromBinary(ByteRange(data + 12, 4));
+      dstIP = IPAddressV4::fromBinary(ByteRange(data + 16, 4));
+      l4Offset = l3Offset + hdrSize;
+      l4Length = totalLength > hdrSize ? totalLength - hdrSize : 0;
+      break;
+    }
+    case ETHERTYPE::ETHERTYPE_IPV6:
+      if (length < kIPv6HdrSize || (data[0] >> 4) != 6) {
+        return Layer::L2;
+      }
+      ipVersion = 6;
+      l4Length = readBE16(data + 4);
+      ipProto = data[6];
+      hopLimit = data[7];
+      srcIP = IPAddressV6::fromBinary(ByteRange(data + 8, 16));
+      dstIP = IPAddressV6::fromBinary(ByteRange(data + 24, 16));
+      l4Offset = l3Offset + kIPv6HdrSize;
+      break;
+    default:
+      return Layer::L2;
+  }
+  if (maxLayer == Layer::L3) {
+    return Layer::L3;
+  }
+  return parseL4(packet);
+}
+
+PktHeaders::Layer PktHeaders::parseL4(ByteRange packet) {
+  const auto* data = packet.data() + l4Offset;
+  size_t length = packet.size() - l4Offset;
+
+  switch (static_cast<IP_PROTO>(ipProto)) {
+    case IP_PROTO::IP_PROTO_UDP:
+      if (length < kUdpHdrSize) {
+        return Layer::L3;
+      }
+      srcPort = readBE16(data);
+      dstPort = readBE16(data + 2);
+      payloadOffset = l4Offset + kUdpHdrSize;
+      break;
+    case IP_PROTO::IP_PROTO_TCP: {
+      if (length < kTcpMinHdrSize) {
+        return Layer::L3;
+      }
+      size_t hdrSize = (data[12] >> 4) * 4;
+      if (hdrSize < kTcpMinHdrSize || length < hdrSize) {
+        return Layer::L3;
+      }
+      srcPort = readBE16(data);
+      dstPort = readBE16(data + 2);
+      payloadOffset = l4Offset + hdrSize;
+      break;
+    }
+    case IP_PROTO::IP_PROTO_ICMP:
+    case IP_PROTO::IP_PROTO_IPV6_ICMP: {
+      auto icmpProto =
+          isIPv4() ? IP_PROTO::IP_PROTO_ICMP : IP_PROTO::IP_PROTO_IPV6_ICMP;
+      if (static_cast<IP_PROTO>(ipProto) != icmpProto ||
+          length < kIcmpHdrSize) {
+        return Layer::L3;
+      }
+      icmpType = data[0];
+      icmpCode = data[1];
+      payloadOffset = l4Offset + kIcmpHdrSize;
+      break;
+    }
+    default:
+      return Layer::L3;
+  }
+  return Layer::L4;
+}
+
+} // namespace facebook::fboss
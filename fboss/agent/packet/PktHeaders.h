@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/Range.h>
+
+#include <optional>
+
+namespace folly {
+class IOBuf;
+} // namespace folly
+
+namespace facebook::fboss {
+
+/*
+ * The Ethernet, IP and transport headers of a packet, parsed in a single
+ * pass over the contiguous start of the packet.
+ *
+ * EthHdr, IPv4Hdr, IPv6Hdr, UDPHeader and ICMPHdr each read all of their
+ * fields through a Cursor, which is what the packet handlers need, but is
+ * slow for just telling what a packet is. This only keeps the fields the
+ * slow path dispatches on, along with the offsets of the headers, so that
+ * the header classes can pick up where it left off for the rest.
+ *
+ * IPv6 extension headers are not followed: for such packets, ipProto is
+ * the type of the first extension header and there is no L4 header.
+ */
+class PktHeaders {
+ public:
+  /*
+   * Enough for an Ethernet header with a VLAN tag, followed by IPv4 and TCP
+   * headers with the most options: the most parse() looks at.
+   */
+  static constexpr size_t kMaxHeaderSize = 18 + 60 + 60;
+
+  enum class Layer : uint8_t {
+    NONE,
+    L2,
+    L3,
+    L4,
+  };
+
+  /*
+   * Parse the headers at the start of a packet, up to maxLayer. Returns the
+   * last layer of which the headers were entirely in the packet, which may
+   * be below the layer the packet claims to carry. The fields of the layers
+   * above the one returned are left unset.
+   */
+  Layer parse(folly::ByteRange packet, Layer maxLayer = Layer::L4);
+  /*
+   * Same for a possibly chained buffer, copying the start of the packet if
+   * it is not contiguous.
+   */
+  Layer parse(const folly::IOBuf* buf, Layer maxLayer = Layer::L4);
+
+  bool isIPv4() const {
+    return ipVersion == 4;
+  }
+  bool isIPv6() const {
+    return ipVersion == 6;
+  }
+
+  // L2
+  folly::MacAddress dstMac;
+  folly::MacAddress srcMac;
+  std::optional<uint16_t> vlanID;
+  // Of the payload, after the VLAN tag if any
+  uint16_t ethertype{0};
+  uint16_t l3Offset{0};
+
+  // L3, for IPv4 and IPv6
+  uint8_t ipVersion{0};
+  uint8_t ipProto{0};
+  // TTL for IPv4
+  uint8_t hopLimit{0};
+  // For IPv4, whether the header checksum is right
+  bool ipChecksumValid{false};
+  folly::IPAddress srcIP;
+  folly::IPAddress dstIP;
+  uint16_t l4Offset{0};
+  // Of the IP payload, as told by the IP header
+  uint16_t l4Length{0};
+
+  // L4, for UDP, TCP, ICMP and ICMPv6
+  uint16_t srcPort{0};
+  uint16_t dstPort{0};
+  uint8_t icmpType{0};
+  uint8_t icmpCode{0};
+  uint16_t payloadOffset{0};
+
+ private:
+  Layer parseL3(folly::ByteRange packet, Layer maxLayer);
+  Layer parseL4(folly::ByteRange packet);
+};
+
+} // namespace facebook::fboss
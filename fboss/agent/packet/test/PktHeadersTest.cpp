@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/PktHeaders.h"
+
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/io/IOBuf.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::ByteRange;
+using folly::IOBuf;
+using folly::IPAddress;
+using folly::MacAddress;
+using Layer = PktHeaders::Layer;
+
+namespace {
+
+IOBuf udpPacket() {
+  return PktUtil::parseHexData(
+      // dst mac, src mac
+      "02 00 00 00 00 01  02 00 00 00 00 02"
+      // 802.1q, VLAN 5
+      "81 00  00 05"
+      // IPv4
+      "08 00"
+      // version, ihl, dscp, total length: 28
+      "45 00 00 1c"
+      // id, flags, ttl: 64, proto: UDP, checksum
+      "00 00 00 00 40 11 66 cf"
+      // src ip: 10.0.0.1, dst ip: 10.0.0.2
+      "0a 00 00 01  0a 00 00 02"
+      // src port: 68, dst port: 67, length, checksum
+      "00 44 00 43 00 08 00 00");
+}
+
+IOBuf ndpPacket() {
+  return PktUtil::parseHexData(
+      // dst mac, src mac
+      "33 33 ff 00 00 01  02 00 00 00 00 02"
+      // IPv6
+      "86 dd"
+      // version, traffic class, flow label
+      "60 00 00 00"
+      // payload length: 24, next header: ICMPv6, hop limit: 255
+      "00 18 3a ff"
+      // src ip: fe80::2
+      "fe 80 00 00 00 00 00 00  00 00 00 00 00 00 00 02"
+      // dst ip: ff02::1:ff00:1
+      "ff 02 00 00 00 00 00 00  00 00 00 01 ff 00 00 01"
+      // type: neighbor solicitation, code, checksum
+      "87 00 00 00"
+      // reserved
+      "00 00 00 00"
+      // target: fe80::1
+      "fe 80 00 00 00 00 00 00  00 00 00 00 00 00 00 01");
+}
+
+} // namespace
+
+TEST(PktHeadersTest, Arp) {
+  auto buf = PktUtil::parseHexData(
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // ARP, htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "08 06  00 01  08 00  06  04"
+      // ARP Request
+      "00 01"
+      // Sender MAC, sender IP
+      "00 02 00 01 02 03  0a 00 01 0f"
+      // Target MAC, target IP
+      "00 00 00 00 00 00  0a 00 00 01");
+
+  PktHeaders headers;
+  EXPECT_EQ(Layer::L2, headers.parse(&buf));
+  EXPECT_EQ(MacAddress::BROADCAST, headers.dstMac);
+  EXPECT_EQ(MacAddress("00:02:00:01:02:03"), headers.srcMac);
+  EXPECT_FALSE(headers.vlanID.has_value());
+  EXPECT_EQ(static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_ARP), headers.ethertype);
+  EXPECT_EQ(14, headers.l3Offset);
+  EXPECT_EQ(0, headers.ipVersion);
+}
+
+TEST(PktHeadersTest, Udp) {
+  auto buf = udpPacket();
+
+  PktHeaders headers;
+  EXPECT_EQ(Layer::L4, headers.parse(&buf));
+  EXPECT_EQ(MacAddress("02:00:00:00:00:01"), headers.dstMac);
+  EXPECT_EQ(MacAddress("02:00:00:00:00:02"), headers.srcMac);
+  EXPECT_EQ(5, headers.vlanID.value());
+  EXPECT_EQ(
+      static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4), headers.ethertype);
+  EXPECT_EQ(18, headers.l3Offset);
+
+  EXPECT_TRUE(headers.isIPv4());
+  EXPECT_EQ(static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP), headers.ipProto);
+  EXPECT_EQ(64, headers.hopLimit);
+  EXPECT_TRUE(headers.ipChecksumValid);
+  EXPECT_EQ(IPAddress("10.0.0.1"), headers.srcIP);
+  EXPECT_EQ(IPAddress("10.0.0.2"), headers.dstIP);
+  EXPECT_EQ(38, headers.l4Offset);
+  EXPECT_EQ(8, headers.l4Length);
+
+  EXPECT_EQ(68, headers.srcPort);
+  EXPECT_EQ(67, headers.dstPort);
+  EXPECT_EQ(46, headers.payloadOffset);
+}
+
+TEST(PktHeadersTest, BadIPv4Checksum) {
+  auto buf = udpPacket();
+  // Change the TTL without updating the checksum
+  buf.writableData()[26] = 63;
+
+  PktHeaders headers;
+  EXPECT_EQ(Layer::L4, headers.parse(&buf));
+  EXPECT_EQ(63, headers.hopLimit);
+  EXPECT_FALSE(headers.ipChecksumValid);
+}
+
+TEST(PktHeadersTest, Ndp) {
+  auto buf = ndpPacket();
+
+  PktHeaders headers;
+  EXPECT_EQ(Layer::L4, headers.parse(&buf));
+  EXPECT_FALSE(headers.vlanID.has_value());
+  EXPECT_EQ(
+      static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6), headers.ethertype);
+  EXPECT_TRUE(headers.isIPv6());
+  EXPECT_EQ(
+      static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP), headers.ipProto);
+  EXPECT_EQ(255, headers.hopLimit);
+  EXPECT_EQ(IPAddress("fe80::2"), headers.srcIP);
+  EXPECT_EQ(IPAddress("ff02::1:ff00:1"), headers.dstIP);
+  EXPECT_EQ(54, headers.l4Offset);
+  EXPECT_EQ(24, headers.l4Length);
+  EXPECT_EQ(135, headers.icmpType);
+  EXPECT_EQ(0, headers.icmpCode);
+  EXPECT_EQ(58, headers.payloadOffset);
+}
+
+TEST(PktHeadersTest, Truncated) {
+  auto buf = udpPacket();
+  ByteRange packet(buf.data(), buf.length());
+
+  // Each layer is only parsed when it is all there
+  EXPECT_EQ(Layer::NONE, PktHeaders().parse(packet.subpiece(0, 13)));
+  EXPECT_EQ(Layer::NONE, PktHeaders().parse(packet.subpiece(0, 17)));
+  EXPECT_EQ(Layer::L2, PktHeaders().parse(packet.subpiece(0, 37)));
+  EXPECT_EQ(Layer::L3, PktHeaders().parse(packet.subpiece(0, 45)));
+  EXPECT_EQ(Layer::L4, PktHeaders().parse(packet.subpiece(0, 46)));
+
+  PktHeaders headers;
+  EXPECT_EQ(Layer::L3, headers.parse(packet.subpiece(0, 45)));
+  EXPECT_EQ(IPAddress("10.0.0.2"), headers.dstIP);
+  EXPECT_EQ(0, headers.srcPort);
+  EXPECT_EQ(0, headers.dstPort);
+}
+
+TEST(PktHeadersTest, MaxLayer) {
+  auto buf = udpPacket();
+
+  PktHeaders l2;
+  EXPECT_EQ(Layer::L2, l2.parse(&buf, Layer::L2));
+  EXPECT_EQ(MacAddress("02:00:00:00:00:02"), l2.srcMac);
+  EXPECT_EQ(18, l2.l3Offset);
+  EXPECT_EQ(0, l2.ipVersion);
+
+  PktHeaders l3;
+  EXPECT_EQ(Layer::L3, l3.parse(&buf, Layer::L3));
+  EXPECT_EQ(IPAddress("10.0.0.2"), l3.dstIP);
+  EXPECT_EQ(0, l3.dstPort);
+
+  // Still NONE for runts
+  ByteRange packet(buf.data(), buf.length());
+  EXPECT_EQ(
+      Layer::NONE, PktHeaders().parse(packet.subpiece(0, 13), Layer::L2));
+}
+
+TEST(PktHeadersTest, Chained) {
+  auto whole = ndpPacket();
+  // Split in the middle of the IPv6 source address
+  auto buf = IOBuf::copyBuffer(whole.data(), 30);
+  buf->appendChain(IOBuf::copyBuffer(whole.data() + 30, whole.length() - 30));
+  ASSERT_TRUE(buf->isChained());
+
+  PktHeaders expected;
+  PktHeaders headers;
+  EXPECT_EQ(Layer::L4, expected.parse(&whole));
+  EXPECT_EQ(Layer::L4, headers.parse(buf.get()));
+  EXPECT_EQ(expected.srcIP, headers.srcIP);
+  EXPECT_EQ(expected.dstIP, headers.dstIP);
+  EXPECT_EQ(expected.icmpType, headers.icmpType);
+  EXPECT_EQ(expected.payloadOffset, headers.payloadOffset);
+}
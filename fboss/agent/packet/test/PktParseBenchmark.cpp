@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/init/Init.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/PktHeaders.h"
+#include "fboss/agent/packet/PktUtil.h"
+#include "fboss/agent/packet/UDPHeader.h"
+
+#include <folly/Benchmark.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+#include <memory>
+#include <vector>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+using folly::io::Cursor;
+
+namespace {
+
+/*
+ * The kind of packets that make it to the CPU: ARP, NDP and DHCP, and TCP
+ * samples of data plane traffic
+ */
+std::vector<IOBuf> trappedPackets() {
+  std::vector<IOBuf> packets;
+  // ARP request
+  packets.push_back(PktUtil::parseHexData(
+      "ff ff ff ff ff ff  00 02 00 01 02 03  81 00 00 01"
+      "08 06  00 01  08 00  06  04  00 01"
+      "00 02 00 01 02 03  0a 00 00 0f  00 00 00 00 00 00  0a 00 00 01"));
+  // NDP neighbor solicitation
+  packets.push_back(PktUtil::parseHexData(
+      "33 33 ff 00 00 01  02 00 00 00 00 02  81 00 00 01  86 dd"
+      "60 00 00 00  00 18 3a ff"
+      "fe 80 00 00 00 00 00 00  00 00 00 00 00 00 00 02"
+      "ff 02 00 00 00 00 00 00  00 00 00 01 ff 00 00 01"
+      "87 00 00 00  00 00 00 00"
+      "fe 80 00 00 00 00 00 00  00 00 00 00 00 00 00 01"));
+  // DHCPv4 discover, headers only
+  packets.push_back(PktUtil::parseHexData(
+      "ff ff ff ff ff ff  02 00 00 00 00 02  81 00 00 01  08 00"
+      "45 00 01 48  00 00 00 00  40 11 79 a6"
+      "00 00 00 00  ff ff ff ff"
+      "00 44 00 43  01 34 00 00"));
+  // TCP, as sampled
+  auto tcp = PktUtil::parseHexData(
+      "02 00 00 00 00 01  02 00 00 00 00 02  81 00 00 01  86 dd"
+      "60 00 00 00  05 c8 06 40"
+      "20 01 0d b8 00 00 00 00  00 00 00 00 00 00 00 01"
+      "20 01 0d b8 00 00 00 00  00 00 00 00 00 00 00 02"
+      "c3 50 01 bb  00 00 00 01  00 00 00 01  50 10 ff ff  00 00 00 00");
+  tcp.reserve(0, 1448);
+  tcp.append(1448);
+  packets.push_back(std::move(tcp));
+  return packets;
+}
+
+const std::vector<IOBuf>& packets() {
+  static const auto kPackets = trappedPackets();
+  return kPackets;
+}
+
+// What SwSwitch and the packet handlers did to tell the packets apart
+void parseWithCursor(const IOBuf* buf) {
+  Cursor cursor(buf);
+  EthHdr ethHdr(cursor);
+  switch (static_cast<ETHERTYPE>(ethHdr.getEtherType())) {
+    case ETHERTYPE::ETHERTYPE_IPV4: {
+      IPv4Hdr ipHdr(cursor);
+      if (ipHdr.protocol == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) {
+        UDPHeader udpHdr;
+        udpHdr.parse(&cursor);
+        folly::doNotOptimizeAway(udpHdr);
+      }
+      folly::doNotOptimizeAway(ipHdr);
+      break;
+    }
+    case ETHERTYPE::ETHERTYPE_IPV6: {
+      IPv6Hdr ipHdr(cursor);
+      if (ipHdr.nextHeader ==
+          static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP)) {
+        ICMPHdr icmpHdr(cursor);
+        folly::doNotOptimizeAway(icmpHdr);
+      }
+      folly::doNotOptimizeAway(ipHdr);
+      break;
+    }
+    default:
+      break;
+  }
+  folly::doNotOptimizeAway(ethHdr);
+}
+
+void checksumBenchmark(size_t iters, size_t size, size_t numChunks) {
+  std::unique_ptr<IOBuf> buf;
+  BENCHMARK_SUSPEND {
+    auto chunkSize = size / numChunks;
+    for (size_t i = 0; i < numChunks; ++i) {
+      auto length = i + 1 == numChunks ? size - i * chunkSize : chunkSize;
+      auto chunk = IOBuf::create(length);
+      chunk->append(length);
+      for (size_t j = 0; j < length; ++j) {
+        chunk->writableData()[j] = i * chunkSize + j;
+      }
+      if (buf) {
+        buf->prependChain(std::move(chunk));
+      } else {
+        buf = std::move(chunk);
+      }
+    }
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(PktUtil::internetChecksum(buf.get()));
+  }
+}
+
+} // namespace
+
+BENCHMARK(ParseWithCursor, iters) {
+  const auto& pkts = packets();
+  for (size_t i = 0; i < iters; ++i) {
+    parseWithCursor(&pkts[i % pkts.size()]);
+  }
+}
+
+BENCHMARK_RELATIVE(ParseWithPktHeaders, iters) {
+  const auto& pkts = packets();
+  for (size_t i = 0; i < iters; ++i) {
+    PktHeaders headers;
+    folly::doNotOptimizeAway(headers.parse(&pkts[i % pkts.size()]));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+// Contiguous buffers
+BENCHMARK_NAMED_PARAM(checksumBenchmark, 64, 64, 1)
+BENCHMARK_NAMED_PARAM(checksumBenchmark, 512, 512, 1)
+BENCHMARK_NAMED_PARAM(checksumBenchmark, 1500, 1500, 1)
+BENCHMARK_NAMED_PARAM(checksumBenchmark, 9000, 9000, 1)
+
+BENCHMARK_DRAW_LINE();
+
+// Chained buffers, with chunks of odd lengths
+BENCHMARK_NAMED_PARAM(checksumBenchmark, 1500_4_chunks, 1500, 4)
+BENCHMARK_NAMED_PARAM(checksumBenchmark, 9000_7_chunks, 9000, 7)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
@@ -18,6 +18,9 @@
 #include <folly/logging/xlog.h>
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <vector>
+
 using namespace facebook::fboss;
 using folly::IOBuf;
 using folly::IPAddressV4;
@@ -222,3 +225,32 @@ TEST(Checksum, TestKnownOdd) {
   expected = ~expected;
   EXPECT_EQ(expected, PktUtil::internetChecksum(bytes, 9));
 }
+
+TEST(Checksum, TestChained) {
+  // Long enough for the vectorized sum to be used, and split at odd and even
+  // offsets so that the chunks are added up in both byte orders
+  for (auto size : {1, 2, 31, 64, 513, 1500, 9001}) {
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes) {
+      byte = Random::rand32(std::numeric_limits<uint8_t>::max() + 1);
+    }
+    auto expected = PktUtil::internetChecksum(bytes.data(), size);
+
+    for (auto split : {1, 2, 7, size / 2, size - 1}) {
+      if (split <= 0 || split >= size) {
+        continue;
+      }
+      auto buf = IOBuf::copyBuffer(bytes.data(), split);
+      buf->appendChain(
+          IOBuf::copyBuffer(bytes.data() + split, size - split));
+      EXPECT_EQ(expected, PktUtil::internetChecksum(buf.get()))
+          << "size " << size << " split " << split;
+    }
+  }
+}
+
+TEST(Checksum, TestAllOnes) {
+  // The most carries there can be
+  std::vector<uint8_t> bytes(1 << 20, 0xff);
+  EXPECT_EQ(0, PktUtil::internetChecksum(bytes.data(), bytes.size()));
+}
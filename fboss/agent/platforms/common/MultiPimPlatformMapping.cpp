@@ -21,6 +21,17 @@ namespace fboss {
 MultiPimPlatformMapping::MultiPimPlatformMapping(
     const std::string& jsonPlatformMappingStr)
     : PlatformMapping(jsonPlatformMappingStr) {
+  initPims();
+}
+
+MultiPimPlatformMapping::MultiPimPlatformMapping(
+    folly::StringPiece jsonPlatformMappingStr,
+    folly::StringPiece precompiledName)
+    : PlatformMapping(jsonPlatformMappingStr, precompiledName) {
+  initPims();
+}
+
+void MultiPimPlatformMapping::initPims() {
   for (auto& port : platformPorts_) {
     int portPimID = getPimID(port.second);
 
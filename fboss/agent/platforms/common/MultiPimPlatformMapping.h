@@ -17,6 +17,9 @@ namespace fboss {
 class MultiPimPlatformMapping : public PlatformMapping {
  public:
   explicit MultiPimPlatformMapping(const std::string& jsonPlatformMappingStr);
+  MultiPimPlatformMapping(
+      folly::StringPiece jsonPlatformMappingStr,
+      folly::StringPiece precompiledName);
 
   PlatformMapping* getPimPlatformMapping(uint8_t pimID);
 
@@ -24,6 +27,8 @@ class MultiPimPlatformMapping : public PlatformMapping {
   std::map<uint8_t, std::unique_ptr<PlatformMapping>> pims_;
 
  private:
+  void initPims();
+
   // Forbidden copy constructor and assignment operator
   MultiPimPlatformMapping(MultiPimPlatformMapping const&) = delete;
   MultiPimPlatformMapping& operator=(MultiPimPlatformMapping const&) = delete;
@@ -16,15 +16,36 @@
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/platforms/common/PrecompiledPlatformMapping.h"
 
 DEFINE_bool(
     override_cmis_tx_setting,
     false,
     "Flag to turn on new GB line tx setting for cmis module running in 100G");
 
+DEFINE_bool(
+    use_precompiled_platform_mapping,
+    true,
+    "Load platform mappings from the thrift compact blobs precompiled at "
+    "build time instead of parsing their JSON, when available");
+
 namespace {
 constexpr auto kFbossPortNameRegex = "eth(\\d+)/(\\d+)/(\\d+)";
 const re2::RE2 portNameRegex(kFbossPortNameRegex);
+
+facebook::fboss::cfg::PlatformMapping loadPlatformMapping(
+    folly::StringPiece jsonPlatformMappingStr,
+    folly::StringPiece precompiledName) {
+  if (FLAGS_use_precompiled_platform_mapping) {
+    if (auto compact = facebook::fboss::findPrecompiledPlatformMapping(
+            precompiledName, jsonPlatformMappingStr.size())) {
+      return apache::thrift::CompactSerializer::deserialize<
+          facebook::fboss::cfg::PlatformMapping>(*compact);
+    }
+  }
+  return apache::thrift::SimpleJSONSerializer::deserialize<
+      facebook::fboss::cfg::PlatformMapping>(jsonPlatformMappingStr);
+}
 } // namespace
 
 namespace facebook {
@@ -114,10 +135,13 @@ std::string PlatformPortProfileConfigMatcher::toString() const {
       .str();
 }
 
-PlatformMapping::PlatformMapping(const std::string& jsonPlatformMappingStr) {
-  auto mapping =
-      apache::thrift::SimpleJSONSerializer::deserialize<cfg::PlatformMapping>(
-          jsonPlatformMappingStr);
+PlatformMapping::PlatformMapping(const std::string& jsonPlatformMappingStr)
+    : PlatformMapping(folly::StringPiece(jsonPlatformMappingStr), "") {}
+
+PlatformMapping::PlatformMapping(
+    folly::StringPiece jsonPlatformMappingStr,
+    folly::StringPiece precompiledName) {
+  auto mapping = loadPlatformMapping(jsonPlatformMappingStr, precompiledName);
   platformPorts_ = std::move(*mapping.ports_ref());
   platformSupportedProfiles_ =
       std::move(*mapping.platformSupportedProfiles_ref());
@@ -13,7 +13,10 @@
 #include "fboss/agent/types.h"
 #include "fboss/qsfp_service/if/gen-cpp2/transceiver_types.h"
 
+#include <folly/Range.h>
+
 DECLARE_bool(override_cmis_tx_setting);
+DECLARE_bool(use_precompiled_platform_mapping);
 
 namespace facebook {
 namespace fboss {
@@ -70,6 +73,14 @@ class PlatformMapping {
  public:
   PlatformMapping() {}
   explicit PlatformMapping(const std::string& jsonPlatformMappingStr);
+  /*
+   * Loads the mapping precompiled from jsonPlatformMappingStr at build time
+   * under precompiledName (see PrecompiledPlatformMapping.h), and only
+   * parses jsonPlatformMappingStr if there is none.
+   */
+  PlatformMapping(
+      folly::StringPiece jsonPlatformMappingStr,
+      folly::StringPiece precompiledName);
   virtual ~PlatformMapping() = default;
 
   cfg::PlatformMapping toThrift() const;
@@ -0,0 +1,222 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+/*
+ * Build time tool that precompiles the JSON platform mappings embedded in
+ * *PlatformMapping.cpp files into thrift compact protocol.
+ *
+ * platform_mapping_compiler --output <generated.cpp> <mapping.cpp>...
+ *
+ * Every raw string literal in the given sources is parsed as a
+ * cfg::PlatformMapping, which also catches malformed mappings at build
+ * time rather than at agent startup, and the generated source defines
+ * getPrecompiledPlatformMappings() (see PrecompiledPlatformMapping.h).
+ * Each mapping is named after the constant it is assigned to, qualified by
+ * the stem of its source, e.g.
+ * "Wedge100PlatformMapping:kJsonPlatformMappingStr".
+ */
+
+#include "fboss/agent/gen-cpp2/platform_config_types.h"
+
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <sysexits.h>
+#include <algorithm>
+#include <cctype>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+DEFINE_string(output, "", "Path of the C++ source to generate");
+
+using namespace facebook::fboss;
+
+namespace {
+
+constexpr auto kBytesPerLine = 16;
+
+struct EmbeddedMapping {
+  std::string source;
+  int line;
+  std::string name;
+  std::string json;
+};
+
+int lineOf(const std::string& text, size_t pos) {
+  return 1 + std::count(text.begin(), text.begin() + pos, '\n');
+}
+
+std::string stemOf(const std::string& source) {
+  auto begin = source.find_last_of('/');
+  begin = begin == std::string::npos ? 0 : begin + 1;
+  auto end = source.find('.', begin);
+  return source.substr(begin, end == std::string::npos ? end : end - begin);
+}
+
+/*
+ * Name of the constant the raw string literal at pos is assigned to, e.g.
+ * kJsonPlatformMappingStr in constexpr char kJsonPlatformMappingStr[] = R"(
+ */
+std::string constantNameAt(
+    const std::string& source,
+    const std::string& text,
+    size_t pos) {
+  static const std::regex kAssignment("(\\w+)\\s*(\\[\\s*\\])?\\s*=\\s*$");
+  auto lineStart = text.rfind('\n', pos);
+  lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+  std::smatch match;
+  auto line = text.substr(lineStart, pos - lineStart);
+  if (!std::regex_search(line, match, kAssignment)) {
+    throw std::runtime_error(folly::to<std::string>(
+        "Raw string not assigned to a named constant at ",
+        source,
+        ":",
+        lineOf(text, pos)));
+  }
+  return stemOf(source) + ":" + match[1].str();
+}
+
+/*
+ * Extract the contents of all raw string literals, R"delim( ... )delim",
+ * exactly as the compiler would see them.
+ */
+std::vector<EmbeddedMapping> extractRawStrings(const std::string& source) {
+  std::string text;
+  if (!folly::readFile(source.c_str(), text)) {
+    throw std::runtime_error(
+        folly::to<std::string>("Unable to read ", source));
+  }
+  std::vector<EmbeddedMapping> mappings;
+  size_t pos = 0;
+  while ((pos = text.find("R\"", pos)) != std::string::npos) {
+    // Skip identifiers that merely end in R, e.g. FOOR"bar"
+    auto prev = pos > 0 ? static_cast<unsigned char>(text[pos - 1]) : ' ';
+    if (std::isalnum(prev) || prev == '_') {
+      pos += 2;
+      continue;
+    }
+    auto open = text.find('(', pos + 2);
+    if (open == std::string::npos) {
+      break;
+    }
+    auto delim = text.substr(pos + 2, open - pos - 2);
+    auto terminator = ")" + delim + "\"";
+    auto close = text.find(terminator, open + 1);
+    if (close == std::string::npos) {
+      throw std::runtime_error(folly::to<std::string>(
+          "Unterminated raw string at ", source, ":", lineOf(text, pos)));
+    }
+    mappings.push_back(EmbeddedMapping{
+        source,
+        lineOf(text, pos),
+        constantNameAt(source, text, pos),
+        text.substr(open + 1, close - open - 1)});
+    pos = close + terminator.size();
+  }
+  return mappings;
+}
+
+std::string toStringLiteral(const std::string& bytes) {
+  std::string literal;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    if (i % kBytesPerLine == 0) {
+      literal += i == 0 ? "    \"" : "\"\n    \"";
+    }
+    // Hex escape every byte so no escape can swallow a following character
+    auto byte = static_cast<unsigned int>(static_cast<uint8_t>(bytes[i]));
+    literal += folly::sformat("\\x{:02x}", byte);
+  }
+  return literal + "\"";
+}
+
+std::string generate(const std::vector<EmbeddedMapping>& mappings) {
+  std::string blobs;
+  std::string entries;
+  std::set<std::string> names;
+  for (size_t i = 0; i < mappings.size(); ++i) {
+    const auto& mapping = mappings[i];
+    if (!names.insert(mapping.name).second) {
+      throw std::runtime_error(folly::to<std::string>(
+          "Duplicate platform mapping name ",
+          mapping.name,
+          " at ",
+          mapping.source,
+          ":",
+          mapping.line));
+    }
+    auto thriftMapping = apache::thrift::SimpleJSONSerializer::deserialize<
+        cfg::PlatformMapping>(mapping.json);
+    auto compact =
+        apache::thrift::CompactSerializer::serialize<std::string>(
+            thriftMapping);
+    XLOG(INFO) << mapping.name << " " << mapping.json.size()
+               << " bytes of JSON -> " << compact.size() << " bytes compact";
+
+    blobs += folly::sformat(
+        "// {}:{}\nconstexpr char kCompact{}[] =\n{};\n\n",
+        mapping.source,
+        mapping.line,
+        i,
+        toStringLiteral(compact));
+    entries += folly::sformat(
+        "    {{\"{}\", {}, kCompact{}, sizeof(kCompact{}) - 1}},\n",
+        mapping.name,
+        mapping.json.size(),
+        i,
+        i);
+  }
+
+  std::string out =
+      "// @" "generated by platform_mapping_compiler, do not edit.\n\n"
+      "#include \"fboss/agent/platforms/common/"
+      "PrecompiledPlatformMapping.h\"\n\n"
+      "namespace facebook {\nnamespace fboss {\n\n";
+  if (mappings.empty()) {
+    return out +
+        "folly::Range<const PrecompiledPlatformMapping*>\n"
+        "getPrecompiledPlatformMappings() {\n  return {};\n}\n\n"
+        "} // namespace fboss\n} // namespace facebook\n";
+  }
+  return out + "namespace {\n" + blobs +
+      "constexpr PrecompiledPlatformMapping kPrecompiledMappings[] = {\n" +
+      entries +
+      "};\n} // namespace\n\n"
+      "folly::Range<const PrecompiledPlatformMapping*>\n"
+      "getPrecompiledPlatformMappings() {\n"
+      "  return folly::range(kPrecompiledMappings);\n}\n\n"
+      "} // namespace fboss\n} // namespace facebook\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  folly::init(&argc, &argv, true);
+  if (FLAGS_output.empty()) {
+    XLOG(ERR) << "--output is required";
+    return EX_USAGE;
+  }
+  std::vector<EmbeddedMapping> mappings;
+  for (int i = 1; i < argc; ++i) {
+    auto sourceMappings = extractRawStrings(argv[i]);
+    mappings.insert(
+        mappings.end(), sourceMappings.begin(), sourceMappings.end());
+  }
+  if (!folly::writeFile(generate(mappings), FLAGS_output.c_str())) {
+    XLOG(ERR) << "Unable to write " << FLAGS_output;
+    return EX_CANTCREAT;
+  }
+  return EX_OK;
+}
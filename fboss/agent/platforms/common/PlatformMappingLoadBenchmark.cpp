@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/platforms/common/PlatformMapping.h"
+#include "fboss/agent/platforms/common/PlatformMode.h"
+#include "fboss/agent/platforms/common/galaxy/GalaxyFCPlatformMapping.h"
+#include "fboss/agent/platforms/common/wedge100/Wedge100PlatformMapping.h"
+#include "fboss/agent/platforms/common/wedge40/Wedge40PlatformMapping.h"
+#include "fboss/agent/platforms/common/wedge400c/Wedge400CPlatformMapping.h"
+#include "fboss/agent/platforms/wedge/elbert/Elbert16QPimPlatformMapping.h"
+#include "fboss/agent/platforms/wedge/fuji/Fuji16QPimPlatformMapping.h"
+#include "fboss/agent/platforms/wedge/minipack/Minipack16QPimPlatformMapping.h"
+#include "fboss/agent/platforms/wedge/wedge400/Wedge400PlatformMapping.h"
+#include "fboss/agent/platforms/wedge/yamp/Yamp16QPimPlatformMapping.h"
+
+#include <folly/Benchmark.h>
+#include <folly/dynamic.h>
+#include <folly/json.h>
+#include <folly/logging/xlog.h>
+
+#include <chrono>
+#include <iostream>
+
+DEFINE_bool(json, true, "Output in json form");
+
+using namespace facebook::fboss;
+
+namespace {
+
+/*
+ * Measure the time it takes to construct a platform mapping, which is what
+ * every agent and test binary pays at startup, either from the thrift
+ * compact blobs precompiled at build time or by parsing the embedded JSON.
+ */
+template <typename PlatformMappingT, typename... Args>
+void platformMappingLoadBenchmark(
+    const std::string& name,
+    bool precompiled,
+    Args&&... args) {
+  folly::BenchmarkSuspender suspender;
+  auto oldPrecompiled = FLAGS_use_precompiled_platform_mapping;
+  FLAGS_use_precompiled_platform_mapping = precompiled;
+  std::unique_ptr<PlatformMappingT> mapping;
+
+  suspender.dismiss();
+  auto startTime = std::chrono::steady_clock::now();
+  mapping = std::make_unique<PlatformMappingT>(std::forward<Args>(args)...);
+  std::chrono::duration<double, std::milli> durationMillseconds =
+      std::chrono::steady_clock::now() - startTime;
+  suspender.rehire();
+
+  folly::doNotOptimizeAway(mapping->getPlatformPorts().size());
+  FLAGS_use_precompiled_platform_mapping = oldPrecompiled;
+  if (FLAGS_json) {
+    folly::dynamic loadTime = folly::dynamic::object;
+    loadTime["platform_mapping"] = name;
+    loadTime["precompiled"] = precompiled;
+    loadTime["load_msecs"] = durationMillseconds.count();
+    std::cout << loadTime << std::endl;
+  } else {
+    XLOG(INFO) << name << (precompiled ? " precompiled" : " json")
+               << " load msecs: " << durationMillseconds.count();
+  }
+}
+
+} // namespace
+
+#define PLATFORM_MAPPING_LOAD_BENCHMARK(name, ...)                          \
+  BENCHMARK(name##Json) {                                                   \
+    platformMappingLoadBenchmark<name>(#name, false, ##__VA_ARGS__);        \
+  }                                                                         \
+  BENCHMARK_RELATIVE(name##Precompiled) {                                   \
+    platformMappingLoadBenchmark<name>(#name, true, ##__VA_ARGS__);         \
+  }
+
+PLATFORM_MAPPING_LOAD_BENCHMARK(Wedge40PlatformMapping)
+PLATFORM_MAPPING_LOAD_BENCHMARK(Wedge100PlatformMapping)
+// The fabric card name gets substituted into the JSON, only the default
+// card matches what was precompiled
+PLATFORM_MAPPING_LOAD_BENCHMARK(GalaxyFCPlatformMapping, std::string("fc001"))
+PLATFORM_MAPPING_LOAD_BENCHMARK(Wedge400PlatformMapping)
+PLATFORM_MAPPING_LOAD_BENCHMARK(Wedge400CPlatformMapping)
+PLATFORM_MAPPING_LOAD_BENCHMARK(Elbert16QPimPlatformMapping)
+PLATFORM_MAPPING_LOAD_BENCHMARK(Fuji16QPimPlatformMapping)
+PLATFORM_MAPPING_LOAD_BENCHMARK(Yamp16QPimPlatformMapping)
+PLATFORM_MAPPING_LOAD_BENCHMARK(
+    Minipack16QPimPlatformMapping,
+    ExternalPhyVersion::MILN5_2)
@@ -0,0 +1,33 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/platforms/common/PrecompiledPlatformMapping.h"
+
+namespace facebook {
+namespace fboss {
+
+std::optional<folly::ByteRange> findPrecompiledPlatformMapping(
+    folly::StringPiece name,
+    size_t jsonSize) {
+  if (name.empty()) {
+    return std::nullopt;
+  }
+  for (const auto& mapping : getPrecompiledPlatformMappings()) {
+    if (name == mapping.name && mapping.jsonSize == jsonSize) {
+      return folly::ByteRange(
+          reinterpret_cast<const uint8_t*>(mapping.compact),
+          mapping.compactSize);
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Platform mappings are authored as JSON embedded in the
+ * *PlatformMapping.cpp files, which for the larger platforms takes a
+ * noticeable amount of time to parse on every agent and test startup.
+ *
+ * At build time platform_mapping_compiler re-serializes each of those JSON
+ * blobs into thrift compact protocol and emits a table of them, keyed by
+ * the name of the constant holding the JSON, qualified by the stem of its
+ * source, e.g. "Wedge100PlatformMapping:kJsonPlatformMappingStr".
+ * PlatformMapping looks the name it is handed up in that table, so the JSON
+ * is never read on a hit, and only falls back to parsing the JSON on a
+ * miss.
+ */
+struct PrecompiledPlatformMapping {
+  const char* name;
+  // Size of the JSON compiled, to catch a name handed in with other JSON
+  size_t jsonSize;
+  const char* compact;
+  size_t compactSize;
+};
+
+/*
+ * Defined in the PrecompiledPlatformMappings.cpp generated at build time.
+ */
+folly::Range<const PrecompiledPlatformMapping*>
+getPrecompiledPlatformMappings();
+
+/*
+ * Returns the compact serialized form of the platform mapping precompiled
+ * under the given name from jsonSize bytes of JSON, if there is one.
+ */
+std::optional<folly::ByteRange> findPrecompiledPlatformMapping(
+    folly::StringPiece name,
+    size_t jsonSize);
+
+} // namespace fboss
+} // namespace facebook
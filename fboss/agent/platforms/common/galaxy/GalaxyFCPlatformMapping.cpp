@@ -19,7 +19,7 @@
 #include <re2/re2.h>
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -6598,13 +6598,22 @@ std::string updatePlatformMappingStr(const std::string& lcName) {
   boost::replace_all(tmpStr, "fab1", folly::to<std::string>("fab", cardID));
   return tmpStr;
 }
+
+// The JSON is only left as precompiled for the default fabric card
+folly::StringPiece precompiledName(const std::string& cardName) {
+  return cardName == kDefaultFCName
+      ? "GalaxyFCPlatformMapping:kJsonPlatformMappingStr"
+      : "";
+}
 } // namespace
 
 namespace facebook {
 namespace fboss {
 GalaxyFCPlatformMapping::GalaxyFCPlatformMapping(
     const std::string& linecardName)
-    : PlatformMapping(updatePlatformMappingStr(linecardName)) {}
+    : PlatformMapping(
+          updatePlatformMappingStr(linecardName),
+          precompiledName(linecardName)) {}
 
 std::string GalaxyFCPlatformMapping::getFabriccardName() {
   std::string netwhoamiStr;
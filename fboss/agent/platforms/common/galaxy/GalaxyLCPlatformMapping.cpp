@@ -24,7 +24,7 @@ DEFINE_string(
     "The path to the local JSON file");
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -10700,13 +10700,22 @@ std::string updatePlatformMappingStr(const std::string& lcName) {
   boost::replace_all(tmpStr, "eth101", folly::to<std::string>("eth", cardID));
   return tmpStr;
 }
+
+// The JSON is only left as precompiled for the default line card
+folly::StringPiece precompiledName(const std::string& cardName) {
+  return cardName == kDefaultLCName
+      ? "GalaxyLCPlatformMapping:kJsonPlatformMappingStr"
+      : "";
+}
 } // namespace
 
 namespace facebook {
 namespace fboss {
 GalaxyLCPlatformMapping::GalaxyLCPlatformMapping(
     const std::string& linecardName)
-    : PlatformMapping(updatePlatformMappingStr(linecardName)) {}
+    : PlatformMapping(
+          updatePlatformMappingStr(linecardName),
+          precompiledName(linecardName)) {}
 
 std::string GalaxyLCPlatformMapping::getLinecardName() {
   std::string netwhoamiStr;
@@ -11,7 +11,7 @@
 #include "fboss/agent/platforms/common/wedge100/Wedge100PlatformMapping.h"
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -37725,6 +37725,9 @@ constexpr auto kJsonPlatformMappingStr = R"(
 namespace facebook {
 namespace fboss {
 Wedge100PlatformMapping::Wedge100PlatformMapping()
-    : PlatformMapping(kJsonPlatformMappingStr) {}
+    : PlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Wedge100PlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace fboss
 } // namespace facebook
@@ -11,7 +11,7 @@
 #include "fboss/agent/platforms/common/wedge40/Wedge40PlatformMapping.h"
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -8574,6 +8574,9 @@ constexpr auto kJsonPlatformMappingStr = R"(
 namespace facebook {
 namespace fboss {
 Wedge40PlatformMapping::Wedge40PlatformMapping()
-    : PlatformMapping(kJsonPlatformMappingStr) {}
+    : PlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Wedge40PlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace fboss
 } // namespace facebook
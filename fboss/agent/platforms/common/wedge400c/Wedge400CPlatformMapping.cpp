@@ -11,7 +11,7 @@
 #include "fboss/agent/platforms/common/wedge400c/Wedge400CPlatformMapping.h"
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -45956,6 +45956,9 @@ constexpr auto kJsonPlatformMappingStr = R"(
 namespace facebook {
 namespace fboss {
 Wedge400CPlatformMapping::Wedge400CPlatformMapping()
-    : PlatformMapping(kJsonPlatformMappingStr) {}
+    : PlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Wedge400CPlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace fboss
 } // namespace facebook
@@ -11,7 +11,7 @@
 #include "fboss/agent/platforms/wedge/elbert/Elbert16QPimPlatformMapping.h"
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -22929,5 +22929,8 @@ constexpr auto kJsonPlatformMappingStr = R"(
 
 namespace facebook::fboss {
 Elbert16QPimPlatformMapping::Elbert16QPimPlatformMapping()
-    : MultiPimPlatformMapping(kJsonPlatformMappingStr) {}
+    : MultiPimPlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Elbert16QPimPlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace facebook::fboss
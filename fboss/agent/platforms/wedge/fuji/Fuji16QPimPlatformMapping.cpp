@@ -12,7 +12,7 @@
 #include <folly/logging/xlog.h>
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -65459,6 +65459,9 @@ constexpr auto kJsonPlatformMappingStr = R"(
 namespace facebook {
 namespace fboss {
 Fuji16QPimPlatformMapping::Fuji16QPimPlatformMapping()
-    : MultiPimPlatformMapping(kJsonPlatformMappingStr) {}
+    : MultiPimPlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Fuji16QPimPlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace fboss
 } // namespace facebook
@@ -12,7 +12,7 @@
 #include <folly/logging/xlog.h>
 
 namespace {
-constexpr auto kJsonMiln42PlatformMappingStr = R"(
+constexpr char kJsonMiln42PlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -50119,7 +50119,7 @@ constexpr auto kJsonMiln42PlatformMappingStr = R"(
 }
 )";
 
-constexpr auto kJsonMiln52PlatformMappingStr = R"(
+constexpr char kJsonMiln52PlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -98102,8 +98102,15 @@ Minipack16QPimPlatformMapping::Minipack16QPimPlatformMapping(
     ExternalPhyVersion xphyVersion)
     : MultiPimPlatformMapping(
           xphyVersion == ExternalPhyVersion::MILN4_2
-              ? kJsonMiln42PlatformMappingStr
-              : kJsonMiln52PlatformMappingStr) {
+              ? folly::StringPiece(
+                    kJsonMiln42PlatformMappingStr,
+                    sizeof(kJsonMiln42PlatformMappingStr) - 1)
+              : folly::StringPiece(
+                    kJsonMiln52PlatformMappingStr,
+                    sizeof(kJsonMiln52PlatformMappingStr) - 1),
+          xphyVersion == ExternalPhyVersion::MILN4_2
+              ? "Minipack16QPimPlatformMapping:kJsonMiln42PlatformMappingStr"
+              : "Minipack16QPimPlatformMapping:kJsonMiln52PlatformMappingStr") {
   XLOG(INFO) << "Initializing Minipack16QPimPlatformMapping for xphy ver: "
              << (xphyVersion == ExternalPhyVersion::MILN4_2 ? "MILN4_2"
                                                             : "MILN5_2");
@@ -11,7 +11,7 @@
 #include "fboss/agent/platforms/wedge/wedge400/Wedge400PlatformMapping.h"
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -28740,6 +28740,9 @@ constexpr auto kJsonPlatformMappingStr = R"(
 namespace facebook {
 namespace fboss {
 Wedge400PlatformMapping::Wedge400PlatformMapping()
-    : PlatformMapping(kJsonPlatformMappingStr) {}
+    : PlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Wedge400PlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace fboss
 } // namespace facebook
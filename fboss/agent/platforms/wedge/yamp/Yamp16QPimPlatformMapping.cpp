@@ -11,7 +11,7 @@
 #include "fboss/agent/platforms/wedge/yamp/Yamp16QPimPlatformMapping.h"
 
 namespace {
-constexpr auto kJsonPlatformMappingStr = R"(
+constexpr char kJsonPlatformMappingStr[] = R"(
 {
   "ports": {
     "1": {
@@ -66950,6 +66950,9 @@ constexpr auto kJsonPlatformMappingStr = R"(
 namespace facebook {
 namespace fboss {
 Yamp16QPimPlatformMapping::Yamp16QPimPlatformMapping()
-    : MultiPimPlatformMapping(kJsonPlatformMappingStr) {}
+    : MultiPimPlatformMapping(
+          folly::StringPiece(
+              kJsonPlatformMappingStr, sizeof(kJsonPlatformMappingStr) - 1),
+          "Yamp16QPimPlatformMapping:kJsonPlatformMappingStr") {}
 } // namespace fboss
 } // namespace facebook
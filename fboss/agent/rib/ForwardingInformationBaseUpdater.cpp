@@ -17,6 +17,7 @@
 #include <folly/logging/xlog.h>
 
 #include <algorithm>
+#include <vector>
 
 namespace facebook::fboss::rib {
 
@@ -67,6 +68,10 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
 
   typename facebook::fboss::ForwardingInformationBase<
       AddressT>::Base::NodeContainer updatedFib;
+  // The routes publishing the FIB has to publish, as it would otherwise go
+  // through all of them
+  std::vector<std::shared_ptr<facebook::fboss::Route<AddressT>>>
+      unpublishedRoutes;
 
   for (const auto& entry : rib) {
     const facebook::fboss::rib::Route<AddressT>& ribRoute = entry.value();
@@ -93,6 +98,9 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
       fibRoute = toFibRoute(ribRoute);
     }
 
+    if (!fibRoute->isPublished()) {
+      unpublishedRoutes.push_back(fibRoute);
+    }
     updatedFib.emplace_hint(updatedFib.cend(), fibPrefix, fibRoute);
   }
 
@@ -107,7 +115,7 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
           }));
 
   return std::make_unique<ForwardingInformationBase<AddressT>>(
-      std::move(updatedFib));
+      std::move(updatedFib), std::move(unpublishedRoutes));
 }
 
 facebook::fboss::RouteNextHopEntry
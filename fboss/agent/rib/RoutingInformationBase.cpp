@@ -17,9 +17,20 @@
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteUpdater.h"
 
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
+
 #include <memory>
+#include <mutex>
+#include <tuple>
 #include <utility>
 
+DEFINE_uint32(
+    rib_resolution_threads,
+    4,
+    "Number of threads resolving the routes of separate VRFs in parallel, "
+    "0 to resolve them one after the other");
+
 namespace {
 class Timer {
  public:
@@ -40,6 +51,99 @@ class Timer {
 
 namespace facebook::fboss::rib {
 
+namespace {
+/*
+ * The FIB updates of all VRFs go to the same SwitchState, so those of VRFs
+ * resolved in parallel are made one at a time.
+ */
+RoutingInformationBase::FibUpdateFunction serializeFibUpdates(
+    RoutingInformationBase::FibUpdateFunction fibUpdateCallback,
+    std::mutex* fibUpdateMutex) {
+  return [fibUpdateCallback = std::move(fibUpdateCallback), fibUpdateMutex](
+             RouterID vrf,
+             const IPv4NetworkToRouteMap& v4NetworkToRoute,
+             const IPv6NetworkToRouteMap& v6NetworkToRoute,
+             void* cookie) {
+    std::lock_guard<std::mutex> guard(*fibUpdateMutex);
+    fibUpdateCallback(vrf, v4NetworkToRoute, v6NetworkToRoute, cookie);
+  };
+}
+
+/*
+ * A client's update, converted to what the RouteUpdater takes. Converting
+ * is what fails on bad routes, so doing it before touching the RIB means a
+ * client's update is either applied whole or not at all.
+ */
+struct PreparedClientUpdate {
+  ClientID clientID;
+  bool resetClientsRoutes{false};
+  std::vector<std::tuple<folly::IPAddress, uint8_t, RouteNextHopEntry>> toAdd;
+  std::vector<std::pair<folly::IPAddress, uint8_t>> toDelete;
+};
+
+PreparedClientUpdate prepareClientRoutes(
+    ClientID clientID,
+    AdminDistance adminDistanceFromClientID,
+    const std::vector<UnicastRoute>& toAdd,
+    const std::vector<IpPrefix>& toDelete,
+    bool resetClientsRoutes) {
+  PreparedClientUpdate prepared;
+  prepared.clientID = clientID;
+  prepared.resetClientsRoutes = resetClientsRoutes;
+  prepared.toAdd.reserve(toAdd.size());
+  for (const auto& route : toAdd) {
+    prepared.toAdd.emplace_back(
+        facebook::network::toIPAddress(route.dest.ip),
+        static_cast<uint8_t>(route.dest.prefixLength),
+        RouteNextHopEntry::from(route, adminDistanceFromClientID));
+  }
+  prepared.toDelete.reserve(toDelete.size());
+  for (const auto& prefix : toDelete) {
+    prepared.toDelete.emplace_back(
+        facebook::network::toIPAddress(prefix.ip),
+        static_cast<uint8_t>(prefix.prefixLength));
+  }
+  return prepared;
+}
+
+void applyClientRoutes(
+    RouteUpdater* updater,
+    PreparedClientUpdate& prepared,
+    RoutingInformationBase::UpdateStatistics* stats) {
+  if (prepared.resetClientsRoutes) {
+    updater->removeAllRoutesForClient(prepared.clientID);
+  }
+
+  for (auto& [network, mask, entry] : prepared.toAdd) {
+    if (network.isV4()) {
+      ++stats->v4RoutesAdded;
+    } else {
+      ++stats->v6RoutesAdded;
+    }
+
+    updater->addRoute(network, mask, prepared.clientID, std::move(entry));
+  }
+
+  for (const auto& [network, mask] : prepared.toDelete) {
+    if (network.isV4()) {
+      ++stats->v4RoutesDeleted;
+    } else {
+      ++stats->v6RoutesDeleted;
+    }
+
+    updater->delRoute(network, mask, prepared.clientID);
+  }
+}
+} // namespace
+
+RoutingInformationBase::RoutingInformationBase() {
+  if (FLAGS_rib_resolution_threads > 0) {
+    resolutionExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        FLAGS_rib_resolution_threads,
+        std::make_shared<folly::NamedThreadFactory>("RibResolution"));
+  }
+}
+
 void RoutingInformationBase::reconfigure(
     const RouterIDAndNetworkToInterfaceRoutes& configRouterIDToInterfaceRoutes,
     const std::vector<cfg::StaticRouteWithNextHops>& staticRoutesWithNextHops,
@@ -47,8 +151,6 @@ void RoutingInformationBase::reconfigure(
     const std::vector<cfg::StaticRouteNoNextHops>& staticRoutesToCpu,
     FibUpdateFunction updateFibCallback,
     void* cookie) {
-  auto lockedRouteTables = synchronizedRouteTables_.wlock();
-
   // Config application is accomplished in the following sequence of steps:
   // 1. Update the VRFs held in RoutingInformationBase's SynchronizedRouteTables
   // data-structure
@@ -65,20 +167,25 @@ void RoutingInformationBase::reconfigure(
   //
   // 5. Update FIB
   //
-  // Steps 2-5 take place in ConfigApplier.
-
-  *lockedRouteTables =
-      constructRouteTables(lockedRouteTables, configRouterIDToInterfaceRoutes);
-
-  // Because of this sequential loop over each VRF, config application scales
-  // linearly with the number of VRFs. If FBOSS is run in a multi-VRF routing
-  // architecture in the future, this slow-down can be avoided by parallelizing
-  // this loop. Converting this loop to use task-level parallelism should be
-  // straightfoward because it has been written to avoid dependencies across
-  // different iterations of the loop.
-  for (auto& vrfAndRouteTable : *lockedRouteTables) {
-    auto vrf = vrfAndRouteTable.first;
+  // Steps 2-5 take place in ConfigApplier, for each VRF in parallel.
+
+  std::vector<std::pair<RouterID, std::shared_ptr<SynchronizedRouteTable>>>
+      routeTables;
+  {
+    auto lockedRouteTables = synchronizedRouteTables_.wlock();
+    *lockedRouteTables = constructRouteTables(
+        lockedRouteTables, configRouterIDToInterfaceRoutes);
+    routeTables.assign(lockedRouteTables->begin(), lockedRouteTables->end());
+  }
+
+  std::mutex fibUpdateMutex;
+  auto serializedFibUpdate =
+      serializeFibUpdates(std::move(updateFibCallback), &fibUpdateMutex);
+
+  auto results = runInParallel(routeTables.size(), [&](size_t i) {
+    auto vrf = routeTables[i].first;
     const auto& interfaceRoutes = configRouterIDToInterfaceRoutes.at(vrf);
+    auto lockedRouteTable = routeTables[i].second->wlock();
 
     // A ConfigApplier object should be independent of the VRF whose routes it
     // is processing. However, because interface and static routes for _all_
@@ -89,17 +196,20 @@ void RoutingInformationBase::reconfigure(
     // processing by the use of boost::filter_iterator.
     ConfigApplier configApplier(
         vrf,
-        &(vrfAndRouteTable.second.v4NetworkToRoute),
-        &(vrfAndRouteTable.second.v6NetworkToRoute),
+        &(lockedRouteTable->v4NetworkToRoute),
+        &(lockedRouteTable->v6NetworkToRoute),
         folly::range(interfaceRoutes.cbegin(), interfaceRoutes.cend()),
         folly::range(staticRoutesToCpu.cbegin(), staticRoutesToCpu.cend()),
         folly::range(staticRoutesToNull.cbegin(), staticRoutesToNull.cend()),
         folly::range(
             staticRoutesWithNextHops.cbegin(), staticRoutesWithNextHops.cend()),
-        updateFibCallback,
+        serializedFibUpdate,
         cookie);
 
     configApplier.updateRibAndFib();
+  });
+  for (auto& result : results) {
+    result.throwIfFailed();
   }
 }
 
@@ -110,63 +220,141 @@ RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
     const std::vector<UnicastRoute>& toAdd,
     const std::vector<IpPrefix>& toDelete,
     bool resetClientsRoutes,
-    folly::StringPiece updateType,
+    folly::StringPiece /* updateType */,
     FibUpdateFunction fibUpdateCallback,
     void* cookie) {
-  UpdateStatistics stats;
-
-  Timer updateTimer(&stats.duration);
-
-  auto lockedRouteTables = synchronizedRouteTables_.wlock();
+  auto prepared = prepareClientRoutes(
+      clientID, adminDistanceFromClientID, toAdd, toDelete, resetClientsRoutes);
+  return updateImpl(
+      routerID,
+      [&](RouteUpdater* updater, UpdateStatistics* stats) {
+        applyClientRoutes(updater, prepared, stats);
+      },
+      fibUpdateCallback,
+      cookie);
+}
 
-  auto it = lockedRouteTables->find(routerID);
-  if (it == lockedRouteTables->end()) {
-    throw FbossError("VRF ", routerID, " not configured");
+RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
+    RouterID routerID,
+    const std::vector<ClientRouteUpdate>& clientUpdates,
+    folly::StringPiece /* updateType */,
+    FibUpdateFunction fibUpdateCallback,
+    void* cookie,
+    std::vector<folly::exception_wrapper>* clientErrors) {
+  if (clientErrors) {
+    clientErrors->assign(clientUpdates.size(), folly::exception_wrapper());
   }
-
-  RouteUpdater updater(
-      &(it->second.v4NetworkToRoute), &(it->second.v6NetworkToRoute));
-
-  if (resetClientsRoutes) {
-    updater.removeAllRoutesForClient(clientID);
+  std::vector<PreparedClientUpdate> prepared;
+  prepared.reserve(clientUpdates.size());
+  for (size_t i = 0; i < clientUpdates.size(); ++i) {
+    const auto& clientUpdate = clientUpdates[i];
+    try {
+      prepared.push_back(prepareClientRoutes(
+          clientUpdate.clientID,
+          clientUpdate.adminDistanceFromClientID,
+          clientUpdate.toAdd,
+          clientUpdate.toDelete,
+          clientUpdate.resetClientsRoutes));
+    } catch (const std::exception& ex) {
+      if (!clientErrors) {
+        throw;
+      }
+      (*clientErrors)[i] =
+          folly::exception_wrapper(std::current_exception(), ex);
+    }
   }
+  return updateImpl(
+      routerID,
+      [&](RouteUpdater* updater, UpdateStatistics* stats) {
+        for (auto& clientUpdate : prepared) {
+          applyClientRoutes(updater, clientUpdate, stats);
+        }
+      },
+      fibUpdateCallback,
+      cookie);
+}
 
-  for (const auto& route : toAdd) {
-    auto network = facebook::network::toIPAddress(route.dest.ip);
-    auto mask = static_cast<uint8_t>(route.dest.prefixLength);
+std::map<RouterID, folly::Try<RoutingInformationBase::UpdateStatistics>>
+RoutingInformationBase::update(
+    const std::map<RouterID, std::vector<ClientRouteUpdate>>& vrfUpdates,
+    folly::StringPiece updateType,
+    FibUpdateFunction fibUpdateCallback,
+    void* cookie,
+    std::map<RouterID, std::vector<folly::exception_wrapper>>* clientErrors) {
+  std::vector<RouterID> vrfs;
+  std::vector<UpdateStatistics> stats(vrfUpdates.size());
+  // Filled in parallel, so one per VRF
+  std::vector<std::vector<folly::exception_wrapper>> vrfClientErrors(
+      vrfUpdates.size());
+  for (const auto& vrfUpdate : vrfUpdates) {
+    vrfs.push_back(vrfUpdate.first);
+  }
 
-    if (network.isV4()) {
-      ++stats.v4RoutesAdded;
+  std::mutex fibUpdateMutex;
+  auto serializedFibUpdate =
+      serializeFibUpdates(std::move(fibUpdateCallback), &fibUpdateMutex);
+
+  auto results = runInParallel(vrfs.size(), [&](size_t i) {
+    stats[i] = update(
+        vrfs[i],
+        vrfUpdates.at(vrfs[i]),
+        updateType,
+        serializedFibUpdate,
+        cookie,
+        clientErrors ? &vrfClientErrors[i] : nullptr);
+  });
+
+  std::map<RouterID, folly::Try<UpdateStatistics>> vrfStats;
+  for (size_t i = 0; i < vrfs.size(); ++i) {
+    if (clientErrors) {
+      (*clientErrors)[vrfs[i]] = std::move(vrfClientErrors[i]);
+    }
+    if (results[i].hasException()) {
+      vrfStats.emplace(
+          vrfs[i],
+          folly::Try<UpdateStatistics>(std::move(results[i].exception())));
     } else {
-      ++stats.v6RoutesAdded;
+      vrfStats.emplace(vrfs[i], folly::Try<UpdateStatistics>(stats[i]));
     }
-
-    updater.addRoute(
-        network,
-        mask,
-        clientID,
-        RouteNextHopEntry::from(route, adminDistanceFromClientID));
   }
+  return vrfStats;
+}
 
-  for (const auto& prefix : toDelete) {
-    auto network = facebook::network::toIPAddress(prefix.ip);
-    auto mask = static_cast<uint8_t>(prefix.prefixLength);
+RoutingInformationBase::UpdateStatistics RoutingInformationBase::updateImpl(
+    RouterID routerID,
+    const UpdateRoutesFunction& updateRoutes,
+    FibUpdateFunction fibUpdateCallback,
+    void* cookie) {
+  UpdateStatistics stats;
 
-    if (network.isV4()) {
-      ++stats.v4RoutesDeleted;
-    } else {
-      ++stats.v6RoutesDeleted;
-    }
+  Timer updateTimer(&stats.duration);
 
-    updater.delRoute(network, mask, clientID);
+  auto routeTable = getRouteTable(routerID);
+  if (!routeTable) {
+    throw FbossError("VRF ", routerID, " not configured");
   }
+  auto lockedRouteTable = routeTable->wlock();
+
+  auto routeUpdateStart = std::chrono::steady_clock::now();
+  RouteUpdater updater(
+      &(lockedRouteTable->v4NetworkToRoute),
+      &(lockedRouteTable->v6NetworkToRoute));
+
+  updateRoutes(&updater, &stats);
 
+  auto resolutionStart = std::chrono::steady_clock::now();
+  stats.routeUpdateDuration =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          resolutionStart - routeUpdateStart);
   updater.updateDone();
+  stats.resolutionDuration =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - resolutionStart);
 
   fibUpdateCallback(
       routerID,
-      it->second.v4NetworkToRoute,
-      it->second.v6NetworkToRoute,
+      lockedRouteTable->v4NetworkToRoute,
+      lockedRouteTable->v6NetworkToRoute,
       cookie);
 
   return stats;
@@ -179,12 +367,13 @@ folly::dynamic RoutingInformationBase::toFollyDynamic() const {
   for (const auto& routeTable : *lockedRouteTables) {
     auto routerIdStr =
         folly::to<std::string>(static_cast<uint32_t>(routeTable.first));
+    auto lockedRouteTable = routeTable.second->rlock();
     rib[routerIdStr] = folly::dynamic::object;
     rib[routerIdStr][kRouterId] = static_cast<uint32_t>(routeTable.first);
     rib[routerIdStr][kRibV4] =
-        routeTable.second.v4NetworkToRoute.toFollyDynamic();
+        lockedRouteTable->v4NetworkToRoute.toFollyDynamic();
     rib[routerIdStr][kRibV6] =
-        routeTable.second.v6NetworkToRoute.toFollyDynamic();
+        lockedRouteTable->v6NetworkToRoute.toFollyDynamic();
   }
 
   return rib;
@@ -198,10 +387,10 @@ RoutingInformationBase RoutingInformationBase::fromFollyDynamic(
   for (const auto& routeTable : ribJson.items()) {
     lockedRouteTables->insert(std::make_pair(
         RouterID(routeTable.first.asInt()),
-        RouteTable{
+        std::make_shared<SynchronizedRouteTable>(RouteTable{
             IPv4NetworkToRouteMap::fromFollyDynamic(routeTable.second[kRibV4]),
             IPv6NetworkToRouteMap::fromFollyDynamic(routeTable.second[kRibV6]),
-            UpdateStatistics{}}));
+            UpdateStatistics{}})));
   }
 
   return rib;
@@ -209,12 +398,14 @@ RoutingInformationBase RoutingInformationBase::fromFollyDynamic(
 
 void RoutingInformationBase::createVrf(RouterID rid) {
   auto lockedRouteTables = synchronizedRouteTables_.wlock();
-  lockedRouteTables->insert(std::make_pair(rid, RouteTable()));
+  lockedRouteTables->insert(
+      std::make_pair(rid, std::make_shared<SynchronizedRouteTable>()));
 }
 
 std::vector<RouterID> RoutingInformationBase::getVrfList() const {
   auto lockedRouteTables = synchronizedRouteTables_.rlock();
-  std::vector<RouterID> res(lockedRouteTables->size());
+  std::vector<RouterID> res;
+  res.reserve(lockedRouteTables->size());
   for (const auto& entry : *lockedRouteTables) {
     res.push_back(entry.first);
   }
@@ -224,24 +415,52 @@ std::vector<RouterID> RoutingInformationBase::getVrfList() const {
 std::vector<RouteDetails> RoutingInformationBase::getRouteTableDetails(
     RouterID rid) const {
   std::vector<RouteDetails> routeDetails;
-  SYNCHRONIZED_CONST(synchronizedRouteTables_) {
-    const auto it = synchronizedRouteTables_.find(rid);
-    if (it != synchronizedRouteTables_.end()) {
-      for (auto rit = it->second.v4NetworkToRoute.begin();
-           rit != it->second.v4NetworkToRoute.end();
-           ++rit) {
-        routeDetails.emplace_back(rit->value().toRouteDetails());
-      }
-      for (auto rit = it->second.v6NetworkToRoute.begin();
-           rit != it->second.v6NetworkToRoute.end();
-           ++rit) {
-        routeDetails.emplace_back(rit->value().toRouteDetails());
-      }
+  auto routeTable = getRouteTable(rid);
+  if (routeTable) {
+    auto lockedRouteTable = routeTable->rlock();
+    for (auto rit = lockedRouteTable->v4NetworkToRoute.begin();
+         rit != lockedRouteTable->v4NetworkToRoute.end();
+         ++rit) {
+      routeDetails.emplace_back(rit->value().toRouteDetails());
+    }
+    for (auto rit = lockedRouteTable->v6NetworkToRoute.begin();
+         rit != lockedRouteTable->v6NetworkToRoute.end();
+         ++rit) {
+      routeDetails.emplace_back(rit->value().toRouteDetails());
     }
   }
   return routeDetails;
 }
 
+std::shared_ptr<RoutingInformationBase::SynchronizedRouteTable>
+RoutingInformationBase::getRouteTable(RouterID rid) const {
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
+  auto it = lockedRouteTables->find(rid);
+  if (it == lockedRouteTables->end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+std::vector<folly::Try<folly::Unit>> RoutingInformationBase::runInParallel(
+    size_t count,
+    const std::function<void(size_t)>& fn) {
+  if (count <= 1 || !resolutionExecutor_) {
+    std::vector<folly::Try<folly::Unit>> results;
+    for (size_t i = 0; i < count; ++i) {
+      results.push_back(folly::makeTryWith([&] { fn(i); }));
+    }
+    return results;
+  }
+
+  std::vector<folly::Future<folly::Unit>> futures;
+  for (size_t i = 0; i < count; ++i) {
+    futures.push_back(
+        folly::via(resolutionExecutor_.get(), [&fn, i] { fn(i); }));
+  }
+  return folly::collectAll(futures.begin(), futures.end()).get();
+}
+
 RoutingInformationBase::RouterIDToRouteTable
 RoutingInformationBase::constructRouteTables(
     const SynchronizedRouteTables::WLockedPtr& lockedRouteTables,
@@ -249,24 +468,25 @@ RoutingInformationBase::constructRouteTables(
     const {
   RouterIDToRouteTable newRouteTables;
 
-  RouterIDToRouteTable::iterator newRouteTablesIter;
   for (const auto& routerIDAndInterfaceRoutes :
        configRouterIDToInterfaceRoutes) {
     const RouterID configVrf = routerIDAndInterfaceRoutes.first;
 
-    newRouteTablesIter = newRouteTables.emplace_hint(
-        newRouteTables.cend(), configVrf, RouteTable());
-
     auto oldRouteTablesIter = lockedRouteTables->find(configVrf);
     if (oldRouteTablesIter == lockedRouteTables->end()) {
-      // configVrf did not exist in the RIB, so it has been added to
-      // newRouteTables with an empty set of routes
+      // configVrf did not exist in the RIB, so it is added to newRouteTables
+      // with an empty set of routes
+      newRouteTables.emplace_hint(
+          newRouteTables.cend(),
+          configVrf,
+          std::make_shared<SynchronizedRouteTable>());
       continue;
     }
 
-    // configVrf exists in the RIB, so it will be shallow copied into
-    // newRouteTables.
-    newRouteTablesIter->second = std::move(oldRouteTablesIter->second);
+    // configVrf exists in the RIB, so its route table is shared with
+    // newRouteTables
+    newRouteTables.emplace_hint(
+        newRouteTables.cend(), configVrf, oldRouteTablesIter->second);
   }
 
   return newRouteTables;
@@ -277,7 +497,17 @@ bool RoutingInformationBase::operator==(
   const auto& routeTables = synchronizedRouteTables_.rlock();
   const auto& otherTables = other.synchronizedRouteTables_.rlock();
 
-  return *routeTables == *otherTables;
+  if (routeTables->size() != otherTables->size()) {
+    return false;
+  }
+  for (const auto& [vrf, routeTable] : *routeTables) {
+    auto otherTable = otherTables->find(vrf);
+    if (otherTable == otherTables->end() ||
+        *routeTable->rlock() != *otherTable->second->rlock()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 } // namespace facebook::fboss::rib
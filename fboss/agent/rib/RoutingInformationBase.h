@@ -14,17 +14,25 @@
 #include "fboss/agent/rib/NetworkToRouteMap.h"
 #include "fboss/agent/types.h"
 
+#include <folly/ExceptionWrapper.h>
 #include <folly/Synchronized.h>
+#include <folly/Try.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <thread>
 #include <vector>
 
 namespace facebook::fboss::rib {
 
+class RouteUpdater;
+
 class RoutingInformationBase {
  public:
+  RoutingInformationBase();
+
   using FibUpdateFunction = std::function<void(
       RouterID vrf,
       const IPv4NetworkToRouteMap& v4NetworkToRoute,
@@ -37,10 +45,15 @@ class RoutingInformationBase {
     std::size_t v6RoutesAdded{0};
     std::size_t v6RoutesDeleted{0};
     std::chrono::microseconds duration{0};
+    // Parts of duration spent adding and deleting routes, and resolving them
+    std::chrono::microseconds routeUpdateDuration{0};
+    std::chrono::microseconds resolutionDuration{0};
+    // Part of duration spent queued, when applied through a RibUpdateQueue
+    std::chrono::microseconds queueDuration{0};
   };
 
   /*
-   * `update()` first acquires exclusive ownership of the RIB and executes the
+   * `update()` first acquires exclusive ownership of the VRF and executes the
    * following sequence of actions:
    * 1. Injects and removes routes in `toAdd` and `toDelete`, respectively.
    * 2. Triggers recursive (IP) resolution.
@@ -64,6 +77,51 @@ class RoutingInformationBase {
       FibUpdateFunction fibUpdateCallback,
       void* cookie);
 
+  /*
+   * The routes a client adds to and deletes from a VRF, with the same
+   * meaning as the arguments of `update()`
+   */
+  struct ClientRouteUpdate {
+    ClientID clientID;
+    AdminDistance adminDistanceFromClientID;
+    std::vector<UnicastRoute> toAdd;
+    std::vector<IpPrefix> toDelete;
+    bool resetClientsRoutes{false};
+  };
+
+  /*
+   * Same as `update()`, for the updates of several clients to a VRF at once.
+   * They are resolved and sent to the FIB together, as a single update.
+   *
+   * The routes of a client update are all checked before any is applied, so
+   * a client update with a bad route is applied whole or not at all. Given
+   * clientErrors, such a client update fails on its own: its error is set at
+   * its index in clientErrors and the other clients are updated. Otherwise
+   * the whole update fails, with nothing applied.
+   */
+  UpdateStatistics update(
+      RouterID routerID,
+      const std::vector<ClientRouteUpdate>& clientUpdates,
+      folly::StringPiece updateType,
+      FibUpdateFunction fibUpdateCallback,
+      void* cookie,
+      std::vector<folly::exception_wrapper>* clientErrors = nullptr);
+
+  /*
+   * Same as `update()`, for the updates of several VRFs at once. The VRFs are
+   * updated and resolved in parallel, only their FIB updates are serialized.
+   * A VRF failing to update does not keep the others from being updated, so
+   * the result of each VRF is returned separately. Client updates fail on
+   * their own as above, their errors being set per VRF in clientErrors.
+   */
+  std::map<RouterID, folly::Try<UpdateStatistics>> update(
+      const std::map<RouterID, std::vector<ClientRouteUpdate>>& vrfUpdates,
+      folly::StringPiece updateType,
+      FibUpdateFunction fibUpdateCallback,
+      void* cookie,
+      std::map<RouterID, std::vector<folly::exception_wrapper>>* clientErrors =
+          nullptr);
+
   /*
    * VrfAndNetworkToInterfaceRoute is conceptually a mapping from the pair
    * (RouterID, folly::CIDRNetwork) to the pair (Interface(1),
@@ -117,21 +175,43 @@ class RoutingInformationBase {
   };
 
   /*
-   * Currently, route updates to separate VRFs are made to be sequential. In the
-   * event FBOSS has to operate in a routing architecture with numerous VRFs,
-   * we can avoid a slow down by a factor of number of VRFs by parallelizing
-   * route updates across VRFs. This can be accomplished simply by associating
-   * the mutex implicit in folly::Synchronized with an individual RouteTable.
+   * Each VRF has its own lock, so that route updates to separate VRFs do not
+   * wait for each other and can be resolved in parallel. The lock of the map
+   * only guards the set of VRFs: it is held just long enough to look a VRF
+   * up, and exclusively only to add or remove VRFs.
    */
-  using RouterIDToRouteTable = boost::container::flat_map<RouterID, RouteTable>;
+  using SynchronizedRouteTable = folly::Synchronized<RouteTable>;
+  using RouterIDToRouteTable = boost::container::
+      flat_map<RouterID, std::shared_ptr<SynchronizedRouteTable>>;
   using SynchronizedRouteTables = folly::Synchronized<RouterIDToRouteTable>;
 
+  // Null if the VRF is not configured
+  std::shared_ptr<SynchronizedRouteTable> getRouteTable(RouterID rid) const;
+
+  /*
+   * Calls fn(i) for i in [0, count), in parallel on resolutionExecutor_ if
+   * there is more than one, and returns how each call went.
+   */
+  std::vector<folly::Try<folly::Unit>> runInParallel(
+      size_t count,
+      const std::function<void(size_t)>& fn);
+
+  using UpdateRoutesFunction =
+      std::function<void(RouteUpdater* updater, UpdateStatistics* stats)>;
+  UpdateStatistics updateImpl(
+      RouterID routerID,
+      const UpdateRoutesFunction& updateRoutes,
+      FibUpdateFunction fibUpdateCallback,
+      void* cookie);
+
   RouterIDToRouteTable constructRouteTables(
       const SynchronizedRouteTables::WLockedPtr& lockedRouteTables,
       const RouterIDAndNetworkToInterfaceRoutes&
           configRouterIDToInterfaceRoutes) const;
 
   SynchronizedRouteTables synchronizedRouteTables_;
+  // Null if VRFs are to be resolved one after the other
+  std::unique_ptr<folly::CPUThreadPoolExecutor> resolutionExecutor_;
 };
 
 } // namespace facebook::fboss::rib
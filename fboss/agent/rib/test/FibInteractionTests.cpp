@@ -33,6 +33,7 @@
 #include <folly/IPAddress.h>
 #include <folly/functional/Partial.h>
 #include <gtest/gtest.h>
+#include <map>
 #include <optional>
 
 using facebook::fboss::AdminDistance;
@@ -618,3 +619,70 @@ TEST(ForwardingInformationBaseUpdater, Deduplication) {
   ASSERT_TRUE(route3);
   EXPECT_NE(route, route3);
 }
+
+TEST(Rib, MultiVrfUpdate) {
+  using namespace facebook::fboss;
+
+  const RouterID vrfZero{0};
+  const RouterID vrfOne{1};
+
+  cfg::SwitchConfig config;
+  config.vlans_ref()->resize(2);
+  config.interfaces_ref()->resize(2);
+  for (int i = 0; i < 2; ++i) {
+    *config.vlans_ref()[i].id_ref() = i + 1;
+    *config.interfaces_ref()[i].intfID_ref() = i + 1;
+    *config.interfaces_ref()[i].vlanID_ref() = i + 1;
+    *config.interfaces_ref()[i].routerID_ref() = i;
+    config.interfaces_ref()[i].mac_ref() = "00:02:00:00:00:01";
+    config.interfaces_ref()[i].ipAddresses_ref()->push_back(
+        folly::to<std::string>("10.0.", i, ".1/24"));
+  }
+
+  auto testHandle =
+      createTestHandle(&config, SwitchFlags::ENABLE_STANDALONE_RIB);
+  auto sw = testHandle->getSw();
+
+  auto fibV4Size = [&](RouterID vrf) {
+    return sw->getState()->getFibs()->getFibContainer(vrf)->getFibV4()->size();
+  };
+  auto vrfZeroSize = fibV4Size(vrfZero);
+  auto vrfOneSize = fibV4Size(vrfOne);
+
+  auto prefixA = folly::CIDRNetworkV4(folly::IPAddressV4("7.1.0.0"), 16);
+  auto prefixB = folly::CIDRNetworkV4(folly::IPAddressV4("7.2.0.0"), 16);
+
+  using ClientRouteUpdate = rib::RoutingInformationBase::ClientRouteUpdate;
+  std::map<RouterID, std::vector<ClientRouteUpdate>> vrfUpdates;
+  for (auto vrf : {vrfZero, vrfOne, RouterID(5)}) {
+    ClientRouteUpdate clientUpdate;
+    clientUpdate.clientID = ClientID(10);
+    clientUpdate.adminDistanceFromClientID = AdminDistance::EBGP;
+    auto nexthop = folly::IPAddress(
+        folly::to<std::string>("10.0.", static_cast<int>(vrf), ".2"));
+    clientUpdate.toAdd.push_back(
+        createUnicastRoute(prefixA.first, prefixA.second, nexthop));
+    if (vrf == vrfOne) {
+      clientUpdate.toAdd.push_back(
+          createUnicastRoute(prefixB.first, prefixB.second, nexthop));
+    }
+    vrfUpdates[vrf].push_back(std::move(clientUpdate));
+  }
+  // VRF 5 is not configured
+
+  auto results = sw->getRib()->update(
+      vrfUpdates,
+      "multi-VRF unit test",
+      &dynamicFibUpdate,
+      static_cast<void*>(sw));
+
+  ASSERT_EQ(3, results.size());
+  ASSERT_TRUE(results.at(vrfZero).hasValue());
+  EXPECT_EQ(1, results.at(vrfZero)->v4RoutesAdded);
+  ASSERT_TRUE(results.at(vrfOne).hasValue());
+  EXPECT_EQ(2, results.at(vrfOne)->v4RoutesAdded);
+  EXPECT_TRUE(results.at(RouterID(5)).hasException());
+
+  EXPECT_EQ(vrfZeroSize + 1, fibV4Size(vrfZero));
+  EXPECT_EQ(vrfOneSize + 2, fibV4Size(vrfOne));
+}
@@ -266,11 +266,11 @@ AggregatePort* AggregatePort::modify(std::shared_ptr<SwitchState>* state) {
 //         as a member of that AggregatePort
 // case C: is not CONFIGURED as a member of any AggregatePort
 bool AggregatePort::isIngressValid(
-    const std::shared_ptr<SwitchState>& state,
+    const SwitchState& state,
     const std::unique_ptr<RxPacket>& packet) {
   auto physicalIngressPort = packet->getSrcPort();
   auto owningAggregatePort =
-      state->getAggregatePorts()->getAggregatePortIf(physicalIngressPort);
+      state.getAggregatePorts()->getAggregatePortIf(physicalIngressPort);
 
   if (!owningAggregatePort) {
     // case C
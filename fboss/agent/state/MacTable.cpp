@@ -48,12 +48,11 @@ void MacTable::updateEntry(
     std::optional<cfg::AclLookupClass> classID,
     std::optional<MacEntryType> type) {
   CHECK(!this->isPublished());
-  auto& nodes = this->writableNodes();
-  auto it = nodes.find(mac);
-  if (it == nodes.end()) {
+  auto node = this->getNodeIf(mac);
+  if (!node) {
     throw FbossError("Mac entry for ", mac.toString(), " does not exist");
   }
-  auto entry = it->second->clone();
+  auto entry = node->clone();
 
   entry->setMac(mac);
   entry->setPort(portDescr);
@@ -61,7 +60,7 @@ void MacTable::updateEntry(
   if (type) {
     entry->setType(type.value());
   }
-  it->second = entry;
+  updateNode(entry);
 }
 
 FBOSS_INSTANTIATE_NODE_MAP(MacTable, MacTableTraits);
@@ -85,31 +85,27 @@ void NeighborTable<IPADDR, ENTRY, SUBCLASS>::updateEntry(
     InterfaceID intfID,
     std::optional<cfg::AclLookupClass> classID) {
   CHECK(!this->isPublished());
-  auto& nodes = this->writableNodes();
-  auto it = nodes.find(ip);
-  if (it == nodes.end()) {
+  auto node = this->getNodeIf(ip);
+  if (!node) {
     throw FbossError("Neighbor entry for ", ip, " does not exist");
   }
-  auto entry = it->second->clone();
+  auto entry = node->clone();
   entry->setMAC(mac);
   entry->setPort(port);
   entry->setIntfID(intfID);
   entry->setState(NeighborState::REACHABLE);
   entry->setClassID(classID);
-  it->second = entry;
+  this->updateNode(entry);
 }
 
 template <typename IPADDR, typename ENTRY, typename SUBCLASS>
 void NeighborTable<IPADDR, ENTRY, SUBCLASS>::updateEntry(
     AddressType ip,
     std::shared_ptr<ENTRY> newEntry) {
-  auto& nodes = this->writableNodes();
-  auto it = nodes.find(ip);
-  if (it == nodes.end()) {
+  if (!this->getNodeIf(ip)) {
     throw FbossError("Neighbor entry for ", ip, " does not exist");
   }
-  it->second = newEntry;
-  return;
+  this->updateNode(newEntry);
 }
 
 template <typename IPADDR, typename ENTRY, typename SUBCLASS>
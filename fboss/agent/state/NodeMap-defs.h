@@ -49,28 +49,30 @@ std::shared_ptr<typename TraitsT::Node> NodeMapT<MapTypeT, TraitsT>::getNodeIf(
 
 template <typename MapTypeT, typename TraitsT>
 void NodeMapT<MapTypeT, TraitsT>::addNode(const std::shared_ptr<Node>& node) {
-  auto& nodes = writableNodes();
-  auto ret = nodes.insert(std::make_pair(TraitsT::getKey(node), node));
+  auto* fields = this->writableFields();
+  auto ret = fields->nodes.insert(std::make_pair(TraitsT::getKey(node), node));
   if (!ret.second) {
     throw FbossError("duplicate node ID ", TraitsT::getKey(node));
   }
+  fields->nodeAdded(node);
 }
 
 template <typename MapTypeT, typename TraitsT>
 void NodeMapT<MapTypeT, TraitsT>::updateNode(
     const std::shared_ptr<Node>& node) {
-  auto& nodes = writableNodes();
-  auto it = nodes.find(TraitsT::getKey(node));
-  if (it == nodes.end()) {
+  auto* fields = this->writableFields();
+  auto it = fields->nodes.find(TraitsT::getKey(node));
+  if (it == fields->nodes.end()) {
     throw FbossError("node ID ", TraitsT::getKey(node), " does not exist");
   }
   it->second = node;
+  fields->nodeAdded(node);
 }
 
 template <typename MapTypeT, typename TraitsT>
 void NodeMapT<MapTypeT, TraitsT>::removeNode(
     const std::shared_ptr<Node>& node) {
-  auto& nodes = writableNodes();
+  auto& nodes = this->writableFields()->nodes;
   auto it = nodes.find(TraitsT::getKey(node));
   if (it == nodes.end()) {
     throw FbossError("node ID ", TraitsT::getKey(node), " does not exist");
@@ -91,7 +93,7 @@ std::shared_ptr<typename TraitsT::Node> NodeMapT<MapTypeT, TraitsT>::removeNode(
 template <typename MapTypeT, typename TraitsT>
 std::shared_ptr<typename TraitsT::Node>
 NodeMapT<MapTypeT, TraitsT>::removeNodeIf(const KeyType& key) {
-  auto& nodes = writableNodes();
+  auto& nodes = this->writableFields()->nodes;
   auto it = nodes.find(key);
   if (it == nodes.end()) {
     return nullptr;
@@ -101,6 +103,17 @@ NodeMapT<MapTypeT, TraitsT>::removeNodeIf(const KeyType& key) {
   return node;
 }
 
+template <typename MapTypeT, typename TraitsT>
+void NodeMapT<MapTypeT, TraitsT>::publish() {
+  if (this->isPublished()) {
+    return;
+  }
+  auto* fields = this->writableFields();
+  fields->forEachUnpublishedChild([](NodeBase* child) { child->publish(); });
+  fields->nodesPublished();
+  NodeBase::publish();
+}
+
 template <typename MapTypeT, typename TraitsT>
 folly::dynamic NodeMapT<MapTypeT, TraitsT>::toFollyDynamic() const {
   folly::dynamic nodesJson = folly::dynamic::array;
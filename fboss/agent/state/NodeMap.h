@@ -11,6 +11,9 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <memory>
+#include <vector>
+
 #include "fboss/agent/state/NodeBase.h"
 #include "fboss/agent/state/NodeMapIterator.h"
 
@@ -28,9 +31,21 @@ struct NodeMapFields {
       boost::container::flat_map<KeyType, std::shared_ptr<Node>>;
 
   NodeMapFields() {}
-  NodeMapFields(NodeContainer nodes) : nodes(std::move(nodes)) {}
+  NodeMapFields(NodeContainer nodes)
+      : nodes(std::move(nodes)), allNodesUnpublished(true) {}
+  /*
+   * For a container of nodes which are all published, but for the given
+   * ones
+   */
+  NodeMapFields(
+      NodeContainer nodes,
+      std::vector<std::shared_ptr<Node>> unpublishedNodes)
+      : nodes(std::move(nodes)),
+        unpublishedNodes(std::move(unpublishedNodes)) {}
   NodeMapFields(const NodeMapFields& other, NodeContainer nodes)
-      : nodes(std::move(nodes)), extra(other.extra) {}
+      : nodes(std::move(nodes)),
+        extra(other.extra),
+        allNodesUnpublished(true) {}
 
   template <typename Fn>
   void forEachChild(Fn fn) {
@@ -40,8 +55,44 @@ struct NodeMapFields {
     extra.forEachChild(fn);
   }
 
+  /*
+   * Same as forEachChild(), but skipping the nodes known to be published
+   * already. This is what makes publishing a map cost as much as the changes
+   * made to it, rather than its size.
+   */
+  template <typename Fn>
+  void forEachUnpublishedChild(Fn fn) {
+    if (allNodesUnpublished) {
+      for (const auto& nodePtr : nodes) {
+        fn(nodePtr.second.get());
+      }
+    } else {
+      // Nodes removed since they were added are included, which is harmless
+      for (const auto& node : unpublishedNodes) {
+        fn(node.get());
+      }
+    }
+    extra.forEachChild(fn);
+  }
+
+  void nodeAdded(const std::shared_ptr<Node>& node) {
+    if (!allNodesUnpublished && !node->isPublished()) {
+      unpublishedNodes.push_back(node);
+    }
+  }
+
+  void nodesPublished() {
+    unpublishedNodes.clear();
+    allNodesUnpublished = false;
+  }
+
   NodeContainer nodes;
   ExtraFields extra;
+  // The nodes added or replaced while the map was unpublished, unless nodes
+  // may have been changed without nodeAdded() being told, in which case any
+  // of them may be unpublished.
+  std::vector<std::shared_ptr<Node>> unpublishedNodes;
+  bool allNodesUnpublished{false};
 };
 
 struct NodeMapNoExtraFields {
@@ -99,8 +150,16 @@ class NodeMapT : public NodeBaseT<MapTypeT, NodeMapFields<TraitsT>> {
   const NodeContainer& getAllNodes() const {
     return this->getFields()->nodes;
   }
+  /*
+   * The nodes can be changed in any way through this, so publish() can no
+   * longer tell which are unpublished and has to go through all of them.
+   * Prefer addNode(), updateNode() and removeNode().
+   */
   NodeContainer& writableNodes() {
-    return this->writableFields()->nodes;
+    auto* fields = this->writableFields();
+    fields->allNodesUnpublished = true;
+    fields->unpublishedNodes.clear();
+    return fields->nodes;
   }
 
   const ExtraFields& getExtraFields() const {
@@ -134,6 +193,12 @@ class NodeMapT : public NodeBaseT<MapTypeT, NodeMapFields<TraitsT>> {
   std::shared_ptr<Node> removeNode(const KeyType& key);
   std::shared_ptr<Node> removeNodeIf(const KeyType& key);
 
+  /*
+   * Publish the nodes added or replaced since the map was cloned, rather
+   * than all of them
+   */
+  void publish() override;
+
   /*
    * Serialize to folly::dynamic
    */
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <folly/FBString.h>
@@ -99,6 +100,11 @@ class StateUpdate {
   std::string name_;
   int behaviorFlags_{static_cast<int>(BehaviorFlags::NONE)};
 
+  // The route update this is part of, if any, and when it was scheduled.
+  // Set by the SwSwitch, which traces route updates through the update thread.
+  uint64_t routeUpdateID_{0};
+  std::chrono::steady_clock::time_point scheduledTime_;
+
   // An intrusive list hook for maintaining the list of pending updates.
   folly::IntrusiveListHook listHook_;
   // The SwSwitch code needs access to our listHook_ member so it can maintain
@@ -0,0 +1,222 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/UcmpWeightNormalizer.h"
+
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+DEFINE_uint32(
+    ucmp_memo_size,
+    16384,
+    "Number of normalized UCMP next hop sets kept, beyond which they are "
+    "all dropped");
+
+namespace facebook::fboss {
+
+namespace {
+
+NextHopWeight nonZeroWeight(const NextHop& nhop) {
+  return std::max(nhop.weight(), NextHopWeight(1));
+}
+
+void reduceByGcd(std::vector<NextHopWeight>* weights) {
+  NextHopWeight gcd = 0;
+  for (auto weight : *weights) {
+    gcd = std::gcd(gcd, weight);
+  }
+  if (gcd > 1) {
+    for (auto& weight : *weights) {
+      weight /= gcd;
+    }
+  }
+}
+
+/*
+ * Scale weights adding up to more than width down to width, at least 1
+ * each, by largest remainder. There are no more weights than width.
+ */
+void scaleDown(std::vector<NextHopWeight>* weights, NextHopWeight width) {
+  auto& ws = *weights;
+  long double total = std::accumulate(ws.begin(), ws.end(), NextHopWeight(0));
+  // The exact share of the width of each next hop
+  std::vector<long double> quotas(ws.size());
+  NextHopWeight scaledTotal = 0;
+  for (size_t i = 0; i < ws.size(); ++i) {
+    quotas[i] = ws[i] * static_cast<long double>(width) / total;
+    ws[i] = std::max(
+        static_cast<NextHopWeight>(std::floor(quotas[i])), NextHopWeight(1));
+    scaledTotal += ws[i];
+  }
+  // Hand what rounding down left over to the largest remainders. Each of
+  // them is less than 1, so each next hop gets at most one more member.
+  if (scaledTotal < width) {
+    std::vector<size_t> order(ws.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return quotas[a] - ws[a] > quotas[b] - ws[b];
+    });
+    for (size_t i = 0; scaledTotal < width; ++i) {
+      ++ws[order[i]];
+      ++scaledTotal;
+    }
+  }
+  // Take back what rounding up to 1 added, from the next hops the furthest
+  // above their share
+  while (scaledTotal > width) {
+    size_t furthest = ws.size();
+    for (size_t i = 0; i < ws.size(); ++i) {
+      if (ws[i] > 1 &&
+          (furthest == ws.size() ||
+           ws[i] - quotas[i] > ws[furthest] - quotas[furthest])) {
+        furthest = i;
+      }
+    }
+    CHECK_LT(furthest, ws.size());
+    --ws[furthest];
+    --scaledTotal;
+  }
+}
+
+} // namespace
+
+UcmpWeightNormalizer* UcmpWeightNormalizer::getInstance() {
+  static UcmpWeightNormalizer instance;
+  return &instance;
+}
+
+RouteNextHopSet UcmpWeightNormalizer::normalize(
+    const RouteNextHopSet& nhops,
+    NextHopWeight width) {
+  // Sets which fit are left as they are, which is cheaper than a lookup
+  NextHopWeight total = 0;
+  for (const auto& nhop : nhops) {
+    total += nonZeroWeight(nhop);
+  }
+  if (total <= width) {
+    return normalizeImpl(nhops, width);
+  }
+
+  auto key = std::make_pair(width, nhops);
+  {
+    auto memo = memo_.rlock();
+    auto itr = memo->find(key);
+    if (itr != memo->end()) {
+      ++memoHits_;
+      return itr->second;
+    }
+  }
+  ++memoMisses_;
+  auto normalized = normalizeImpl(nhops, width);
+  auto memo = memo_.wlock();
+  if (memo->size() >= FLAGS_ucmp_memo_size) {
+    memo->clear();
+  }
+  memo->emplace(std::move(key), normalized);
+  return normalized;
+}
+
+RouteNextHopSet UcmpWeightNormalizer::normalizeImpl(
+    const RouteNextHopSet& nhops,
+    NextHopWeight width) {
+  CHECK_GT(width, 0);
+  std::vector<NextHop> nexthops(nhops.begin(), nhops.end());
+  std::vector<NextHopWeight> weights;
+  weights.reserve(nexthops.size());
+  for (const auto& nhop : nexthops) {
+    weights.push_back(nonZeroWeight(nhop));
+  }
+
+  if (nexthops.size() > width) {
+    XLOG(WARNING) << "More next hops than the max ecmp width " << width
+                  << ", keeping the heaviest ones of " << nhops;
+    std::vector<size_t> order(nexthops.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return weights[a] > weights[b];
+    });
+    std::vector<NextHopWeight> kept(nexthops.size(), 0);
+    for (size_t i = 0; i < width; ++i) {
+      kept[order[i]] = 1;
+    }
+    weights = std::move(kept);
+  } else {
+    auto total =
+        std::accumulate(weights.begin(), weights.end(), NextHopWeight(0));
+    if (total > width) {
+      XLOG(DBG2) << "Total weight of next hops exceeds max ecmp width: "
+                 << total << " > " << width << " (" << nhops << ")";
+      reduceByGcd(&weights);
+      total = std::accumulate(weights.begin(), weights.end(), NextHopWeight(0));
+      if (total > width) {
+        scaleDown(&weights, width);
+        reduceByGcd(&weights);
+      }
+    }
+  }
+
+  RouteNextHopSet normalized;
+  normalized.reserve(nexthops.size());
+  for (size_t i = 0; i < nexthops.size(); ++i) {
+    if (weights[i] == 0) {
+      continue;
+    }
+    const auto& nhop = nexthops[i];
+    normalized.insert(ResolvedNextHop(
+        nhop.addr(), nhop.intf(), weights[i], nhop.labelForwardingAction()));
+  }
+  return normalized;
+}
+
+double UcmpWeightNormalizer::maxShareError(
+    const RouteNextHopSet& nhops,
+    const RouteNextHopSet& normalized) {
+  auto shares = [](const RouteNextHopSet& nexthops) {
+    NextHopWeight total = 0;
+    for (const auto& nhop : nexthops) {
+      total += nonZeroWeight(nhop);
+    }
+    std::map<std::pair<InterfaceID, folly::IPAddress>, double> result;
+    for (const auto& nhop : nexthops) {
+      result[std::make_pair(nhop.intf(), nhop.addr())] =
+          static_cast<double>(nonZeroWeight(nhop)) / total;
+    }
+    return result;
+  };
+  auto expected = shares(nhops);
+  auto actual = shares(normalized);
+  double maxError = 0;
+  for (const auto& [nexthop, share] : expected) {
+    auto itr = actual.find(nexthop);
+    double actualShare = itr == actual.end() ? 0 : itr->second;
+    maxError = std::max(maxError, std::abs(share - actualShare));
+  }
+  return maxError;
+}
+
+UcmpWeightNormalizer::Stats UcmpWeightNormalizer::getStats() const {
+  Stats stats;
+  stats.memoHits = memoHits_.load();
+  stats.memoMisses = memoMisses_.load();
+  stats.memoSize = memo_.rlock()->size();
+  return stats;
+}
+
+void UcmpWeightNormalizer::clear() {
+  memo_.wlock()->clear();
+  memoHits_ = 0;
+  memoMisses_ = 0;
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/state/RouteNextHopEntry.h"
+
+#include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
+
+#include <atomic>
+#include <map>
+#include <utility>
+
+namespace facebook::fboss {
+
+/*
+ * Fits the UCMP weights of next hop sets into the ECMP width of the ASIC,
+ * that is the number of members a next hop group may have, each next hop
+ * taking as many members as its weight.
+ *
+ * ECMP next hops (weight 0) count as weight 1. Weights adding up to more
+ * than the width are first divided by their greatest common divisor, which
+ * costs no precision. If they still do, they are scaled down to it by largest
+ * remainder: each next hop gets within one member of its exact share of
+ * the width, except that none gets less than one member. Should there be
+ * more next hops than the width, only the heaviest ones are kept.
+ *
+ * Scaling a set down is the costly case, and the same sets come up for many
+ * routes, so results are memoized per next hop set and width. The memo is
+ * thread safe, and is dropped whole once it holds FLAGS_ucmp_memo_size sets.
+ */
+class UcmpWeightNormalizer {
+ public:
+  struct Stats {
+    uint64_t memoHits{0};
+    uint64_t memoMisses{0};
+    size_t memoSize{0};
+  };
+
+  static UcmpWeightNormalizer* getInstance();
+
+  RouteNextHopSet normalize(const RouteNextHopSet& nhops, NextHopWeight width);
+
+  /*
+   * The normalization proper, without the memo
+   */
+  static RouteNextHopSet normalizeImpl(
+      const RouteNextHopSet& nhops,
+      NextHopWeight width);
+
+  /*
+   * The largest difference, over the next hops of the original set, between
+   * the share of traffic they get from the normalized set and the one they
+   * were meant to get.
+   */
+  static double maxShareError(
+      const RouteNextHopSet& nhops,
+      const RouteNextHopSet& normalized);
+
+  Stats getStats() const;
+  void clear();
+
+ private:
+  // Keyed by width and next hop set
+  using Memo =
+      std::map<std::pair<NextHopWeight, RouteNextHopSet>, RouteNextHopSet>;
+
+  folly::Synchronized<Memo, folly::SharedMutex> memo_;
+  std::atomic<uint64_t> memoHits_{0};
+  std::atomic<uint64_t> memoMisses_{0};
+};
+
+} // namespace facebook::fboss
@@ -277,3 +277,47 @@ TEST(ForwardingInformationBaseV6, IPv6DefaultPrefixComparesSmallest) {
 }
 
 } // namespace facebook::fboss
+
+TEST(ForwardingInformationBaseV4, PublishAddedAndUpdatedRoutes) {
+  using facebook::fboss::ForwardingInformationBaseV4;
+
+  auto fib = std::make_shared<ForwardingInformationBaseV4>();
+  fib->addNode(createRouteFromPrefix(ip4_64, 2));
+  fib->addNode(createRouteFromPrefix(ip4_128, 1));
+  fib->publish();
+  EXPECT_TRUE(fib->getNode({ip4_64, 2})->isPublished());
+  EXPECT_TRUE(fib->getNode({ip4_128, 1})->isPublished());
+
+  auto newFib = fib->clone();
+  auto added = createRouteFromPrefix(ip4_48, 4);
+  auto updated = fib->getNode({ip4_64, 2})->clone();
+  newFib->addNode(added);
+  newFib->updateNode(updated);
+  // Removed before being published
+  newFib->addNode(createRouteFromPrefix(ip4_160, 3));
+  newFib->removeNode(facebook::fboss::RoutePrefixV4{ip4_160, 3});
+  newFib->publish();
+
+  EXPECT_TRUE(added->isPublished());
+  EXPECT_TRUE(updated->isPublished());
+  EXPECT_EQ(updated, newFib->getNode({ip4_64, 2}));
+  EXPECT_EQ(3, newFib->size());
+  for (const auto& route : *newFib) {
+    EXPECT_TRUE(route->isPublished());
+  }
+}
+
+TEST(ForwardingInformationBaseV4, PublishWritableNodes) {
+  using facebook::fboss::ForwardingInformationBaseV4;
+
+  auto fib = std::make_shared<ForwardingInformationBaseV4>();
+  fib->addNode(createRouteFromPrefix(ip4_64, 2));
+  fib->publish();
+
+  // Nodes changed behind the map's back are published all the same
+  auto newFib = fib->clone();
+  auto route = createRouteFromPrefix(ip4_128, 1);
+  newFib->writableNodes().emplace(route->prefix(), route);
+  newFib->publish();
+  EXPECT_TRUE(route->isPublished());
+}
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/ApplyThriftConfig.h"
+#include "fboss/agent/hw/mock/MockPlatform.h"
+#include "fboss/agent/state/AclEntry.h"
+#include "fboss/agent/state/AclMap.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Conv.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using std::shared_ptr;
+
+namespace {
+constexpr auto kNumAcls = 10;
+// Applier stages the cache can skip as a whole
+constexpr auto kNumSkippableSections = 6;
+
+cfg::SwitchConfig testConfigWithAcls() {
+  auto config = testConfigA();
+  for (auto& port : *config.ports_ref()) {
+    *port.state_ref() = cfg::PortState::ENABLED;
+  }
+  config.acls_ref()->resize(kNumAcls);
+  for (int i = 0; i < kNumAcls; ++i) {
+    auto& acl = config.acls_ref()[i];
+    *acl.name_ref() = folly::to<std::string>("acl", i);
+    *acl.actionType_ref() = cfg::AclActionType::DENY;
+    acl.dstIp_ref() = folly::to<std::string>("10.", i, ".0.0/16");
+  }
+  return config;
+}
+
+shared_ptr<SwitchState> publishAndApplyConfigWithCache(
+    shared_ptr<SwitchState>& state,
+    const cfg::SwitchConfig* config,
+    const Platform* platform,
+    ThriftConfigApplyCache* cache) {
+  state->publish();
+  return applyThriftConfig(state, config, platform, nullptr, cache);
+}
+
+void expectSameAcls(
+    const shared_ptr<SwitchState>& expected,
+    const shared_ptr<SwitchState>& actual) {
+  ASSERT_EQ(expected->getAcls()->size(), actual->getAcls()->size());
+  for (const auto& acl : *expected->getAcls()) {
+    auto actualAcl = actual->getAcls()->getEntryIf(acl->getID());
+    ASSERT_NE(nullptr, actualAcl);
+    EXPECT_EQ(*acl, *actualAcl);
+  }
+}
+} // namespace
+
+TEST(ThriftConfigApplyCache, reapplySameConfig) {
+  auto platform = createMockPlatform();
+  ThriftConfigApplyCache cache;
+  auto config = testConfigWithAcls();
+
+  auto stateV0 = testStateA();
+  auto stateV1 = publishAndApplyConfigWithCache(
+      stateV0, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, stateV1);
+  EXPECT_EQ(0, cache.getNumSkippedSections());
+  EXPECT_EQ(kNumAcls, stateV1->getAcls()->size());
+
+  auto uncached = publishAndApplyConfig(stateV1, &config, platform.get());
+  auto cached = publishAndApplyConfigWithCache(
+      stateV1, &config, platform.get(), &cache);
+  EXPECT_EQ(nullptr, uncached);
+  EXPECT_EQ(nullptr, cached);
+  EXPECT_EQ(kNumSkippableSections, cache.getNumSkippedSections());
+
+  // Once cleared everything is applied in full again
+  cache.clear();
+  EXPECT_EQ(
+      nullptr,
+      publishAndApplyConfigWithCache(
+          stateV1, &config, platform.get(), &cache));
+  EXPECT_EQ(0, cache.getNumSkippedSections());
+}
+
+TEST(ThriftConfigApplyCache, singleAclChange) {
+  auto platform = createMockPlatform();
+  ThriftConfigApplyCache cache;
+  auto config = testConfigWithAcls();
+
+  auto stateV0 = testStateA();
+  auto stateV1 = publishAndApplyConfigWithCache(
+      stateV0, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, stateV1);
+
+  config.acls_ref()[3].dstIp_ref() = "192.168.0.0/16";
+  auto uncached = publishAndApplyConfig(stateV1, &config, platform.get());
+  auto cached = publishAndApplyConfigWithCache(
+      stateV1, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, uncached);
+  ASSERT_NE(nullptr, cached);
+  expectSameAcls(uncached, cached);
+  EXPECT_EQ(
+      "192.168.0.0",
+      cached->getAcls()->getEntry("acl3")->getDstIp().first.str());
+
+  // Only the ACL stage ran, and it only rebuilt the changed ACL
+  EXPECT_EQ(kNumSkippableSections - 1, cache.getNumSkippedSections());
+  EXPECT_EQ(kNumAcls - 1, cache.getNumSkippedEntries());
+  EXPECT_EQ(stateV1->getPorts(), cached->getPorts());
+  EXPECT_EQ(
+      stateV1->getAcls()->getEntry("acl0"),
+      cached->getAcls()->getEntry("acl0"));
+}
+
+TEST(ThriftConfigApplyCache, aclReorder) {
+  auto platform = createMockPlatform();
+  ThriftConfigApplyCache cache;
+  auto config = testConfigWithAcls();
+
+  auto stateV0 = testStateA();
+  auto stateV1 = publishAndApplyConfigWithCache(
+      stateV0, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, stateV1);
+
+  // Priorities follow config order, so moved ACLs must not be skipped
+  std::swap(config.acls_ref()[0], config.acls_ref()[1]);
+  auto uncached = publishAndApplyConfig(stateV1, &config, platform.get());
+  auto cached = publishAndApplyConfigWithCache(
+      stateV1, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, uncached);
+  ASSERT_NE(nullptr, cached);
+  expectSameAcls(uncached, cached);
+  EXPECT_EQ(kNumAcls - 2, cache.getNumSkippedEntries());
+}
+
+TEST(ThriftConfigApplyCache, runtimePortChangeIsReconciled) {
+  auto platform = createMockPlatform();
+  ThriftConfigApplyCache cache;
+  auto config = testConfigWithAcls();
+
+  auto stateV0 = testStateA();
+  auto stateV1 = publishAndApplyConfigWithCache(
+      stateV0, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, stateV1);
+  stateV1->publish();
+
+  // Something other than config, e.g. a thrift call, brings a port down
+  auto stateV2 = stateV1->clone();
+  auto port = stateV2->getPorts()->getPort(PortID(1))->modify(&stateV2);
+  port->setAdminState(cfg::PortState::DISABLED);
+
+  auto stateV3 = publishAndApplyConfigWithCache(
+      stateV2, &config, platform.get(), &cache);
+  ASSERT_NE(nullptr, stateV3);
+  EXPECT_EQ(
+      cfg::PortState::ENABLED,
+      stateV3->getPorts()->getPort(PortID(1))->getAdminState());
+  // Every other port is unchanged and skipped
+  EXPECT_EQ(config.ports_ref()->size() - 1, cache.getNumSkippedEntries());
+  EXPECT_EQ(
+      stateV2->getPorts()->getPort(PortID(2)),
+      stateV3->getPorts()->getPort(PortID(2)));
+}
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/UcmpWeightNormalizer.h"
+
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+DECLARE_uint32(ucmp_memo_size);
+
+using namespace facebook::fboss;
+
+namespace {
+
+RouteNextHopSet makeNextHops(const std::vector<NextHopWeight>& weights) {
+  RouteNextHopSet nhops;
+  for (size_t i = 0; i < weights.size(); ++i) {
+    nhops.insert(ResolvedNextHop(
+        folly::IPAddress(folly::sformat("10.0.{}.{}", i / 256, i % 256)),
+        InterfaceID(1),
+        weights[i]));
+  }
+  return nhops;
+}
+
+} // namespace
+
+class UcmpWeightNormalizerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    normalizer = UcmpWeightNormalizer::getInstance();
+    normalizer->clear();
+  }
+
+  void TearDown() override {
+    normalizer->clear();
+    FLAGS_ucmp_memo_size = 16384;
+  }
+
+  UcmpWeightNormalizer* normalizer;
+};
+
+TEST_F(UcmpWeightNormalizerTest, FittingSetsUnchanged) {
+  EXPECT_EQ(
+      makeNextHops({2, 4, 6}),
+      normalizer->normalize(makeNextHops({2, 4, 6}), 64));
+  // ECMP next hops take one member each
+  EXPECT_EQ(
+      makeNextHops({1, 1}),
+      normalizer->normalize(makeNextHops({ECMP_WEIGHT, ECMP_WEIGHT}), 64));
+}
+
+TEST_F(UcmpWeightNormalizerTest, ReducedByGcd) {
+  EXPECT_EQ(
+      makeNextHops({2, 3}), normalizer->normalize(makeNextHops({20, 30}), 8));
+  EXPECT_EQ(
+      makeNextHops({1, 2}),
+      normalizer->normalize(makeNextHops({1000, 2000}), 64));
+}
+
+TEST_F(UcmpWeightNormalizerTest, ScaledDown) {
+  EXPECT_EQ(
+      makeNextHops({31, 31, 1, 1}),
+      normalizer->normalize(makeNextHops({50, 50, 1, 1}), 64));
+  EXPECT_EQ(
+      makeNextHops({29, 29, 1, 1, 1, 1, 1, 1}),
+      normalizer->normalize(makeNextHops({50, 50, 1, 1, 1, 1, 1, 1}), 64));
+  EXPECT_EQ(
+      makeNextHops({63, 63, 1, 1}),
+      normalizer->normalize(makeNextHops({100, 100, 1, 1}), 128));
+  EXPECT_EQ(
+      makeNextHops({61, 61, 1, 1, 1, 1, 1, 1}),
+      normalizer->normalize(makeNextHops({100, 100, 1, 1, 1, 1, 1, 1}), 128));
+  // The largest remainders get the members rounding down left over
+  EXPECT_EQ(
+      makeNextHops({3, 2, 2, 1}),
+      normalizer->normalize(makeNextHops({35, 25, 25, 15}), 8));
+}
+
+TEST_F(UcmpWeightNormalizerTest, MoreNextHopsThanWidth) {
+  EXPECT_EQ(
+      makeNextHops({1, 1, 1}),
+      normalizer->normalize(makeNextHops({5, 4, 3, 2, 1}), 3));
+}
+
+TEST_F(UcmpWeightNormalizerTest, ErrorBounded) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<NextHopWeight> weight(1, 1000);
+  for (auto width : {64, 128, 512}) {
+    for (int i = 0; i < 100; ++i) {
+      std::vector<NextHopWeight> weights(16);
+      for (auto& w : weights) {
+        w = weight(gen);
+      }
+      auto nhops = makeNextHops(weights);
+      auto normalized = normalizer->normalize(nhops, width);
+      NextHopWeight total = 0;
+      for (const auto& nhop : normalized) {
+        EXPECT_GE(nhop.weight(), 1);
+        total += nhop.weight();
+      }
+      EXPECT_LE(total, width);
+      EXPECT_EQ(nhops.size(), normalized.size());
+      // Within one member of the exact share, give or take the members
+      // next hops rounded up to one member had to be made up for with
+      EXPECT_LE(
+          UcmpWeightNormalizer::maxShareError(nhops, normalized), 2.0 / width);
+    }
+  }
+}
+
+TEST_F(UcmpWeightNormalizerTest, Memoized) {
+  auto nhops = makeNextHops({50, 50, 1, 1});
+  auto normalized = normalizer->normalize(nhops, 64);
+  auto stats = normalizer->getStats();
+  EXPECT_EQ(0, stats.memoHits);
+  EXPECT_EQ(1, stats.memoMisses);
+  EXPECT_EQ(1, stats.memoSize);
+
+  EXPECT_EQ(normalized, normalizer->normalize(nhops, 64));
+  stats = normalizer->getStats();
+  EXPECT_EQ(1, stats.memoHits);
+  EXPECT_EQ(1, stats.memoMisses);
+
+  // Another width is another entry
+  normalizer->normalize(nhops, 128);
+  EXPECT_EQ(2, normalizer->getStats().memoSize);
+
+  // Sets which fit are not memoized
+  normalizer->normalize(makeNextHops({1, 2}), 64);
+  stats = normalizer->getStats();
+  EXPECT_EQ(2, stats.memoMisses);
+  EXPECT_EQ(2, stats.memoSize);
+}
+
+TEST_F(UcmpWeightNormalizerTest, MemoBounded) {
+  FLAGS_ucmp_memo_size = 2;
+  normalizer->normalize(makeNextHops({50, 50, 1, 1}), 64);
+  normalizer->normalize(makeNextHops({60, 50, 1, 1}), 64);
+  EXPECT_EQ(2, normalizer->getStats().memoSize);
+  normalizer->normalize(makeNextHops({70, 50, 1, 1}), 64);
+  EXPECT_EQ(1, normalizer->getStats().memoSize);
+}
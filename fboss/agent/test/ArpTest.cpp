@@ -11,10 +11,12 @@
 #include <folly/Memory.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
+#include <folly/synchronization/Baton.h>
 #include "fboss/agent/AddressUtil.h"
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/StateObserver.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/ThriftHandler.h"
@@ -39,6 +41,7 @@
 #include <boost/range/combine.hpp>
 #include <gtest/gtest.h>
 #include <array>
+#include <atomic>
 #include <future>
 #include <string>
 
@@ -734,7 +737,8 @@ void sendArpReply(
     HwTestHandle* handle,
     StringPiece ipStr,
     StringPiece macStr,
-    int port) {
+    int port,
+    bool waitForNeighborUpdater = true) {
   IPAddressV4 srcIP(ipStr);
   MacAddress srcMac(macStr);
 
@@ -764,9 +768,29 @@ void sendArpReply(
 
   // Inform the SwSwitch of the ARP request
   handle->rxPacket(std::move(buf), PortID(port), VlanID(1));
-  handle->getSw()->getNeighborUpdater()->waitForPendingUpdates();
+  if (waitForNeighborUpdater) {
+    handle->getSw()->getNeighborUpdater()->waitForPendingUpdates();
+  }
 }
 
+// Counts the state updates changing the ARP table of VLAN 1
+class ArpTableUpdateCounter : public AutoRegisterStateObserver {
+ public:
+  explicit ArpTableUpdateCounter(SwSwitch* sw)
+      : AutoRegisterStateObserver(sw, "ArpTableUpdateCounter") {}
+
+  void stateUpdated(const StateDelta& delta) override {
+    auto oldVlan = delta.oldState()->getVlans()->getVlanIf(VlanID(1));
+    auto newVlan = delta.newState()->getVlans()->getVlanIf(VlanID(1));
+    if (oldVlan && newVlan &&
+        oldVlan->getArpTable() != newVlan->getArpTable()) {
+      ++count;
+    }
+  }
+
+  std::atomic<int> count{0};
+};
+
 TEST(ArpTest, FlushEntry) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
@@ -851,6 +875,50 @@ TEST(ArpTest, FlushEntry) {
       thriftHandler.flushNeighborEntry(std::move(binAddrPtr), 123), FbossError);
 }
 
+TEST(ArpTest, RepliesBatched) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+  ArpTableUpdateCounter counter(sw);
+
+  // Hold the neighbor cache thread while the replies come in, so that it
+  // handles them all in the same loop
+  folly::Baton<> resume;
+  sw->getNeighborCacheEvb()->runInEventBaseThread([&]() { resume.wait(); });
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(testing::AtLeast(1));
+  sendArpReply(handle.get(), "10.0.0.11", "02:10:20:30:40:11", 2, false);
+  sendArpReply(handle.get(), "10.0.0.15", "02:10:20:30:40:15", 3, false);
+  sendArpReply(handle.get(), "10.0.0.7", "02:10:20:30:40:07", 1, false);
+  sendArpReply(handle.get(), "10.0.0.22", "02:10:20:30:40:22", 4, false);
+  resume.post();
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+
+  // All of them were programmed with a single state update
+  EXPECT_EQ(1, counter.count);
+  for (auto ip : {"10.0.0.11", "10.0.0.15", "10.0.0.7", "10.0.0.22"}) {
+    auto entry = getArpEntry(sw, IPAddressV4(ip));
+    ASSERT_NE(nullptr, entry);
+    EXPECT_FALSE(entry->isPending());
+  }
+
+  // Flushing through thrift waits for each entry to be removed, so does not
+  // wait for the end of the loop
+  ThriftHandler thriftHandler(sw);
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(testing::AtLeast(1));
+  for (auto ip : {"10.0.0.11", "10.0.0.15"}) {
+    auto binAddr = toBinaryAddress(IPAddressV4(ip));
+    EXPECT_EQ(
+        1,
+        thriftHandler.flushNeighborEntry(
+            make_unique<BinaryAddress>(binAddr), 1));
+  }
+  waitForStateUpdates(sw);
+  EXPECT_EQ(3, counter.count);
+  EXPECT_EQ(nullptr, getArpEntry(sw, IPAddressV4("10.0.0.11")));
+  EXPECT_EQ(nullptr, getArpEntry(sw, IPAddressV4("10.0.0.15")));
+  EXPECT_NE(nullptr, getArpEntry(sw, IPAddressV4("10.0.0.7")));
+}
+
 TEST(ArpTest, PendingArp) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
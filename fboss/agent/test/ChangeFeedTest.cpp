@@ -0,0 +1,249 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ChangeFeed.h"
+#include <folly/IPAddress.h>
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/RouteUpdater.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <memory>
+
+DECLARE_int32(change_feed_scan_window);
+
+using namespace facebook::fboss;
+using facebook::network::toBinaryAddress;
+using facebook::network::toIPAddress;
+
+namespace {
+
+constexpr size_t kMaxEntries = 1000;
+
+class ChangeFeedTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    handle = createTestHandle();
+    sw = handle->getSw();
+    initState = sw->getState();
+    auto initialStateA = testStateA();
+    RouteUpdater updater(initialStateA->getRouteTables());
+    updater.addRoute(
+        RouterID(0),
+        folly::IPAddressV4("0.0.0.0"),
+        0,
+        ClientID::STATIC_ROUTE,
+        RouteNextHopEntry(
+            RouteForwardAction::DROP, AdminDistance::MAX_ADMIN_DISTANCE));
+    updater.addRoute(
+        RouterID(0),
+        folly::IPAddressV6("::"),
+        0,
+        ClientID::STATIC_ROUTE,
+        RouteNextHopEntry(
+            RouteForwardAction::DROP, AdminDistance::MAX_ADMIN_DISTANCE));
+    stateA = initialStateA->clone();
+    stateA->resetRouteTables(updater.updateDone());
+
+    deltaAdd = std::make_shared<StateDelta>(initState, stateA);
+    deltaRemove = std::make_shared<StateDelta>(stateA, initState);
+  }
+
+  ChangeFeedPage readAll(const ChangeFeed& feed, int64_t afterSequence) {
+    return feed.read(
+        afterSequence,
+        feed.getFeedId(),
+        ChangeFeedMatcher(ChangeFeedFilter()),
+        kMaxEntries);
+  }
+
+  std::unique_ptr<HwTestHandle> handle;
+  SwSwitch* sw;
+  std::shared_ptr<SwitchState> initState;
+  std::shared_ptr<SwitchState> stateA;
+  std::shared_ptr<StateDelta> deltaAdd;
+  std::shared_ptr<StateDelta> deltaRemove;
+};
+
+} // namespace
+
+TEST_F(ChangeFeedTest, RouteAddAndRemove) {
+  ChangeFeed feed(sw);
+  feed.stateUpdated(*deltaAdd);
+  auto added = readAll(feed, 0);
+  EXPECT_FALSE(*added.resyncRequired_ref());
+  ASSERT_FALSE(added.entries_ref()->empty());
+  EXPECT_EQ(added.entries_ref()->size(), *added.lastSequence_ref());
+  EXPECT_EQ(feed.getLastSequence(), *added.lastSequence_ref());
+
+  int64_t sequence = 0;
+  bool defaultRouteAdded = false;
+  for (const auto& entry : *added.entries_ref()) {
+    EXPECT_EQ(++sequence, *entry.sequence_ref());
+    EXPECT_EQ(ChangeFeedEntryType::ROUTE, *entry.type_ref());
+    EXPECT_FALSE(*entry.removed_ref());
+    defaultRouteAdded |= entry.prefix_ref()->prefixLength == 0 &&
+        entry.prefix_ref()->ip ==
+            toBinaryAddress(folly::IPAddress("0.0.0.0"));
+  }
+  EXPECT_TRUE(defaultRouteAdded);
+
+  feed.stateUpdated(*deltaRemove);
+  auto removed = readAll(feed, *added.lastSequence_ref());
+  EXPECT_EQ(added.entries_ref()->size(), removed.entries_ref()->size());
+  for (const auto& entry : *removed.entries_ref()) {
+    EXPECT_TRUE(*entry.removed_ref());
+  }
+  EXPECT_EQ(2 * sequence, *removed.lastSequence_ref());
+}
+
+TEST_F(ChangeFeedTest, FibRouteAddAndRemove) {
+  // Routes of the standalone RIB only show up in the FIBs
+  auto route = std::make_shared<RouteV4>(
+      RoutePrefixV4{folly::IPAddressV4("10.0.0.0"), 8},
+      ClientID::STATIC_ROUTE,
+      RouteNextHopEntry(
+          RouteForwardAction::DROP, AdminDistance::MAX_ADMIN_DISTANCE));
+  route->setResolved(RouteNextHopEntry(
+      RouteForwardAction::DROP, AdminDistance::MAX_ADMIN_DISTANCE));
+  auto fibContainer =
+      std::make_shared<ForwardingInformationBaseContainer>(RouterID(0));
+  fibContainer->writableFields()->fibV4->addNode(route);
+  auto fibs = std::make_shared<ForwardingInformationBaseMap>();
+  fibs->addNode(fibContainer);
+  auto fibState = initState->clone();
+  fibState->resetForwardingInformationBases(fibs);
+
+  ChangeFeed feed(sw);
+  feed.stateUpdated(StateDelta(initState, fibState));
+  auto added = readAll(feed, 0);
+  ASSERT_EQ(1, added.entries_ref()->size());
+  const auto& entry = added.entries_ref()->front();
+  EXPECT_EQ(ChangeFeedEntryType::ROUTE, *entry.type_ref());
+  EXPECT_FALSE(*entry.removed_ref());
+  EXPECT_EQ(0, *entry.vrf_ref());
+  EXPECT_EQ(8, entry.prefix_ref()->prefixLength);
+  EXPECT_EQ(
+      toBinaryAddress(folly::IPAddress("10.0.0.0")), entry.prefix_ref()->ip);
+
+  feed.stateUpdated(StateDelta(fibState, initState));
+  auto removed = readAll(feed, *added.lastSequence_ref());
+  ASSERT_EQ(1, removed.entries_ref()->size());
+  EXPECT_TRUE(*removed.entries_ref()->front().removed_ref());
+}
+
+TEST_F(ChangeFeedTest, PrefixFilter) {
+  ChangeFeed feed(sw);
+  feed.stateUpdated(*deltaAdd);
+
+  ChangeFeedFilter filter;
+  IpPrefix v6Default;
+  v6Default.ip = toBinaryAddress(folly::IPAddress("::"));
+  v6Default.prefixLength = 0;
+  filter.prefixes_ref() = {v6Default};
+  auto page = feed.read(0, 0, ChangeFeedMatcher(filter), kMaxEntries);
+  ASSERT_FALSE(page.entries_ref()->empty());
+  EXPECT_LT(page.entries_ref()->size(), *page.lastSequence_ref());
+  for (const auto& entry : *page.entries_ref()) {
+    EXPECT_TRUE(toIPAddress(entry.prefix_ref()->ip).isV6());
+  }
+
+  filter.types_ref() = {ChangeFeedEntryType::ARP};
+  page = feed.read(0, 0, ChangeFeedMatcher(filter), kMaxEntries);
+  EXPECT_TRUE(page.entries_ref()->empty());
+  EXPECT_EQ(feed.getLastSequence(), *page.lastSequence_ref());
+}
+
+TEST_F(ChangeFeedTest, ResyncWhenOverwritten) {
+  ChangeFeed feed(sw, 2);
+  feed.stateUpdated(*deltaAdd);
+  auto lastSequence = feed.getLastSequence();
+  ASSERT_GT(lastSequence, 2);
+
+  auto page = readAll(feed, 0);
+  EXPECT_TRUE(*page.resyncRequired_ref());
+  EXPECT_TRUE(page.entries_ref()->empty());
+  EXPECT_EQ(lastSequence, *page.lastSequence_ref());
+
+  // The last two changes are still there
+  page = readAll(feed, lastSequence - 2);
+  EXPECT_FALSE(*page.resyncRequired_ref());
+  EXPECT_EQ(2, page.entries_ref()->size());
+
+  // Sequence numbers from a previous agent run
+  page = readAll(feed, lastSequence + 1);
+  EXPECT_TRUE(*page.resyncRequired_ref());
+}
+
+TEST_F(ChangeFeedTest, StartFromLatest) {
+  ChangeFeed feed(sw);
+  feed.stateUpdated(*deltaAdd);
+  auto page = readAll(feed, -1);
+  EXPECT_FALSE(*page.resyncRequired_ref());
+  EXPECT_TRUE(page.entries_ref()->empty());
+  EXPECT_EQ(feed.getLastSequence(), *page.lastSequence_ref());
+
+  feed.stateUpdated(*deltaRemove);
+  page = readAll(feed, *page.lastSequence_ref());
+  EXPECT_FALSE(page.entries_ref()->empty());
+  EXPECT_EQ(feed.getLastSequence(), *page.lastSequence_ref());
+}
+
+TEST_F(ChangeFeedTest, PageSize) {
+  ChangeFeed feed(sw);
+  feed.stateUpdated(*deltaAdd);
+  auto page = feed.read(0, 0, ChangeFeedMatcher(ChangeFeedFilter()), 1);
+  ASSERT_EQ(1, page.entries_ref()->size());
+  EXPECT_EQ(1, *page.lastSequence_ref());
+}
+
+TEST_F(ChangeFeedTest, ResyncAfterRestart) {
+  ChangeFeed oldFeed(sw);
+  oldFeed.stateUpdated(*deltaAdd);
+  auto oldPage = readAll(oldFeed, 0);
+  EXPECT_EQ(oldFeed.getFeedId(), *oldPage.feedId_ref());
+
+  // A restarted agent which has gone past the client's sequence number
+  ChangeFeed feed(sw);
+  EXPECT_NE(oldFeed.getFeedId(), feed.getFeedId());
+  feed.stateUpdated(*deltaAdd);
+  feed.stateUpdated(*deltaRemove);
+  ASSERT_GT(feed.getLastSequence(), *oldPage.lastSequence_ref());
+  auto page = feed.read(
+      *oldPage.lastSequence_ref(),
+      *oldPage.feedId_ref(),
+      ChangeFeedMatcher(ChangeFeedFilter()),
+      kMaxEntries);
+  EXPECT_TRUE(*page.resyncRequired_ref());
+  EXPECT_TRUE(page.entries_ref()->empty());
+  EXPECT_EQ(feed.getLastSequence(), *page.lastSequence_ref());
+  EXPECT_EQ(feed.getFeedId(), *page.feedId_ref());
+}
+
+TEST_F(ChangeFeedTest, ScanWindow) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_change_feed_scan_window = 1;
+  ChangeFeed feed(sw);
+  feed.stateUpdated(*deltaAdd);
+  ASSERT_GT(feed.getLastSequence(), 1);
+
+  // Only the first change is looked at, and it doesn't match
+  ChangeFeedFilter filter;
+  filter.types_ref() = {ChangeFeedEntryType::ARP};
+  auto page = feed.read(0, 0, ChangeFeedMatcher(filter), 1);
+  EXPECT_FALSE(*page.resyncRequired_ref());
+  EXPECT_TRUE(page.entries_ref()->empty());
+  EXPECT_EQ(1, *page.lastSequence_ref());
+}
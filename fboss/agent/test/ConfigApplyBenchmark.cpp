@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/ApplyThriftConfig.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/MacAddress.h>
+#include <folly/logging/xlog.h>
+
+DEFINE_int32(config_apply_num_acls, 2000, "Number of ACLs in the config");
+
+using namespace facebook::fboss;
+
+namespace {
+
+void addAcls(cfg::SwitchConfig* config, int numAcls) {
+  for (int i = 0; i < numAcls; ++i) {
+    cfg::AclEntry acl;
+    *acl.name_ref() = folly::to<std::string>("acl", i);
+    *acl.actionType_ref() = cfg::AclActionType::DENY;
+    acl.dstIp_ref() =
+        folly::to<std::string>("2401:db00:", i / 256, ":", i % 256, "::/64");
+    acl.l4DstPort_ref() = 1024 + i;
+    config->acls_ref()->push_back(std::move(acl));
+  }
+}
+
+/*
+ * Measure how long the update thread spends applying a config reload in
+ * which a single ACL changed, on top of a ConfigFactory config with one port
+ * per vlan on every port and a large number of ACLs.
+ */
+void runConfigApplyBenchmark(bool useCache) {
+  auto constexpr kNumPorts = 128;
+  folly::BenchmarkSuspender suspender;
+
+  auto sw = std::make_unique<SwSwitch>(std::make_unique<SimPlatform>(
+      folly::MacAddress("02:00:00:00:00:01"), kNumPorts));
+  sw->init(nullptr /* No custom TunManager */);
+
+  std::vector<PortID> ports;
+  for (int i = 1; i < kNumPorts; ++i) {
+    ports.push_back(PortID(i));
+  }
+  auto config = utility::onePortPerVlanConfig(sw->getHw(), ports);
+  addAcls(&config, FLAGS_config_apply_num_acls);
+  sw->updateStateBlocking(
+      "apply config", [&](const std::shared_ptr<SwitchState>& state) {
+        return applyThriftConfig(state, &config, sw->getPlatform());
+      });
+
+  auto state = sw->getState();
+  ThriftConfigApplyCache cache;
+  if (useCache) {
+    // Prime the cache, as a previous reload of the same config would
+    applyThriftConfig(state, &config, sw->getPlatform(), nullptr, &cache);
+  }
+  config.acls_ref()->back().l4DstPort_ref() = 80;
+
+  suspender.dismiss();
+  auto newState = applyThriftConfig(
+      state, &config, sw->getPlatform(), nullptr, useCache ? &cache : nullptr);
+  suspender.rehire();
+
+  CHECK(newState);
+  if (useCache) {
+    XLOG(INFO) << "Skipped " << cache.getNumSkippedSections()
+               << " sections, " << cache.getNumSkippedEntries()
+               << " ports/acls";
+  }
+}
+
+} // namespace
+
+BENCHMARK(ConfigApplySingleAclChange) {
+  runConfigApplyBenchmark(false);
+}
+
+BENCHMARK_RELATIVE(ConfigApplySingleAclChangeCached) {
+  runConfigApplyBenchmark(true);
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
@@ -21,17 +21,24 @@
 #include <folly/MacAddress.h>
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
+#include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include <folly/synchronization/Baton.h>
 #include <folly/system/ThreadName.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "fboss/agent/FbossError.h"
 #include "fboss/agent/LacpController.h"
 #include "fboss/agent/LacpTypes.h"
 #include "fboss/agent/LinkAggregationManager.h"
 #include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/TxPacket.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
+#include "fboss/agent/hw/mock/MockHwSwitch.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/test/CounterCache.h"
 #include "fboss/agent/test/HwTestHandle.h"
 #include "fboss/agent/test/TestUtils.h"
@@ -1288,3 +1295,71 @@ TEST_F(LacpTest, lacpDownCounters) {
   // both members should timeout
   counters.checkDelta(SwitchStats::kCounterPrefix + "lacp.rx_timeout.sum", 2);
 }
+
+/*
+ * The ethernet header of the LACPDUs sent on a port is only built once, and
+ * its VLAN patched in place when the port's ingress VLAN changes
+ */
+TEST_F(LacpTest, lacpPduTemplates) {
+  auto handle = createTestHandle(testStateAWithPortsUp());
+  auto sw = handle->getSw();
+  LinkAggregationManager lagManager(sw);
+  PortID port(1);
+  auto expectedVlan =
+      sw->getState()->getPorts()->getPort(port)->getIngressVlan();
+
+  EXPECT_HW_CALL(
+      sw,
+      sendPacketOutOfPortAsync_(
+          TxPacketMatcher::createMatcher(
+              "LACPDU",
+              [&expectedVlan](const TxPacket* pkt) {
+                folly::io::Cursor c(pkt->buf());
+                c.skip(2 * folly::MacAddress::SIZE);
+                if (c.readBE<uint16_t>() != 0x8100) {
+                  throw FbossError("expected VLAN tag to be present");
+                }
+                VlanID vlan(c.readBE<uint16_t>());
+                if (vlan != expectedVlan) {
+                  throw FbossError(
+                      "expected VLAN ", expectedVlan, "; got ", vlan);
+                }
+                if (c.readBE<uint16_t>() != LACPDU::SLOW_PROTOCOLS ||
+                    c.read<uint8_t>() != LACPDU::LACP) {
+                  throw FbossError("expected LACP ethertype and subtype");
+                }
+              }),
+          port,
+          ::testing::_))
+      .Times(3);
+
+  CounterCache counters(sw);
+  auto transmit = [&]() {
+    sw->getLacpEvb()->runInEventBaseThreadAndWait(
+        [&]() { EXPECT_TRUE(lagManager.transmit(LACPDU(), port)); });
+  };
+  transmit();
+  transmit();
+  counters.update();
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lacp.template_rebuild.sum", 1);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "lacp.template_hit.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lacp.template_patch.sum", 0);
+
+  expectedVlan = VlanID(55);
+  sw->updateStateBlocking(
+      "update ingress vlan", [&](const std::shared_ptr<SwitchState>& state) {
+        auto newState = state->clone();
+        auto newPort = newState->getPorts()->getPort(port)->modify(&newState);
+        newPort->setIngressVlan(expectedVlan);
+        return newState;
+      });
+  transmit();
+  counters.update();
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lacp.template_rebuild.sum", 0);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "lacp.template_hit.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lacp.template_patch.sum", 1);
+}
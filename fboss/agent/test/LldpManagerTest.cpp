@@ -14,6 +14,7 @@
 #include <folly/io/IOBuf.h>
 #include <folly/logging/xlog.h>
 #include <limits.h>
+#include <set>
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/SwSwitch.h"
@@ -22,6 +23,7 @@
 #include "fboss/agent/hw/mock/MockHwSwitch.h"
 #include "fboss/agent/hw/mock/MockPlatform.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/lldp/LinkNeighbor.h"
 #include "fboss/agent/packet/PktUtil.h"
 #include "fboss/agent/test/CounterCache.h"
 #include "fboss/agent/test/HwTestHandle.h"
@@ -127,6 +129,37 @@ TxMatchFn checkLldpPDU() {
   };
 }
 
+// Matches LLDP PDUs sent on the port with the given name and description
+TxMatchFn checkLldpPortFields(
+    const std::string& portName,
+    const std::string& portDesc) {
+  return [=](const TxPacket* pkt) {
+    Cursor c(pkt->buf());
+    PktUtil::readMac(&c);
+    auto srcMac = PktUtil::readMac(&c);
+    // VLAN tag
+    c.skip(4);
+    auto ethertype = c.readBE<uint16_t>();
+    LinkNeighbor neighbor;
+    if (!neighbor.parseLldpPdu(
+            PortID(0), VlanID(0), srcMac, ethertype, &c)) {
+      throw FbossError("invalid LLDP PDU");
+    }
+    if (neighbor.humanReadablePortId() != portName ||
+        neighbor.getPortDescription() != portDesc) {
+      throw FbossError(
+          "expected port ",
+          portName,
+          " with description ",
+          portDesc,
+          "; got port ",
+          neighbor.humanReadablePortId(),
+          " with description ",
+          neighbor.getPortDescription());
+    }
+  };
+}
+
 TEST(LldpManagerTest, LldpSend) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
@@ -332,4 +365,86 @@ TEST(LldpManagerTest, LldpValidationFail) {
   counters.checkDelta(
       SwitchStats::kCounterPrefix + "lldp.validate_mismatch.sum", 1);
 }
+
+TEST(LldpManagerTest, LldpSendReusesTemplates) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  EXPECT_HW_CALL(
+      sw,
+      sendPacketOutOfPortAsync_(
+          TxPacketMatcher::createMatcher("Lldp PDU", checkLldpPDU()),
+          _,
+          std::optional<uint8_t>(kNCStrictPriorityQueue)))
+      .Times(AtLeast(1));
+  LldpManager lldpManager(sw);
+  CounterCache counters(sw);
+  int numUpPorts = 0;
+  for (const auto& port : *sw->getState()->getPorts()) {
+    numUpPorts += port->isPortUp() ? 1 : 0;
+  }
+  ASSERT_GT(numUpPorts, 1);
+
+  lldpManager.sendLldpOnAllPorts();
+  counters.update();
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lldp.template_rebuild.sum", numUpPorts);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "lldp.template_hit.sum", 0);
+
+  lldpManager.sendLldpOnAllPorts();
+  counters.update();
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lldp.template_rebuild.sum", 0);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lldp.template_hit.sum", numUpPorts);
+
+  // Changing a port's name and description only patches them into that
+  // port's frame, moving the TLVs after them
+  sw->updateStateBlocking(
+      "update port name and description",
+      [](const std::shared_ptr<SwitchState>& state) {
+        auto newState = state->clone();
+        auto port = newState->getPorts()->getPort(PortID(1))->modify(&newState);
+        port->setName("renamed-port1");
+        port->setDescription("new description");
+        return newState;
+      });
+  EXPECT_HW_CALL(
+      sw,
+      sendPacketOutOfPortAsync_(
+          TxPacketMatcher::createMatcher(
+              "Patched Lldp PDU",
+              checkLldpPortFields("renamed-port1", "new description")),
+          _,
+          std::optional<uint8_t>(kNCStrictPriorityQueue)))
+      .Times(1);
+  lldpManager.sendLldpOnAllPorts();
+  counters.update();
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lldp.template_rebuild.sum", 0);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lldp.template_patch.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "lldp.template_hit.sum", numUpPorts - 1);
+}
+
+TEST(LldpManagerTest, LldpTxSlots) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+  LldpManager lldpManager(sw);
+
+  // Ports are hashed to a fixed tick of the interval
+  std::set<uint32_t> slots;
+  for (const auto& port : *sw->getState()->getPorts()) {
+    auto slot = lldpManager.getTxSlot(port->getID());
+    EXPECT_LT(slot, LldpManager::LLDP_TX_SLOTS);
+    EXPECT_EQ(slot, lldpManager.getTxSlot(port->getID()));
+    slots.insert(slot);
+  }
+  // and spread over the interval rather than all sent in the same tick
+  ASSERT_GT(
+      sw->getState()->getPorts()->size(),
+      static_cast<size_t>(LldpManager::LLDP_TX_SLOTS));
+  EXPECT_GT(slots.size(), 1u);
+}
 } // unnamed namespace
@@ -9,6 +9,7 @@
  */
 
 #include "common/init/Init.h"
+#include "fboss/agent/Constants.h"
 #include "fboss/agent/StandaloneRibConversions.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/hw/sim/SimPlatform.h"
@@ -24,8 +25,12 @@
 
 using namespace facebook::fboss;
 
+/*
+ * With numVrfs > 1, the routes generated for VRF 0 are copied to the other
+ * VRFs, which are then resolved in parallel when syncing the FIB.
+ */
 template <typename Generator>
-static void runConversionBenchmark() {
+static void runConversionBenchmark(int numVrfs = 1) {
   auto constexpr kEcmpWidth = 4;
 
   SimPlatform plat(folly::MacAddress(), 128);
@@ -35,6 +40,11 @@ static void runConversionBenchmark() {
   }
   cfg::SwitchConfig config =
       utility::onePortPerVlanConfig(plat.getHwSwitch(), ports);
+  // The last interfaces go to the other VRFs, so that these have a FIB
+  for (int vrf = 1; vrf < numVrfs; ++vrf) {
+    auto& intf = config.interfaces_ref()[config.interfaces_ref()->size() - vrf];
+    *intf.routerID_ref() = vrf;
+  }
   auto testHandle =
       createTestHandle(&config, SwitchFlags::ENABLE_STANDALONE_RIB);
   auto sw = testHandle->getSw();
@@ -60,7 +70,23 @@ static void runConversionBenchmark() {
   auto standaloneRib = switchStateToStandaloneRib(swStateTables);
   auto swStateRib = standaloneToSwitchStateRib(standaloneRib);
 
-  syncFibWithStandaloneRib(standaloneRib, sw);
+  if (numVrfs == 1) {
+    syncFibWithStandaloneRib(standaloneRib, sw);
+    return;
+  }
+
+  folly::dynamic ribJson;
+  {
+    folly::BenchmarkSuspender suspender;
+    ribJson = standaloneRib.toFollyDynamic();
+    for (int vrf = 1; vrf < numVrfs; ++vrf) {
+      auto vrfJson = ribJson["0"];
+      vrfJson[kRouterId] = vrf;
+      ribJson[folly::to<std::string>(vrf)] = std::move(vrfJson);
+    }
+  }
+  auto multiVrfRib = rib::RoutingInformationBase::fromFollyDynamic(ribJson);
+  syncFibWithStandaloneRib(multiVrfRib, sw);
 }
 
 BENCHMARK(RibConversionFSW) {
@@ -79,6 +105,22 @@ BENCHMARK(RibConversionHgridUu) {
   runConversionBenchmark<utility::HgridUuRouteScaleGenerator>();
 }
 
+BENCHMARK(RibConversionFSWFourVrfs) {
+  runConversionBenchmark<utility::FSWRouteScaleGenerator>(4);
+}
+
+BENCHMARK(RibConversionTHAlpmFourVrfs) {
+  runConversionBenchmark<utility::THAlpmRouteScaleGenerator>(4);
+}
+
+BENCHMARK(RibConversionHgridDuFourVrfs) {
+  runConversionBenchmark<utility::HgridDuRouteScaleGenerator>(4);
+}
+
+BENCHMARK(RibConversionHgridUuFourVrfs) {
+  runConversionBenchmark<utility::HgridUuRouteScaleGenerator>(4);
+}
+
 int main(int argc, char** argv) {
   facebook::initFacebook(&argc, &argv);
   folly::runBenchmarks();
@@ -0,0 +1,260 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RibUpdateQueue.h"
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/rib/ForwardingInformationBaseUpdater.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+
+DECLARE_int32(rib_update_window_ms);
+
+using namespace facebook::fboss;
+using facebook::network::toBinaryAddress;
+
+namespace {
+
+const RouterID kVrf(0);
+
+void dynamicFibUpdate(
+    RouterID vrf,
+    const rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
+    const rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    void* cookie) {
+  rib::ForwardingInformationBaseUpdater fibUpdater(
+      vrf, v4NetworkToRoute, v6NetworkToRoute);
+
+  auto sw = static_cast<SwSwitch*>(cookie);
+  sw->updateStateBlocking("", std::move(fibUpdater));
+}
+
+UnicastRoute makeRoute(const std::string& network, uint8_t mask) {
+  UnicastRoute route;
+  route.dest.ip = toBinaryAddress(folly::IPAddress(network));
+  route.dest.prefixLength = mask;
+  NextHopThrift nexthop;
+  *nexthop.address_ref() = toBinaryAddress(folly::IPAddress("10.0.0.2"));
+  route.nextHops_ref()->push_back(nexthop);
+  return route;
+}
+
+IpPrefix makePrefix(const std::string& network, uint8_t mask) {
+  IpPrefix prefix;
+  prefix.ip = toBinaryAddress(folly::IPAddress(network));
+  prefix.prefixLength = mask;
+  return prefix;
+}
+
+class RibUpdateQueueTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    cfg::SwitchConfig config;
+    config.vlans_ref()->resize(1);
+    *config.vlans_ref()[0].id_ref() = 1;
+    config.interfaces_ref()->resize(1);
+    *config.interfaces_ref()[0].intfID_ref() = 1;
+    *config.interfaces_ref()[0].vlanID_ref() = 1;
+    *config.interfaces_ref()[0].routerID_ref() = 0;
+    config.interfaces_ref()[0].mac_ref() = "00:02:00:00:00:01";
+    config.interfaces_ref()[0].ipAddresses_ref()->push_back("10.0.0.1/24");
+
+    handle = createTestHandle(&config, SwitchFlags::ENABLE_STANDALONE_RIB);
+    sw = handle->getSw();
+    queue = std::make_unique<RibUpdateQueue>(sw, &dynamicFibUpdate);
+  }
+
+  size_t fibV4Size() const {
+    return sw->getState()->getFibs()->getFibContainer(kVrf)->getFibV4()->size();
+  }
+
+  std::unique_ptr<HwTestHandle> handle;
+  SwSwitch* sw;
+  std::unique_ptr<RibUpdateQueue> queue;
+};
+
+} // namespace
+
+TEST_F(RibUpdateQueueTest, SingleUpdate) {
+  auto numRoutes = fibV4Size();
+  auto stats = queue
+                   ->enqueue(
+                       kVrf,
+                       ClientID(10),
+                       AdminDistance::EBGP,
+                       {makeRoute("20.0.0.0", 16)},
+                       {},
+                       false)
+                   .get();
+  EXPECT_EQ(1, stats.v4RoutesAdded);
+  EXPECT_EQ(0, stats.v6RoutesAdded);
+  EXPECT_GE(stats.duration, stats.queueDuration);
+  EXPECT_EQ(numRoutes + 1, fibV4Size());
+}
+
+TEST_F(RibUpdateQueueTest, UpdatesMerged) {
+  gflags::FlagSaver flagSaver;
+  // Long enough for all the updates below to be queued before any is applied
+  FLAGS_rib_update_window_ms = 200;
+  auto numRoutes = fibV4Size();
+
+  auto addA = queue->enqueue(
+      kVrf,
+      ClientID(10),
+      AdminDistance::EBGP,
+      {makeRoute("20.0.0.0", 16), makeRoute("21.0.0.0", 16)},
+      {},
+      false);
+  auto addB = queue->enqueue(
+      kVrf,
+      ClientID(20),
+      AdminDistance::EBGP,
+      {makeRoute("22.0.0.0", 16)},
+      {},
+      false);
+  // Cancels the add of the same prefix by the same client
+  auto deleteA = queue->enqueue(
+      kVrf,
+      ClientID(10),
+      AdminDistance::EBGP,
+      {},
+      {makePrefix("20.0.0.0", 16)},
+      false);
+
+  // Each caller gets the statistics of its own update
+  auto addAStats = std::move(addA).get();
+  EXPECT_EQ(2, addAStats.v4RoutesAdded);
+  EXPECT_EQ(0, addAStats.v4RoutesDeleted);
+  EXPECT_EQ(1, std::move(addB).get().v4RoutesAdded);
+  EXPECT_EQ(1, std::move(deleteA).get().v4RoutesDeleted);
+  EXPECT_EQ(numRoutes + 2, fibV4Size());
+
+  auto ribRoutes = sw->getRib()->getRouteTableDetails(kVrf);
+  auto hasRoute = [&](const std::string& network) {
+    auto ip = toBinaryAddress(folly::IPAddress(network));
+    return std::any_of(
+        ribRoutes.begin(), ribRoutes.end(), [&](const auto& route) {
+          return route.dest.ip == ip && route.dest.prefixLength == 16;
+        });
+  };
+  EXPECT_FALSE(hasRoute("20.0.0.0"));
+  EXPECT_TRUE(hasRoute("21.0.0.0"));
+  EXPECT_TRUE(hasRoute("22.0.0.0"));
+}
+
+TEST_F(RibUpdateQueueTest, SyncReplacesQueuedRoutes) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_rib_update_window_ms = 200;
+  auto numRoutes = fibV4Size();
+
+  auto add = queue->enqueue(
+      kVrf,
+      ClientID(10),
+      AdminDistance::EBGP,
+      {makeRoute("20.0.0.0", 16)},
+      {},
+      false);
+  auto sync = queue->enqueue(
+      kVrf,
+      ClientID(10),
+      AdminDistance::EBGP,
+      {makeRoute("21.0.0.0", 16)},
+      {},
+      true);
+  std::move(add).get();
+  std::move(sync).get();
+  EXPECT_EQ(numRoutes + 1, fibV4Size());
+}
+
+TEST_F(RibUpdateQueueTest, ErrorReachesAllCallers) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_rib_update_window_ms = 200;
+  // No such VRF
+  auto first = queue->enqueue(
+      RouterID(5),
+      ClientID(10),
+      AdminDistance::EBGP,
+      {makeRoute("20.0.0.0", 16)},
+      {},
+      false);
+  auto second = queue->enqueue(
+      RouterID(5),
+      ClientID(20),
+      AdminDistance::EBGP,
+      {makeRoute("21.0.0.0", 16)},
+      {},
+      false);
+  EXPECT_ANY_THROW(std::move(first).get());
+  EXPECT_ANY_THROW(std::move(second).get());
+}
+
+TEST_F(RibUpdateQueueTest, ClientErrorOnlyFailsThatClient) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_rib_update_window_ms = 200;
+  auto numRoutes = fibV4Size();
+  auto numRibRoutes = sw->getRib()->getRouteTableDetails(kVrf).size();
+
+  // A next hop which is no address at all
+  auto badRoute = makeRoute("21.0.0.0", 16);
+  (*badRoute.nextHops_ref())[0].address_ref()->addr = "bad";
+  auto good = queue->enqueue(
+      kVrf,
+      ClientID(10),
+      AdminDistance::EBGP,
+      {makeRoute("20.0.0.0", 16)},
+      {},
+      false);
+  auto bad = queue->enqueue(
+      kVrf,
+      ClientID(20),
+      AdminDistance::EBGP,
+      {makeRoute("22.0.0.0", 16), badRoute},
+      {},
+      false);
+
+  EXPECT_EQ(1, std::move(good).get().v4RoutesAdded);
+  EXPECT_ANY_THROW(std::move(bad).get());
+  // None of the failed client's routes were applied
+  EXPECT_EQ(numRoutes + 1, fibV4Size());
+  EXPECT_EQ(
+      numRibRoutes + 1, sw->getRib()->getRouteTableDetails(kVrf).size());
+}
+
+TEST_F(RibUpdateQueueTest, InvalidPrefixDoesNotStallQueue) {
+  auto numRoutes = fibV4Size();
+  EXPECT_ANY_THROW(queue
+                       ->enqueue(
+                           kVrf,
+                           ClientID(10),
+                           AdminDistance::EBGP,
+                           {makeRoute("20.0.0.0", 33)},
+                           {},
+                           false)
+                       .get());
+  // Later updates are still applied
+  auto stats = queue
+                   ->enqueue(
+                       kVrf,
+                       ClientID(10),
+                       AdminDistance::EBGP,
+                       {makeRoute("21.0.0.0", 16)},
+                       {},
+                       false)
+                   .get();
+  EXPECT_EQ(1, stats.v4RoutesAdded);
+  EXPECT_EQ(numRoutes + 1, fibV4Size());
+}
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RouteUpdateTracer.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <memory>
+
+DECLARE_int32(route_update_trace_count);
+
+using namespace facebook::fboss;
+
+namespace {
+
+class RouteUpdateTracerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    handle = createTestHandle(testStateA());
+    sw = handle->getSw();
+    tracer = sw->getRouteUpdateTracer();
+  }
+
+  std::unique_ptr<HwTestHandle> handle;
+  SwSwitch* sw;
+  RouteUpdateTracer* tracer;
+};
+
+} // namespace
+
+TEST_F(RouteUpdateTracerTest, CurrentID) {
+  EXPECT_EQ(0, RouteUpdateTracer::getCurrentID());
+  {
+    RouteUpdateTracer::Scope outer(tracer, "outer", 1);
+    EXPECT_EQ(outer.getID(), RouteUpdateTracer::getCurrentID());
+    {
+      RouteUpdateTracer::Scope inner(tracer, "inner", 1);
+      EXPECT_GT(inner.getID(), outer.getID());
+      EXPECT_EQ(inner.getID(), RouteUpdateTracer::getCurrentID());
+    }
+    EXPECT_EQ(outer.getID(), RouteUpdateTracer::getCurrentID());
+  }
+  EXPECT_EQ(0, RouteUpdateTracer::getCurrentID());
+}
+
+TEST_F(RouteUpdateTracerTest, StagesThroughUpdateThread) {
+  int64_t id;
+  {
+    RouteUpdateTracer::Scope trace(tracer, "add routes", 10);
+    id = trace.getID();
+    trace.record(RouteUpdateStage::RIB_UPDATE, std::chrono::microseconds(5));
+    sw->updateStateBlocking(
+        "traced update",
+        [](const std::shared_ptr<SwitchState>& state) {
+          return state->clone();
+        });
+    // Not done until the scope is left
+    EXPECT_EQ(0, *tracer->getTraces(1)[0].totalDurationUs_ref());
+  }
+
+  auto traces = tracer->getTraces(1);
+  ASSERT_EQ(1, traces.size());
+  const auto& trace = traces[0];
+  EXPECT_EQ(id, *trace.updateId_ref());
+  EXPECT_EQ("add routes", *trace.name_ref());
+  EXPECT_EQ(10, *trace.numRoutes_ref());
+  const auto& stages = *trace.stageDurationsUs_ref();
+  EXPECT_EQ(5, stages.at("rib_update"));
+  for (auto stage :
+       {RouteUpdateStage::QUEUE,
+        RouteUpdateStage::STATE_UPDATE,
+        RouteUpdateStage::PUBLISH,
+        RouteUpdateStage::HW_PROGRAMMING,
+        RouteUpdateStage::OBSERVERS}) {
+    EXPECT_EQ(1, stages.count(routeUpdateStageName(stage).str()));
+  }
+  EXPECT_EQ(0, stages.count("resolution"));
+  EXPECT_GE(*trace.totalDurationUs_ref(), 5);
+
+  // Updates outside of a route update are not traced
+  sw->updateStateBlocking(
+      "untraced update", [](const std::shared_ptr<SwitchState>& state) {
+        return state->clone();
+      });
+  EXPECT_EQ(stages, *tracer->getTraces(1)[0].stageDurationsUs_ref());
+}
+
+TEST_F(RouteUpdateTracerTest, LastTracesKept) {
+  for (int i = 0; i < FLAGS_route_update_trace_count + 10; ++i) {
+    RouteUpdateTracer::Scope trace(tracer, "update", i);
+  }
+  auto traces = tracer->getTraces(FLAGS_route_update_trace_count + 10);
+  ASSERT_EQ(FLAGS_route_update_trace_count, traces.size());
+  // Most recent first
+  EXPECT_EQ(FLAGS_route_update_trace_count + 9, *traces[0].numRoutes_ref());
+  EXPECT_EQ(10, *traces.back().numRoutes_ref());
+  EXPECT_EQ(2, tracer->getTraces(2).size());
+}
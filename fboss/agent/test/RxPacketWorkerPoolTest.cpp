@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketWorkerPool.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+
+#include <folly/synchronization/Baton.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// Broadcast ARP, and the same behind a VLAN tag
+const std::string kArp = "ff ff ff ff ff ff 02 00 01 00 00 01 08 06";
+const std::string kTaggedArp =
+    "ff ff ff ff ff ff 02 00 01 00 00 01 81 00 00 01 08 06";
+const std::string kIPv6 = "33 33 00 00 00 01 02 00 01 00 00 01 86 dd";
+
+uint64_t flowKey(const std::string& hex, PortID port) {
+  auto pkt = MockRxPacket::fromHex(hex);
+  pkt->padToLength(64);
+  pkt->setSrcPort(port);
+  return RxPacketWorkerPool::flowKey(pkt.get());
+}
+
+} // namespace
+
+TEST(RxPacketWorkerPoolTest, flowKey) {
+  EXPECT_EQ(flowKey(kArp, PortID(1)), flowKey(kArp, PortID(1)));
+  // VLAN tags are skipped
+  EXPECT_EQ(flowKey(kArp, PortID(1)), flowKey(kTaggedArp, PortID(1)));
+  EXPECT_NE(flowKey(kArp, PortID(1)), flowKey(kArp, PortID(2)));
+  EXPECT_NE(flowKey(kArp, PortID(1)), flowKey(kIPv6, PortID(1)));
+}
+
+TEST(RxPacketWorkerPoolTest, flowOrderKept) {
+  RxPacketWorkerPool pool("rx_test", 4, 1000);
+  constexpr int kFlows = 16;
+  constexpr int kPackets = 100;
+  std::mutex mutex;
+  std::vector<std::vector<int>> handled(kFlows);
+  for (int i = 0; i < kPackets; ++i) {
+    for (int flow = 0; flow < kFlows; ++flow) {
+      EXPECT_TRUE(pool.dispatch(flow, [&mutex, &handled, flow, i] {
+        std::lock_guard<std::mutex> g(mutex);
+        handled[flow].push_back(i);
+      }));
+    }
+  }
+  pool.stop();
+  for (const auto& flowHandled : handled) {
+    ASSERT_EQ(kPackets, flowHandled.size());
+    EXPECT_TRUE(std::is_sorted(flowHandled.begin(), flowHandled.end()));
+  }
+  uint64_t processed = 0;
+  for (const auto& stats : pool.getWorkerStats()) {
+    processed += stats.processed;
+    EXPECT_EQ(0, stats.queueDepth);
+  }
+  EXPECT_EQ(kFlows * kPackets, processed);
+}
+
+TEST(RxPacketWorkerPoolTest, dropWhenQueueFull) {
+  RxPacketWorkerPool pool("rx_test", 1, 2);
+  folly::Baton<> blocked;
+  folly::Baton<> unblock;
+  EXPECT_TRUE(pool.dispatch(0, [&] {
+    blocked.post();
+    unblock.wait();
+  }));
+  blocked.wait();
+  // Work counts against the queue until done
+  EXPECT_TRUE(pool.dispatch(0, [] {}));
+  EXPECT_FALSE(pool.dispatch(0, [] {}));
+
+  auto stats = pool.getWorkerStats();
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ(1, stats[0].dropped);
+  EXPECT_EQ(2, stats[0].maxQueueDepth);
+  unblock.post();
+  pool.stop();
+  stats = pool.getWorkerStats();
+  EXPECT_EQ(2, stats[0].processed);
+  EXPECT_EQ(0, stats[0].queueDepth);
+}
+
+TEST(RxPacketWorkerPoolTest, dropAfterStop) {
+  RxPacketWorkerPool pool("rx_test", 1, 2);
+  pool.stop();
+  EXPECT_FALSE(pool.dispatch(0, [] { FAIL() << "Work ran after stop"; }));
+  auto stats = pool.getWorkerStats();
+  EXPECT_EQ(1, stats[0].dropped);
+  EXPECT_EQ(0, stats[0].queueDepth);
+}
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/ApplyThriftConfig.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/hw/sim/SimSwitch.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/RouteScaleGenerators.h"
+
+#include <boost/cast.hpp>
+#include <folly/Benchmark.h>
+#include <folly/MacAddress.h>
+#include <folly/logging/xlog.h>
+
+using namespace facebook::fboss;
+
+/*
+ * CPU only route convergence benchmarks: the route scale generators are
+ * pushed through SwSwitch into a SimSwitch, which programs its software
+ * forwarding tables. This exercises everything above the ASIC SDK, so
+ * regressions in the RIB/FIB/StateDelta path show up without hardware.
+ */
+template <typename Generator>
+static void runSimRouteScaleBenchmark() {
+  auto constexpr kNumPorts = 128;
+  folly::BenchmarkSuspender suspender;
+
+  auto sw = std::make_unique<SwSwitch>(std::make_unique<SimPlatform>(
+      folly::MacAddress("02:00:00:00:00:01"), kNumPorts));
+  sw->init(nullptr /* No custom TunManager */);
+
+  std::vector<PortID> ports;
+  for (int i = 1; i < kNumPorts; ++i) {
+    ports.push_back(PortID(i));
+  }
+  auto config = utility::onePortPerVlanConfig(sw->getHw(), ports);
+  sw->updateStateBlocking(
+      "apply config", [&](const std::shared_ptr<SwitchState>& state) {
+        return applyThriftConfig(state, &config, sw->getPlatform());
+      });
+
+  auto generator = Generator(sw->getState());
+  const auto& states = generator.getSwitchStates();
+
+  suspender.dismiss();
+  for (const auto& state : states) {
+    sw->updateStateBlocking(
+        "add routes",
+        [&state](const std::shared_ptr<SwitchState>& /*oldState*/) {
+          return state;
+        });
+  }
+  suspender.rehire();
+
+  auto sim = boost::polymorphic_downcast<SimSwitch*>(sw->getHw());
+  auto stats = sim->getProgrammingStats();
+  XLOG(INFO) << "SimSwitch programmed " << stats.numUpdates
+             << " updates, total: " << stats.totalLatency.count()
+             << "us, max: " << stats.maxLatency.count() << "us";
+}
+
+BENCHMARK(SimSwitchFswRouteScale) {
+  runSimRouteScaleBenchmark<utility::FSWRouteScaleGenerator>();
+}
+
+BENCHMARK(SimSwitchRswRouteScale) {
+  runSimRouteScaleBenchmark<utility::RSWRouteScaleGenerator>();
+}
+
+BENCHMARK(SimSwitchThAlpmRouteScale) {
+  runSimRouteScaleBenchmark<utility::THAlpmRouteScaleGenerator>();
+}
+
+BENCHMARK(SimSwitchHgridDuRouteScale) {
+  runSimRouteScaleBenchmark<utility::HgridDuRouteScaleGenerator>();
+}
+
+BENCHMARK(SimSwitchHgridUuRouteScale) {
+  runSimRouteScaleBenchmark<utility::HgridUuRouteScaleGenerator>();
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/hw/sim/SimSwitch.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/io/Cursor.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::MacAddress;
+
+namespace {
+
+class RecordingCallback : public HwSwitch::Callback {
+ public:
+  void packetReceived(std::unique_ptr<RxPacket> pkt) noexcept override {
+    punted.push_back(std::move(pkt));
+  }
+  void linkStateChanged(PortID /*port*/, bool /*up*/) override {}
+  void l2LearningUpdateReceived(
+      L2Entry /*l2Entry*/,
+      L2EntryUpdateType /*l2EntryUpdateType*/) override {}
+  void exitFatal() const noexcept override {}
+
+  std::vector<std::unique_ptr<RxPacket>> punted;
+};
+
+// UDP from 10.0.55.10 on VLAN 55 towards dstIp, ingressing port 12
+std::unique_ptr<MockRxPacket> makeIPv4Packet(
+    const std::string& dstMacHex,
+    const std::string& dstIpHex) {
+  auto pkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      dstMacHex + " 02 00 00 00 00 99"
+      // IPv4
+      " 08 00"
+      // version/ihl, tos, length, id, flags/frag, ttl 64, UDP, csum
+      " 45 00 00 14 00 00 00 00 40 11 00 00"
+      // src ip 10.0.55.10
+      " 0a 00 37 0a " +
+      dstIpHex);
+  pkt->setSrcPort(PortID(12));
+  pkt->setSrcVlan(VlanID(55));
+  return pkt;
+}
+
+class SimSwitchTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    platform_ =
+        std::make_unique<SimPlatform>(MacAddress("02:00:00:00:00:01"), 20);
+    sim_ = static_cast<SimSwitch*>(platform_->getHwSwitch());
+    sim_->init(&callback_, false);
+    sim_->setPortTxHandler(
+        [this](PortID port, std::unique_ptr<folly::IOBuf> buf) {
+          egress_.emplace_back(port, std::move(buf));
+        });
+    applyState(testStateAWithPortsUp());
+  }
+
+  void applyState(const std::shared_ptr<SwitchState>& newState) {
+    auto oldState = state_ ? state_ : std::make_shared<SwitchState>();
+    sim_->stateChanged(StateDelta(oldState, newState));
+    state_ = newState;
+  }
+
+  void resolveNextHops() {
+    auto newState = state_->clone();
+    auto arpTable =
+        state_->getVlans()->getVlan(VlanID(1))->getArpTable()->modify(
+            VlanID(1), &newState);
+    arpTable->addEntry(
+        IPAddressV4("10.0.0.22"),
+        MacAddress("02:00:00:00:00:22"),
+        PortDescriptor(PortID(2)),
+        InterfaceID(1));
+    arpTable->addEntry(
+        IPAddressV4("10.0.0.23"),
+        MacAddress("02:00:00:00:00:23"),
+        PortDescriptor(PortID(3)),
+        InterfaceID(1));
+    applyState(newState);
+  }
+
+ protected:
+  RecordingCallback callback_;
+  std::unique_ptr<SimPlatform> platform_;
+  SimSwitch* sim_{nullptr};
+  std::shared_ptr<SwitchState> state_;
+  std::vector<std::pair<PortID, std::unique_ptr<folly::IOBuf>>> egress_;
+};
+
+} // namespace
+
+TEST_F(SimSwitchTest, ProgramsTablesFromDelta) {
+  resolveNextHops();
+  sim_->withForwardingTables([](const SimForwardingTables& tables) {
+    EXPECT_GT(tables.numRoutes(), 0);
+    EXPECT_EQ(2, tables.numHosts());
+    // 10.1.1.0/24 is the only multi-path route
+    auto route = tables.longestMatch(RouterID(0), IPAddressV4("10.1.1.5"));
+    ASSERT_NE(nullptr, route);
+    EXPECT_EQ(RouteForwardAction::NEXTHOPS, route->action);
+    EXPECT_EQ(2, route->ecmpGroup->members().size());
+  });
+  auto stats = sim_->getProgrammingStats();
+  EXPECT_EQ(2, stats.numUpdates);
+  EXPECT_GE(stats.totalLatency, stats.maxLatency);
+}
+
+TEST_F(SimSwitchTest, RoutedPacketIsForwarded) {
+  resolveNextHops();
+  sim_->injectPacket(makeIPv4Packet("00 02 00 00 00 55", "0a 01 01 05"));
+
+  EXPECT_TRUE(callback_.punted.empty());
+  ASSERT_EQ(1, egress_.size());
+  auto port = egress_[0].first;
+  EXPECT_TRUE(port == PortID(2) || port == PortID(3));
+
+  folly::io::Cursor cursor(egress_[0].second.get());
+  EthHdr ethHdr(cursor);
+  EXPECT_EQ(
+      port == PortID(2) ? MacAddress("02:00:00:00:00:22")
+                        : MacAddress("02:00:00:00:00:23"),
+      ethHdr.getDstMac());
+  EXPECT_EQ(MacAddress("00:02:00:00:00:01"), ethHdr.getSrcMac());
+  IPv4Hdr ipHdr(cursor);
+  EXPECT_EQ(63, ipHdr.ttl);
+  EXPECT_EQ(IPAddressV4("10.1.1.5"), ipHdr.dstAddr);
+  EXPECT_EQ(1, sim_->getForwardingStats().routedPackets);
+  EXPECT_EQ(1, sim_->getPortTxCount(port));
+}
+
+TEST_F(SimSwitchTest, UnresolvedNextHopIsPunted) {
+  sim_->injectPacket(makeIPv4Packet("00 02 00 00 00 55", "0a 01 01 05"));
+  EXPECT_TRUE(egress_.empty());
+  EXPECT_EQ(1, callback_.punted.size());
+  EXPECT_EQ(1, sim_->getForwardingStats().puntedPackets);
+}
+
+TEST_F(SimSwitchTest, PacketToLocalAddressIsPunted) {
+  resolveNextHops();
+  // 10.0.55.1 is interface 55's address
+  sim_->injectPacket(makeIPv4Packet("00 02 00 00 00 55", "0a 00 37 01"));
+  EXPECT_TRUE(egress_.empty());
+  EXPECT_EQ(1, callback_.punted.size());
+}
+
+TEST_F(SimSwitchTest, BroadcastIsPuntedAndFlooded) {
+  sim_->injectPacket(makeIPv4Packet("ff ff ff ff ff ff", "ff ff ff ff"));
+  EXPECT_EQ(1, callback_.punted.size());
+  // Ports 11-20 are in VLAN 55, all but the ingress port get a copy
+  EXPECT_EQ(9, egress_.size());
+  for (const auto& pkt : egress_) {
+    EXPECT_NE(PortID(12), pkt.first);
+  }
+}
+
+TEST_F(SimSwitchTest, NoRouteIsDropped) {
+  resolveNextHops();
+  sim_->injectPacket(makeIPv4Packet("00 02 00 00 00 55", "0b 00 00 01"));
+  EXPECT_TRUE(egress_.empty());
+  EXPECT_TRUE(callback_.punted.empty());
+  EXPECT_EQ(1, sim_->getForwardingStats().droppedPackets);
+}
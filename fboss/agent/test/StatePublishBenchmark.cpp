@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/init/Init.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteTypes.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV6.h>
+
+#include <memory>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// Routes changed by each update, whatever the size of the FIB
+constexpr size_t kRoutesChanged = 10;
+
+RoutePrefixV6 prefix(size_t index) {
+  folly::ByteArray16 bytes{};
+  bytes[0] = 0x20;
+  bytes[1] = 0x01;
+  for (size_t i = 0; i < sizeof(index); ++i) {
+    bytes[15 - i] = (index >> (8 * i)) & 0xff;
+  }
+  return RoutePrefixV6{folly::IPAddressV6(bytes), 128};
+}
+
+std::shared_ptr<ForwardingInformationBaseV6> publishedFib(size_t numRoutes) {
+  auto fib = std::make_shared<ForwardingInformationBaseV6>();
+  for (size_t i = 0; i < numRoutes; ++i) {
+    RouteFields<folly::IPAddressV6> fields(prefix(i));
+    fib->addNode(std::make_shared<RouteV6>(fields));
+  }
+  fib->publish();
+  return fib;
+}
+
+/*
+ * Clone a published FIB, replace a few routes in it and publish it, as a
+ * state update changing a few routes does.
+ */
+void publishBenchmark(size_t iters, size_t numRoutes, bool writableNodes) {
+  std::shared_ptr<ForwardingInformationBaseV6> fib;
+  BENCHMARK_SUSPEND {
+    fib = publishedFib(numRoutes);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    std::shared_ptr<ForwardingInformationBaseV6> newFib;
+    BENCHMARK_SUSPEND {
+      newFib = fib->clone();
+      if (writableNodes) {
+        // As if the nodes were changed without the map knowing which
+        newFib->writableNodes();
+      }
+      for (size_t j = 0; j < kRoutesChanged; ++j) {
+        auto index = (i * kRoutesChanged + j) % numRoutes;
+        newFib->updateNode(newFib->getNode(prefix(index))->clone());
+      }
+    }
+    newFib->publish();
+    BENCHMARK_SUSPEND {
+      fib = std::move(newFib);
+    }
+  }
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(publishBenchmark, 1k_routes, 1000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(publishBenchmark, 1k_routes_all, 1000, true)
+BENCHMARK_NAMED_PARAM(publishBenchmark, 10k_routes, 10000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(publishBenchmark, 10k_routes_all, 10000, true)
+BENCHMARK_NAMED_PARAM(publishBenchmark, 100k_routes, 100000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(publishBenchmark, 100k_routes_all, 100000, true)
+BENCHMARK_NAMED_PARAM(publishBenchmark, 200k_routes, 200000, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(publishBenchmark, 200k_routes_all, 200000, true)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
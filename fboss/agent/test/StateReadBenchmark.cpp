@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/init/Init.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Benchmark.h>
+#include <folly/MacAddress.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+std::unique_ptr<SwSwitch> sw;
+
+/*
+ * Read the state from numThreads threads at once, as the RX and thrift
+ * threads do, while the update thread keeps replacing it if withUpdates.
+ */
+template <typename ReadFn>
+void readBenchmark(
+    size_t iters,
+    size_t numThreads,
+    bool withUpdates,
+    ReadFn read) {
+  std::atomic<bool> done{false};
+  std::thread updater;
+  BENCHMARK_SUSPEND {
+    if (withUpdates) {
+      updater = std::thread([&done]() {
+        while (!done.load()) {
+          sw->updateStateBlocking(
+              "bump generation",
+              [](const std::shared_ptr<SwitchState>& state) {
+                return state->clone();
+              });
+        }
+      });
+    }
+  }
+
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < numThreads; ++i) {
+    readers.emplace_back([iters, numThreads, read]() {
+      for (size_t j = 0; j < iters / numThreads; ++j) {
+        read();
+      }
+    });
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  BENCHMARK_SUSPEND {
+    done = true;
+    if (updater.joinable()) {
+      updater.join();
+    }
+  }
+}
+
+void getStateBenchmark(size_t iters, size_t numThreads, bool withUpdates) {
+  readBenchmark(iters, numThreads, withUpdates, []() {
+    auto state = sw->getState();
+    folly::doNotOptimizeAway(state->getGeneration());
+  });
+}
+
+void getStateViewBenchmark(size_t iters, size_t numThreads, bool withUpdates) {
+  readBenchmark(iters, numThreads, withUpdates, []() {
+    auto state = sw->getStateView();
+    folly::doNotOptimizeAway(state->getGeneration());
+  });
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(getStateBenchmark, 1_thread, 1, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(getStateViewBenchmark, 1_thread, 1, false)
+BENCHMARK_NAMED_PARAM(getStateBenchmark, 4_threads, 4, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(getStateViewBenchmark, 4_threads, 4, false)
+BENCHMARK_NAMED_PARAM(getStateBenchmark, 16_threads, 16, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(getStateViewBenchmark, 16_threads, 16, false)
+
+BENCHMARK_DRAW_LINE();
+
+// With state updates going on
+BENCHMARK_NAMED_PARAM(getStateBenchmark, 4_threads_updates, 4, true)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    getStateViewBenchmark, 4_threads_updates, 4, true)
+BENCHMARK_NAMED_PARAM(getStateBenchmark, 16_threads_updates, 16, true)
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    getStateViewBenchmark, 16_threads_updates, 16, true)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+
+  // Setting up the switch is expensive, so it is done once for all of the
+  // benchmarks
+  folly::MacAddress localMac("02:00:01:00:00:01");
+  sw = std::make_unique<SwSwitch>(std::make_unique<SimPlatform>(localMac, 10));
+  sw->init(nullptr /* No custom TunManager */);
+
+  folly::runBenchmarks();
+  sw.reset();
+  return EXIT_SUCCESS;
+}
@@ -29,7 +29,12 @@
 #include <folly/IPAddressV6.h>
 #include <folly/MacAddress.h>
 
+#include <gflags/gflags.h>
+
 #include <algorithm>
+#include <thread>
+
+DECLARE_uint32(link_state_coalesce_window_ms);
 
 using namespace facebook::fboss;
 using folly::IPAddressV4;
@@ -81,6 +86,24 @@ TEST_F(SwSwitchTest, GetPortStats) {
   EXPECT_EQ(sw->stats()->getPortStats()->size(), 2);
   EXPECT_EQ(portStats->getPortName(), "port0");
 }
+TEST_F(SwSwitchTest, StateView) {
+  auto oldState = sw->getState();
+  auto oldView = sw->getStateView();
+  EXPECT_EQ(oldState.get(), oldView.get());
+
+  sw->updateState(
+      "Bring Ports Up", [](const std::shared_ptr<SwitchState>& state) {
+        return bringAllPortsUp(state);
+      });
+  waitForStateUpdates(sw);
+
+  // Views taken before the update keep reading the state they started with
+  auto newView = sw->getStateView();
+  EXPECT_EQ(sw->getState().get(), newView.get());
+  EXPECT_EQ(oldState->getGeneration(), oldView->getGeneration());
+  EXPECT_GT(newView->getGeneration(), oldView->getGeneration());
+}
+
 ACTION(ThrowException) {
   throw std::exception();
 }
@@ -161,6 +184,64 @@ TEST_F(SwSwitchTest, TestStateNonCoalescing) {
   verifyReachableCnt(0);
 }
 
+TEST_F(SwSwitchTest, LinkStateChangesCoalesced) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_link_state_coalesce_window_ms = 10;
+  const PortID kPort1{1};
+  const PortID kPort2{2};
+  const PortID kPort3{3};
+  const VlanID kVlan1{1};
+
+  auto getReachableCount = [kVlan1, this]() {
+    auto reachableCnt = 0;
+    auto arpTable = sw->getState()->getVlans()->getVlan(kVlan1)->getArpTable();
+    for (const auto entry : *arpTable) {
+      if (entry->getState() == NeighborState::REACHABLE) {
+        ++reachableCnt;
+      }
+    }
+    return reachableCnt;
+  };
+  auto waitForLinkStateChanges = [this]() {
+    // Wait past the window, for the changes to be scheduled
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(10 * FLAGS_link_state_coalesce_window_ms));
+    waitForStateUpdates(sw);
+  };
+  auto bringPortsUpUpdateFn = [](const std::shared_ptr<SwitchState>& state) {
+    return bringAllPortsUp(state);
+  };
+  sw->updateState("Bring Ports Up", bringPortsUpUpdateFn);
+  sw->getNeighborUpdater()->receivedArpMine(
+      kVlan1,
+      IPAddressV4("10.0.0.2"),
+      MacAddress("01:02:03:04:05:06"),
+      PortDescriptor(kPort1),
+      ArpOpCode::ARP_OP_REPLY);
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+  EXPECT_EQ(1, getReachableCount());
+
+  // Flap port 1, and bring ports 2 and 3 down, all within the window
+  sw->linkStateChanged(kPort1, false);
+  sw->linkStateChanged(kPort1, true);
+  sw->linkStateChanged(kPort2, false);
+  sw->linkStateChanged(kPort3, false);
+  waitForLinkStateChanges();
+  EXPECT_FALSE(sw->getState()->getPort(kPort2)->isUp());
+  EXPECT_FALSE(sw->getState()->getPort(kPort3)->isUp());
+  // Port 1 comes back up in the next batch
+  waitForLinkStateChanges();
+  EXPECT_TRUE(sw->getState()->getPort(kPort1)->isUp());
+
+  // Port 1 going down in between was not missed, its neighbor is purged
+  waitForBackgroundThread(sw);
+  waitForStateUpdates(sw);
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+  waitForStateUpdates(sw);
+  EXPECT_EQ(0, getReachableCount());
+}
+
 TEST_F(SwSwitchTest, VerifyIsValidStateUpdate) {
   ON_CALL(*getMockHw(sw), isValidStateUpdate(_))
       .WillByDefault(testing::Return(true));
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/init/Init.h"
+#include "fboss/agent/state/UcmpWeightNormalizer.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+
+#include <random>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+constexpr size_t kNumRoutes = 10000;
+// Routes mostly share a few next hop sets, one per group of neighbors
+constexpr size_t kNumNextHopSets = 100;
+
+enum class Weights {
+  // Remaining capacity of the paths, in Gbps
+  CAPACITY,
+  // A few paths carrying most of the traffic
+  SKEWED,
+  // As many paths as fit in the ECMP width, with arbitrary weights
+  WIDE,
+};
+
+RouteNextHopSet makeNextHops(Weights weights, std::mt19937* gen) {
+  size_t numNextHops = 16;
+  if (weights == Weights::SKEWED) {
+    numNextHops = 32;
+  } else if (weights == Weights::WIDE) {
+    numNextHops = FLAGS_ecmp_width;
+  }
+  std::uniform_int_distribution<NextHopWeight> capacity(1, 400);
+  std::uniform_int_distribution<NextHopWeight> arbitrary(1, 100000);
+  RouteNextHopSet nhops;
+  for (size_t i = 0; i < numNextHops; ++i) {
+    NextHopWeight weight = 0;
+    switch (weights) {
+      case Weights::CAPACITY:
+        weight = capacity(*gen);
+        break;
+      case Weights::SKEWED:
+        weight = 100000 / (i + 1) + capacity(*gen);
+        break;
+      case Weights::WIDE:
+        weight = arbitrary(*gen);
+        break;
+    }
+    nhops.insert(ResolvedNextHop(
+        folly::IPAddress(folly::sformat("2401:db00::{}", i + 1)),
+        InterfaceID(i % 4 + 1),
+        weight));
+  }
+  return nhops;
+}
+
+std::vector<RouteNextHopSet> makeRouteNextHops(Weights weights) {
+  std::mt19937 gen(0);
+  std::vector<RouteNextHopSet> nextHopSets;
+  for (size_t i = 0; i < kNumNextHopSets; ++i) {
+    nextHopSets.push_back(makeNextHops(weights, &gen));
+  }
+  std::uniform_int_distribution<size_t> pick(0, kNumNextHopSets - 1);
+  std::vector<RouteNextHopSet> routeNextHops;
+  for (size_t i = 0; i < kNumRoutes; ++i) {
+    routeNextHops.push_back(nextHopSets[pick(gen)]);
+  }
+  return routeNextHops;
+}
+
+/*
+ * Normalize the next hops of every route, as programming them does
+ */
+void normalizeBenchmark(size_t iters, Weights weights, bool memoized) {
+  std::vector<RouteNextHopSet> routeNextHops;
+  BENCHMARK_SUSPEND {
+    routeNextHops = makeRouteNextHops(weights);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    BENCHMARK_SUSPEND {
+      UcmpWeightNormalizer::getInstance()->clear();
+    }
+    for (const auto& nhops : routeNextHops) {
+      if (memoized) {
+        folly::doNotOptimizeAway(UcmpWeightNormalizer::getInstance()->normalize(
+            nhops, FLAGS_ecmp_width));
+      } else {
+        folly::doNotOptimizeAway(
+            UcmpWeightNormalizer::normalizeImpl(nhops, FLAGS_ecmp_width));
+      }
+    }
+  }
+}
+
+} // namespace
+
+#define UCMP_NORMALIZE_BENCHMARK(name, weights) \
+  BENCHMARK(name, iters) {                      \
+    normalizeBenchmark(iters, weights, false);  \
+  }                                             \
+  BENCHMARK_RELATIVE(name##Memoized, iters) {   \
+    normalizeBenchmark(iters, weights, true);   \
+  }
+
+UCMP_NORMALIZE_BENCHMARK(CapacityWeights, Weights::CAPACITY)
+UCMP_NORMALIZE_BENCHMARK(SkewedWeights, Weights::SKEWED)
+UCMP_NORMALIZE_BENCHMARK(WideWeights, Weights::WIDE)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/lib/CallProfiler.h"
+
+#include <fb303/ServiceData.h>
+#include <folly/Conv.h>
+#include <gflags/gflags.h>
+
+#include <cmath>
+
+#include <fmt/format.h>
+
+DEFINE_bool(
+    enable_call_profiler,
+    true,
+    "Record the count and latency of SDK calls per API and operation");
+
+namespace facebook::fboss {
+
+thread_local CallProfiler::ThreadStats* CallProfiler::threadStats_{nullptr};
+
+/*
+ * Hands the stats of a thread back to the profiler when the thread exits
+ */
+struct CallProfiler::ThreadStatsReleaser {
+  ~ThreadStatsReleaser() {
+    if (threadStats_) {
+      CallProfiler::getInstance()->unregisterThread(threadStats_);
+      threadStats_ = nullptr;
+    }
+  }
+};
+
+std::chrono::nanoseconds CallProfiler::CallStats::percentile(
+    double pct) const {
+  auto target = static_cast<uint64_t>(std::ceil(count * pct / 100));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets[i];
+    if (seen && seen >= target) {
+      return std::chrono::nanoseconds(1ULL << (i + 1));
+    }
+  }
+  return std::chrono::nanoseconds(0);
+}
+
+CallProfiler::CallProfiler() : isOn_(FLAGS_enable_call_profiler) {}
+
+CallProfiler::ThreadStats::~ThreadStats() {
+  for (auto& histogram : histograms) {
+    delete histogram.load();
+  }
+}
+
+CallProfiler::Histogram* CallProfiler::ThreadStats::create(size_t slot) {
+  auto histogram = new Histogram();
+  histograms[slot].store(histogram, std::memory_order_release);
+  return histogram;
+}
+
+CallProfiler::ThreadStats* CallProfiler::registerThread() {
+  static thread_local ThreadStatsReleaser releaser;
+  (void)releaser;
+  auto stats = std::make_unique<ThreadStats>();
+  threadStats_ = stats.get();
+  allStats_.wlock()->threads.push_back(std::move(stats));
+  return threadStats_;
+}
+
+void CallProfiler::unregisterThread(ThreadStats* stats) {
+  auto allStats = allStats_.wlock();
+  for (size_t slot = 0; slot < stats->histograms.size(); ++slot) {
+    auto histogram = stats->histograms[slot].load(std::memory_order_acquire);
+    if (!histogram) {
+      continue;
+    }
+    auto exited = allStats->exited.histograms[slot].load();
+    if (!exited) {
+      exited = allStats->exited.create(slot);
+    }
+    ThreadStats::increment(exited->count, histogram->count.load());
+    ThreadStats::increment(exited->totalNsecs, histogram->totalNsecs.load());
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      ThreadStats::increment(exited->buckets[i], histogram->buckets[i].load());
+    }
+  }
+  auto& threads = allStats->threads;
+  threads.erase(
+      std::remove_if(
+          threads.begin(),
+          threads.end(),
+          [stats](const auto& threadStats) {
+            return threadStats.get() == stats;
+          }),
+      threads.end());
+}
+
+void CallProfiler::setApiName(uint32_t api, std::string name) {
+  (*apiNames_.wlock())[std::min(api, kMaxApis - 1)] = std::move(name);
+}
+
+std::string CallProfiler::apiName(uint32_t api) const {
+  auto name = (*apiNames_.rlock())[std::min(api, kMaxApis - 1)];
+  return name.empty() ? folly::to<std::string>(api) : name;
+}
+
+std::string CallProfiler::operationStr(Operation op) {
+  switch (op) {
+    case Operation::CREATE:
+      return "create";
+    case Operation::REMOVE:
+      return "remove";
+    case Operation::SET:
+      return "set";
+    case Operation::GET:
+      return "get";
+    case Operation::STATS:
+      return "stats";
+    case Operation::OTHER:
+      return "other";
+  }
+  return "unknown";
+}
+
+std::vector<CallProfiler::CallStats> CallProfiler::getCallStats() const {
+  std::vector<CallStats> callStats;
+  auto allStats = allStats_.rlock();
+  for (size_t slot = 0; slot < kMaxApis * kNumOperations; ++slot) {
+    CallStats stats;
+    stats.api = slot / kNumOperations;
+    stats.op = static_cast<Operation>(slot % kNumOperations);
+    auto add = [&stats, slot](const ThreadStats& threadStats) {
+      auto histogram =
+          threadStats.histograms[slot].load(std::memory_order_acquire);
+      if (!histogram) {
+        return;
+      }
+      stats.count += histogram->count.load(std::memory_order_relaxed);
+      stats.totalNsecs +=
+          histogram->totalNsecs.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < kNumBuckets; ++i) {
+        stats.buckets[i] +=
+            histogram->buckets[i].load(std::memory_order_relaxed);
+      }
+    };
+    add(allStats->exited);
+    for (const auto& threadStats : allStats->threads) {
+      add(*threadStats);
+    }
+    if (stats.count) {
+      callStats.push_back(stats);
+    }
+  }
+  return callStats;
+}
+
+std::string CallProfiler::dump() const {
+  auto callStats = getCallStats();
+  // Costliest calls first
+  std::sort(
+      callStats.begin(),
+      callStats.end(),
+      [](const auto& lhs, const auto& rhs) {
+        return lhs.totalNsecs > rhs.totalNsecs;
+      });
+  std::string output = fmt::format(
+      "{:<20} {:<8} {:>10} {:>12} {:>10} {:>10} {:>10}\n",
+      "api",
+      "op",
+      "calls",
+      "total_ms",
+      "avg_us",
+      "p50_us",
+      "p99_us");
+  for (const auto& stats : callStats) {
+    output += fmt::format(
+        "{:<20} {:<8} {:>10} {:>12.3f} {:>10.3f} {:>10.3f} {:>10.3f}\n",
+        apiName(stats.api),
+        operationStr(stats.op),
+        stats.count,
+        stats.totalNsecs / 1e6,
+        stats.totalNsecs / 1e3 / stats.count,
+        stats.percentile(50).count() / 1e3,
+        stats.percentile(99).count() / 1e3);
+  }
+  return output;
+}
+
+void CallProfiler::publish() const {
+  for (const auto& stats : getCallStats()) {
+    auto prefix = fmt::format(
+        "sdk_calls.{}.{}", apiName(stats.api), operationStr(stats.op));
+    fb303::fbData->setCounter(prefix + ".count", stats.count);
+    fb303::fbData->setCounter(prefix + ".usecs", stats.totalNsecs / 1000);
+  }
+}
+
+void CallProfiler::clear() {
+  auto allStats = allStats_.wlock();
+  auto clearStats = [](ThreadStats& threadStats) {
+    for (auto& slot : threadStats.histograms) {
+      auto histogram = slot.load(std::memory_order_acquire);
+      if (!histogram) {
+        continue;
+      }
+      histogram->count.store(0, std::memory_order_relaxed);
+      histogram->totalNsecs.store(0, std::memory_order_relaxed);
+      for (auto& bucket : histogram->buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  };
+  clearStats(allStats->exited);
+  for (auto& threadStats : allStats->threads) {
+    clearStats(*threadStats);
+  }
+}
+
+} // namespace facebook::fboss
@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#pragma once
+
+#include <folly/Likely.h>
+#include <folly/lang/Bits.h>
+#include <folly/Preprocessor.h>
+#include <folly/Synchronized.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace facebook::fboss {
+
+/*
+ * Profiles the calls into the SDK (SAI or native), keeping call counts and
+ * latency histograms per API type and operation. Calls are recorded into
+ * stats owned by the calling thread, reached through a plain thread local
+ * pointer, so recording a call takes no lock and touches no refcount. The
+ * stats of all threads are only summed up when read (dump, publish,
+ * getCallStats).
+ */
+class CallProfiler {
+ public:
+  enum class Operation : uint8_t {
+    CREATE,
+    REMOVE,
+    SET,
+    GET,
+    STATS,
+    OTHER,
+  };
+  static constexpr size_t kNumOperations =
+      static_cast<size_t>(Operation::OTHER) + 1;
+  // Wide enough for every SAI api type, larger ones share the last slot
+  static constexpr uint32_t kMaxApis = 64;
+  // Bucket i counts calls taking [2^i, 2^(i+1)) nsecs, the last bucket
+  // counts anything slower
+  static constexpr size_t kNumBuckets = 32;
+
+  struct CallStats {
+    uint32_t api{0};
+    Operation op{Operation::OTHER};
+    uint64_t count{0};
+    uint64_t totalNsecs{0};
+    std::array<uint64_t, kNumBuckets> buckets{};
+
+    /*
+     * Upper bound of the bucket the given percentile (0-100) of calls
+     * falls in
+     */
+    std::chrono::nanoseconds percentile(double pct) const;
+  };
+
+  /*
+   * The profiler lives as long as the process, so that calls made while
+   * static objects are destroyed can still be recorded
+   */
+  static CallProfiler* getInstance() {
+    static CallProfiler* profiler = new CallProfiler();
+    return profiler;
+  }
+
+  CallProfiler(const CallProfiler&) = delete;
+  CallProfiler& operator=(const CallProfiler&) = delete;
+
+  bool isOn() const {
+    return isOn_.load(std::memory_order_relaxed);
+  }
+  void setOn(bool on) {
+    isOn_.store(on, std::memory_order_relaxed);
+  }
+
+  void record(uint32_t api, Operation op, std::chrono::nanoseconds latency) {
+    auto stats = threadStats_;
+    if (UNLIKELY(!stats)) {
+      stats = registerThread();
+    }
+    stats->record(api, op, latency);
+  }
+
+  void setApiName(uint32_t api, std::string name);
+  std::string apiName(uint32_t api) const;
+
+  /*
+   * Stats of every (api, operation) called so far, summed over threads
+   */
+  std::vector<CallStats> getCallStats() const;
+  /*
+   * Human readable table of count, total time and latency percentiles
+   * per (api, operation)
+   */
+  std::string dump() const;
+  /*
+   * Export call counts and total call time to fb303, as
+   * sdk_calls.<api>.<operation>.{count,usecs}
+   */
+  void publish() const;
+  /*
+   * Calls recorded while clearing may or may not be cleared
+   */
+  void clear();
+
+  static std::string operationStr(Operation op);
+
+  /*
+   * Records the time from construction to destruction as one call
+   */
+  class ScopedCall {
+   public:
+    ScopedCall(uint32_t api, Operation op) : api_(api), op_(op) {
+      if (LIKELY(CallProfiler::getInstance()->isOn())) {
+        start_ = std::chrono::steady_clock::now();
+      }
+    }
+    ~ScopedCall() {
+      if (start_.time_since_epoch().count()) {
+        CallProfiler::getInstance()->record(
+            api_, op_, std::chrono::steady_clock::now() - start_);
+      }
+    }
+    ScopedCall(const ScopedCall&) = delete;
+    ScopedCall& operator=(const ScopedCall&) = delete;
+
+   private:
+    uint32_t api_;
+    Operation op_;
+    std::chrono::steady_clock::time_point start_{};
+  };
+
+ private:
+  struct Histogram {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalNsecs{0};
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets{};
+  };
+
+  /*
+   * Written only by the owning thread, read by whoever sums the stats up.
+   * Histograms are allocated on the first call to their (api, operation)
+   */
+  struct ThreadStats {
+    ~ThreadStats();
+    void record(uint32_t api, Operation op, std::chrono::nanoseconds latency) {
+      auto slot = index(api, op);
+      auto histogram = histograms[slot].load(std::memory_order_acquire);
+      if (UNLIKELY(!histogram)) {
+        histogram = create(slot);
+      }
+      uint64_t nsecs = std::max<int64_t>(latency.count(), 0);
+      auto bucket = std::min<size_t>(
+          std::max<size_t>(folly::findLastSet(nsecs), 1) - 1, kNumBuckets - 1);
+      // Only this thread writes, so there is no need for atomic increments
+      increment(histogram->count, 1);
+      increment(histogram->totalNsecs, nsecs);
+      increment(histogram->buckets[bucket], 1);
+    }
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+      counter.store(
+          counter.load(std::memory_order_relaxed) + value,
+          std::memory_order_relaxed);
+    }
+    Histogram* create(size_t slot);
+
+    std::array<std::atomic<Histogram*>, kMaxApis * kNumOperations>
+        histograms{};
+  };
+
+  struct ThreadStatsReleaser;
+
+  CallProfiler();
+  ~CallProfiler() = default;
+
+  ThreadStats* registerThread();
+  void unregisterThread(ThreadStats* stats);
+
+  static size_t index(uint32_t api, Operation op) {
+    if (UNLIKELY(api >= kMaxApis)) {
+      api = kMaxApis - 1;
+    }
+    return api * kNumOperations + static_cast<size_t>(op);
+  }
+
+  struct AllStats {
+    std::vector<std::unique_ptr<ThreadStats>> threads;
+    // Stats of exited threads
+    ThreadStats exited;
+  };
+
+  std::atomic<bool> isOn_;
+  folly::Synchronized<AllStats> allStats_;
+  folly::Synchronized<std::array<std::string, kMaxApis>> apiNames_;
+
+  static thread_local ThreadStats* threadStats_;
+};
+
+#define PROFILE_CALL(api, op)                   \
+  facebook::fboss::CallProfiler::ScopedCall \
+  FB_ANONYMOUS_VARIABLE(profiledCall)(api, op)
+
+} // namespace facebook::fboss
@@ -0,0 +1,550 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/lang/Bits.h>
+
+namespace facebook::network {
+
+/*
+ * Packed, left aligned representation of the address bits of a prefix, so
+ * that bit N (counting from the MSB) of an address is bit N of the words.
+ */
+template <typename IPADDRTYPE>
+struct CompactPrefixBits;
+
+template <>
+struct CompactPrefixBits<folly::IPAddressV4> {
+  typedef uint32_t Word;
+  static constexpr size_t kNumWords = 1;
+  typedef std::array<Word, kNumWords> Bits;
+
+  static Bits fromAddress(const folly::IPAddressV4& addr) {
+    return {{addr.toLongHBO()}};
+  }
+  static folly::IPAddressV4 toAddress(const Bits& bits) {
+    return folly::IPAddressV4::fromLongHBO(bits[0]);
+  }
+};
+
+template <>
+struct CompactPrefixBits<folly::IPAddressV6> {
+  typedef uint64_t Word;
+  static constexpr size_t kNumWords = 2;
+  typedef std::array<Word, kNumWords> Bits;
+
+  static Bits fromAddress(const folly::IPAddressV6& addr) {
+    auto bytes = addr.toByteArray();
+    return {
+        {folly::Endian::big(folly::loadUnaligned<uint64_t>(bytes.data())),
+         folly::Endian::big(
+             folly::loadUnaligned<uint64_t>(bytes.data() + 8))}};
+  }
+  static folly::IPAddressV6 toAddress(const Bits& bits) {
+    folly::ByteArray16 bytes;
+    folly::storeUnaligned(bytes.data(), folly::Endian::big(bits[0]));
+    folly::storeUnaligned(bytes.data() + 8, folly::Endian::big(bits[1]));
+    return folly::IPAddressV6(bytes);
+  }
+};
+
+/*
+ * Memory compact variant of RadixTree, for trees holding a large number of
+ * prefixes, e.g. a RIB with hundreds of thousands of routes per VRF.
+ *
+ * Rather than being individually heap allocated and linked through
+ * unique_ptrs, all nodes live in a single pool owned by the tree and
+ * reference each other through 32 bit indices into it. Nodes hold the
+ * address bits packed into machine words instead of a folly IP address,
+ * and there is no per node delete callback. Freed nodes are recycled
+ * through a free list threaded through the pool.
+ *
+ * The tree is a path compressed binary trie with the same invariants as
+ * RadixTree: nodes without a value always have 2 children.
+ *
+ * Since nodes move when the pool grows, iterators are invalidated by
+ * insertions, as well as by erasing the node they point to.
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTree {
+  typedef CompactPrefixBits<IPADDRTYPE> PrefixBits;
+  typedef typename PrefixBits::Word Word;
+  typedef typename PrefixBits::Bits Bits;
+  static constexpr uint32_t kWordBits = sizeof(Word) * 8;
+  static constexpr uint32_t kNull = std::numeric_limits<uint32_t>::max();
+
+  struct Node {
+    Bits bits;
+    // Children, or the next free node for nodes on the free list
+    std::array<uint32_t, 2> children{{kNull, kNull}};
+    uint32_t parent{kNull};
+    uint8_t masklen{0};
+    std::optional<T> value;
+  };
+
+  template <bool kIsConst>
+  class IteratorImpl : public std::iterator<
+                           std::forward_iterator_tag,
+                           IteratorImpl<kIsConst>> {
+   public:
+    typedef typename std::
+        conditional<kIsConst, const CompactRadixTree*, CompactRadixTree*>::type
+            TreePtr;
+    typedef typename std::conditional<kIsConst, const T, T>::type ValueType;
+
+    IteratorImpl() {}
+    IteratorImpl(TreePtr tree, uint32_t cursor)
+        : tree_(tree), cursor_(cursor) {}
+    // Allow conversion from iterator to const iterator
+    template <
+        bool kOtherConst,
+        typename = std::enable_if_t<kIsConst && !kOtherConst>>
+    /* implicit */ IteratorImpl(const IteratorImpl<kOtherConst>& other)
+        : tree_(other.tree_), cursor_(other.cursor_) {}
+
+    IteratorImpl& operator++() {
+      CHECK(!atEnd());
+      cursor_ = tree_->nextValueNode(cursor_);
+      return *this;
+    }
+    IteratorImpl operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+    bool operator==(const IteratorImpl& r) const {
+      return cursor_ == r.cursor_;
+    }
+    bool operator!=(const IteratorImpl& r) const {
+      return !(*this == r);
+    }
+    const IteratorImpl& operator*() const {
+      CHECK(!atEnd());
+      return *this;
+    }
+    const IteratorImpl* operator->() const {
+      CHECK(!atEnd());
+      return this;
+    }
+
+    bool atEnd() const {
+      return cursor_ == kNull;
+    }
+    IPADDRTYPE ipAddress() const {
+      return PrefixBits::toAddress(node().bits);
+    }
+    uint8_t masklen() const {
+      return node().masklen;
+    }
+    ValueType& value() const {
+      return *node().value;
+    }
+    template <typename VALUE>
+    void setValue(VALUE&& value) const {
+      static_assert(!kIsConst, "Can't set value through a const iterator");
+      *node().value = std::forward<VALUE>(value);
+    }
+    std::string str(bool printValue = true) const {
+      auto nodeStr = folly::to<std::string>(ipAddress().str(), "/", masklen());
+      if (printValue) {
+        nodeStr += folly::to<std::string>("(", value(), ")");
+      }
+      return nodeStr;
+    }
+
+   private:
+    auto& node() const {
+      CHECK(!atEnd());
+      return tree_->nodes_[cursor_];
+    }
+
+    TreePtr tree_{nullptr};
+    uint32_t cursor_{kNull};
+
+    friend class CompactRadixTree;
+    friend class IteratorImpl<!kIsConst>;
+  };
+
+ public:
+  typedef IteratorImpl<false> Iterator;
+  typedef IteratorImpl<true> ConstIterator;
+
+  CompactRadixTree() {}
+  CompactRadixTree(CompactRadixTree&&) noexcept = default;
+  CompactRadixTree& operator=(CompactRadixTree&&) noexcept = default;
+  CompactRadixTree(const CompactRadixTree&) = delete;
+  CompactRadixTree& operator=(const CompactRadixTree&) = delete;
+
+  /*
+   * Nodes are pooled, so clone is just a copy of the pool.
+   */
+  template <typename U = T>
+  typename std::
+      enable_if<std::is_copy_constructible<U>::value, CompactRadixTree>::type
+      clone() const {
+    CompactRadixTree copy;
+    copy.nodes_ = nodes_;
+    copy.root_ = root_;
+    copy.freeList_ = freeList_;
+    copy.numFreeNodes_ = numFreeNodes_;
+    copy.size_ = size_;
+    return copy;
+  }
+
+  Iterator begin() {
+    return Iterator(this, firstValueNode(root_));
+  }
+  Iterator end() {
+    return Iterator(this, kNull);
+  }
+  ConstIterator begin() const {
+    return ConstIterator(this, firstValueNode(root_));
+  }
+  ConstIterator end() const {
+    return ConstIterator(this, kNull);
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Number of nodes in the tree, with or without values
+  size_t numNodes() const {
+    return nodes_.size() - numFreeNodes_;
+  }
+
+  // Bytes allocated for the node pool
+  size_t memoryUsage() const {
+    return sizeof(*this) + nodes_.capacity() * sizeof(Node);
+  }
+
+  // Pre-allocate the pool for at least numPrefixes prefixes
+  void reserve(size_t numPrefixes) {
+    // A tree with N values has at most N - 1 nodes without a value
+    nodes_.reserve(numPrefixes ? 2 * numPrefixes - 1 : 0);
+  }
+
+  // Free all nodes and clear the tree.
+  void clear() {
+    nodes_.clear();
+    root_ = kNull;
+    freeList_ = kNull;
+    numFreeNodes_ = 0;
+    size_ = 0;
+  }
+
+  /*
+   * Insert a IP, mask, value in tree. Returns inserted node, true
+   * if a node was inserted. If a node for IP, mask already existed
+   * in the tree we return that node, false.
+   */
+  template <typename VALUE>
+  std::pair<Iterator, bool>
+  insert(const IPADDRTYPE& ipaddr, uint8_t masklen, VALUE&& value);
+
+  // Erase a IP, mask
+  bool erase(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    return erase(exactMatch(ipaddr, masklen));
+  }
+
+  // Erase node pointed to by iterator
+  bool erase(Iterator itr);
+
+  // Given a IP, mask return the node with longest match for it
+  ConstIterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    return ConstIterator(this, lookup(ipaddr, masklen, false /*exact*/));
+  }
+  Iterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    return Iterator(this, lookup(ipaddr, masklen, false /*exact*/));
+  }
+
+  // Given a IP, mask return the node matching this prefix exactly
+  ConstIterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    return ConstIterator(this, lookup(ipaddr, masklen, true /*exact*/));
+  }
+  Iterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    return Iterator(this, lookup(ipaddr, masklen, true /*exact*/));
+  }
+
+ private:
+  static uint32_t countLeadingZeros(uint32_t word) {
+    return __builtin_clz(word);
+  }
+  static uint32_t countLeadingZeros(uint64_t word) {
+    return __builtin_clzll(word);
+  }
+
+  static Bits maskBits(Bits bits, uint8_t masklen) {
+    for (uint32_t i = 0; i < PrefixBits::kNumWords; ++i) {
+      auto wordStart = i * kWordBits;
+      if (masklen <= wordStart) {
+        bits[i] = 0;
+      } else if (masklen < wordStart + kWordBits) {
+        bits[i] &= ~Word(0) << (kWordBits - (masklen - wordStart));
+      }
+    }
+    return bits;
+  }
+
+  static uint32_t getBit(const Bits& bits, uint32_t bit) {
+    return (bits[bit / kWordBits] >> (kWordBits - 1 - bit % kWordBits)) & 1;
+  }
+
+  static uint8_t
+  commonPrefixLen(const Bits& lhs, const Bits& rhs, uint8_t maxLen) {
+    for (uint32_t i = 0; i < PrefixBits::kNumWords; ++i) {
+      if (auto diff = lhs[i] ^ rhs[i]) {
+        uint32_t common = i * kWordBits + countLeadingZeros(diff);
+        return std::min<uint32_t>(common, maxLen);
+      }
+    }
+    return maxLen;
+  }
+
+  template <typename... VALUE>
+  uint32_t allocNode(const Bits& bits, uint8_t masklen, VALUE&&... value);
+  void freeNode(uint32_t index);
+
+  // Point whatever pointed to oldChild (its parent or the root) at newChild
+  void replaceChild(uint32_t parent, uint32_t oldChild, uint32_t newChild);
+  void setChild(uint32_t parent, uint32_t dir, uint32_t child) {
+    nodes_[parent].children[dir] = child;
+    if (child != kNull) {
+      nodes_[child].parent = parent;
+    }
+  }
+
+  uint32_t lookup(const IPADDRTYPE& ipaddr, uint8_t masklen, bool exact)
+      const;
+
+  // Preorder traversal, skipping nodes without a value
+  uint32_t nextNode(uint32_t index) const;
+  uint32_t firstValueNode(uint32_t index) const {
+    while (index != kNull && !nodes_[index].value) {
+      index = nextNode(index);
+    }
+    return index;
+  }
+  uint32_t nextValueNode(uint32_t index) const {
+    return firstValueNode(nextNode(index));
+  }
+
+  std::vector<Node> nodes_;
+  uint32_t root_{kNull};
+  uint32_t freeList_{kNull};
+  uint32_t numFreeNodes_{0};
+  size_t size_{0};
+};
+
+template <typename IPADDRTYPE, typename T>
+template <typename... VALUE>
+uint32_t CompactRadixTree<IPADDRTYPE, T>::allocNode(
+    const Bits& bits,
+    uint8_t masklen,
+    VALUE&&... value) {
+  uint32_t index;
+  if (freeList_ != kNull) {
+    index = freeList_;
+    freeList_ = nodes_[index].children[0];
+    --numFreeNodes_;
+    nodes_[index] = Node();
+  } else {
+    CHECK_LT(nodes_.size(), kNull) << "CompactRadixTree node pool exhausted";
+    index = nodes_.size();
+    nodes_.emplace_back();
+  }
+  auto& node = nodes_[index];
+  node.bits = bits;
+  node.masklen = masklen;
+  if constexpr (sizeof...(VALUE) > 0) {
+    node.value.emplace(std::forward<VALUE>(value)...);
+  }
+  return index;
+}
+
+template <typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::freeNode(uint32_t index) {
+  auto& node = nodes_[index];
+  node.value.reset();
+  node.parent = kNull;
+  node.children = {{freeList_, kNull}};
+  freeList_ = index;
+  ++numFreeNodes_;
+}
+
+template <typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::replaceChild(
+    uint32_t parent,
+    uint32_t oldChild,
+    uint32_t newChild) {
+  if (parent == kNull) {
+    root_ = newChild;
+    if (newChild != kNull) {
+      nodes_[newChild].parent = kNull;
+    }
+    return;
+  }
+  auto dir = nodes_[parent].children[0] == oldChild ? 0 : 1;
+  DCHECK_EQ(nodes_[parent].children[dir], oldChild);
+  setChild(parent, dir, newChild);
+}
+
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+std::pair<typename CompactRadixTree<IPADDRTYPE, T>::Iterator, bool>
+CompactRadixTree<IPADDRTYPE, T>::insert(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    VALUE&& value) {
+  DCHECK_LE(masklen, IPADDRTYPE::bitCount());
+  // Can't trust the clients to have 0s in all bits after mask length
+  auto toAdd = maskBits(PrefixBits::fromAddress(ipaddr), masklen);
+  if (root_ == kNull) {
+    root_ = allocNode(toAdd, masklen, std::forward<VALUE>(value));
+    ++size_;
+    return std::make_pair(Iterator(this, root_), true);
+  }
+
+  uint32_t parent = kNull;
+  uint32_t cur = root_;
+  while (true) {
+    auto curMasklen = nodes_[cur].masklen;
+    auto common = commonPrefixLen(
+        nodes_[cur].bits, toAdd, std::min(curMasklen, masklen));
+    if (common < curMasklen) {
+      // The prefix diverges from cur above cur's mask length, or is less
+      // specific than cur. Either way it goes between parent and cur.
+      uint32_t newNode;
+      if (common == masklen) {
+        newNode = allocNode(toAdd, masklen, std::forward<VALUE>(value));
+        replaceChild(parent, cur, newNode);
+        setChild(newNode, getBit(nodes_[cur].bits, masklen), cur);
+      } else {
+        // Add a non value node at the common prefix as their parent
+        auto internal = allocNode(maskBits(toAdd, common), common);
+        newNode = allocNode(toAdd, masklen, std::forward<VALUE>(value));
+        replaceChild(parent, cur, internal);
+        auto newDir = getBit(toAdd, common);
+        setChild(internal, newDir, newNode);
+        setChild(internal, !newDir, cur);
+      }
+      ++size_;
+      return std::make_pair(Iterator(this, newNode), true);
+    }
+    if (curMasklen == masklen) {
+      // Found exact match. Check if in use
+      if (nodes_[cur].value) {
+        return std::make_pair(Iterator(this, cur), false);
+      }
+      nodes_[cur].value.emplace(std::forward<VALUE>(value));
+      ++size_;
+      return std::make_pair(Iterator(this, cur), true);
+    }
+    auto dir = getBit(toAdd, curMasklen);
+    auto child = nodes_[cur].children[dir];
+    if (child == kNull) {
+      auto newNode = allocNode(toAdd, masklen, std::forward<VALUE>(value));
+      setChild(cur, dir, newNode);
+      ++size_;
+      return std::make_pair(Iterator(this, newNode), true);
+    }
+    parent = cur;
+    cur = child;
+  }
+}
+
+/*
+ * Same as RadixTree::erase, maintains that non value nodes always have 2
+ * children: a value node with 2 children just loses its value, one with a
+ * single child is replaced by it, and removing a leaf may leave its non value
+ * parent with a single child, in which case the parent goes too.
+ */
+template <typename IPADDRTYPE, typename T>
+bool CompactRadixTree<IPADDRTYPE, T>::erase(Iterator itr) {
+  if (itr.atEnd()) {
+    return false;
+  }
+  auto toDelete = itr.cursor_;
+  CHECK(nodes_[toDelete].value);
+  nodes_[toDelete].value.reset();
+  --size_;
+
+  while (toDelete != kNull && !nodes_[toDelete].value) {
+    auto left = nodes_[toDelete].children[0];
+    auto right = nodes_[toDelete].children[1];
+    if (left != kNull && right != kNull) {
+      break;
+    }
+    auto parent = nodes_[toDelete].parent;
+    replaceChild(parent, toDelete, left != kNull ? left : right);
+    freeNode(toDelete);
+    // Only a removed leaf can leave its parent with a single child
+    toDelete = (left == kNull && right == kNull) ? parent : kNull;
+  }
+  return true;
+}
+
+template <typename IPADDRTYPE, typename T>
+uint32_t CompactRadixTree<IPADDRTYPE, T>::lookup(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    bool exact) const {
+  DCHECK_LE(masklen, IPADDRTYPE::bitCount());
+  auto toMatch = maskBits(PrefixBits::fromAddress(ipaddr), masklen);
+  uint32_t lastValueNodeSeen = kNull;
+  auto cur = root_;
+  while (cur != kNull) {
+    const auto& node = nodes_[cur];
+    if (node.masklen > masklen ||
+        commonPrefixLen(node.bits, toMatch, node.masklen) < node.masklen) {
+      break;
+    }
+    if (node.masklen == masklen) {
+      return node.value ? cur : (exact ? kNull : lastValueNodeSeen);
+    }
+    if (node.value) {
+      lastValueNodeSeen = cur;
+    }
+    cur = node.children[getBit(toMatch, node.masklen)];
+  }
+  return exact ? kNull : lastValueNodeSeen;
+}
+
+template <typename IPADDRTYPE, typename T>
+uint32_t CompactRadixTree<IPADDRTYPE, T>::nextNode(uint32_t index) const {
+  const auto& node = nodes_[index];
+  if (node.children[0] != kNull) {
+    return node.children[0];
+  }
+  if (node.children[1] != kNull) {
+    return node.children[1];
+  }
+  // Go up until we come from the left of a node which has a right child
+  while (index != kNull) {
+    auto parent = nodes_[index].parent;
+    if (parent != kNull && nodes_[parent].children[0] == index &&
+        nodes_[parent].children[1] != kNull) {
+      return nodes_[parent].children[1];
+    }
+    index = parent;
+  }
+  return kNull;
+}
+
+} // namespace facebook::network
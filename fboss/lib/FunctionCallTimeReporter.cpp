@@ -9,15 +9,12 @@
  */
 
 #include "fboss/lib/FunctionCallTimeReporter.h"
+#include "fboss/lib/CallProfiler.h"
 
 #include <folly/logging/xlog.h>
 
-#include <folly/Format.h>
 #include <folly/Singleton.h>
-#include <folly/system/ThreadName.h>
 #include <gflags/gflags.h>
-#include <sstream>
-#include <thread>
 
 DEFINE_bool(enable_call_timing, false, "Enable call time reporting");
 
@@ -37,28 +34,13 @@ FunctionCallTimeReporter::getInstance() {
 
 namespace facebook::fboss {
 
-thread_local FunctionCallTimeReporter::CallTimeTracker
-    FunctionCallTimeReporter::tracker_;
-
-FunctionCallTimeReporter::CallTimeTracker::~CallTimeTracker() {
-  std::string threadIdStr;
-  std::stringstream ss;
-  ss << std::this_thread::get_id();
-  threadIdStr = ss.str();
-  std::string threadStr;
-  auto threadName = folly::getCurrentThreadName();
-  if (threadName) {
-    threadStr = folly::sformat("{} ({})", *threadName, threadIdStr);
-  } else {
-    threadStr = threadIdStr;
-  }
-  XLOG(INFO) << " Thread: " << threadStr
-             << " function time msecs: " << (cumalativeUsecs_.count() / 1000.0);
-}
-
 void FunctionCallTimeReporter::start() {
   CHECK(!isOn_);
   isOn_ = true;
+  auto profiler = CallProfiler::getInstance();
+  profilerWasOn_ = profiler->isOn();
+  profiler->clear();
+  profiler->setOn(true);
   startTime_ = std::chrono::steady_clock::now();
 }
 
@@ -67,6 +49,9 @@ void FunctionCallTimeReporter::end() {
   std::chrono::duration<double, std::micro> durationUsecs =
       std::chrono::steady_clock::now() - startTime_;
   XLOG(INFO) << "Total time, msecs: " << (durationUsecs.count() / 1000.0);
+  auto profiler = CallProfiler::getInstance();
+  XLOG(INFO) << "SDK calls:\n" << profiler->dump();
+  profiler->setOn(profilerWasOn_);
   isOn_ = false;
 }
 
@@ -12,9 +12,9 @@
 
 #include <memory>
 
-#include <folly/ScopeGuard.h>
 #include <folly/Singleton.h>
 
+#include <atomic>
 #include <chrono>
 
 namespace facebook::fboss {
@@ -26,35 +26,14 @@ class FunctionCallTimeReporter {
   FunctionCallTimeReporter& operator=(const FunctionCallTimeReporter&) = delete;
   FunctionCallTimeReporter() = default;
   ~FunctionCallTimeReporter() = default;
+  /*
+   * Time from start to end, and dump the SDK calls made meanwhile (see
+   * CallProfiler) once done
+   */
   void start();
   void end();
-  void callStart() {
-    if (UNLIKELY(isOn_)) {
-      tracker_.callStart();
-    }
-  }
-  void callEnd() {
-    if (UNLIKELY(isOn_)) {
-      tracker_.callEnd();
-    }
-  }
 
  private:
-  struct CallTimeTracker {
-    ~CallTimeTracker();
-    void callStart() {
-      startTime_ = std::chrono::steady_clock::now();
-    }
-    void callEnd() {
-      std::chrono::duration<double, std::micro> callUsecs =
-          std::chrono::steady_clock::now() - startTime_;
-      cumalativeUsecs_ += callUsecs;
-    }
-
-    std::chrono::time_point<std::chrono::steady_clock> startTime_;
-    std::chrono::duration<double, std::micro> cumalativeUsecs_{0};
-  };
-
   std::chrono::time_point<std::chrono::steady_clock> startTime_;
   /*
    * Use a bool to track on/off. Another option was to wrap startTime in
@@ -63,15 +42,9 @@ class FunctionCallTimeReporter {
    * and would need heavier means of synchronization
    */
   std::atomic<bool> isOn_{false};
-  static thread_local CallTimeTracker tracker_;
+  bool profilerWasOn_{false};
 };
 
-#define TIME_CALL                                       \
-  FunctionCallTimeReporter::getInstance()->callStart(); \
-  SCOPE_EXIT {                                          \
-    FunctionCallTimeReporter::getInstance()->callEnd(); \
-  };
-
 class ScopedCallTimer {
  public:
   ScopedCallTimer();
@@ -10,13 +10,61 @@
 #include <folly/Synchronized.h>
 #include <folly/futures/Future.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <thread>
 
+DEFINE_bool(
+    fpga_i2c_batched_reads,
+    false,
+    "Queue batched I2C reads on all the descriptors of an FPGA RTC at once. "
+    "The descriptor layout this relies on is not confirmed on hardware yet, "
+    "so batched reads are issued one at a time unless this is set.");
+
 namespace {
 constexpr uint32_t kFacebookFpgaRTCWriteBlock = 0x2000;
 constexpr uint32_t kFacebookFpgaRTCReadBlock = 0x3000;
+
+// Descriptor layout, from the RTC (I2C real time controller) register map of
+// the FB FPGA, whose addresses are in FbFpgaRegisters.cpp:
+//
+// - The descriptors of an RTC are laid out back to back from its
+//   DescriptorLower register, each one a lower and an upper register, so
+//   descriptor N's are at DescriptorLower/Upper + N * kDescriptorRegSize.
+//   The per RTC stride of these registers is how many descriptors it has:
+//   0x20 (4 descriptors) on version 0, 0x8 (1 descriptor) on version 1.
+// - The read and write IO blocks of an RTC are split evenly between its
+//   descriptors, descriptor N's data being at N * getRTCIOBlockSize() /
+//   getNumDescriptors() in them, e.g. 0x80 bytes each on version 0.
+// - The done and error bits of descriptor N are at bit 4 * N of the RTC
+//   status register.
+constexpr uint32_t kDescriptorRegSize = 0x8;
+constexpr uint32_t kMaxDescriptors = 4;
+constexpr uint32_t kStatusBitsPerDescriptor = 4;
+
+constexpr uint32_t kDescOpWrite = 0;
+constexpr uint32_t kDescOpRead = 1;
+
+// Expected time per byte until transactions have been timed, this used to be
+// the fixed initial wait
+constexpr double kInitialUsecPerByte = 100;
+// How fast the expected time follows the observed one
+constexpr double kCalibrationWeight = 0.25;
+// Transactions fail this long after the initial expected time
+constexpr uint32_t kResponseTimeoutUsec = 20000;
+constexpr uint32_t kMinPollUsec = 10;
+constexpr uint32_t kMaxPollUsec = 1000;
+
+uint32_t descDoneBit(uint32_t desc) {
+  return 1 << (kStatusBitsPerDescriptor * desc);
+}
+
+uint32_t descErrorBit(uint32_t desc) {
+  return descDoneBit(desc) << 1;
+}
 } // unnamed namespace
 
 namespace facebook::fboss {
@@ -29,7 +77,8 @@ FbFpgaI2c::FbFpgaI2c(
           folly::to<std::string>("i2cController.pim.", pimId, ".rtc.", rtcId)),
       fpga_(fpga),
       rtcId_(rtcId),
-      version_(version) {
+      version_(version),
+      expectedUsecPerByte_(kInitialUsecPerByte) {
   XLOG(DBG4, "Initialized I2C controller for rtcId={:d}", rtcId);
 }
 
@@ -42,58 +91,102 @@ FbFpgaI2c::FbFpgaI2c(
           folly::to<std::string>("i2cController.pim.", pimId, ".rtc.", rtcId)),
       io_(std::make_unique<FbDomFpga>(move(io))),
       rtcId_(rtcId),
-      version_(version) {
+      version_(version),
+      expectedUsecPerByte_(kInitialUsecPerByte) {
   fpga_ = io_.get();
   XLOG(DBG4, "Initialized I2C controller for rtcId={:d}", rtcId);
 }
 
-bool FbFpgaI2c::waitForResponse(size_t len) {
-  I2cRtcStatus rtcStatus(version_);
-  uint32_t retries = 20;
-
-  // Make the initial wait according to the length of read/write.
-  usleep(100 * len);
+uint32_t FbFpgaI2c::waitForResponse(uint32_t descMask, size_t len) {
+  auto start = std::chrono::steady_clock::now();
+  len = std::max<size_t>(len, 1);
+  double expectedUsec = expectedUsecPerByte_ * len;
+  uint64_t timeoutUsec = kInitialUsecPerByte * len + kResponseTimeoutUsec;
+  uint32_t pollUsec = std::clamp<uint32_t>(
+      static_cast<uint32_t>(expectedUsec / 8), kMinPollUsec, kMaxPollUsec);
 
-  readReg(rtcStatus);
+  // Only sleep through part of the expected time and poll for the rest, so
+  // that calibration can follow the controller when it gets faster.
+  usleep(static_cast<useconds_t>(expectedUsec / 2));
 
-  while (!rtcStatus.dataUnion.desc0done && --retries) {
-    usleep(1000);
+  I2cRtcStatus rtcStatus(version_);
+  uint32_t pending = descMask;
+  uint32_t succeeded = 0;
+  uint64_t elapsedUsec = 0;
+  while (true) {
     readReg(rtcStatus);
+    for (uint32_t desc = 0; desc < kMaxDescriptors; ++desc) {
+      if (!(pending & (1 << desc))) {
+        continue;
+      }
+      if (rtcStatus.dataUnion.reg & descErrorBit(desc)) {
+        XLOG(DBG5) << "I2C read/write ops has error on descriptor " << desc;
+        pending &= ~(1 << desc);
+      } else if (rtcStatus.dataUnion.reg & descDoneBit(desc)) {
+        succeeded |= 1 << desc;
+        pending &= ~(1 << desc);
+      }
+    }
+    elapsedUsec = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    if (!pending || elapsedUsec >= timeoutUsec) {
+      break;
+    }
+    usleep(pollUsec);
   }
 
-  if (rtcStatus.dataUnion.desc0error) {
-    XLOG(DBG5) << "I2C read/write ops has error.";
-    rtcStatus.dataUnion.reg = 0xffffffff;
-    return false;
+  if (succeeded == descMask) {
+    recordLatencyUsec(elapsedUsec);
+    expectedUsecPerByte_ += kCalibrationWeight *
+        (static_cast<double>(elapsedUsec) / len - expectedUsecPerByte_);
   }
-
-  return rtcStatus.dataUnion.desc0done;
+  return succeeded;
 }
 
-uint8_t FbFpgaI2c::readByte(uint8_t channel, uint8_t offset) {
-  uint8_t byte = 0;
-  read(channel, offset, folly::MutableByteRange(&byte, 1));
-  return byte;
-}
-
-void FbFpgaI2c::read(
+void FbFpgaI2c::issueDescriptor(
+    uint32_t desc,
+    uint32_t op,
     uint8_t channel,
     uint8_t offset,
-    folly::MutableByteRange buf) {
+    size_t len) {
   I2cDescriptorLower descLower(version_);
   I2cDescriptorUpper descUpper(version_);
   descLower.dataUnion.reg = 0;
   descUpper.dataUnion.reg = 0;
 
-  descLower.dataUnion.op = 1; // Read
-  descLower.dataUnion.len = buf.size();
+  descLower.dataUnion.op = op;
+  descLower.dataUnion.len = len;
 
   descUpper.dataUnion.offset = offset;
   descUpper.dataUnion.channel = channel;
   descUpper.dataUnion.valid = 1;
 
-  writeReg(descLower);
-  writeReg(descUpper);
+  writeReg(descLower, desc);
+  writeReg(descUpper, desc);
+}
+
+void FbFpgaI2c::copyReadData(uint32_t addr, folly::MutableByteRange buf) {
+  for (int bytesRead = 0; bytesRead < buf.size(); bytesRead += 4) {
+    uint32_t data = fpga_->read(addr + bytesRead);
+    std::memcpy(
+        buf.begin() + bytesRead,
+        &data,
+        std::min(buf.size() - bytesRead, (size_t)4));
+  }
+}
+
+uint8_t FbFpgaI2c::readByte(uint8_t channel, uint8_t offset) {
+  uint8_t byte = 0;
+  read(channel, offset, folly::MutableByteRange(&byte, 1));
+  return byte;
+}
+
+void FbFpgaI2c::read(
+    uint8_t channel,
+    uint8_t offset,
+    folly::MutableByteRange buf) {
+  issueDescriptor(0, kDescOpRead, channel, offset, buf.size());
 
   // Increment the counter for I2C read tranbsaction issued
   incrReadTotal();
@@ -101,42 +194,74 @@ void FbFpgaI2c::read(
   uint32_t readBlockAddr =
       getRegAddr(kFacebookFpgaRTCReadBlock, getRTCIOBlockSize());
 
-  if (!waitForResponse(descLower.dataUnion.len)) {
+  if (!waitForResponse(1 /* descriptor 0 */, buf.size())) {
     // Increment the counter for I2C read transaction failure and
     // throw error
     incrReadFailed();
 
     throw FbFpgaI2cError("I2C read failed.");
   } else {
-    for (int bytesRead = 0; bytesRead < buf.size(); bytesRead += 4) {
-      uint32_t data = fpga_->read(readBlockAddr + bytesRead);
-      std::memcpy(
-          buf.begin() + bytesRead,
-          &data,
-          std::min(buf.size() - bytesRead, (size_t)4));
-    }
+    copyReadData(readBlockAddr, buf);
     // Update the number of bytes read
     incrReadBytes(buf.size());
   }
 }
 
+void FbFpgaI2c::readMultiple(folly::Range<FbFpgaI2cRead*> reads) {
+  auto numDescriptors = getNumDescriptors();
+  auto descBlockSize = getDescriptorIOBlockSize();
+  uint32_t readBlockAddr =
+      getRegAddr(kFacebookFpgaRTCReadBlock, getRTCIOBlockSize());
+
+  auto request = reads.begin();
+  while (request != reads.end()) {
+    if (!FLAGS_fpga_i2c_batched_reads || request->buf.size() > descBlockSize) {
+      // Batching is off, or this needs the whole IO block to itself
+      try {
+        read(request->channel, request->offset, request->buf);
+        request->success = true;
+      } catch (const FbFpgaI2cError&) {
+        request->success = false;
+      }
+      ++request;
+      continue;
+    }
+
+    // Queue as many of the following reads as there are descriptors
+    std::array<FbFpgaI2cRead*, kMaxDescriptors> issued;
+    uint32_t numIssued = 0;
+    size_t len = 0;
+    while (request != reads.end() && numIssued < numDescriptors &&
+           request->buf.size() <= descBlockSize) {
+      issueDescriptor(
+          numIssued,
+          kDescOpRead,
+          request->channel,
+          request->offset,
+          request->buf.size());
+      incrReadTotal();
+      len += request->buf.size();
+      issued[numIssued++] = request++;
+    }
+
+    auto succeeded = waitForResponse((1 << numIssued) - 1, len);
+    for (uint32_t desc = 0; desc < numIssued; ++desc) {
+      issued[desc]->success = succeeded & (1 << desc);
+      if (issued[desc]->success) {
+        copyReadData(readBlockAddr + desc * descBlockSize, issued[desc]->buf);
+        incrReadBytes(issued[desc]->buf.size());
+      } else {
+        incrReadFailed();
+      }
+    }
+  }
+}
+
 void FbFpgaI2c::writeByte(uint8_t channel, uint8_t offset, uint8_t val) {
   write(channel, offset, folly::ByteRange(&val, 1));
 }
 
 void FbFpgaI2c::write(uint8_t channel, uint8_t offset, folly::ByteRange buf) {
-  I2cDescriptorLower descLower(version_);
-  I2cDescriptorUpper descUpper(version_);
-  descLower.dataUnion.reg = 0;
-  descUpper.dataUnion.reg = 0;
-
-  descLower.dataUnion.op = 0; // Write
-  descLower.dataUnion.len = buf.size();
-
-  descUpper.dataUnion.offset = offset;
-  descUpper.dataUnion.channel = channel;
-  descUpper.dataUnion.valid = 1;
-
   // Increment the counter for write transaction issued
   incrWriteTotal();
 
@@ -152,10 +277,9 @@ void FbFpgaI2c::write(uint8_t channel, uint8_t offset, folly::ByteRange buf) {
     fpga_->write(writeBlockAddr + bytesWritten, data);
   }
 
-  writeReg(descLower);
-  writeReg(descUpper);
+  issueDescriptor(0, kDescOpWrite, channel, offset, buf.size());
 
-  if (!waitForResponse(descLower.dataUnion.len)) {
+  if (!waitForResponse(1 /* descriptor 0 */, buf.size())) {
     // Increment the counter for I2c write transaction failure and
     // throw error
     incrWriteFailed();
@@ -174,10 +298,12 @@ void FbFpgaI2c::readReg(Register& reg) {
 }
 
 template <typename Register>
-void FbFpgaI2c::writeReg(Register& reg) {
+void FbFpgaI2c::writeReg(Register& reg, uint32_t desc) {
   XLOG(DBG5) << reg;
   fpga_->write(
-      getRegAddr(reg.getBaseAddr(), reg.getAddrIncr()), reg.dataUnion.reg);
+      getRegAddr(reg.getBaseAddr(), reg.getAddrIncr()) +
+          desc * kDescriptorRegSize,
+      reg.dataUnion.reg);
 }
 
 uint32_t FbFpgaI2c::getRegAddr(uint32_t regBase, uint32_t regIncr) {
@@ -197,7 +323,7 @@ uint32_t FbFpgaI2c::getRegAddr(uint32_t regBase, uint32_t regIncr) {
   return regBase + regIncr * rtcId_;
 }
 
-uint32_t FbFpgaI2c::getRTCIOBlockSize() {
+uint32_t FbFpgaI2c::getRTCIOBlockSize() const {
   switch (version_) {
     case 1:
       return 0x80;
@@ -206,6 +332,20 @@ uint32_t FbFpgaI2c::getRTCIOBlockSize() {
   }
 }
 
+uint32_t FbFpgaI2c::getNumDescriptors() const {
+  // However many descriptors fit in the space each RTC has for them
+  auto descLower = I2CRegisterAddrConstants::getI2CRegisterAddr(
+      version_, I2CRegisterType::DESC_LOWER);
+  return std::clamp<uint32_t>(
+      descLower.addrIncr / kDescriptorRegSize, 1, kMaxDescriptors);
+}
+
+uint32_t FbFpgaI2c::getDescriptorIOBlockSize() const {
+  // The IO block of the RTC is split evenly between its descriptors, with
+  // descriptor 0 using the start of it
+  return getRTCIOBlockSize() / getNumDescriptors();
+}
+
 FbFpgaI2cController::FbFpgaI2cController(
     FbDomFpga* fpga,
     uint32_t rtcId,
@@ -294,6 +434,18 @@ void FbFpgaI2cController::write(
   }
 }
 
+void FbFpgaI2cController::readMultiple(folly::Range<FbFpgaI2cRead*> reads) {
+  if (eventBase_->isInEventBaseThread()) {
+    syncedFbI2c_.lock()->readMultiple(reads);
+  } else {
+    via(eventBase_.get())
+        .thenValue([=](auto&&) mutable {
+          syncedFbI2c_.lock()->readMultiple(reads);
+        })
+        .get();
+  }
+}
+
 folly::EventBase* FbFpgaI2cController::getEventBase() {
   return eventBase_.get();
 }
@@ -27,6 +27,16 @@ class FbFpgaI2cError : public I2cError {
   explicit FbFpgaI2cError(const std::string& what) : I2cError(what) {}
 };
 
+/* A read issued as part of a batch through FbFpgaI2c::readMultiple().
+ */
+struct FbFpgaI2cRead {
+  uint8_t channel{0};
+  uint8_t offset{0};
+  folly::MutableByteRange buf;
+  // Set once the data in buf was read successfully
+  bool success{false};
+};
+
 class FbFpgaI2c : public I2cController {
  public:
   // TODO(clin82): After refactor Wedge400I2CBus to make use of
@@ -45,15 +55,45 @@ class FbFpgaI2c : public I2cController {
   void writeByte(uint8_t channel, uint8_t offset, uint8_t val);
   void write(uint8_t channel, uint8_t offset, folly::ByteRange buf);
 
+  /* Queue the reads on all the descriptors of the RTC, so that several
+   * channels or pages are in flight at once, and wait for them together.
+   * Descriptor N is programmed at DescriptorLower/Upper + N * 0x8 and its
+   * data is read from its 1 / getNumDescriptors() share of the RTC read
+   * block, as laid out in the FB FPGA RTC register map (see FbFpgaI2c.cpp).
+   * Reads which don't fit in a descriptor's share of the IO block are
+   * issued on their own, and so are all of them unless
+   * --fpga_i2c_batched_reads is set. Failed reads are reported through their
+   * success field instead of by throwing.
+   */
+  void readMultiple(folly::Range<FbFpgaI2cRead*> reads);
+
+  // Number of descriptors the RTC can have in flight
+  uint32_t getNumDescriptors() const;
+
+  // Expected transaction time per byte, calibrated from completed ones
+  double getExpectedUsecPerByte() const {
+    return expectedUsecPerByte_;
+  }
+
  private:
-  bool waitForResponse(size_t len);
+  // Returns the mask of descriptors in descMask which completed without
+  // error, len being the total number of bytes they transfer
+  uint32_t waitForResponse(uint32_t descMask, size_t len);
+  void issueDescriptor(
+      uint32_t desc,
+      uint32_t op,
+      uint8_t channel,
+      uint8_t offset,
+      size_t len);
+  void copyReadData(uint32_t addr, folly::MutableByteRange buf);
   uint32_t getRegAddr(uint32_t regBase, uint32_t regIncr);
-  uint32_t getRTCIOBlockSize();
+  uint32_t getRTCIOBlockSize() const;
+  uint32_t getDescriptorIOBlockSize() const;
 
   template <typename Register>
   void readReg(Register& value);
   template <typename Register>
-  void writeReg(Register& value);
+  void writeReg(Register& value, uint32_t desc = 0);
 
   // TODO(clin82): After refactor Wedge400I2CBus to make use of
   // FpgaMemoryRegion, we can remove the dependency of FbDomFpga from FbFpgaI2c
@@ -62,6 +102,7 @@ class FbFpgaI2c : public I2cController {
 
   int rtcId_{-1};
   int version_{0};
+  double expectedUsecPerByte_;
 };
 
 class FbFpgaI2cController {
@@ -87,6 +128,8 @@ class FbFpgaI2cController {
   void writeByte(uint8_t channel, uint8_t offset, uint8_t val);
   void write(uint8_t channel, uint8_t offset, folly::ByteRange buf);
 
+  void readMultiple(folly::Range<FbFpgaI2cRead*> reads);
+
   folly::EventBase* getEventBase();
 
   /* Get the I2c transaction stats from this controller with the lock
@@ -12,14 +12,23 @@
 #include <stdint.h>
 #include "fboss/lib/i2c/gen-cpp2/i2c_controller_stats_types.h"
 
+#include <folly/lang/Bits.h>
+#include <algorithm>
+
 namespace facebook::fboss {
 
 /* This is the base class for i2c controllers.
  */
 class I2cController {
  public:
+  // Number of power of 2 buckets in the latency histogram, the last one
+  // collects everything from ~32ms up
+  static constexpr uint32_t kLatencyHistogramBuckets = 16;
+
   I2cController(std::string name) {
     *i2cControllerPlatformStats_.controllerName__ref() = name;
+    i2cControllerPlatformStats_.latencyHistogramUsec__ref()->resize(
+        kLatencyHistogramBuckets);
   }
   ~I2cController() {}
 
@@ -31,6 +40,8 @@ class I2cController {
     *i2cControllerPlatformStats_.writeTotal__ref() = 0;
     *i2cControllerPlatformStats_.writeFailed__ref() = 0;
     *i2cControllerPlatformStats_.writeBytes__ref() = 0;
+    auto& histogram = *i2cControllerPlatformStats_.latencyHistogramUsec__ref();
+    std::fill(histogram.begin(), histogram.end(), 0);
   }
   // Total number of reads
   void incrReadTotal(uint32_t count = 1) {
@@ -57,6 +68,13 @@ class I2cController {
     *i2cControllerPlatformStats_.writeBytes__ref() += count;
   }
 
+  // Time a transaction took to complete
+  void recordLatencyUsec(uint64_t usec) {
+    uint32_t bucket = usec ? folly::findLastSet(usec) - 1 : 0;
+    bucket = std::min(bucket, kLatencyHistogramBuckets - 1);
+    (*i2cControllerPlatformStats_.latencyHistogramUsec__ref())[bucket]++;
+  }
+
   /* Get the I2c transaction stats from the i2c controller
    */
   const I2cControllerStats& getI2cControllerPlatformStats() const {
@@ -69,4 +87,28 @@ class I2cController {
   I2cControllerStats i2cControllerPlatformStats_;
 };
 
+/* Estimate a latency percentile (0-100) from the histogram in the stats, as
+ * the upper bound of the bucket it falls in. Returns 0 without samples.
+ */
+inline int64_t getI2cLatencyPercentileUsec(
+    const I2cControllerStats& stats,
+    double percentile) {
+  const auto& histogram = *stats.latencyHistogramUsec__ref();
+  int64_t total = 0;
+  for (auto count : histogram) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  int64_t seen = 0;
+  for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+    seen += histogram[bucket];
+    if (seen * 100 >= total * percentile) {
+      return int64_t(1) << (bucket + 1);
+    }
+  }
+  return int64_t(1) << histogram.size();
+}
+
 } // namespace facebook::fboss
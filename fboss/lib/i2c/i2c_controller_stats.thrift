@@ -11,4 +11,7 @@ struct I2cControllerStats {
   5: i64 writeTotal_ = STAT_UNINITIALIZED
   6: i64 writeFailed_ = STAT_UNINITIALIZED
   7: i64 writeBytes_ = STAT_UNINITIALIZED
+  // Histogram of transaction completion latency. Bucket i counts the
+  // transactions that took [2^i, 2^(i+1)) usec, the last bucket is open ended
+  8: list<i64> latencyHistogramUsec_
 }
@@ -2,6 +2,8 @@
 
 #include "fboss/lib/i2c/minipack/MinipackBaseI2cBus.h"
 
+#include <map>
+
 namespace facebook::fboss {
 
 MinipackBaseI2cBus::MinipackBaseI2cBus() {}
@@ -52,6 +54,40 @@ void MinipackBaseI2cBus::moduleWrite(
       port, offset, folly::ByteRange(data, len));
 }
 
+void MinipackBaseI2cBus::moduleReadMultiple(
+    std::vector<TransceiverI2CRead>& reads) {
+  std::map<FbFpgaI2cController*, std::vector<TransceiverI2CRead*>>
+      controllerReads;
+  for (auto& read : reads) {
+    if (read.len > 128) {
+      read.success = false;
+      continue;
+    }
+    auto pim = getPim(read.module);
+    auto port = getQsfpPimPort(read.module);
+    controllerReads[systemContainer_->getPimContainer(pim)->getI2cController(
+                        port)]
+        .push_back(&read);
+  }
+
+  for (auto& [controller, moduleReads] : controllerReads) {
+    std::vector<FbFpgaI2cRead> fpgaReads;
+    for (auto read : moduleReads) {
+      FbFpgaI2cRead fpgaRead;
+      fpgaRead.channel = getQsfpPimPort(read->module);
+      fpgaRead.offset = read->offset;
+      fpgaRead.buf = folly::MutableByteRange(read->buf, read->len);
+      fpgaReads.push_back(fpgaRead);
+    }
+    XLOG(DBG3) << folly::format(
+        "I2C read of {:d} modules in one batch", fpgaReads.size());
+    controller->readMultiple(folly::range(fpgaReads));
+    for (size_t i = 0; i < moduleReads.size(); ++i) {
+      moduleReads[i]->success = fpgaReads[i].success;
+    }
+  }
+}
+
 bool MinipackBaseI2cBus::isPresent(unsigned int module) {
   auto pim = getPim(module);
   auto port = getQsfpPimPort(module);
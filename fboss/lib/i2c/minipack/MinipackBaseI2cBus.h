@@ -32,6 +32,12 @@ class MinipackBaseI2cBus : public TransceiverI2CApi {
       int offset,
       int len,
       const uint8_t* buf) override;
+  /*
+   * Reads behind the same I2C controller are handed to it together through
+   * FbFpgaI2cController::readMultiple(), which queues them on all of its
+   * descriptors at once if --fpga_i2c_batched_reads is set.
+   */
+  void moduleReadMultiple(std::vector<TransceiverI2CRead>& reads) override;
 
   bool isPresent(unsigned int module) override;
   void scanPresence(std::map<int32_t, ModulePresence>& presences) override;
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/lib/CallProfiler.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace facebook::fboss {
+
+class CallProfilerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    profiler = CallProfiler::getInstance();
+    profiler->setOn(true);
+    profiler->clear();
+  }
+
+  void TearDown() override {
+    profiler->clear();
+  }
+
+  CallProfiler* profiler;
+};
+
+TEST_F(CallProfilerTest, recordPerApiAndOperation) {
+  profiler->record(1, CallProfiler::Operation::CREATE, 1000ns);
+  profiler->record(1, CallProfiler::Operation::CREATE, 3000ns);
+  profiler->record(1, CallProfiler::Operation::GET, 100ns);
+  profiler->record(2, CallProfiler::Operation::CREATE, 10ns);
+
+  auto callStats = profiler->getCallStats();
+  ASSERT_EQ(3, callStats.size());
+  EXPECT_EQ(1, callStats[0].api);
+  EXPECT_EQ(CallProfiler::Operation::CREATE, callStats[0].op);
+  EXPECT_EQ(2, callStats[0].count);
+  EXPECT_EQ(4000, callStats[0].totalNsecs);
+  // 1000ns falls in [512, 1024), 3000ns in [2048, 4096)
+  EXPECT_EQ(1, callStats[0].buckets[9]);
+  EXPECT_EQ(1, callStats[0].buckets[11]);
+  EXPECT_EQ(1024ns, callStats[0].percentile(50));
+  EXPECT_EQ(4096ns, callStats[0].percentile(99));
+  EXPECT_EQ(CallProfiler::Operation::GET, callStats[1].op);
+  EXPECT_EQ(1, callStats[1].count);
+  EXPECT_EQ(2, callStats[2].api);
+}
+
+TEST_F(CallProfilerTest, exitedThreadsKept) {
+  std::thread([this]() {
+    profiler->record(3, CallProfiler::Operation::REMOVE, 100ns);
+  }).join();
+  profiler->record(3, CallProfiler::Operation::REMOVE, 100ns);
+
+  auto callStats = profiler->getCallStats();
+  ASSERT_EQ(1, callStats.size());
+  EXPECT_EQ(2, callStats[0].count);
+  EXPECT_EQ(200, callStats[0].totalNsecs);
+}
+
+TEST_F(CallProfilerTest, scopedCall) {
+  {
+    PROFILE_CALL(4, CallProfiler::Operation::SET);
+  }
+  profiler->setOn(false);
+  {
+    PROFILE_CALL(4, CallProfiler::Operation::SET);
+  }
+  profiler->setOn(true);
+
+  auto callStats = profiler->getCallStats();
+  ASSERT_EQ(1, callStats.size());
+  EXPECT_EQ(1, callStats[0].count);
+}
+
+TEST_F(CallProfilerTest, clear) {
+  profiler->record(5, CallProfiler::Operation::STATS, 100ns);
+  profiler->clear();
+  EXPECT_TRUE(profiler->getCallStats().empty());
+}
+
+TEST_F(CallProfilerTest, dump) {
+  profiler->setApiName(6, "route");
+  profiler->record(6, CallProfiler::Operation::CREATE, 100ns);
+  profiler->record(7, CallProfiler::Operation::OTHER, 100ns);
+
+  auto dump = profiler->dump();
+  EXPECT_NE(std::string::npos, dump.find("route"));
+  EXPECT_NE(std::string::npos, dump.find("create"));
+  // Unnamed apis show up by number
+  EXPECT_NE(std::string::npos, dump.find("7 "));
+  EXPECT_NE(std::string::npos, dump.find("other"));
+}
+
+} // namespace facebook::fboss
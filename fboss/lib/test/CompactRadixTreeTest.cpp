@@ -0,0 +1,178 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include "common/base/Random.h"
+
+#include "fboss/lib/CompactRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook;
+using namespace facebook::network;
+using namespace std;
+
+namespace {
+using IPAddressV4 = folly::IPAddressV4;
+using IPAddressV6 = folly::IPAddressV6;
+
+constexpr auto kNumOps = 20000;
+
+IPAddressV4 randomIP(IPAddressV4 /*tag*/) {
+  // Keep prefixes clustered so that inserts land on shared paths
+  return IPAddressV4::fromLongHBO(folly::Random::rand32() & 0xff00ff0f);
+}
+
+IPAddressV6 randomIP(IPAddressV6 /*tag*/) {
+  folly::ByteArray16 ba{};
+  ba[0] = 0x20;
+  ba[1] = folly::Random::rand32(2);
+  ba[7] = folly::Random::rand32(256);
+  ba[8] = folly::Random::rand32(4);
+  ba[15] = folly::Random::rand32(256);
+  return IPAddressV6(ba);
+}
+
+template <typename IPADDRTYPE>
+void expectSameTrees(
+    const RadixTree<IPADDRTYPE, int>& expected,
+    const CompactRadixTree<IPADDRTYPE, int>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  // Same prefixes, in the same (preorder) order
+  auto citr = actual.begin();
+  for (auto itr = expected.begin(); itr != expected.end(); ++itr, ++citr) {
+    ASSERT_NE(actual.end(), citr);
+    EXPECT_EQ(itr->ipAddress(), citr->ipAddress());
+    EXPECT_EQ(itr->masklen(), citr->masklen());
+    EXPECT_EQ(itr->value(), citr->value());
+  }
+  EXPECT_EQ(actual.end(), citr);
+  // Non value nodes always have 2 children
+  EXPECT_LT(actual.numNodes(), 2 * actual.size() + 1);
+}
+
+/*
+ * Apply the same random inserts, erases and lookups to a RadixTree and a
+ * CompactRadixTree and check they always agree.
+ */
+template <typename IPADDRTYPE>
+void randomOpsMatchRadixTree() {
+  RadixTree<IPADDRTYPE, int> rtree;
+  CompactRadixTree<IPADDRTYPE, int> crtree;
+  auto maxMask = IPADDRTYPE::bitCount();
+  for (int i = 0; i < kNumOps; ++i) {
+    auto ip = randomIP(IPADDRTYPE());
+    uint8_t mask = folly::Random::rand32(maxMask + 1);
+    switch (folly::Random::rand32(4)) {
+      case 0:
+        EXPECT_EQ(rtree.erase(ip, mask), crtree.erase(ip, mask));
+        break;
+      case 1: {
+        auto itr = rtree.longestMatch(ip, mask);
+        auto citr = crtree.longestMatch(ip, mask);
+        ASSERT_EQ(itr == rtree.end(), citr == crtree.end());
+        if (itr != rtree.end()) {
+          EXPECT_EQ(itr->ipAddress(), citr->ipAddress());
+          EXPECT_EQ(itr->masklen(), citr->masklen());
+          EXPECT_EQ(itr->value(), citr->value());
+        }
+        auto eitr = rtree.exactMatch(ip, mask);
+        auto ecitr = crtree.exactMatch(ip, mask);
+        EXPECT_EQ(eitr == rtree.end(), ecitr == crtree.end());
+        break;
+      }
+      default:
+        EXPECT_EQ(
+            rtree.insert(ip, mask, i).second,
+            crtree.insert(ip, mask, i).second);
+        break;
+    }
+  }
+  expectSameTrees(rtree, crtree);
+
+  auto clone = crtree.clone();
+  expectSameTrees(rtree, clone);
+
+  // Erasing everything returns every node to the pool
+  while (crtree.begin() != crtree.end()) {
+    auto itr = crtree.begin();
+    EXPECT_TRUE(rtree.erase(itr->ipAddress(), itr->masklen()));
+    EXPECT_TRUE(crtree.erase(itr));
+  }
+  EXPECT_EQ(0, crtree.size());
+  EXPECT_EQ(0, crtree.numNodes());
+  expectSameTrees(rtree, crtree);
+}
+} // namespace
+
+TEST(CompactRadixTree, RandomOps4) {
+  randomOpsMatchRadixTree<IPAddressV4>();
+}
+
+TEST(CompactRadixTree, RandomOps6) {
+  randomOpsMatchRadixTree<IPAddressV6>();
+}
+
+TEST(CompactRadixTree, LongestMatch4) {
+  CompactRadixTree<IPAddressV4, int> crtree;
+  EXPECT_TRUE(crtree.insert(IPAddressV4("10.0.0.0"), 8, 8).second);
+  EXPECT_TRUE(crtree.insert(IPAddressV4("10.1.0.0"), 16, 16).second);
+  EXPECT_TRUE(crtree.insert(IPAddressV4("10.1.1.0"), 24, 24).second);
+  // Bits past the mask length are ignored
+  EXPECT_FALSE(crtree.insert(IPAddressV4("10.1.1.1"), 24, 25).second);
+
+  EXPECT_EQ(24, crtree.longestMatch(IPAddressV4("10.1.1.1"), 32)->value());
+  EXPECT_EQ(16, crtree.longestMatch(IPAddressV4("10.1.2.1"), 32)->value());
+  EXPECT_EQ(8, crtree.longestMatch(IPAddressV4("10.2.1.1"), 32)->value());
+  EXPECT_EQ(crtree.end(), crtree.longestMatch(IPAddressV4("11.0.0.1"), 32));
+  EXPECT_EQ(crtree.end(), crtree.exactMatch(IPAddressV4("10.1.1.0"), 25));
+
+  crtree.exactMatch(IPAddressV4("10.1.0.0"), 16)->setValue(160);
+  EXPECT_EQ(160, crtree.longestMatch(IPAddressV4("10.1.2.1"), 32)->value());
+
+  EXPECT_TRUE(crtree.erase(IPAddressV4("10.1.0.0"), 16));
+  EXPECT_FALSE(crtree.erase(IPAddressV4("10.1.0.0"), 16));
+  EXPECT_EQ(8, crtree.longestMatch(IPAddressV4("10.1.2.1"), 32)->value());
+  EXPECT_EQ(2, crtree.size());
+  EXPECT_EQ(
+      "10.1.1.0/24(24)",
+      crtree.exactMatch(IPAddressV4("10.1.1.0"), 24)->str());
+}
+
+TEST(CompactRadixTree, Reserve) {
+  CompactRadixTree<IPAddressV6, int> crtree;
+  crtree.reserve(1000);
+  auto reserved = crtree.memoryUsage();
+  for (int i = 0; i < 1000; ++i) {
+    crtree.insert(randomIP(IPAddressV6()), 128, i);
+  }
+  // No reallocation of the pool once reserved
+  EXPECT_EQ(reserved, crtree.memoryUsage());
+  crtree.clear();
+  EXPECT_EQ(0, crtree.size());
+  EXPECT_EQ(crtree.end(), crtree.begin());
+}
+
+TEST(CompactRadixTree, CloneWithFreeNodes) {
+  CompactRadixTree<IPAddressV4, int> crtree;
+  crtree.insert(IPAddressV4("10.0.0.0"), 8, 8);
+  crtree.insert(IPAddressV4("10.1.0.0"), 16, 16);
+  crtree.insert(IPAddressV4("10.1.1.0"), 24, 24);
+  crtree.insert(IPAddressV4("10.2.0.0"), 16, 162);
+  EXPECT_TRUE(crtree.erase(IPAddressV4("10.1.1.0"), 24));
+  EXPECT_TRUE(crtree.erase(IPAddressV4("10.2.0.0"), 16));
+
+  auto clone = crtree.clone();
+  EXPECT_EQ(crtree.numNodes(), clone.numNodes());
+  EXPECT_EQ(crtree.size(), clone.size());
+
+  // Reuses the nodes freed before the clone
+  crtree.insert(IPAddressV4("10.3.0.0"), 16, 163);
+  clone.insert(IPAddressV4("10.3.0.0"), 16, 163);
+  EXPECT_EQ(crtree.numNodes(), clone.numNodes());
+  EXPECT_EQ(crtree.size(), clone.size());
+  EXPECT_EQ(3, clone.size());
+  EXPECT_EQ(163, clone.longestMatch(IPAddressV4("10.3.0.1"), 32)->value());
+}
@@ -0,0 +1,312 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include "FakePhysicalMemory.h"
+#include "fboss/lib/fpga/FbFpgaI2c.h"
+#include "fboss/lib/fpga/FbFpgaRegisters.h"
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <vector>
+
+DECLARE_bool(fpga_i2c_batched_reads);
+
+namespace facebook::fboss {
+namespace {
+const uint64_t kFakeFpgaAddr = 0xfb100000;
+const uint32_t kFakeFpgaSize = 0x4000;
+const uint32_t kRtcId = 1;
+const uint32_t kPim = 2;
+// Version 0 RTCs have four descriptors
+const int kVersion = 0;
+const uint32_t kNumDescriptors = 4;
+const uint32_t kDescIncr = 0x20;
+const uint32_t kDescLowerBase = 0x500;
+const uint32_t kDescUpperBase = 0x504;
+const uint32_t kStatusBase = 0x600;
+const uint32_t kWriteBlock = 0x2000;
+const uint32_t kReadBlock = 0x3000;
+const uint32_t kIOBlockSize = 0x200;
+
+uint8_t expectedByte(uint8_t channel, uint8_t offset, uint32_t i) {
+  return channel * 64 + offset + i;
+}
+
+/*
+ * Emulates an FPGA RTC on top of FakePhysicalMemory. Setting the valid bit
+ * of a descriptor starts a transaction, which completes usecPerByte per byte
+ * later. Reads return a pattern derived from their channel and offset.
+ */
+class FakeRtcFpgaDevice : public FpgaDevice {
+ public:
+  FakeRtcFpgaDevice()
+      : FpgaDevice(kFakeFpgaAddr, kFakeFpgaSize),
+        mem_(kFakeFpgaAddr, kFakeFpgaSize, false) {
+    mem_.mmap();
+  }
+
+  uint32_t read(uint32_t offset) const override {
+    if (offset == kStatusBase + kRtcId * 4) {
+      return status();
+    }
+    return mem_.read(offset);
+  }
+
+  void write(uint32_t offset, uint32_t value) override {
+    mem_.write(offset, value);
+    for (uint32_t desc = 0; desc < kNumDescriptors; ++desc) {
+      if (offset == kDescUpperBase + kRtcId * kDescIncr + desc * 8) {
+        startTransaction(desc, value);
+      }
+    }
+  }
+
+  void setUsecPerByte(uint32_t usecPerByte) {
+    usecPerByte_ = usecPerByte;
+  }
+  void setFailChannel(uint8_t channel) {
+    failChannel_ = channel;
+  }
+  uint32_t getMaxInFlight() const {
+    return maxInFlight_;
+  }
+  const std::vector<uint8_t>& getLastWrite() const {
+    return lastWrite_;
+  }
+
+ private:
+  struct Transaction {
+    std::chrono::steady_clock::time_point done;
+    bool error;
+  };
+
+  void startTransaction(uint32_t desc, uint32_t upperReg) {
+    I2cDescriptorUpperDataUnion upper;
+    upper.reg = upperReg;
+    if (!upper.valid) {
+      return;
+    }
+    I2cDescriptorLowerDataUnion lower;
+    lower.reg = mem_.read(kDescLowerBase + kRtcId * kDescIncr + desc * 8);
+
+    uint32_t dataAddr = kRtcId * kIOBlockSize + desc * kIOBlockSize / 4;
+    if (lower.op == 1) {
+      for (uint32_t i = 0; i < lower.len; i += 4) {
+        uint32_t word = 0;
+        for (uint32_t byte = 0; byte < 4; ++byte) {
+          word |= expectedByte(upper.channel, upper.offset, i + byte)
+              << (8 * byte);
+        }
+        mem_.write(kReadBlock + dataAddr + i, word);
+      }
+    } else {
+      lastWrite_.clear();
+      for (uint32_t i = 0; i < lower.len; ++i) {
+        auto word = mem_.read(kWriteBlock + dataAddr + i / 4 * 4);
+        lastWrite_.push_back(word >> (8 * (i % 4)));
+      }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    transactions_[desc] = Transaction{
+        now + std::chrono::microseconds(usecPerByte_ * lower.len),
+        failChannel_ == upper.channel};
+    uint32_t inFlight = 0;
+    for (const auto& transaction : transactions_) {
+      inFlight += transaction && transaction->done > now;
+    }
+    maxInFlight_ = std::max(maxInFlight_, inFlight);
+  }
+
+  uint32_t status() const {
+    auto now = std::chrono::steady_clock::now();
+    uint32_t reg = 0;
+    for (uint32_t desc = 0; desc < kNumDescriptors; ++desc) {
+      const auto& transaction = transactions_[desc];
+      if (transaction && transaction->done <= now) {
+        reg |= (transaction->error ? 0x3 : 0x1) << (4 * desc);
+      }
+    }
+    return reg;
+  }
+
+  FakePhysicalMemory32 mem_;
+  std::array<std::optional<Transaction>, kNumDescriptors> transactions_;
+  uint32_t usecPerByte_{1};
+  std::optional<uint8_t> failChannel_;
+  uint32_t maxInFlight_{0};
+  std::vector<uint8_t> lastWrite_;
+};
+
+class FbFpgaI2cTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    device_ = std::make_unique<FakeRtcFpgaDevice>();
+    i2c_ = std::make_unique<FbFpgaI2c>(
+        std::make_unique<FpgaMemoryRegion>(
+            "pim2", device_.get(), 0, kFakeFpgaSize),
+        kRtcId,
+        kPim,
+        kVersion);
+  }
+
+  void expectData(uint8_t channel, uint8_t offset, folly::ByteRange buf) {
+    for (uint32_t i = 0; i < buf.size(); ++i) {
+      EXPECT_EQ(expectedByte(channel, offset, i), buf[i]);
+    }
+  }
+
+  std::unique_ptr<FakeRtcFpgaDevice> device_;
+  std::unique_ptr<FbFpgaI2c> i2c_;
+};
+} // namespace
+
+TEST_F(FbFpgaI2cTest, readWrite) {
+  std::array<uint8_t, 17> buf;
+  i2c_->read(2, 10, folly::MutableByteRange(buf.data(), buf.size()));
+  expectData(2, 10, folly::ByteRange(buf.data(), buf.size()));
+
+  std::array<uint8_t, 5> data{1, 2, 3, 4, 5};
+  i2c_->write(1, 20, folly::ByteRange(data.data(), data.size()));
+  EXPECT_EQ(
+      std::vector<uint8_t>(data.begin(), data.end()), device_->getLastWrite());
+
+  const auto& stats = i2c_->getI2cControllerPlatformStats();
+  EXPECT_EQ(1, *stats.readTotal__ref());
+  EXPECT_EQ(buf.size(), *stats.readBytes__ref());
+  EXPECT_EQ(1, *stats.writeTotal__ref());
+  EXPECT_EQ(data.size(), *stats.writeBytes__ref());
+}
+
+TEST_F(FbFpgaI2cTest, readMultipleInFlight) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_fpga_i2c_batched_reads = true;
+  EXPECT_EQ(kNumDescriptors, i2c_->getNumDescriptors());
+  device_->setUsecPerByte(20);
+
+  std::array<std::array<uint8_t, 32>, 6> bufs;
+  std::vector<FbFpgaI2cRead> reads;
+  for (uint32_t i = 0; i < bufs.size(); ++i) {
+    reads.push_back(FbFpgaI2cRead{
+        uint8_t(i % 4),
+        uint8_t(i * 8),
+        folly::MutableByteRange(bufs[i].data(), bufs[i].size())});
+  }
+  i2c_->readMultiple(folly::range(reads));
+
+  for (const auto& read : reads) {
+    EXPECT_TRUE(read.success);
+    expectData(read.channel, read.offset, read.buf);
+  }
+  // All descriptors were busy at once
+  EXPECT_EQ(kNumDescriptors, device_->getMaxInFlight());
+  EXPECT_EQ(
+      reads.size(), *i2c_->getI2cControllerPlatformStats().readTotal__ref());
+}
+
+TEST_F(FbFpgaI2cTest, readMultipleOneAtATime) {
+  device_->setUsecPerByte(20);
+  std::array<std::array<uint8_t, 32>, 4> bufs;
+  std::vector<FbFpgaI2cRead> reads;
+  for (uint8_t channel = 0; channel < bufs.size(); ++channel) {
+    reads.push_back(FbFpgaI2cRead{
+        channel,
+        0,
+        folly::MutableByteRange(bufs[channel].data(), bufs[channel].size())});
+  }
+  // Batching is off by default
+  i2c_->readMultiple(folly::range(reads));
+
+  for (const auto& read : reads) {
+    EXPECT_TRUE(read.success);
+    expectData(read.channel, read.offset, read.buf);
+  }
+  EXPECT_EQ(1, device_->getMaxInFlight());
+}
+
+TEST_F(FbFpgaI2cTest, readMultipleLargeRead) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_fpga_i2c_batched_reads = true;
+  // Too large for a descriptor's share of the IO block
+  std::array<uint8_t, 200> large;
+  std::array<uint8_t, 8> small;
+  std::vector<FbFpgaI2cRead> reads{
+      {0, 0, folly::MutableByteRange(small.data(), small.size())},
+      {1, 0, folly::MutableByteRange(large.data(), large.size())},
+      {2, 0, folly::MutableByteRange(small.data(), small.size())}};
+  i2c_->readMultiple(folly::range(reads));
+
+  for (const auto& read : reads) {
+    EXPECT_TRUE(read.success);
+  }
+  expectData(1, 0, reads[1].buf);
+  expectData(2, 0, reads[2].buf);
+  EXPECT_EQ(1, device_->getMaxInFlight());
+}
+
+TEST_F(FbFpgaI2cTest, failuresAreReported) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_fpga_i2c_batched_reads = true;
+  device_->setFailChannel(3);
+
+  std::array<std::array<uint8_t, 4>, 4> bufs;
+  std::vector<FbFpgaI2cRead> reads;
+  for (uint8_t channel = 0; channel < bufs.size(); ++channel) {
+    reads.push_back(FbFpgaI2cRead{
+        channel,
+        0,
+        folly::MutableByteRange(bufs[channel].data(), bufs[channel].size())});
+  }
+  i2c_->readMultiple(folly::range(reads));
+
+  EXPECT_TRUE(reads[0].success);
+  EXPECT_TRUE(reads[2].success);
+  EXPECT_FALSE(reads[3].success);
+  EXPECT_EQ(1, *i2c_->getI2cControllerPlatformStats().readFailed__ref());
+
+  EXPECT_THROW(i2c_->readByte(3, 0), FbFpgaI2cError);
+  EXPECT_EQ(2, *i2c_->getI2cControllerPlatformStats().readFailed__ref());
+}
+
+TEST_F(FbFpgaI2cTest, timeout) {
+  device_->setUsecPerByte(1000000);
+  EXPECT_THROW(i2c_->readByte(0, 0), FbFpgaI2cError);
+}
+
+TEST_F(FbFpgaI2cTest, adaptivePolling) {
+  constexpr auto kUsecPerByte = 5;
+  constexpr auto kNumReads = 20;
+  device_->setUsecPerByte(kUsecPerByte);
+  auto initialUsecPerByte = i2c_->getExpectedUsecPerByte();
+
+  std::array<uint8_t, 64> buf;
+  for (int i = 0; i < kNumReads; ++i) {
+    i2c_->read(0, 0, folly::MutableByteRange(buf.data(), buf.size()));
+  }
+
+  // The expected time follows the faster controller, instead of waiting for
+  // what used to be a fixed 100usec per byte
+  EXPECT_LT(i2c_->getExpectedUsecPerByte(), initialUsecPerByte / 4);
+  EXPECT_GT(i2c_->getExpectedUsecPerByte(), kUsecPerByte / 2.0);
+
+  const auto& stats = i2c_->getI2cControllerPlatformStats();
+  int64_t numSamples = 0;
+  for (auto count : *stats.latencyHistogramUsec__ref()) {
+    numSamples += count;
+  }
+  EXPECT_EQ(kNumReads, numSamples);
+  EXPECT_LT(
+      getI2cLatencyPercentileUsec(stats, 50), initialUsecPerByte * buf.size());
+}
+
+} // namespace facebook::fboss
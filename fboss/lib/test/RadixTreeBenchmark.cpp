@@ -8,6 +8,7 @@
 #include "PyRadixWrapper.h"
 #include "common/base/Random.h"
 #include "common/init/Init.h"
+#include "fboss/lib/CompactRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 
 using namespace std;
@@ -57,6 +58,11 @@ BENCHMARK_RELATIVE(RadixTreeInsert4) {
   setupTree4(rtree);
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeInsert4) {
+  CompactRadixTree<IPAddressV4, int> rtree;
+  setupTree4(rtree);
+}
+
 BENCHMARK(PyRadixErase4) {
   PyRadixWrapper<IPAddressV4, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -77,6 +83,16 @@ BENCHMARK_RELATIVE(RadixTreeErase4) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeErase4) {
+  CompactRadixTree<IPAddressV4, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree4(rtree);
+  }
+  for (auto pfx : eraseSet4) {
+    rtree.erase(pfx.ip, pfx.mask);
+  }
+}
+
 BENCHMARK(PyRadixExactMatch4) {
   PyRadixWrapper<IPAddressV4, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -97,6 +113,16 @@ BENCHMARK_RELATIVE(RadixTreeExactMatch4) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeExactMatch4) {
+  CompactRadixTree<IPAddressV4, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree4(rtree);
+  }
+  for (auto pfx : exactMatchSet4) {
+    rtree.exactMatch(pfx.ip, pfx.mask);
+  }
+}
+
 BENCHMARK(PyRadixLongestMatch4) {
   PyRadixWrapper<IPAddressV4, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -117,6 +143,38 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch4) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeLongestMatch4) {
+  CompactRadixTree<IPAddressV4, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree4(rtree);
+  }
+  for (auto pfx : longestMatchSet4) {
+    rtree.longestMatch(pfx.ip, pfx.mask);
+  }
+}
+
+template <typename TREE>
+void iterateTree4(TREE& tree) {
+  BENCHMARK_SUSPEND {
+    setupTree4(tree);
+  }
+  int sum = 0;
+  for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
+    sum += itr->value();
+  }
+  folly::doNotOptimizeAway(sum);
+}
+
+BENCHMARK(RadixTreeIterate4) {
+  RadixTree<IPAddressV4, int> rtree;
+  iterateTree4(rtree);
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeIterate4) {
+  CompactRadixTree<IPAddressV4, int> rtree;
+  iterateTree4(rtree);
+}
+
 // V6 benchmarks
 
 template <typename TREE>
@@ -137,6 +195,11 @@ BENCHMARK_RELATIVE(RadixTreeInsert6) {
   setupTree6(rtree);
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeInsert6) {
+  CompactRadixTree<IPAddressV6, int> rtree;
+  setupTree6(rtree);
+}
+
 BENCHMARK(PyRadixErase6) {
   PyRadixWrapper<IPAddressV6, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -157,6 +220,16 @@ BENCHMARK_RELATIVE(RadixTreeErase6) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeErase6) {
+  CompactRadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree6(rtree);
+  }
+  for (auto pfx : eraseSet6) {
+    rtree.erase(pfx.ip, pfx.mask);
+  }
+}
+
 BENCHMARK(PyRadixExactMatch6) {
   PyRadixWrapper<IPAddressV6, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -177,6 +250,16 @@ BENCHMARK_RELATIVE(RadixTreeExactMatch6) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeExactMatch6) {
+  CompactRadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree6(rtree);
+  }
+  for (auto pfx : exactMatchSet6) {
+    rtree.exactMatch(pfx.ip, pfx.mask);
+  }
+}
+
 BENCHMARK(PyRadixLongestMatch6) {
   PyRadixWrapper<IPAddressV6, int> pyrtree;
   BENCHMARK_SUSPEND {
@@ -197,6 +280,63 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch6) {
   }
 }
 
+BENCHMARK_RELATIVE(CompactRadixTreeLongestMatch6) {
+  CompactRadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupTree6(rtree);
+  }
+  for (auto pfx : longestMatchSet6) {
+    rtree.longestMatch(pfx.ip, pfx.mask);
+  }
+}
+
+template <typename TREE>
+void iterateTree6(TREE& tree) {
+  BENCHMARK_SUSPEND {
+    setupTree6(tree);
+  }
+  int sum = 0;
+  for (auto itr = tree.begin(); itr != tree.end(); ++itr) {
+    sum += itr->value();
+  }
+  folly::doNotOptimizeAway(sum);
+}
+
+BENCHMARK(RadixTreeIterate6) {
+  RadixTree<IPAddressV6, int> rtree;
+  iterateTree6(rtree);
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeIterate6) {
+  CompactRadixTree<IPAddressV6, int> rtree;
+  iterateTree6(rtree);
+}
+
+/*
+ * Log the memory held by the nodes of both tree variants for the insert
+ * set. For RadixTree this counts node objects only, not allocator overhead.
+ */
+template <typename ADDR, typename PREFIX>
+void logMemoryUsage(const set<PREFIX>& prefixes) {
+  RadixTree<ADDR, int> rtree;
+  CompactRadixTree<ADDR, int> crtree;
+  for (auto pfx : prefixes) {
+    rtree.insert(pfx.ip, pfx.mask, 0);
+    crtree.insert(pfx.ip, pfx.mask, 0);
+  }
+  size_t numNodes = 0;
+  typename RadixTree<ADDR, int>::ConstIterator itr(
+      rtree.root(), true /*includeNonValueNodes*/);
+  for (; !itr.atEnd(); ++itr) {
+    ++numNodes;
+  }
+  LOG(INFO) << "v" << int(ADDR().version()) << " prefixes: " << prefixes.size()
+            << " RadixTree: " << numNodes << " nodes, "
+            << numNodes * sizeof(typename RadixTree<ADDR, int>::TreeNode)
+            << " bytes; CompactRadixTree: " << crtree.numNodes()
+            << " nodes, " << crtree.memoryUsage() << " bytes";
+}
+
 } // namespace
 
 int main(int /*argc*/, char* /*argv*/ []) {
@@ -252,5 +392,7 @@ int main(int /*argc*/, char* /*argv*/ []) {
     auto newIp = pfx.ip.mask(newMask);
     longestMatchSet6.insert(Prefix6(newIp, newMask));
   }
+  logMemoryUsage<IPAddressV4>(insertSet4);
+  logMemoryUsage<IPAddressV6>(insertSet6);
   runBenchmarks();
 }
@@ -1,13 +1,16 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
+#include <folly/Benchmark.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <array>
+#include <memory>
 #include <set>
 #include <vector>
 #include "Utils.h"
 #include "common/base/Random.h"
 #include "common/init/Init.h"
+#include "fboss/lib/CompactRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 
 using namespace std;
@@ -19,10 +22,13 @@ DEFINE_bool(v4Inserts, false, "Do inserts into v4 trees");
 DEFINE_bool(v4Deletes, false, "Perform deletes on v4 trees");
 DEFINE_bool(v4Exact, false, "Perform exact match on v4 trees");
 DEFINE_bool(v4Longest, false, "Perform longest match on v4 trees");
+DEFINE_bool(v4Iterate, false, "Iterate over v4 trees");
 DEFINE_bool(v6Inserts, false, "Do inserts into v6 trees");
 DEFINE_bool(v6Deletes, false, "Perform deletes on v6 trees");
 DEFINE_bool(v6Exact, false, "Perform exact match on v6 trees");
 DEFINE_bool(v6Longest, false, "Perform longest match on v6 trees");
+DEFINE_bool(v6Iterate, false, "Iterate over v6 trees");
+DEFINE_bool(compact, false, "Profile CompactRadixTree instead of RadixTree");
 
 constexpr auto kTreeCount = 1000;
 constexpr auto kInsertCount = 10000;
@@ -36,14 +42,14 @@ vector<int> valueSet;
 
 typedef array<RadixTree<IPAddressV4, int>, kTreeCount> V4Trees_t;
 typedef array<RadixTree<IPAddressV6, int>, kTreeCount> V6Trees_t;
-
-V4Trees_t v4Trees;
-V6Trees_t v6Trees;
+typedef array<CompactRadixTree<IPAddressV4, int>, kTreeCount> CompactV4Trees_t;
+typedef array<CompactRadixTree<IPAddressV6, int>, kTreeCount> CompactV6Trees_t;
 // V4
-void setupV4Trees(uint32_t numTrees = kTreeCount) {
+template <typename TREES>
+void setupV4Trees(TREES& trees, uint32_t numTrees = kTreeCount) {
   auto treeCount = 0;
-  for (auto ritr = v4Trees.begin();
-       treeCount < numTrees && ritr != v4Trees.end();
+  for (auto ritr = trees.begin();
+       treeCount < numTrees && ritr != trees.end();
        ++ritr, ++treeCount) {
     auto count = 0;
     for (auto pfx : insertVec4) {
@@ -52,22 +58,25 @@ void setupV4Trees(uint32_t numTrees = kTreeCount) {
   }
 }
 
-void radixTreeInsert4() {
-  setupV4Trees();
+template <typename TREES>
+void radixTreeInsert4(TREES& trees) {
+  setupV4Trees(trees);
 }
 
-void radixTreeErase4() {
-  setupV4Trees();
-  for (auto& rtree : v4Trees) {
+template <typename TREES>
+void radixTreeErase4(TREES& trees) {
+  setupV4Trees(trees);
+  for (auto& rtree : trees) {
     for (auto pfx : matchVec4) {
       rtree.erase(pfx.ip, pfx.mask);
     }
   }
 }
 
-void radixTreeExactMatch4() {
-  setupV4Trees(1);
-  auto& rtree = v4Trees[1];
+template <typename TREES>
+void radixTreeExactMatch4(TREES& trees) {
+  setupV4Trees(trees, 1);
+  auto& rtree = trees[1];
   for (auto i = 0; i < kTreeCount; ++i) {
     for (auto pfx : matchVec4) {
       auto itr = rtree.exactMatch(pfx.ip, pfx.mask);
@@ -78,9 +87,10 @@ void radixTreeExactMatch4() {
   }
 }
 
-void radixTreeLongestMatch4() {
-  setupV4Trees(1);
-  auto& rtree = v4Trees[1];
+template <typename TREES>
+void radixTreeLongestMatch4(TREES& trees) {
+  setupV4Trees(trees, 1);
+  auto& rtree = trees[1];
   for (auto i = 0; i < kTreeCount; ++i) {
     for (auto pfx : matchVec4) {
       rtree.longestMatch(pfx.ip, pfx.mask);
@@ -91,11 +101,24 @@ void radixTreeLongestMatch4() {
     }
   }
 }
+
+template <typename TREES>
+void radixTreeIterate4(TREES& trees) {
+  setupV4Trees(trees);
+  int sum = 0;
+  for (auto& rtree : trees) {
+    for (auto itr = rtree.begin(); itr != rtree.end(); ++itr) {
+      sum += itr->value();
+    }
+  }
+  folly::doNotOptimizeAway(sum);
+}
 // V6
-void setupV6Trees(uint32_t numTrees = kTreeCount) {
+template <typename TREES>
+void setupV6Trees(TREES& trees, uint32_t numTrees = kTreeCount) {
   auto treeCount = 0;
-  for (auto ritr = v6Trees.begin();
-       treeCount < numTrees && ritr != v6Trees.end();
+  for (auto ritr = trees.begin();
+       treeCount < numTrees && ritr != trees.end();
        ++ritr, ++treeCount) {
     auto count = 0;
     for (auto pfx : insertVec6) {
@@ -104,22 +127,25 @@ void setupV6Trees(uint32_t numTrees = kTreeCount) {
   }
 }
 
-void radixTreeInsert6() {
-  setupV6Trees();
+template <typename TREES>
+void radixTreeInsert6(TREES& trees) {
+  setupV6Trees(trees);
 }
 
-void radixTreeErase6() {
-  setupV6Trees();
-  for (auto& rtree : v6Trees) {
+template <typename TREES>
+void radixTreeErase6(TREES& trees) {
+  setupV6Trees(trees);
+  for (auto& rtree : trees) {
     for (auto pfx : matchVec6) {
       rtree.erase(pfx.ip, pfx.mask);
     }
   }
 }
 
-void radixTreeExactMatch6() {
-  setupV6Trees(1);
-  auto& rtree = v6Trees[1];
+template <typename TREES>
+void radixTreeExactMatch6(TREES& trees) {
+  setupV6Trees(trees, 1);
+  auto& rtree = trees[1];
   for (auto i = 0; i < 100000; ++i) {
     for (auto pfx : matchVec6) {
       auto itr = rtree.exactMatch(pfx.ip, pfx.mask);
@@ -130,9 +156,10 @@ void radixTreeExactMatch6() {
   }
 }
 
-void radixTreeLongestMatch6() {
-  setupV6Trees(1);
-  auto& rtree = v6Trees[1];
+template <typename TREES>
+void radixTreeLongestMatch6(TREES& trees) {
+  setupV6Trees(trees, 1);
+  auto& rtree = trees[1];
   for (auto i = 0; i < kTreeCount; ++i) {
     for (auto pfx : matchVec6) {
       auto itr = rtree.longestMatch(pfx.ip, pfx.mask);
@@ -143,6 +170,18 @@ void radixTreeLongestMatch6() {
   }
 }
 
+template <typename TREES>
+void radixTreeIterate6(TREES& trees) {
+  setupV6Trees(trees);
+  int sum = 0;
+  for (auto& rtree : trees) {
+    for (auto itr = rtree.begin(); itr != rtree.end(); ++itr) {
+      sum += itr->value();
+    }
+  }
+  folly::doNotOptimizeAway(sum);
+}
+
 void fillV4MatchVec() {
   if (matchVec4.size()) {
     return;
@@ -167,10 +206,57 @@ void fillV6MatchVec() {
   matchVec6 = {matchSet.begin(), matchSet.end()};
 }
 
+template <typename TREES>
+void runV4Ops() {
+  auto trees = std::make_unique<TREES>();
+  if (FLAGS_v4Inserts) {
+    radixTreeInsert4(*trees);
+  }
+  if (FLAGS_v4Deletes) {
+    fillV4MatchVec();
+    radixTreeErase4(*trees);
+  }
+  if (FLAGS_v4Exact) {
+    fillV4MatchVec();
+    radixTreeExactMatch4(*trees);
+  }
+  if (FLAGS_v4Longest) {
+    fillV4MatchVec();
+    radixTreeLongestMatch4(*trees);
+  }
+  if (FLAGS_v4Iterate) {
+    radixTreeIterate4(*trees);
+  }
+}
+
+template <typename TREES>
+void runV6Ops() {
+  auto trees = std::make_unique<TREES>();
+  if (FLAGS_v6Inserts) {
+    radixTreeInsert6(*trees);
+  }
+  if (FLAGS_v6Deletes) {
+    fillV6MatchVec();
+    radixTreeErase6(*trees);
+  }
+  if (FLAGS_v6Exact) {
+    fillV6MatchVec();
+    radixTreeExactMatch6(*trees);
+  }
+  if (FLAGS_v6Longest) {
+    fillV6MatchVec();
+    radixTreeLongestMatch6(*trees);
+  }
+  if (FLAGS_v6Iterate) {
+    radixTreeIterate6(*trees);
+  }
+}
+
 int main(int argc, char* argv[]) {
   facebook::initFacebook(&argc, &argv);
   // V4 ops
-  if (FLAGS_v4Inserts || FLAGS_v4Deletes || FLAGS_v4Exact || FLAGS_v4Longest) {
+  if (FLAGS_v4Inserts || FLAGS_v4Deletes || FLAGS_v4Exact || FLAGS_v4Longest ||
+      FLAGS_v4Iterate) {
     set<Prefix4> inserted4;
     while (inserted4.size() < kInsertCount) {
       auto mask = folly::Random::rand32(32);
@@ -181,25 +267,16 @@ int main(int argc, char* argv[]) {
         insertVec4.push_back(Prefix4(ip, mask));
       }
     }
-    if (FLAGS_v4Inserts) {
-      radixTreeInsert4();
-    }
-    if (FLAGS_v4Deletes) {
-      fillV4MatchVec();
-      radixTreeErase4();
-    }
-    if (FLAGS_v4Exact) {
-      fillV4MatchVec();
-      radixTreeExactMatch4();
-    }
-    if (FLAGS_v4Longest) {
-      fillV4MatchVec();
-      radixTreeLongestMatch4();
+    if (FLAGS_compact) {
+      runV4Ops<CompactV4Trees_t>();
+    } else {
+      runV4Ops<V4Trees_t>();
     }
   }
 
   // V6 ops
-  if (FLAGS_v6Inserts || FLAGS_v6Deletes || FLAGS_v6Exact || FLAGS_v6Longest) {
+  if (FLAGS_v6Inserts || FLAGS_v6Deletes || FLAGS_v6Exact || FLAGS_v6Longest ||
+      FLAGS_v6Iterate) {
     set<Prefix6> inserted6;
     while (inserted6.size() < kInsertCount) {
       auto mask = folly::Random::rand32(128);
@@ -213,20 +290,10 @@ int main(int argc, char* argv[]) {
         insertVec6.push_back(Prefix6(ip, mask));
       }
     }
-    if (FLAGS_v6Inserts) {
-      radixTreeInsert6();
-    }
-    if (FLAGS_v6Deletes) {
-      fillV6MatchVec();
-      radixTreeErase6();
-    }
-    if (FLAGS_v6Exact) {
-      fillV6MatchVec();
-      radixTreeExactMatch6();
-    }
-    if (FLAGS_v6Longest) {
-      fillV6MatchVec();
-      radixTreeLongestMatch6();
+    if (FLAGS_compact) {
+      runV6Ops<CompactV6Trees_t>();
+    } else {
+      runV6Ops<V6Trees_t>();
     }
   }
 
@@ -16,6 +16,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace facebook::fboss {
 enum class ModulePresence { PRESENT, ABSENT, UNKNOWN };
@@ -32,6 +33,19 @@ class I2cError : public std::exception {
   std::string what_;
 };
 
+/*
+ * A read issued as part of a batch through moduleReadMultiple().
+ */
+struct TransceiverI2CRead {
+  unsigned int module{0};
+  uint8_t i2cAddress{0};
+  int offset{0};
+  int len{0};
+  uint8_t* buf{nullptr};
+  // Set once the data in buf was read successfully
+  bool success{false};
+};
+
 /*
  * Abstract away some of the details of handling the I2C bus to query
  * QSFP and SFP transceiver modules.
@@ -57,6 +71,24 @@ class TransceiverI2CApi {
       int len,
       const uint8_t* buf) = 0;
 
+  /*
+   * Read from several modules at once. Platforms whose I2C controllers can
+   * have several transactions in flight override this to queue them
+   * together, by default they are read one after the other. Failed reads are
+   * reported through their success field instead of by throwing.
+   */
+  virtual void moduleReadMultiple(std::vector<TransceiverI2CRead>& reads) {
+    for (auto& read : reads) {
+      try {
+        moduleRead(
+            read.module, read.i2cAddress, read.offset, read.len, read.buf);
+        read.success = true;
+      } catch (const std::exception&) {
+        read.success = false;
+      }
+    }
+  }
+
   virtual void verifyBus(bool autoReset) = 0;
 
   virtual bool isPresent(unsigned int module) = 0;
@@ -171,6 +171,8 @@ struct TransceiverStats {
   1: double readDownTime,
   // duration between last write and last successful write
   2: double writeDownTime,
+  // bytes read from and written to the module by the latest refresh
+  3: i64 refreshI2cBytes,
 }
 
 struct TransceiverInfo {
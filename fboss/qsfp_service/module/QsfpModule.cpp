@@ -10,6 +10,7 @@
 #include "QsfpModule.h"
 
 #include <boost/assign.hpp>
+#include <algorithm>
 #include <string>
 #include <iomanip>
 #include "fboss/agent/FbossError.h"
@@ -17,6 +18,8 @@
 #include "fboss/qsfp_service/StatsPublisher.h"
 #include "fboss/lib/usb/TransceiverI2CApi.h"
 
+#include <folly/ScopeGuard.h>
+#include <folly/hash/Hash.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
@@ -33,6 +36,15 @@ DEFINE_int32(
     remediate_interval,
     300,
     "seconds between running more destructive remediations on down ports");
+DEFINE_bool(
+    qsfp_flag_driven_dom_polling,
+    true,
+    "only read qsfp DOM data when the module raises an interrupt or flag, "
+    "or every qsfp_dom_refresh_interval seconds");
+DEFINE_int32(
+    qsfp_dom_refresh_interval,
+    30,
+    "how often to refetch qsfp DOM data when no flags are raised");
 
 using std::memcpy;
 using std::mutex;
@@ -116,6 +128,9 @@ bool QsfpModule::detectPresenceLocked() {
     dirty_ = true;
     present_ = currentQsfpStatus;
     moduleResetCounter_ = 0;
+    // A different module may be plugged in now
+    staticPagesFingerprint_.reset();
+    domRefreshWanted_ = true;
 
     // If a transceiver went from present to missing, clear the cached data.
     if (!present_) {
@@ -298,15 +313,41 @@ folly::Future<folly::Unit> QsfpModule::futureRefresh() {
   });
 }
 
+int QsfpModule::getStatusPrefetchLength() {
+  lock_guard<std::mutex> g(qsfpModuleMutex_);
+  // Only a refresh of clean data starts with the status bytes. Not one
+  // which customizes the module first either: writing to it drops the
+  // prefetched bytes, and with them the latched flags reading them cleared.
+  if (!present_ || dirty_ ||
+      !shouldRefresh(FLAGS_qsfp_data_refresh_interval) ||
+      customizationWanted(FLAGS_customize_interval)) {
+    return 0;
+  }
+  return getStatusBytesLength();
+}
+
+void QsfpModule::setPrefetchedStatus(folly::ByteRange data) {
+  lock_guard<std::mutex> g(qsfpModuleMutex_);
+  prefetchedStatus_.assign(data.begin(), data.end());
+}
+
 void QsfpModule::refreshLocked() {
+  // Prefetched status bytes are only good for this refresh
+  SCOPE_EXIT {
+    prefetchedStatus_.clear();
+  };
   detectPresenceLocked();
 
-  auto customizeWanted = customizationWanted(FLAGS_customize_interval);
+  // Status bytes prefetched before customization became due hold latched
+  // flags which can't be read again, so customize on the next refresh
+  auto customizeWanted = prefetchedStatus_.empty() &&
+      customizationWanted(FLAGS_customize_interval);
   auto willRefresh = !dirty_ && shouldRefresh(FLAGS_qsfp_data_refresh_interval);
   if (!dirty_ && !customizeWanted && !willRefresh) {
     return;
   }
 
+  refreshI2cBytes_ = 0;
   if (dirty_) {
     // make sure data is up to date before trying to customize.
     ensureOutOfReset();
@@ -377,7 +418,63 @@ std::optional<TransceiverStats> QsfpModule::getTransceiverStats() {
   if (!transceiverStats.has_value()) {
     return {};
   }
+  transceiverStats->refreshI2cBytes_ref() = refreshI2cBytes_;
   return transceiverStats.value();
 }
 
+void QsfpModule::readTransceiverLocked(
+    int dataAddress,
+    int offset,
+    int length,
+    uint8_t* data) {
+  if (!dirty_ && dataAddress == TransceiverI2CApi::ADDR_QSFP && offset == 0 &&
+      length == static_cast<int>(prefetchedStatus_.size())) {
+    std::copy(prefetchedStatus_.begin(), prefetchedStatus_.end(), data);
+    prefetchedStatus_.clear();
+  } else {
+    qsfpImpl_->readTransceiver(dataAddress, offset, length, data);
+  }
+  refreshI2cBytes_ += length;
+}
+
+void QsfpModule::writeTransceiverLocked(
+    int dataAddress,
+    int offset,
+    int length,
+    uint8_t* data) {
+  prefetchedStatus_.clear();
+  qsfpImpl_->writeTransceiver(dataAddress, offset, length, data);
+  refreshI2cBytes_ += length;
+  // Anything but selecting a page may change control bytes we keep with the
+  // DOM data, so read it again on the next refresh
+  if (offset != 127 || length != 1) {
+    domRefreshWanted_ = true;
+  }
+}
+
+bool QsfpModule::staticPagesCachedFor(folly::ByteRange identity) const {
+  return staticPagesFingerprint_ &&
+      *staticPagesFingerprint_ ==
+      folly::hash::fnv64_buf(identity.data(), identity.size());
+}
+
+void QsfpModule::cacheStaticPages(folly::ByteRange identity) {
+  staticPagesFingerprint_ =
+      folly::hash::fnv64_buf(identity.data(), identity.size());
+}
+
+bool QsfpModule::shouldRefreshDom(bool flagsRaised) const {
+  if (!FLAGS_qsfp_flag_driven_dom_polling || domRefreshWanted_ ||
+      flagsRaised) {
+    return true;
+  }
+  return std::time(nullptr) - lastDomRefreshTime_ >=
+      FLAGS_qsfp_dom_refresh_interval;
+}
+
+void QsfpModule::domRefreshed() {
+  lastDomRefreshTime_ = std::time(nullptr);
+  domRefreshWanted_ = false;
+}
+
 }} //namespace facebook::fboss
@@ -15,6 +15,8 @@
 #include "fboss/qsfp_service/if/gen-cpp2/transceiver_types.h"
 
 #include <optional>
+#include <vector>
+#include <folly/Range.h>
 #include <folly/Synchronized.h>
 #include <folly/futures/Future.h>
 
@@ -77,6 +79,9 @@ class QsfpModule : public Transceiver {
   folly::Future<folly::Unit> futureRefresh() override;
   void refreshLocked();
 
+  int getStatusPrefetchLength() override;
+  void setPrefetchedStatus(folly::ByteRange data) override;
+
   /*
    * Customize QSPF fields as necessary
    *
@@ -153,6 +158,61 @@ class QsfpModule : public Transceiver {
   // last time we know transceiver was working because at least one port was up
   time_t lastWorkingTime_{0};
 
+  /*
+   * Static pages are kept across refreshes of the same module. The cache is
+   * keyed by a fingerprint of the module identity bytes (vendor name, part
+   * and serial number), and dropped whenever presence changes. These MUST be
+   * accessed holding qsfpModuleMutex_.
+   */
+  std::optional<uint64_t> staticPagesFingerprint_;
+  // Last time the DOM (monitor) data was read, and whether it is due anyway
+  time_t lastDomRefreshTime_{0};
+  bool domRefreshWanted_{true};
+  // Bytes read from and written to the module by the latest refresh
+  int64_t refreshI2cBytes_{0};
+  // Status bytes read ahead of the refresh, used by its first read
+  std::vector<uint8_t> prefetchedStatus_;
+
+  /*
+   * Read from or write to the module, accounting the bytes to the current
+   * refresh. Writes have the next refresh read the DOM data again, as it
+   * holds the control bytes. All writes to the module must go through here.
+   * This must be called with a lock held on qsfpModuleMutex_
+   */
+  void readTransceiverLocked(
+      int dataAddress,
+      int offset,
+      int length,
+      uint8_t* data);
+  void writeTransceiverLocked(
+      int dataAddress,
+      int offset,
+      int length,
+      uint8_t* data);
+
+  /*
+   * Number of bytes at the start of the lower page updateQsfpData() reads
+   * first, to decide what else to read.
+   */
+  virtual int getStatusBytesLength() = 0;
+
+  /*
+   * Whether the cached static pages were read from the module with the
+   * given identity bytes, and record that they now are.
+   */
+  bool staticPagesCachedFor(folly::ByteRange identity) const;
+  void cacheStaticPages(folly::ByteRange identity);
+
+  /*
+   * Whether the DOM data should be read on this refresh. With flag driven
+   * polling it is only read when the module raised its interrupt or a
+   * latched flag, after customization or presence changes, and otherwise
+   * every qsfp_dom_refresh_interval seconds. domRefreshed() must be called
+   * once it has been read.
+   */
+  bool shouldRefreshDom(bool flagsRaised) const;
+  void domRefreshed();
+
   /*
    * Perform transceiver customization
    * This must be called with a lock held on qsfpModuleMutex_
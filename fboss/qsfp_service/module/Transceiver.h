@@ -14,6 +14,7 @@
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 #include "fboss/qsfp_service/if/gen-cpp2/transceiver_types.h"
 
+#include <folly/Range.h>
 #include <folly/futures/Future.h>
 
 namespace facebook { namespace fboss {
@@ -52,6 +53,17 @@ class Transceiver {
   virtual void refresh() = 0;
   virtual folly::Future<folly::Unit> futureRefresh() = 0;
 
+  /*
+   * Number of bytes at the start of the lower page the next refresh reads
+   * first, or 0 if it won't read them. They may be read for several
+   * transceivers at once, and handed over with setPrefetchedStatus() right
+   * before refreshing, for the refresh to use instead of reading them.
+   */
+  virtual int getStatusPrefetchLength() {
+    return 0;
+  }
+  virtual void setPrefetchedStatus(folly::ByteRange /* data */) {}
+
   /*
    * Return all of the transceiver information
    */
@@ -2,6 +2,7 @@
 
 #include "CmisModule.h"
 
+#include <algorithm>
 #include <boost/assign.hpp>
 #include <cmath>
 #include <iomanip>
@@ -705,6 +706,11 @@ void CmisModule::getFieldValueLocked(CmisField fieldName, uint8_t* fieldValue)
   getQsfpValue(dataAddress, offset, length, fieldValue);
 }
 
+int CmisModule::getStatusBytesLength() {
+  // The flags are spread over the whole lower page
+  return sizeof(lowerPage_);
+}
+
 void CmisModule::updateQsfpData(bool allPages) {
   // expects the lock to be held
   if (!present_) {
@@ -714,44 +720,72 @@ void CmisModule::updateQsfpData(bool allPages) {
     XLOG(DBG2) << "Performing " << ((allPages) ? "full" : "partial")
                << " qsfp data cache refresh for transceiver "
                << folly::to<std::string>(qsfpImpl_->getName());
-    qsfpImpl_->readTransceiver(
-        TransceiverI2CApi::ADDR_QSFP, 0, sizeof(lowerPage_), lowerPage_);
+    readTransceiverLocked(
+        TransceiverI2CApi::ADDR_QSFP, 0, getStatusBytesLength(), lowerPage_);
     lastRefreshTime_ = std::time(nullptr);
     dirty_ = false;
     setQsfpFlatMem();
 
-    // If we have flat memory, we don't have to set the page
-    if (!flatMem_) {
-      uint8_t page = 0x00;
-      qsfpImpl_->writeTransceiver(
-          TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
+    // Page 00h is static. Once cached it is only reread if the identity
+    // bytes show a different module on a full refresh.
+    int dataAddress;
+    int identityOffset;
+    int identityEnd;
+    int length;
+    getQsfpFieldAddress(
+        CmisField::VENDOR_NAME, dataAddress, identityOffset, length);
+    getQsfpFieldAddress(
+        CmisField::VENDOR_SERIAL_NUMBER, dataAddress, identityEnd, length);
+    identityEnd += length;
+    bool staticPagesValid = staticPagesFingerprint_ && !allPages;
+    if (!staticPagesValid) {
+      // If we have flat memory, we don't have to set the page
+      if (!flatMem_) {
+        uint8_t page = 0x00;
+        writeTransceiverLocked(
+            TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
+      }
+      if (staticPagesFingerprint_) {
+        uint8_t identity[MAX_QSFP_PAGE_SIZE] = {0};
+        readTransceiverLocked(
+            TransceiverI2CApi::ADDR_QSFP,
+            identityOffset,
+            identityEnd - identityOffset,
+            identity);
+        staticPagesValid = staticPagesCachedFor(
+            folly::ByteRange(identity, identityEnd - identityOffset));
+      }
+      if (!staticPagesValid) {
+        readTransceiverLocked(
+            TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page0_), page0_);
+      }
     }
-    qsfpImpl_->readTransceiver(
-        TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page0_), page0_);
-    if (!flatMem_) {
+
+    if (!flatMem_ && shouldRefreshDom(flagsRaised())) {
       uint8_t page = 0x10;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page10_), page10_);
 
       page = 0x11;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page11_), page11_);
 
       page = 0x14;
       auto diagFeature = (uint8_t)DiagnosticFeatureEncoding::SNR;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(diagFeature), &diagFeature);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page14_), page14_);
+      domRefreshed();
     }
 
-    if (!allPages) {
+    if (!allPages || staticPagesValid) {
       // The information on the following pages are static. Thus no need to
       // fetch them every time. We just need to do it when we first retriving
       // the data from this module.
@@ -760,23 +794,25 @@ void CmisModule::updateQsfpData(bool allPages) {
 
     if (!flatMem_) {
       uint8_t page = 0x01;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page01_), page01_);
 
       page = 0x02;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page02_), page02_);
 
       page = 0x13;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page13_), page13_);
     }
+    cacheStaticPages(folly::ByteRange(
+        page0_ + identityOffset - 128, page0_ + identityEnd - 128));
   } catch (const std::exception& ex) {
     // No matter what kind of exception throws, we need to set the dirty_ flag
     // to true.
@@ -788,6 +824,25 @@ void CmisModule::updateQsfpData(bool allPages) {
   }
 }
 
+bool CmisModule::flagsRaised() const {
+  int dataAddress;
+  int offset;
+  int length;
+  // The interrupt bit is active low
+  getQsfpFieldAddress(CmisField::MODULE_STATE, dataAddress, offset, length);
+  if (!(lowerPage_[offset] & 0x1)) {
+    return true;
+  }
+  // Lane flag summaries of each bank, followed by the module flags
+  int flagsBegin;
+  getQsfpFieldAddress(CmisField::BANK0_FLAGS, dataAddress, flagsBegin, length);
+  getQsfpFieldAddress(CmisField::MODULE_ALARMS, dataAddress, offset, length);
+  return std::any_of(
+      lowerPage_ + flagsBegin,
+      lowerPage_ + offset + length,
+      [](uint8_t flags) { return flags != 0; });
+}
+
 void CmisModule::setApplicationCode(cfg::PortSpeed speed) {
   auto applicationIter = speedApplicationMapping.find(speed);
 
@@ -856,12 +911,13 @@ void CmisModule::setApplicationCode(cfg::PortSpeed speed) {
 
   // Flip to page 0x10 to get prepared.
   uint8_t page = 0x10;
-  qsfpImpl_->writeTransceiver(TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
+  writeTransceiverLocked(
+      TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
 
   getQsfpFieldAddress(CmisField::APP_SEL_LANE_1, dataAddress, offset, length);
 
   for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
-    qsfpImpl_->writeTransceiver(
+    writeTransceiverLocked(
         TransceiverI2CApi::ADDR_QSFP,
         offset + channel,
         sizeof(newApSelCode),
@@ -871,7 +927,7 @@ void CmisModule::setApplicationCode(cfg::PortSpeed speed) {
   uint8_t applySet0 = 0x0f;
 
   getQsfpFieldAddress(CmisField::STAGE_CTRL_SET_0, dataAddress, offset, length);
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, offset, sizeof(applySet0), &applySet0);
 
   XLOG(INFO) << "Port: " << folly::to<std::string>(qsfpImpl_->getName())
@@ -893,6 +949,8 @@ void CmisModule::remediateFlakyTransceiver() {
     transceiverManager_->getQsfpPlatformApi()->triggerQsfpHardReset(
         static_cast<unsigned int>(getID()) + 1);
     moduleResetCounter_++;
+    // The reset puts the control bytes back to their defaults
+    domRefreshWanted_ = true;
   } else {
     XLOG(DBG2) << "Reached reset limit for module " << qsfpImpl_->getName();
   }
@@ -929,7 +987,7 @@ void CmisModule::setPowerOverrideIfSupported(PowerControlState currentState) {
   currentModuleControl = currentModuleControl | (1 << 6);
 
   // first set to low power
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, offset, length, &currentModuleControl);
 
   // Transceivers need a bit of time to handle the low power setting
@@ -940,7 +998,7 @@ void CmisModule::setPowerOverrideIfSupported(PowerControlState currentState) {
   // then enable target power class
   currentModuleControl = currentModuleControl & 0x3f;
 
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, offset, length, &currentModuleControl);
 
   XLOG(INFO) << "Port " << portStr << ": QSFP module control field set to "
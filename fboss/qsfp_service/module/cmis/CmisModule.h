@@ -215,6 +215,7 @@ class CmisModule : public QsfpModule {
    * there is not much point in refreshing static data on other pages.
    */
   virtual void updateQsfpData(bool allPages = true) override;
+  int getStatusBytesLength() override;
 
   /*
    * Put logic here that should only be run on ports that have been
@@ -225,6 +226,11 @@ class CmisModule : public QsfpModule {
 
  private:
   void getFieldValueLocked(CmisField fieldName, uint8_t* fieldValue) const;
+  /*
+   * Whether the module asserted its interrupt or has any latched module or
+   * lane flag set, according to the cached lower page.
+   */
+  bool flagsRaised() const;
   /*
    * Helpers to parse DOM data for DAC cables. These incorporate some
    * extra fields that FB has vendors put in the 'Vendor specific'
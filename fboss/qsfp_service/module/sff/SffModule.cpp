@@ -3,6 +3,7 @@
 #include "fboss/qsfp_service/module/sff/SffModule.h"
 
 #include <assert.h>
+#include <algorithm>
 #include <boost/assign.hpp>
 #include <iomanip>
 #include <string>
@@ -661,6 +662,15 @@ void SffModule::getFieldValue(SffField fieldName, uint8_t* fieldValue) {
   getQsfpValue(dataAddress, offset, length, fieldValue);
 }
 
+int SffModule::getStatusBytesLength() {
+  // Status and latched flag bytes, up to the monitor bytes
+  int dataAddress;
+  int domOffset;
+  int length;
+  getQsfpFieldAddress(SffField::TEMPERATURE, dataAddress, domOffset, length);
+  return domOffset;
+}
+
 void SffModule::updateQsfpData(bool allPages) {
   // expects the lock to be held
   if (!present_) {
@@ -670,12 +680,24 @@ void SffModule::updateQsfpData(bool allPages) {
     XLOG(DBG2) << "Performing " << ((allPages) ? "full" : "partial")
                << " qsfp data cache refresh for transceiver "
                << folly::to<std::string>(qsfpImpl_->getName());
-    qsfpImpl_->readTransceiver(
-        TransceiverI2CApi::ADDR_QSFP, 0, sizeof(lowerPage_), lowerPage_);
+    // The status and latched flag bytes come first, and tell whether the
+    // monitor and control bytes that follow them are worth reading
+    int domOffset = getStatusBytesLength();
+    readTransceiverLocked(
+        TransceiverI2CApi::ADDR_QSFP, 0, domOffset, lowerPage_);
     lastRefreshTime_ = std::time(nullptr);
     dirty_ = false;
     setQsfpFlatMem();
 
+    if (allPages || shouldRefreshDom(flagsRaised(domOffset))) {
+      readTransceiverLocked(
+          TransceiverI2CApi::ADDR_QSFP,
+          domOffset,
+          sizeof(lowerPage_) - domOffset,
+          lowerPage_ + domOffset);
+      domRefreshed();
+    }
+
     if (!allPages) {
       // Only the first page has fields that change often so provide
       // an option to only fetch that page. Also the write path is
@@ -688,18 +710,44 @@ void SffModule::updateQsfpData(bool allPages) {
     // If we have flat memory, we don't have to set the page
     if (!flatMem_) {
       uint8_t page = 0;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
     }
-    qsfpImpl_->readTransceiver(
+    // Only the identity bytes are needed to tell whether the static pages
+    // we have cached are still those of the module plugged in
+    int dataAddress;
+    int identityOffset;
+    int identityEnd;
+    int length;
+    getQsfpFieldAddress(
+        SffField::VENDOR_NAME, dataAddress, identityOffset, length);
+    getQsfpFieldAddress(
+        SffField::VENDOR_SERIAL_NUMBER, dataAddress, identityEnd, length);
+    identityEnd += length;
+    if (staticPagesFingerprint_) {
+      uint8_t identity[MAX_QSFP_PAGE_SIZE] = {0};
+      readTransceiverLocked(
+          TransceiverI2CApi::ADDR_QSFP,
+          identityOffset,
+          identityEnd - identityOffset,
+          identity);
+      if (staticPagesCachedFor(
+              folly::ByteRange(identity, identityEnd - identityOffset))) {
+        return;
+      }
+    }
+
+    readTransceiverLocked(
         TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page0_), page0_);
     if (!flatMem_) {
       uint8_t page = 3;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
-      qsfpImpl_->readTransceiver(
+      readTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, 128, sizeof(page3_), page3_);
     }
+    cacheStaticPages(folly::ByteRange(
+        page0_ + identityOffset - 128, page0_ + identityEnd - 128));
   } catch (const std::exception& ex) {
     // No matter what kind of exception throws, we need to set the dirty_ flag
     // to true.
@@ -711,6 +759,21 @@ void SffModule::updateQsfpData(bool allPages) {
   }
 }
 
+bool SffModule::flagsRaised(int flagsEnd) const {
+  // IntL is active low, and stays asserted while any latched flag is set
+  if (!(lowerPage_[2] & (1 << 1))) {
+    return true;
+  }
+  int dataAddress;
+  int offset;
+  int length;
+  getQsfpFieldAddress(SffField::LOS, dataAddress, offset, length);
+  return std::any_of(
+      lowerPage_ + offset, lowerPage_ + flagsEnd, [](uint8_t flags) {
+        return flags != 0;
+      });
+}
+
 void SffModule::setCdrIfSupported(
     cfg::PortSpeed speed,
     FeatureState currentStateTx,
@@ -760,7 +823,7 @@ void SffModule::setCdrIfSupported(
   getQsfpFieldAddress(
       SffField::CDR_CONTROL, dataAddress, dataOffset, dataLength);
 
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, dataOffset, sizeof(value), &value);
   XLOG(INFO) << folly::to<std::string>(
       "Port: ",
@@ -825,12 +888,12 @@ void SffModule::setRateSelectIfSupported(
 
   getQsfpFieldAddress(
       SffField::RATE_SELECT_RX, dataAddress, dataOffset, dataLength);
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, dataOffset, sizeof(value), &value);
 
   getQsfpFieldAddress(
       SffField::RATE_SELECT_RX, dataAddress, dataOffset, dataLength);
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, dataOffset, sizeof(value), &value);
   XLOG(INFO) << "Port: " << folly::to<std::string>(qsfpImpl_->getName())
              << " set rate select to "
@@ -893,7 +956,7 @@ void SffModule::setPowerOverrideIfSupported(PowerControlState currentState) {
   getQsfpFieldAddress(SffField::POWER_CONTROL, dataAddress, offset, length);
 
   // enable target power class
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, offset, sizeof(power), &power);
 
   XLOG(INFO) << "Port " << portStr << ": QSFP set to power setting "
@@ -928,7 +991,7 @@ void SffModule::resetLowPowerMode() {
 
   if (oldPower != lowPower) {
     // first set to low power
-    qsfpImpl_->writeTransceiver(
+    writeTransceiverLocked(
         TransceiverI2CApi::ADDR_QSFP, offset, sizeof(lowPower), &lowPower);
 
     // Transceivers need a bit of time to handle the low power setting
@@ -938,7 +1001,7 @@ void SffModule::resetLowPowerMode() {
   }
 
   // set back to previous value
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, offset, sizeof(oldPower), &oldPower);
 }
 
@@ -959,7 +1022,7 @@ void SffModule::ensureTxEnabled() {
 
   // Force enable
   std::array<uint8_t, 1> buf = {{0}};
-  qsfpImpl_->writeTransceiver(
+  writeTransceiverLocked(
       TransceiverI2CApi::ADDR_QSFP, offset, 1, buf.data());
 }
 
@@ -975,7 +1038,7 @@ void SffModule::overwriteChannelControlSettings() {
   }
 
       uint8_t page = 3;
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
         TransceiverI2CApi::ADDR_QSFP, 127, sizeof(page), &page);
       int offset;
       int length;
@@ -987,7 +1050,7 @@ void SffModule::overwriteChannelControlSettings() {
                           offset,
                           length);
       CHECK_EQ(length, 2);
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, offset, length, buf.data());
 
       getQsfpFieldAddress(SffField::RX_EMPHASIS,
@@ -995,7 +1058,7 @@ void SffModule::overwriteChannelControlSettings() {
                           offset,
                           length);
       CHECK_EQ(length, 2);
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, offset, length, buf.data());
 
       buf.fill(0x22);
@@ -1004,7 +1067,7 @@ void SffModule::overwriteChannelControlSettings() {
                           offset,
                           length);
       CHECK_EQ(length, 2);
-      qsfpImpl_->writeTransceiver(
+      writeTransceiverLocked(
           TransceiverI2CApi::ADDR_QSFP, offset, length, buf.data());
 
       // Bump up the ODS counter.
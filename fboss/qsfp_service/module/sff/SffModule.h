@@ -207,8 +207,14 @@ class SffModule : public QsfpModule {
    * there is not much point in refreshing static data on other pages.
    */
   void updateQsfpData(bool allPages = true) override;
+  int getStatusBytesLength() override;
 
  private:
+  /*
+   * Whether the module asserted its interrupt or has any latched flag set,
+   * looking at the cached lower page bytes up to flagsEnd.
+   */
+  bool flagsRaised(int flagsEnd) const;
   /*
    * Helpers to parse DOM data for DAC cables. These incorporate some
    * extra fields that FB has vendors put in the 'Vendor specific'
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/qsfp_service/module/tests/MockCmisModule.h"
+#include "fboss/qsfp_service/module/tests/MockTransceiverImpl.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+
+namespace facebook { namespace fboss {
+using namespace ::testing;
+
+class CmisTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    auto transceiverImpl = std::make_unique<NiceMock<MockTransceiverImpl>>();
+    transImpl_ = transceiverImpl.get();
+    // A paged module with its interrupt deasserted and no flag raised
+    ON_CALL(*transImpl_, readTransceiver(_, _, _, _))
+        .WillByDefault(Invoke([](int, int offset, int len, uint8_t* data) {
+          std::fill(data, data + len, 0);
+          if (offset == 0) {
+            data[3] = 0x1;
+          }
+          return 0;
+        }));
+    EXPECT_CALL(*transImpl_, detectTransceiver()).WillRepeatedly(Return(true));
+    qsfp_ = std::make_unique<MockCmisModule>(
+        nullptr, std::move(transceiverImpl), 4);
+    qsfp_->detectPresence();
+  }
+
+  std::unique_ptr<MockCmisModule> qsfp_;
+  NiceMock<MockTransceiverImpl>* transImpl_;
+};
+
+TEST_F(CmisTest, updateQsfpDataFlagDrivenDom) {
+  // The first refresh reads all the pages, later ones only the lower page
+  // while no flag is raised
+  qsfp_->actualUpdateQsfpData(true);
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 128, _, _)).Times(0);
+  qsfp_->actualUpdateQsfpData(false);
+}
+
+TEST_F(CmisTest, writeRefreshesControlBytes) {
+  qsfp_->actualUpdateQsfpData(true);
+
+  // Writing the module control bytes has the next refresh read the DOM
+  // pages 10h, 11h and 14h again, so that they show what was written
+  EXPECT_CALL(*transImpl_, writeTransceiver(_, 26, _, _)).Times(2);
+  qsfp_->actualSetPowerOverrideIfSupported(PowerControlState::POWER_LPMODE);
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 128, _, _)).Times(3);
+  qsfp_->actualUpdateQsfpData(false);
+  Mock::VerifyAndClearExpectations(transImpl_);
+
+  // But only once
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 128, _, _)).Times(0);
+  qsfp_->actualUpdateQsfpData(false);
+}
+
+}} // namespace facebook::fboss
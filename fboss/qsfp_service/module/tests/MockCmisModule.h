@@ -0,0 +1,41 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#pragma once
+
+#include "fboss/qsfp_service/module/TransceiverImpl.h"
+#include "fboss/qsfp_service/module/cmis/CmisModule.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace facebook { namespace fboss {
+
+class MockCmisModule : public CmisModule {
+ public:
+  explicit MockCmisModule(
+      TransceiverManager* transceiverManager,
+      std::unique_ptr<TransceiverImpl> qsfpImpl,
+      unsigned int portsPerTransceiver)
+      : CmisModule(
+            transceiverManager,
+            std::move(qsfpImpl),
+            portsPerTransceiver) {}
+
+  // Provide way to call parent
+  void actualUpdateQsfpData(bool full) {
+    present_ = true;
+    CmisModule::updateQsfpData(full);
+  }
+  void actualSetPowerOverrideIfSupported(PowerControlState currentState) {
+    CmisModule::setPowerOverrideIfSupported(currentState);
+  }
+};
+}} // namespace facebook::fboss
@@ -62,6 +62,9 @@ class MockSffModule : public SffModule {
   void setFlatMem() {
     flatMem_ = false;
   }
+  int64_t getRefreshI2cBytes() const {
+    return refreshI2cBytes_;
+  }
 
 
   void customizeTransceiver(cfg::PortSpeed speed) override {
@@ -25,6 +25,12 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <array>
+
+DECLARE_int32(qsfp_data_refresh_interval);
+DECLARE_int32(customize_interval);
+
 namespace facebook { namespace fboss {
 using namespace ::testing;
 
@@ -406,6 +412,123 @@ TEST_F(QsfpModuleTest, updateQsfpDataFull) {
   qsfp_->actualUpdateQsfpData(true);
 }
 
+TEST_F(QsfpModuleTest, updateQsfpDataFlagDrivenDom) {
+  uint8_t flags = 0;
+  ON_CALL(*transImpl_, readTransceiver(_, 0, _, _))
+      .WillByDefault(Invoke([&flags](int, int, int len, uint8_t* data) {
+        std::fill(data, data + len, 0);
+        // IntL deasserted, and a single latched LOS flag byte
+        data[2] = 0x2;
+        data[3] = flags;
+        return 0;
+      }));
+
+  // The first refresh of a module always reads its DOM bytes, later ones
+  // only when the module raises a flag
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 22, _, _)).Times(1);
+  qsfp_->actualUpdateQsfpData(false);
+  auto bytes = qsfp_->getRefreshI2cBytes();
+  qsfp_->actualUpdateQsfpData(false);
+  EXPECT_EQ(22, qsfp_->getRefreshI2cBytes() - bytes);
+  Mock::VerifyAndClearExpectations(transImpl_);
+
+  flags = 0x1;
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 22, _, _)).Times(1);
+  qsfp_->actualUpdateQsfpData(false);
+}
+
+TEST_F(QsfpModuleTest, updateQsfpDataFullCachesStaticPages) {
+  ON_CALL(*transImpl_, readTransceiver(_, _, _, _))
+      .WillByDefault(DoAll(
+          InvokeWithoutArgs(qsfp_.get(), &MockSffModule::setFlatMem),
+          Return(0)));
+
+  // Page 0 and page 3 are only read once for the same module
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 128, _, _)).Times(2);
+  qsfp_->actualUpdateQsfpData(true);
+  auto bytes = qsfp_->getRefreshI2cBytes();
+  qsfp_->actualUpdateQsfpData(true);
+  EXPECT_GT(2 * 128, qsfp_->getRefreshI2cBytes() - bytes);
+  Mock::VerifyAndClearExpectations(transImpl_);
+
+  // Replacing the module drops the cache
+  EXPECT_CALL(*transImpl_, detectTransceiver()).WillOnce(Return(false));
+  qsfp_->detectPresence();
+  EXPECT_CALL(*transImpl_, detectTransceiver()).WillOnce(Return(true));
+  qsfp_->detectPresence();
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 128, _, _)).Times(2);
+  qsfp_->actualUpdateQsfpData(true);
+}
+
+TEST_F(QsfpModuleTest, updateQsfpDataPrefetchedStatus) {
+  qsfp_->actualUpdateQsfpData(false);
+
+  // The status bytes read ahead of the refresh are used instead of being
+  // read again, but only once
+  std::array<uint8_t, 22> status{};
+  qsfp_->setPrefetchedStatus(folly::range(status));
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 0, 22, _)).Times(0);
+  qsfp_->actualUpdateQsfpData(false);
+  Mock::VerifyAndClearExpectations(transImpl_);
+
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 0, 22, _)).Times(1);
+  qsfp_->actualUpdateQsfpData(false);
+  Mock::VerifyAndClearExpectations(transImpl_);
+
+  // Nor after writing to the module
+  ON_CALL(*qsfp_, setRateSelectIfSupported(_, _, _))
+      .WillByDefault(
+          Invoke(qsfp_.get(), &MockSffModule::actualSetRateSelectIfSupported));
+  qsfp_->setRateSelect(
+      RateSelectState::EXTENDED_RATE_SELECT_V2,
+      RateSelectSetting::LESS_THAN_12GB);
+  qsfp_->setPrefetchedStatus(folly::range(status));
+  EXPECT_CALL(*transImpl_, writeTransceiver(_, _, _, _)).Times(AtLeast(1));
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 0, 22, _)).Times(1);
+  qsfp_->customizeTransceiver(cfg::PortSpeed::HUNDREDG);
+  qsfp_->actualUpdateQsfpData(false);
+}
+
+TEST_F(QsfpModuleTest, noPrefetchedStatusWhenCustomizing) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_qsfp_data_refresh_interval = 0;
+  FLAGS_customize_interval = 300;
+  qsfp_->refresh();
+  ON_CALL(*qsfp_, updateQsfpData(_))
+      .WillByDefault(Invoke(qsfp_.get(), &MockSffModule::actualUpdateQsfpData));
+  qsfp_->transceiverPortsChanged({
+      {1, portStatus(true, false)},
+      {2, portStatus(true, false)},
+      {3, portStatus(true, false)},
+      {4, portStatus(true, false)},
+  });
+
+  // Customizing writes to the module, which would drop the latched flags
+  // read ahead of it
+  EXPECT_EQ(0, qsfp_->getStatusPrefetchLength());
+
+  // Status bytes prefetched just before customization became due are used,
+  // and customization waits for the next refresh
+  MockFunction<void()> nextRefresh;
+  {
+    InSequence s;
+    EXPECT_CALL(nextRefresh, Call());
+    EXPECT_CALL(*qsfp_, setCdrIfSupported(_, _, _)).Times(1);
+  }
+  std::array<uint8_t, 22> status{};
+  qsfp_->setPrefetchedStatus(folly::range(status));
+  EXPECT_CALL(*transImpl_, readTransceiver(_, 0, 22, _)).Times(0);
+  qsfp_->refresh();
+  Mock::VerifyAndClearExpectations(transImpl_);
+  EXPECT_CALL(*transImpl_, detectTransceiver()).WillRepeatedly(Return(true));
+
+  nextRefresh.Call();
+  qsfp_->refresh();
+
+  // Until the next customization is due
+  EXPECT_EQ(22, qsfp_->getStatusPrefetchLength());
+}
+
 TEST_F(QsfpModuleTest, skipCustomizingMissingPorts) {
   // set present_ = false, dirty_ = true
   EXPECT_CALL(*transImpl_, detectTransceiver()).WillRepeatedly(Return(false));
@@ -1,5 +1,6 @@
 #include "fboss/qsfp_service/platforms/wedge/WedgeManager.h"
 
+#include "fboss/lib/i2c/I2cController.h"
 #include "fboss/qsfp_service/module/QsfpModule.h"
 #include "fboss/qsfp_service/module/cmis/CmisModule.h"
 #include "fboss/qsfp_service/module/sff/SffModule.h"
@@ -279,15 +280,72 @@ void WedgeManager::refreshTransceivers() {
 
   auto lockedTransceivers = transceivers_.rlock();
 
+  // Transceivers behind the same I2C controller are refreshed together on
+  // its event base, so that their reads can be in flight at once
+  std::map<folly::EventBase*, std::vector<Transceiver*>> batches;
   for (const auto& transceiver : *lockedTransceivers) {
+    auto i2cEvb =
+        wedgeI2cBus_->getEventBase(static_cast<int>(transceiver.first) + 1);
+    if (i2cEvb) {
+      batches[i2cEvb].push_back(transceiver.second.get());
+      continue;
+    }
     XLOG(DBG3) << "Fired to refresh transceiver " << transceiver.second->getID();
     futs.push_back(transceiver.second->futureRefresh());
   }
+  for (auto& [i2cEvb, batch] : batches) {
+    XLOG(DBG3) << "Fired to refresh " << batch.size() << " transceivers";
+    futs.push_back(via(i2cEvb).thenValue(
+        [this, batch = std::move(batch)](auto&&) mutable {
+          refreshTransceiversBatched(batch);
+        }));
+  }
 
   folly::collectAll(futs.begin(), futs.end()).wait();
   XLOG(INFO) << "Finished refreshing all transceivers";
 }
 
+void WedgeManager::refreshTransceiversBatched(
+    const std::vector<Transceiver*>& batch) {
+  std::vector<TransceiverI2CRead> reads;
+  std::vector<Transceiver*> readFor;
+  const int kPageSize = QsfpModule::MAX_QSFP_PAGE_SIZE;
+  std::vector<uint8_t> buf(batch.size() * kPageSize);
+  for (auto transceiver : batch) {
+    auto len = transceiver->getStatusPrefetchLength();
+    if (len <= 0 || len > kPageSize) {
+      continue;
+    }
+    TransceiverI2CRead read;
+    read.module = static_cast<int>(transceiver->getID()) + 1;
+    read.i2cAddress = TransceiverI2CApi::ADDR_QSFP;
+    read.offset = 0;
+    read.len = len;
+    read.buf = buf.data() + reads.size() * kPageSize;
+    reads.push_back(read);
+    readFor.push_back(transceiver);
+  }
+  if (!reads.empty()) {
+    wedgeI2cBus_->moduleReadMultiple(reads);
+  }
+  for (size_t i = 0; i < reads.size(); ++i) {
+    // Failed reads are retried by the refresh itself
+    if (reads[i].success) {
+      readFor[i]->setPrefetchedStatus(
+          folly::ByteRange(reads[i].buf, reads[i].len));
+    }
+  }
+
+  for (auto transceiver : batch) {
+    try {
+      transceiver->refresh();
+    } catch (const std::exception& ex) {
+      XLOG(DBG2) << "Transceiver " << static_cast<int>(transceiver->getID())
+                 << ": Error calling refresh(): " << ex.what();
+    }
+  }
+}
+
 int WedgeManager::scanTransceiverPresence(
     std::unique_ptr<std::vector<int32_t>> ids) {
   // If the id list is empty, we default to scan the presence of all the
@@ -484,6 +542,16 @@ void WedgeManager::publishI2cTransactionStats() {
     statName = folly::to<std::string>(
         "qsfp.", *counter.controllerName__ref(), ".writeBytes");
     tcData().setCounter(statName, *counter.writeBytes__ref());
+
+    for (auto percentile : {50, 99}) {
+      statName = folly::to<std::string>(
+          "qsfp.",
+          *counter.controllerName__ref(),
+          ".latencyUsec.p",
+          percentile);
+      tcData().setCounter(
+          statName, getI2cLatencyPercentileUsec(counter, percentile));
+    }
   }
 }
 
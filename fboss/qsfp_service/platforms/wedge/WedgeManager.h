@@ -109,6 +109,12 @@ class WedgeManager : public TransceiverManager {
 
  private:
   void loadConfig() override;
+  /*
+   * Refresh transceivers behind the same I2C controller, with the status
+   * bytes each refresh starts with read for all of them in one batch. This
+   * must run on the event base of the controller.
+   */
+  void refreshTransceiversBatched(const std::vector<Transceiver*>& batch);
   // Forbidden copy constructor and assignment operator
   WedgeManager(WedgeManager const &) = delete;
   WedgeManager& operator=(WedgeManager const &) = delete;